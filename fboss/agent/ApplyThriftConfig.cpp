@@ -76,7 +76,11 @@ void updateFibFromConfig(
     facebook::fboss::RouterID vrf,
     const facebook::fboss::rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
     const facebook::fboss::rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const std::vector<folly::CIDRNetwork>* /* affectedPrefixes */,
     void* cookie) {
+  // Config is applied rarely, so rebuild the whole FIB rather than patching
+  // it. This also brings the FIB back in line with the RIB should a prior
+  // state update have been dropped.
   facebook::fboss::rib::ForwardingInformationBaseUpdater fibUpdater(
       vrf, v4NetworkToRoute, v6NetworkToRoute);
 
@@ -0,0 +1,491 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/BinaryDynamic.h"
+
+#include "fboss/agent/FbossError.h"
+
+#include <folly/File.h>
+#include <folly/FileUtil.h>
+#include <folly/MemoryMapping.h>
+#include <folly/json.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+constexpr char kMagic[] = {'F', 'B', 'W', 'B'};
+constexpr size_t kHeaderSize = sizeof(kMagic) + 1;
+constexpr size_t kFooterSize = sizeof(uint64_t) + sizeof(kMagic);
+constexpr size_t kWriteBufferSize = 64 * 1024;
+
+enum class Type : uint8_t {
+  NULLT = 0,
+  FALSE = 1,
+  TRUE = 2,
+  INT64 = 3,
+  DOUBLE = 4,
+  STRING = 5,
+  KEY = 6,
+  ARRAY = 7,
+  OBJECT = 8,
+};
+
+/*
+ * Produces the encoding, handing it out to sink in chunks of up to
+ * kWriteBufferSize bytes.
+ */
+template <typename Sink>
+class Encoder {
+ public:
+  explicit Encoder(Sink sink) : sink_(std::move(sink)) {
+    buf_.reserve(kWriteBufferSize);
+  }
+
+  void encode(const folly::dynamic& value) {
+    append(kMagic, sizeof(kMagic));
+    appendByte(facebook::fboss::kBinaryDynamicVersion);
+    encodeValue(value);
+
+    uint64_t dictOffset = offset_ + buf_.size();
+    appendVarint(keys_.size());
+    for (auto key : keys_) {
+      appendVarint(key.size());
+      append(key.data(), key.size());
+    }
+    for (auto i = 0; i < 8; ++i) {
+      appendByte(dictOffset >> (8 * i));
+    }
+    append(kMagic, sizeof(kMagic));
+    flush();
+  }
+
+ private:
+  void encodeValue(const folly::dynamic& value) {
+    switch (value.type()) {
+      case folly::dynamic::NULLT:
+        appendByte(static_cast<uint8_t>(Type::NULLT));
+        break;
+      case folly::dynamic::BOOL:
+        appendByte(static_cast<uint8_t>(value.asBool() ? Type::TRUE
+                                                       : Type::FALSE));
+        break;
+      case folly::dynamic::INT64: {
+        appendByte(static_cast<uint8_t>(Type::INT64));
+        auto i = value.asInt();
+        // zigzag, so that small negative numbers stay small
+        appendVarint((static_cast<uint64_t>(i) << 1) ^ (i >> 63));
+        break;
+      }
+      case folly::dynamic::DOUBLE: {
+        appendByte(static_cast<uint8_t>(Type::DOUBLE));
+        auto d = value.asDouble();
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        for (auto i = 0; i < 8; ++i) {
+          appendByte(bits >> (8 * i));
+        }
+        break;
+      }
+      case folly::dynamic::STRING: {
+        appendByte(static_cast<uint8_t>(Type::STRING));
+        auto str = value.stringPiece();
+        appendVarint(str.size());
+        append(str.data(), str.size());
+        break;
+      }
+      case folly::dynamic::ARRAY:
+        appendByte(static_cast<uint8_t>(Type::ARRAY));
+        appendVarint(value.size());
+        for (const auto& elem : value) {
+          encodeValue(elem);
+        }
+        break;
+      case folly::dynamic::OBJECT:
+        appendByte(static_cast<uint8_t>(Type::OBJECT));
+        appendVarint(value.size());
+        for (const auto& item : value.items()) {
+          if (item.first.isString()) {
+            encodeKey(item.first.stringPiece());
+          } else {
+            encodeValue(item.first);
+          }
+          encodeValue(item.second);
+        }
+        break;
+    }
+  }
+
+  void encodeKey(folly::StringPiece key) {
+    // The StringPieces point into the dynamic being encoded, which outlives
+    // the encoder.
+    auto ret = keyIndex_.emplace(key, keys_.size());
+    if (ret.second) {
+      keys_.push_back(key);
+    }
+    appendByte(static_cast<uint8_t>(Type::KEY));
+    appendVarint(ret.first->second);
+  }
+
+  void appendByte(uint8_t byte) {
+    if (buf_.size() == kWriteBufferSize) {
+      flush();
+    }
+    buf_.push_back(static_cast<char>(byte));
+  }
+
+  void appendVarint(uint64_t value) {
+    while (value >= 0x80) {
+      appendByte((value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+    appendByte(value);
+  }
+
+  void append(const char* data, size_t len) {
+    while (len > 0) {
+      if (buf_.size() == kWriteBufferSize) {
+        flush();
+      }
+      auto toCopy = std::min(len, kWriteBufferSize - buf_.size());
+      buf_.append(data, toCopy);
+      data += toCopy;
+      len -= toCopy;
+    }
+  }
+
+  void flush() {
+    offset_ += buf_.size();
+    sink_(folly::StringPiece(buf_));
+    buf_.clear();
+  }
+
+  Sink sink_;
+  std::string buf_;
+  uint64_t offset_{0};
+  std::vector<folly::StringPiece> keys_;
+  std::unordered_map<folly::StringPiece, uint64_t> keyIndex_;
+};
+
+template <typename Sink>
+void encode(const folly::dynamic& value, Sink sink) {
+  Encoder<Sink>(std::move(sink)).encode(value);
+}
+
+/*
+ * Walks over an encoded value. Bounds are checked on every read since the
+ * input comes from a file that could be truncated or corrupt.
+ */
+class Decoder {
+ public:
+  Decoder(folly::ByteRange data, const std::vector<folly::StringPiece>& keys)
+      : data_(data), keys_(keys) {}
+
+  folly::dynamic decodeValue() {
+    switch (readType()) {
+      case Type::NULLT:
+        return nullptr;
+      case Type::FALSE:
+        return false;
+      case Type::TRUE:
+        return true;
+      case Type::INT64: {
+        auto zigzag = readVarint();
+        return static_cast<int64_t>((zigzag >> 1) ^ -(zigzag & 1));
+      }
+      case Type::DOUBLE: {
+        auto bits = readFixed64();
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+      }
+      case Type::STRING:
+        return readString();
+      case Type::KEY:
+        return readKey();
+      case Type::ARRAY: {
+        auto count = readCount();
+        auto array = folly::dynamic::array();
+        array.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+          array.push_back(decodeValue());
+        }
+        return array;
+      }
+      case Type::OBJECT: {
+        auto count = readCount();
+        auto object = folly::dynamic::object();
+        for (uint64_t i = 0; i < count; ++i) {
+          auto key = decodeValue();
+          object[std::move(key)] = decodeValue();
+        }
+        return object;
+      }
+    }
+    throw facebook::fboss::FbossError("Invalid binary state value type");
+  }
+
+  /*
+   * Skip over the next value without decoding it.
+   */
+  void skipValue() {
+    switch (readType()) {
+      case Type::NULLT:
+      case Type::FALSE:
+      case Type::TRUE:
+        return;
+      case Type::INT64:
+      case Type::KEY:
+        readVarint();
+        return;
+      case Type::DOUBLE:
+        readFixed64();
+        return;
+      case Type::STRING:
+        advance(readVarint());
+        return;
+      case Type::ARRAY: {
+        auto count = readCount();
+        for (uint64_t i = 0; i < count; ++i) {
+          skipValue();
+        }
+        return;
+      }
+      case Type::OBJECT: {
+        auto count = readCount();
+        for (uint64_t i = 0; i < count; ++i) {
+          skipValue();
+          skipValue();
+        }
+        return;
+      }
+    }
+    throw facebook::fboss::FbossError("Invalid binary state value type");
+  }
+
+  /*
+   * If the next value is an object, position the decoder at its value for
+   * key and return true. Otherwise return false.
+   */
+  bool findMember(folly::StringPiece key) {
+    if (readType() != Type::OBJECT) {
+      return false;
+    }
+    auto count = readCount();
+    for (uint64_t i = 0; i < count; ++i) {
+      auto type = peekType();
+      if (type == Type::KEY || type == Type::STRING) {
+        readType();
+        auto memberKey = type == Type::KEY ? readKey() : readString();
+        if (memberKey == key) {
+          return true;
+        }
+      } else {
+        skipValue();
+      }
+      skipValue();
+    }
+    return false;
+  }
+
+  uint64_t readVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      auto byte = readByte();
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+    throw facebook::fboss::FbossError("Invalid varint in binary state");
+  }
+
+  folly::StringPiece readString() {
+    auto len = readVarint();
+    auto start = data_.data();
+    advance(len);
+    return folly::StringPiece(
+        reinterpret_cast<const char*>(start), static_cast<size_t>(len));
+  }
+
+ private:
+  Type peekType() const {
+    checkAvailable(1);
+    return static_cast<Type>(data_.front());
+  }
+
+  Type readType() {
+    return static_cast<Type>(readByte());
+  }
+
+  uint8_t readByte() {
+    checkAvailable(1);
+    auto byte = data_.front();
+    data_.advance(1);
+    return byte;
+  }
+
+  uint64_t readFixed64() {
+    checkAvailable(8);
+    uint64_t value = 0;
+    for (auto i = 0; i < 8; ++i) {
+      value |= static_cast<uint64_t>(data_[i]) << (8 * i);
+    }
+    data_.advance(8);
+    return value;
+  }
+
+  uint64_t readCount() {
+    auto count = readVarint();
+    // Every element takes at least a byte, so a larger count is corrupt
+    checkAvailable(count);
+    return count;
+  }
+
+  folly::StringPiece readKey() {
+    auto index = readVarint();
+    if (index >= keys_.size()) {
+      throw facebook::fboss::FbossError(
+          "Invalid key index ", index, " in binary state");
+    }
+    return keys_[index];
+  }
+
+  void advance(uint64_t len) {
+    checkAvailable(len);
+    data_.advance(len);
+  }
+
+  void checkAvailable(uint64_t len) const {
+    if (data_.size() < len) {
+      throw facebook::fboss::FbossError("Truncated binary state");
+    }
+  }
+
+  folly::ByteRange data_;
+  const std::vector<folly::StringPiece>& keys_;
+};
+
+} // namespace
+
+namespace facebook::fboss {
+
+std::string toBinaryDynamic(const folly::dynamic& value) {
+  std::string out;
+  encode(value, [&out](folly::StringPiece chunk) {
+    out.append(chunk.data(), chunk.size());
+  });
+  return out;
+}
+
+bool dumpBinaryStateToFile(
+    const std::string& filename,
+    const folly::dynamic& value) {
+  // Write to a temporary file and rename it over the old one once it is on
+  // disk, so that a crash or a full disk halfway through the write leaves
+  // the previous state file intact.
+  auto tmpFilename = filename + ".tmp";
+  int fd = folly::openNoInt(
+      tmpFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666 /* mode */);
+  if (fd == -1) {
+    return false;
+  }
+  bool ok = true;
+  encode(value, [fd, &ok](folly::StringPiece chunk) {
+    if (ok) {
+      auto written = folly::writeFull(fd, chunk.data(), chunk.size());
+      ok = written == static_cast<ssize_t>(chunk.size());
+    }
+  });
+  if (ok && folly::fsyncNoInt(fd) != 0) {
+    ok = false;
+  }
+  if (folly::closeNoInt(fd) != 0) {
+    ok = false;
+  }
+  if (ok && ::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+    ok = false;
+  }
+  if (!ok) {
+    ::unlink(tmpFilename.c_str());
+  }
+  return ok;
+}
+
+bool isBinaryDynamic(folly::ByteRange data) {
+  return data.size() >= kHeaderSize + kFooterSize &&
+      std::memcmp(data.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+BinaryDynamicReader::BinaryDynamicReader(folly::ByteRange data) {
+  if (!isBinaryDynamic(data)) {
+    throw FbossError("Not a binary state");
+  }
+  auto version = data[sizeof(kMagic)];
+  if (version > kBinaryDynamicVersion) {
+    throw FbossError(
+        "Unsupported binary state version ",
+        static_cast<int>(version),
+        ", expected at most ",
+        static_cast<int>(kBinaryDynamicVersion));
+  }
+  auto footer = data.subpiece(data.size() - kFooterSize);
+  if (std::memcmp(
+          footer.data() + sizeof(uint64_t), kMagic, sizeof(kMagic)) != 0) {
+    throw FbossError("Truncated binary state, footer missing");
+  }
+  uint64_t dictOffset = 0;
+  for (auto i = 0; i < 8; ++i) {
+    dictOffset |= static_cast<uint64_t>(footer[i]) << (8 * i);
+  }
+  if (dictOffset < kHeaderSize || dictOffset > data.size() - kFooterSize) {
+    throw FbossError("Invalid binary state dictionary offset ", dictOffset);
+  }
+
+  data_ = data.subpiece(kHeaderSize, dictOffset - kHeaderSize);
+  Decoder dict(
+      data.subpiece(dictOffset, data.size() - kFooterSize - dictOffset),
+      keys_);
+  auto numKeys = dict.readVarint();
+  keys_.reserve(numKeys);
+  for (uint64_t i = 0; i < numKeys; ++i) {
+    keys_.push_back(dict.readString());
+  }
+}
+
+folly::dynamic BinaryDynamicReader::decode() const {
+  return Decoder(data_, keys_).decodeValue();
+}
+
+folly::dynamic BinaryDynamicReader::decode(
+    const std::vector<std::string>& path) const {
+  Decoder decoder(data_, keys_);
+  for (const auto& key : path) {
+    if (!decoder.findMember(key)) {
+      return nullptr;
+    }
+  }
+  return decoder.decodeValue();
+}
+
+folly::dynamic readStateFromFile(const std::string& filename) {
+  folly::MemoryMapping mapping(filename.c_str());
+  auto data = mapping.range();
+  if (isBinaryDynamic(data)) {
+    return BinaryDynamicReader(data).decode();
+  }
+  // State written by older versions, or with binary state disabled
+  return folly::parseJson(folly::StringPiece(data));
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Range.h>
+#include <folly/dynamic.h>
+
+#include <string>
+#include <vector>
+
+namespace facebook::fboss {
+
+/*
+ * A compact, versioned binary encoding of folly::dynamic, used to store the
+ * warm boot state.
+ *
+ * Compared to JSON, integers are varint encoded, doubles are stored in binary
+ * and each object key string is only stored once, in a dictionary at the end
+ * of the file, no matter how many objects use it. The encoding is written out
+ * as it is produced, so a large state never has to be held in memory as a
+ * single string.
+ *
+ * Layout:
+ *   header:     magic (4 bytes), version (1 byte)
+ *   value:      type (1 byte), followed by
+ *                 INT64:  zigzag varint
+ *                 DOUBLE: 8 bytes, little endian
+ *                 STRING: varint length, bytes
+ *                 KEY:    varint index into the key dictionary
+ *                 ARRAY:  varint count, values
+ *                 OBJECT: varint count, (key value, value) pairs
+ *   dictionary: varint count, (varint length, bytes) for each key
+ *   footer:     dictionary offset (8 bytes, little endian), magic (4 bytes)
+ */
+constexpr uint8_t kBinaryDynamicVersion = 1;
+
+/*
+ * Encode value into a string.
+ */
+std::string toBinaryDynamic(const folly::dynamic& value);
+
+/*
+ * Encode value and write it to filename. Returns false on error, same as
+ * dumpStateToFile(), in which case any existing filename is left as it was.
+ */
+bool dumpBinaryStateToFile(
+    const std::string& filename,
+    const folly::dynamic& value);
+
+/*
+ * Returns true if data starts with the binary dynamic header. Used to tell
+ * binary state files apart from the JSON ones written by older versions.
+ */
+bool isBinaryDynamic(folly::ByteRange data);
+
+/*
+ * Decodes values from an encoded buffer, typically an mmap'ed file. The
+ * buffer must outlive the reader.
+ *
+ * decode(path) only decodes the subtree at path into folly::dynamic and
+ * skips over the rest, which is what tools inspecting part of a state file
+ * want. decode() decodes everything, eagerly.
+ */
+class BinaryDynamicReader {
+ public:
+  explicit BinaryDynamicReader(folly::ByteRange data);
+
+  /*
+   * Decode the whole value.
+   */
+  folly::dynamic decode() const;
+
+  /*
+   * Decode only the value found by following path, a list of object keys,
+   * from the top level object. Returns nullptr if there is no such value.
+   */
+  folly::dynamic decode(const std::vector<std::string>& path) const;
+
+ private:
+  folly::ByteRange data_;
+  std::vector<folly::StringPiece> keys_;
+};
+
+/*
+ * Read a state file, either binary or JSON, into folly::dynamic. The whole
+ * state is decoded, as warm boot needs all of it. Mapping the file only
+ * saves reading it into a string first.
+ */
+folly::dynamic readStateFromFile(const std::string& filename);
+
+} // namespace facebook::fboss
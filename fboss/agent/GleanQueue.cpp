@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/GleanQueue.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+
+DEFINE_bool(
+    glean_queue,
+    false,
+    "Hold packets whose next hop is unresolved until ARP or NDP resolves "
+    "it, rather than dropping them");
+DEFINE_int32(
+    glean_queue_packets_per_nexthop,
+    16,
+    "Number of packets held for each unresolved next hop");
+DEFINE_int32(
+    glean_queue_packets_per_vlan,
+    256,
+    "Number of packets held for the unresolved next hops of each VLAN");
+DEFINE_int64(
+    glean_queue_max_bytes,
+    4 << 20,
+    "Total size of the packets held for unresolved next hops");
+DEFINE_int32(
+    glean_queue_ttl_ms,
+    1000,
+    "Time after which packets held for an unresolved next hop are dropped, "
+    "and another ARP request or neighbor solicitation may be sent for it");
+
+namespace facebook::fboss {
+
+GleanQueue::Config GleanQueue::Config::fromFlags() {
+  Config config;
+  config.maxPacketsPerNexthop =
+      std::max(FLAGS_glean_queue_packets_per_nexthop, 0);
+  config.maxPacketsPerVlan = std::max(FLAGS_glean_queue_packets_per_vlan, 0);
+  config.maxBytes = std::max<int64_t>(FLAGS_glean_queue_max_bytes, 0);
+  config.ttl = std::chrono::milliseconds(std::max(FLAGS_glean_queue_ttl_ms, 0));
+  return config;
+}
+
+bool GleanQueue::requestNeeded(
+    VlanID vlan,
+    const folly::IPAddress& ip,
+    Clock::time_point now) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto& entry = entries_[std::make_pair(vlan, ip)];
+  if (entry.requested != Clock::time_point() && outstanding(entry, now)) {
+    return false;
+  }
+  entry.requested = now;
+  return true;
+}
+
+bool GleanQueue::hasRoom(
+    VlanID vlan,
+    const folly::IPAddress& ip,
+    uint64_t bytes) const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return fits(vlan, ip, bytes);
+}
+
+bool GleanQueue::enqueue(
+    VlanID vlan,
+    const folly::IPAddress& ip,
+    Packet pkt,
+    Clock::time_point now) {
+  auto bytes = packetBytes(pkt);
+  std::lock_guard<std::mutex> guard(lock_);
+  if (!fits(vlan, ip, bytes)) {
+    return false;
+  }
+  auto& entry = entries_[std::make_pair(vlan, ip)];
+  if (entry.requested == Clock::time_point()) {
+    // Queued without a request of ours, e.g. while an entry programmed by
+    // someone else is pending. Expire it as if we had sent one now.
+    entry.requested = now;
+  }
+  entry.packets.push_back(QueuedPacket{now, std::move(pkt)});
+  ++vlanPackets_[vlan];
+  ++numPackets_;
+  numBytes_ += bytes;
+  return true;
+}
+
+std::vector<GleanQueue::Packet> GleanQueue::resolved(
+    VlanID vlan,
+    const folly::IPAddress& ip) {
+  std::vector<Packet> packets;
+  std::lock_guard<std::mutex> guard(lock_);
+  auto itr = entries_.find(std::make_pair(vlan, ip));
+  if (itr == entries_.end()) {
+    return packets;
+  }
+  packets.reserve(itr->second.packets.size());
+  for (auto& queued : itr->second.packets) {
+    dequeued(vlan, queued.pkt);
+    packets.push_back(std::move(queued.pkt));
+  }
+  entries_.erase(itr);
+  return packets;
+}
+
+uint32_t GleanQueue::remove(VlanID vlan, const folly::IPAddress& ip) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto itr = entries_.find(std::make_pair(vlan, ip));
+  if (itr == entries_.end()) {
+    return 0;
+  }
+  uint32_t dropped = itr->second.packets.size();
+  for (const auto& queued : itr->second.packets) {
+    dequeued(vlan, queued.pkt);
+  }
+  entries_.erase(itr);
+  return dropped;
+}
+
+uint32_t GleanQueue::expire(Clock::time_point now) {
+  uint32_t dropped = 0;
+  std::lock_guard<std::mutex> guard(lock_);
+  for (auto itr = entries_.begin(); itr != entries_.end();) {
+    auto vlan = itr->first.first;
+    auto& packets = itr->second.packets;
+    // Packets are queued in order, so the oldest ones are in front
+    while (!packets.empty() && now - packets.front().queued >= config_.ttl) {
+      dequeued(vlan, packets.front().pkt);
+      packets.pop_front();
+      ++dropped;
+    }
+    if (packets.empty() && !outstanding(itr->second, now)) {
+      itr = entries_.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
+  return dropped;
+}
+
+uint32_t GleanQueue::numPackets() const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return numPackets_;
+}
+
+uint64_t GleanQueue::numBytes() const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return numBytes_;
+}
+
+bool GleanQueue::fits(
+    VlanID vlan,
+    const folly::IPAddress& ip,
+    uint64_t bytes) const {
+  auto vlanItr = vlanPackets_.find(vlan);
+  auto vlanPackets = vlanItr == vlanPackets_.end() ? 0 : vlanItr->second;
+  if (numBytes_ + bytes > config_.maxBytes ||
+      vlanPackets >= config_.maxPacketsPerVlan) {
+    return false;
+  }
+  auto itr = entries_.find(std::make_pair(vlan, ip));
+  return itr == entries_.end() ||
+      itr->second.packets.size() < config_.maxPacketsPerNexthop;
+}
+
+void GleanQueue::dequeued(VlanID vlan, const Packet& pkt) {
+  auto vlanItr = vlanPackets_.find(vlan);
+  CHECK(vlanItr != vlanPackets_.end());
+  if (--vlanItr->second == 0) {
+    vlanPackets_.erase(vlanItr);
+  }
+  --numPackets_;
+  numBytes_ -= packetBytes(pkt);
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,178 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/types.h"
+
+#include <folly/IPAddress.h>
+#include <folly/MacAddress.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace facebook::fboss {
+
+/*
+ * GleanQueue holds on to the packets trapped to us because their next hop
+ * has no ARP or NDP entry yet, so that they can be sent out once the entry
+ * is resolved rather than dropped.
+ *
+ * Packets are queued per next hop, i.e. per VLAN and neighbor IP. A next
+ * hop's entry also records when we last sent an ARP request or neighbor
+ * solicitation for it, so that we send one request per next hop while it
+ * is outstanding instead of one per trapped packet.
+ *
+ * The queue is bounded by the number of packets per next hop and per VLAN,
+ * and by the total number of bytes held. Packets are dropped when they
+ * have been queued for longer than the TTL, and a request is considered
+ * outstanding for one TTL after it was sent. All methods are thread safe.
+ */
+class GleanQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Config {
+    uint32_t maxPacketsPerNexthop{16};
+    uint32_t maxPacketsPerVlan{256};
+    uint64_t maxBytes{4 << 20};
+    std::chrono::milliseconds ttl{1000};
+
+    static Config fromFlags();
+  };
+
+  /*
+   * An L3 packet to route once its next hop is resolved, by sending it to
+   * dstMac, the router MAC it was trapped with, on the VLAN it came in on.
+   */
+  struct Packet {
+    VlanID vlan{0};
+    folly::MacAddress dstMac;
+    uint16_t ethertype{0};
+    std::unique_ptr<folly::IOBuf> l3Packet;
+  };
+
+  /*
+   * Copy the IPv4 or IPv6 packet with header hdr and the payloadLength
+   * bytes at payload, as the trapped packet's buffer is not ours to keep.
+   * payload must hold at least payloadLength bytes.
+   */
+  template <typename IPHdr>
+  static Packet makePacket(
+      VlanID vlan,
+      folly::MacAddress dstMac,
+      uint16_t ethertype,
+      const IPHdr& hdr,
+      folly::io::Cursor payload,
+      uint32_t payloadLength) {
+    auto length = hdr.size() + payloadLength;
+    auto l3Packet = folly::IOBuf::create(length);
+    l3Packet->append(length);
+    folly::io::RWPrivateCursor cursor(l3Packet.get());
+    hdr.serialize(&cursor);
+    cursor.push(payload, payloadLength);
+    return Packet{vlan, dstMac, ethertype, std::move(l3Packet)};
+  }
+
+  explicit GleanQueue(const Config& config) : config_(config) {}
+
+  /*
+   * Called before sending an ARP request or neighbor solicitation for ip
+   * on vlan. Returns false if a request is already outstanding, in which
+   * case the caller should not send another one.
+   */
+  bool requestNeeded(
+      VlanID vlan,
+      const folly::IPAddress& ip,
+      Clock::time_point now = Clock::now());
+
+  /*
+   * Returns false if a packet of the given size would be dropped by
+   * enqueue() because a limit was hit, so that callers can skip copying
+   * it. enqueue() checks the limits again, as another packet may have
+   * taken the room since.
+   */
+  bool hasRoom(VlanID vlan, const folly::IPAddress& ip, uint64_t bytes) const;
+
+  /*
+   * Queue pkt until ip is resolved on vlan. Returns false if pkt was
+   * dropped because a limit was hit.
+   */
+  bool enqueue(
+      VlanID vlan,
+      const folly::IPAddress& ip,
+      Packet pkt,
+      Clock::time_point now = Clock::now());
+
+  /*
+   * Take the packets waiting for ip on vlan, now that it is resolved.
+   */
+  std::vector<Packet> resolved(VlanID vlan, const folly::IPAddress& ip);
+
+  /*
+   * Drop the packets waiting for ip on vlan, e.g. because the pending
+   * neighbor entry expired. Returns the number of packets dropped.
+   */
+  uint32_t remove(VlanID vlan, const folly::IPAddress& ip);
+
+  /*
+   * Drop the packets queued for longer than the TTL, and forget the
+   * requests sent longer than the TTL ago. Returns the number of packets
+   * dropped.
+   */
+  uint32_t expire(Clock::time_point now = Clock::now());
+
+  uint32_t numPackets() const;
+  uint64_t numBytes() const;
+
+ private:
+  using Nexthop = std::pair<VlanID, folly::IPAddress>;
+
+  struct QueuedPacket {
+    Clock::time_point queued;
+    Packet pkt;
+  };
+
+  struct NexthopEntry {
+    Clock::time_point requested;
+    std::deque<QueuedPacket> packets;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  GleanQueue(GleanQueue const&) = delete;
+  GleanQueue& operator=(GleanQueue const&) = delete;
+
+  static uint64_t packetBytes(const Packet& pkt) {
+    return pkt.l3Packet->computeChainDataLength();
+  }
+  // Whether a packet of the given size fits, lock_ must be held
+  bool fits(VlanID vlan, const folly::IPAddress& ip, uint64_t bytes) const;
+  // Account for pkt leaving the queue
+  void dequeued(VlanID vlan, const Packet& pkt);
+  bool outstanding(const NexthopEntry& entry, Clock::time_point now) const {
+    return now - entry.requested < config_.ttl;
+  }
+
+  const Config config_;
+  mutable std::mutex lock_;
+  std::map<Nexthop, NexthopEntry> entries_;
+  std::map<VlanID, uint32_t> vlanPackets_;
+  uint32_t numPackets_{0};
+  uint64_t numBytes_{0};
+};
+
+} // namespace facebook::fboss
@@ -9,6 +9,7 @@
  */
 #include "IPv4Handler.h"
 
+#include <algorithm>
 #include <folly/IPAddress.h>
 #include <folly/IPAddressV4.h>
 #include <folly/MacAddress.h>
@@ -17,6 +18,7 @@
 #include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/DHCPv4Handler.h"
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/GleanQueue.h"
 #include "fboss/agent/HwSwitch.h"
 #include "fboss/agent/IPHeaderV4.h"
 #include "fboss/agent/NeighborUpdater.h"
@@ -135,9 +137,11 @@ void IPv4Handler::handlePacket(
              << " --> " << v4Hdr.dstAddr.str() << " proto: 0x" << std::hex
              << static_cast<int>(v4Hdr.protocol);
 
-  // Additional data (such as FCS) may be appended after the IP payload
-  auto payload =
-      folly::IOBuf::wrapBuffer(cursor.data(), v4Hdr.length - v4Hdr.size());
+  // Additional data (such as FCS) may be appended after the IP payload, and
+  // a bogus total length must not take us past the end of the packet
+  auto payload = folly::IOBuf::wrapBuffer(
+      cursor.data(),
+      std::min<size_t>(v4Hdr.length - v4Hdr.size(), cursor.length()));
   cursor.reset(payload.get());
 
   // retrieve the current switch state
@@ -230,22 +234,67 @@ void IPv4Handler::handlePacket(
   // We will need to manage the rate somehow. Either from HW
   // or a SW control here
   stats->port(port)->ipv4Nexthop();
-  if (!resolveMac(state, port, v4Hdr.dstAddr, pkt->getSrcVlan())) {
+  std::optional<std::pair<VlanID, IPAddressV4>> unresolved;
+  if (!resolveMac(
+          state, port, v4Hdr.dstAddr, pkt->getSrcVlan(), &unresolved)) {
     stats->port(port)->ipv4NoArp();
     XLOG(DBG4) << "Cannot find the interface to send out ARP request for "
                << v4Hdr.dstAddr.str();
   }
-  // TODO: ideally, we need to store this packet until the ARP is done and
-  // then send this pkt out. For now, just drop it.
+  // Hold on to the packet until the ARP is done, if we can
+  if (unresolved &&
+      gleanPacket(
+          pkt.get(),
+          dst,
+          v4Hdr,
+          cursor,
+          unresolved->first,
+          unresolved->second)) {
+    return;
+  }
   stats->port(port)->pktDropped();
 }
 
+bool IPv4Handler::gleanPacket(
+    const RxPacket* pkt,
+    MacAddress dst,
+    const IPv4Hdr& v4Hdr,
+    Cursor cursor,
+    VlanID vlan,
+    IPAddressV4 nexthop) {
+  auto gleanQueue = sw_->getGleanQueue();
+  if (!gleanQueue) {
+    return false;
+  }
+  uint32_t payloadLength = v4Hdr.length - v4Hdr.size();
+  if (payloadLength > cursor.totalLength()) {
+    XLOG(DBG4) << "not holding IPv4 packet for " << nexthop.str()
+               << ", total length " << v4Hdr.length << " exceeds the packet";
+    return false;
+  }
+  // Check for room before copying the packet, rather than when queueing it
+  if (!gleanQueue->hasRoom(
+          vlan, IPAddress(nexthop), v4Hdr.size() + payloadLength)) {
+    sw_->stats()->gleanQueueFull();
+    return false;
+  }
+  auto gleaned = GleanQueue::makePacket(
+      pkt->getSrcVlan(), dst, ETHERTYPE_IPV4, v4Hdr, cursor, payloadLength);
+  if (!gleanQueue->enqueue(vlan, IPAddress(nexthop), std::move(gleaned))) {
+    sw_->stats()->gleanQueueFull();
+    return false;
+  }
+  sw_->stats()->gleanQueued();
+  return true;
+}
+
 // Return true if we successfully sent an ARP request, false otherwise
 bool IPv4Handler::resolveMac(
     std::shared_ptr<SwitchState> state,
     PortID ingressPort,
     IPAddressV4 dest,
-    VlanID ingressVlan) {
+    VlanID ingressVlan,
+    std::optional<std::pair<VlanID, IPAddressV4>>* unresolved) {
   // need to find out our own IP and MAC addresses so that we can send the
   // ARP request out. Since the request will be broadcast, there is no need to
   // worry about which port to send the packet out.
@@ -281,7 +330,20 @@ bool IPv4Handler::resolveMac(
       auto vlan = state->getVlans()->getVlanIf(vlanID);
       if (vlan) {
         auto entry = vlan->getArpTable()->getEntryIf(target);
-        if (entry == nullptr) {
+        if (unresolved && !*unresolved &&
+            (entry == nullptr || entry->isPending())) {
+          *unresolved = std::make_pair(vlanID, target);
+        }
+        auto gleanQueue = sw_->getGleanQueue();
+        if (entry == nullptr && gleanQueue &&
+            !gleanQueue->requestNeeded(vlanID, IPAddress(target))) {
+          // The ARP request we sent is still outstanding, its pending entry
+          // just hasn't made it to the switch state yet
+          XLOG(DBG4) << "not sending arp for " << target.str()
+                     << ", request outstanding";
+          sw_->stats()->gleanRequestSuppressed();
+          sent = true;
+        } else if (entry == nullptr) {
           // No entry in ARP table, send ARP request
           auto mac = intf->getMac();
           ArpHandler::sendArpRequest(sw_, vlanID, mac, source, target);
@@ -12,6 +12,8 @@
 #include "fboss/agent/types.h"
 
 #include <memory>
+#include <optional>
+#include <utility>
 
 #include <folly/IPAddressV4.h>
 #include <folly/MacAddress.h>
@@ -45,12 +47,17 @@ class IPv4Handler {
   /*
    * TODO(aeckert): t17949183 unify packet handling pipeline and then
    * make this private again.
+   *
+   * If unresolved is given, it is set to a next hop to dest without a
+   * resolved ARP entry, if any.
    */
   bool resolveMac(
       std::shared_ptr<SwitchState> state,
       PortID ingressPort,
       folly::IPAddressV4 dest,
-      VlanID ingressVlan);
+      VlanID ingressVlan,
+      std::optional<std::pair<VlanID, folly::IPAddressV4>>* unresolved =
+          nullptr);
 
  private:
   void sendICMPTimeExceeded(
@@ -60,6 +67,18 @@ class IPv4Handler {
       IPv4Hdr& v4Hdr,
       folly::io::Cursor cursor);
 
+  /*
+   * Hand the packet over to the GleanQueue until its next hop is resolved.
+   * Returns false if the packet should be dropped instead.
+   */
+  bool gleanPacket(
+      const RxPacket* pkt,
+      folly::MacAddress dst,
+      const IPv4Hdr& v4Hdr,
+      folly::io::Cursor cursor,
+      VlanID vlan,
+      folly::IPAddressV4 nexthop);
+
   // Forbidden copy constructor and assignment operator
   IPv4Handler(IPv4Handler const&) = delete;
   IPv4Handler& operator=(IPv4Handler const&) = delete;
@@ -9,11 +9,13 @@
  */
 #include "fboss/agent/IPv6Handler.h"
 
+#include <algorithm>
 #include <folly/Format.h>
 #include <folly/MacAddress.h>
 #include <folly/logging/xlog.h>
 #include "fboss/agent/DHCPv6Handler.h"
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/GleanQueue.h"
 #include "fboss/agent/NeighborUpdater.h"
 #include "fboss/agent/Platform.h"
 #include "fboss/agent/RxPacket.h"
@@ -40,6 +42,7 @@
 #include "fboss/agent/state/Vlan.h"
 #include "fboss/agent/state/VlanMap.h"
 
+using folly::IPAddress;
 using folly::IPAddressV6;
 using folly::MacAddress;
 using folly::io::Cursor;
@@ -141,8 +144,10 @@ void IPv6Handler::handlePacket(
              << " dst: " << ipv6.dstAddr.str() << " (" << dst << ")"
              << " nextHeader: " << static_cast<int>(ipv6.nextHeader);
 
-  // Additional data (such as FCS) may be appended after the IP payload
-  auto payload = folly::IOBuf::wrapBuffer(cursor.data(), ipv6.payloadLength);
+  // Additional data (such as FCS) may be appended after the IP payload, and
+  // a bogus payload length must not take us past the end of the packet
+  auto payload = folly::IOBuf::wrapBuffer(
+      cursor.data(), std::min<size_t>(ipv6.payloadLength, cursor.length()));
   cursor.reset(payload.get());
 
   // retrieve the current switch state
@@ -751,6 +756,7 @@ void IPv6Handler::resolveDestAndHandlePacket(
 
   auto interfaces = state->getInterfaces();
   auto nexthops = route->getForwardInfo().getNextHopSet();
+  std::optional<std::pair<VlanID, IPAddressV6>> unresolved;
 
   for (auto nexthop : nexthops) {
     // get interface needed to reach next hop
@@ -783,13 +789,16 @@ void IPv6Handler::resolveDestAndHandlePacket(
         auto vlan = state->getVlans()->getVlanIf(vlanID);
         if (vlan) {
           auto entry = vlan->getNdpTable()->getEntryIf(target);
-          if (nullptr == entry) {
+          if (!unresolved && (nullptr == entry || entry->isPending())) {
+            unresolved = std::make_pair(vlanID, target);
+          }
+          if (nullptr == entry && solicitationNeeded(vlanID, target)) {
             // No entry in NDP table, create a neighbor solicitation packet
             sendMulticastNeighborSolicitation(
                 sw_, target, intf->getMac(), vlan->getID());
             // Notify the updater that we sent a solicitation out
             sw_->getNeighborUpdater()->sentNeighborSolicitation(vlanID, target);
-          } else {
+          } else if (nullptr != entry) {
             XLOG(DBG5) << "not sending neighbor solicitation for "
                        << target.str() << ", "
                        << ((entry->isPending()) ? "pending" : "")
@@ -799,9 +808,60 @@ void IPv6Handler::resolveDestAndHandlePacket(
       }
     }
   }
+  // Hold on to the packet until the next hop is resolved, if we can
+  if (unresolved &&
+      gleanPacket(
+          pkt.get(), dst, hdr, cursor, unresolved->first, unresolved->second)) {
+    return;
+  }
   sw_->portStats(pkt)->pktDropped();
 }
 
+bool IPv6Handler::solicitationNeeded(VlanID vlan, const IPAddressV6& target) {
+  auto gleanQueue = sw_->getGleanQueue();
+  if (gleanQueue && !gleanQueue->requestNeeded(vlan, IPAddress(target))) {
+    // Its pending entry just hasn't made it to the switch state yet
+    XLOG(DBG5) << "not sending neighbor solicitation for " << target.str()
+               << ", request outstanding";
+    sw_->stats()->gleanRequestSuppressed();
+    return false;
+  }
+  return true;
+}
+
+bool IPv6Handler::gleanPacket(
+    const RxPacket* pkt,
+    MacAddress dst,
+    const IPv6Hdr& hdr,
+    Cursor cursor,
+    VlanID vlan,
+    const IPAddressV6& nexthop) {
+  auto gleanQueue = sw_->getGleanQueue();
+  if (!gleanQueue) {
+    return false;
+  }
+  if (hdr.payloadLength > cursor.totalLength()) {
+    XLOG(DBG4) << "not holding IPv6 packet for " << nexthop.str()
+               << ", payload length " << hdr.payloadLength
+               << " exceeds the packet";
+    return false;
+  }
+  // Check for room before copying the packet, rather than when queueing it
+  if (!gleanQueue->hasRoom(
+          vlan, IPAddress(nexthop), hdr.size() + hdr.payloadLength)) {
+    sw_->stats()->gleanQueueFull();
+    return false;
+  }
+  auto gleaned = GleanQueue::makePacket(
+      pkt->getSrcVlan(), dst, ETHERTYPE_IPV6, hdr, cursor, hdr.payloadLength);
+  if (!gleanQueue->enqueue(vlan, IPAddress(nexthop), std::move(gleaned))) {
+    sw_->stats()->gleanQueueFull();
+    return false;
+  }
+  sw_->stats()->gleanQueued();
+  return true;
+}
+
 void IPv6Handler::sendMulticastNeighborSolicitations(
     PortID ingressPort,
     const folly::IPAddressV6& targetIP) {
@@ -836,6 +896,9 @@ void IPv6Handler::sendMulticastNeighborSolicitations(
       if (vlan) {
         auto entry = vlan->getNdpTable()->getEntryIf(target);
         if (entry == nullptr) {
+          if (!solicitationNeeded(vlanID, target)) {
+            continue;
+          }
           // No entry in NDP table, create a neighbor solicitation packet
           sendMulticastNeighborSolicitation(
               sw_, target, intf->getMac(), vlan->getID());
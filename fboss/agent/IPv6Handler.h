@@ -169,6 +169,24 @@ class IPv6Handler : public AutoRegisterStateObserver {
       folly::MacAddress src,
       folly::io::Cursor cursor);
 
+  /*
+   * Returns false if the neighbor solicitation we sent for target is still
+   * outstanding, in which case we should not send another one.
+   */
+  bool solicitationNeeded(VlanID vlan, const folly::IPAddressV6& target);
+
+  /*
+   * Hand the packet over to the GleanQueue until its next hop is resolved.
+   * Returns false if the packet should be dropped instead.
+   */
+  bool gleanPacket(
+      const RxPacket* pkt,
+      folly::MacAddress dst,
+      const IPv6Hdr& hdr,
+      folly::io::Cursor cursor,
+      VlanID vlan,
+      const folly::IPAddressV6& nexthop);
+
   static void sendNeighborSolicitation(
       SwSwitch* sw,
       const folly::IPAddressV6& dstIP,
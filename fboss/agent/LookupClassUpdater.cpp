@@ -2,13 +2,94 @@
 #include "fboss/agent/LookupClassUpdater.h"
 #include "fboss/agent/MacTableUtils.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/state/ArpTable.h"
 #include "fboss/agent/state/DeltaFunctions.h"
+#include "fboss/agent/state/NdpTable.h"
 #include "fboss/agent/state/Port.h"
 #include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
 
 using facebook::fboss::DeltaFunctions::forEachChanged;
 using facebook::fboss::DeltaFunctions::isEmpty;
 
+namespace {
+
+using facebook::fboss::MacEntry;
+using facebook::fboss::MacTableUtils;
+using facebook::fboss::NeighborEntryFields;
+using facebook::fboss::SwitchState;
+
+template <typename ClassIDUpdateT>
+void updateMacClassIDs(
+    std::shared_ptr<SwitchState>* state,
+    const std::vector<ClassIDUpdateT>& updates) {
+  for (const auto& update : updates) {
+    if (!(*state)->getVlans()->getVlanIf(update.vlan)) {
+      continue;
+    }
+    auto macEntry = std::make_shared<MacEntry>(update.addr, update.port);
+    if (update.classID.has_value()) {
+      *state = MacTableUtils::updateOrAddEntryWithClassID(
+          *state, update.vlan, macEntry.get(), update.classID.value());
+    } else {
+      *state = MacTableUtils::removeClassIDForEntry(
+          *state, update.vlan, macEntry.get());
+    }
+  }
+}
+
+template <typename NTable, typename ClassIDUpdateT>
+void updateNeighborClassIDs(
+    std::shared_ptr<SwitchState>* state,
+    const std::vector<ClassIDUpdateT>& updates) {
+  for (const auto& update : updates) {
+    auto* vlan = (*state)->getVlans()->getVlanIf(update.vlan).get();
+    if (!vlan) {
+      continue;
+    }
+    auto* table = vlan->template getNeighborTable<NTable>().get();
+    auto node = table->getNodeIf(update.addr);
+    if (!node) {
+      continue;
+    }
+    table = table->modify(&vlan, state);
+    table->updateEntry(NeighborEntryFields(
+        node->getIP(),
+        node->getMac(),
+        node->getPort(),
+        node->getIntfID(),
+        node->getState(),
+        update.classID));
+  }
+}
+
+/*
+ * Only MAC entries and reachable neighbors on physical ports are assigned
+ * classIDs, so only those are indexed.
+ */
+template <typename EntryT>
+bool isPortIndexed(const EntryT* entry) {
+  if (!entry || !entry->getPort().isPhysicalPort()) {
+    return false;
+  }
+  if constexpr (std::is_same_v<EntryT, MacEntry>) {
+    return true;
+  } else {
+    return entry->isReachable();
+  }
+}
+
+template <typename EntryT>
+auto getPortIndexKey(facebook::fboss::VlanID vlan, const EntryT* entry) {
+  if constexpr (std::is_same_v<EntryT, MacEntry>) {
+    return std::make_pair(vlan, entry->getMac());
+  } else {
+    return std::make_pair(vlan, entry->getIP());
+  }
+}
+
+} // namespace
+
 namespace facebook::fboss {
 
 template <typename AddrT>
@@ -33,6 +114,29 @@ auto LookupClassUpdater::getTableDelta(const VlanDelta& vlanDelta) {
   }
 }
 
+template <typename AddrT>
+LookupClassUpdater::ClassIDUpdates<AddrT>&
+LookupClassUpdater::getClassIDUpdates() {
+  if constexpr (std::is_same_v<AddrT, folly::MacAddress>) {
+    return macClassIDUpdates_;
+  } else if constexpr (std::is_same_v<AddrT, folly::IPAddressV4>) {
+    return arpClassIDUpdates_;
+  } else {
+    return ndpClassIDUpdates_;
+  }
+}
+
+template <typename AddrT>
+LookupClassUpdater::Port2Neighbors<AddrT>& LookupClassUpdater::getPortIndex() {
+  if constexpr (std::is_same_v<AddrT, folly::MacAddress>) {
+    return port2Macs_;
+  } else if constexpr (std::is_same_v<AddrT, folly::IPAddressV4>) {
+    return port2ArpNeighbors_;
+  } else {
+    return port2NdpNeighbors_;
+  }
+}
+
 int LookupClassUpdater::getRefCnt(
     PortID portID,
     const folly::MacAddress& mac,
@@ -81,16 +185,75 @@ void LookupClassUpdater::removeClassIDForPortAndMac(
   XLOG(DBG2) << "Updating Qos Policy for Neighbor:: port: "
              << removedEntry->str() << " classID: None";
 
-  if constexpr (std::is_same_v<RemovedEntryT, MacEntry>) {
-    auto removeMacClassIDFn = [vlan, removedEntry](
-                                  const std::shared_ptr<SwitchState>& state) {
-      return MacTableUtils::removeClassIDForEntry(state, vlan, removedEntry);
-    };
+  scheduleClassIDUpdate(vlan, removedEntry);
+}
 
-    sw_->updateState("remove classID: ", std::move(removeMacClassIDFn));
+template <typename EntryT>
+void LookupClassUpdater::scheduleClassIDUpdate(
+    VlanID vlan,
+    const EntryT* entry,
+    std::optional<cfg::AclLookupClass> classID) {
+  if constexpr (std::is_same_v<EntryT, MacEntry>) {
+    macClassIDUpdates_.push_back(
+        {vlan, entry->getMac(), entry->getPort(), classID});
   } else {
+    /*
+     * The neighbor cache keeps its own copy of the classID, which it uses
+     * when it reprograms the entry, so update it right away.
+     */
     auto updater = sw_->getNeighborUpdater();
-    updater->updateEntryClassID(vlan, removedEntry->getIP());
+    updater->updateEntryClassID(vlan, entry->getIP(), classID);
+    getClassIDUpdates<typename EntryT::AddressType>().push_back(
+        {vlan, entry->getIP(), entry->getPort(), classID});
+  }
+}
+
+void LookupClassUpdater::flushClassIDUpdates() {
+  auto numUpdates = macClassIDUpdates_.size() + arpClassIDUpdates_.size() +
+      ndpClassIDUpdates_.size();
+  if (numUpdates == 0) {
+    return;
+  }
+
+  auto updateClassIDsFn = [macUpdates = std::move(macClassIDUpdates_),
+                           arpUpdates = std::move(arpClassIDUpdates_),
+                           ndpUpdates = std::move(ndpClassIDUpdates_)](
+                              const std::shared_ptr<SwitchState>& state) {
+    std::shared_ptr<SwitchState> newState{state};
+    updateMacClassIDs(&newState, macUpdates);
+    updateNeighborClassIDs<ArpTable>(&newState, arpUpdates);
+    updateNeighborClassIDs<NdpTable>(&newState, ndpUpdates);
+    return newState;
+  };
+  macClassIDUpdates_.clear();
+  arpClassIDUpdates_.clear();
+  ndpClassIDUpdates_.clear();
+
+  sw_->updateState(
+      folly::to<std::string>(
+          "configure lookup classID for ", numUpdates, " entries"),
+      std::move(updateClassIDsFn));
+}
+
+template <typename AddrT, typename EntryT>
+void LookupClassUpdater::addToPortIndex(VlanID vlan, const EntryT* entry) {
+  if (isPortIndexed(entry)) {
+    getPortIndex<AddrT>()[entry->getPort().phyPortID()].insert(
+        getPortIndexKey(vlan, entry));
+  }
+}
+
+template <typename AddrT, typename EntryT>
+void LookupClassUpdater::removeFromPortIndex(
+    VlanID vlan,
+    const EntryT* entry) {
+  if (!isPortIndexed(entry)) {
+    return;
+  }
+  auto& portIndex = getPortIndex<AddrT>();
+  auto iter = portIndex.find(entry->getPort().phyPortID());
+  if (iter != portIndex.end()) {
+    iter->second.erase(getPortIndexKey(vlan, entry));
   }
 }
 
@@ -150,20 +313,7 @@ void LookupClassUpdater::updateNeighborClassID(
   XLOG(DBG2) << "Updating Qos Policy for Neighbor:: port: " << newEntry->str()
              << " classID: " << static_cast<int>(classID);
 
-  if constexpr (std::is_same_v<NewEntryT, MacEntry>) {
-    auto updateMacClassIDFn =
-        [vlan, newEntry, classID](const std::shared_ptr<SwitchState>& state) {
-          return MacTableUtils::updateOrAddEntryWithClassID(
-              state, vlan, newEntry, classID);
-        };
-
-    sw_->updateState(
-        folly::to<std::string>("configure lookup classID: ", classID),
-        std::move(updateMacClassIDFn));
-  } else {
-    auto updater = sw_->getNeighborUpdater();
-    updater->updateEntryClassID(vlan, newEntry->getIP(), classID);
-  }
+  scheduleClassIDUpdate(vlan, newEntry, classID);
 }
 
 template <typename AddedEntryT>
@@ -243,6 +393,9 @@ void LookupClassUpdater::processNeighborUpdates(const StateDelta& stateDelta) {
       const auto* oldEntry = delta.getOld().get();
       const auto* newEntry = delta.getNew().get();
 
+      removeFromPortIndex<AddrT>(vlan, oldEntry);
+      addToPortIndex<AddrT>(vlan, newEntry);
+
       /*
        * At this point in time, queue-per-host fix is needed (and thus
        * supported) for physical link only.
@@ -284,36 +437,28 @@ template <typename AddrT>
 void LookupClassUpdater::clearClassIdsForResolvedNeighbors(
     const std::shared_ptr<SwitchState>& switchState,
     PortID portID) {
-  auto port = switchState->getPorts()->getPortIf(portID);
-  for (auto vlanMember : port->getVlans()) {
-    auto vlanID = vlanMember.first;
+  auto& portIndex = getPortIndex<AddrT>();
+  auto iter = portIndex.find(portID);
+  if (iter == portIndex.end()) {
+    return;
+  }
+
+  for (const auto& [vlanID, addr] : iter->second) {
     auto vlan = switchState->getVlans()->getVlanIf(vlanID);
     if (!vlan) {
       continue;
     }
 
-    for (const auto& entry : *getTable<AddrT>(vlan)) {
-      /*
-       * At this point in time, queue-per-host fix is needed (and thus
-       * supported) for physical link only.
-       */
-      if (entry->getPort().isPhysicalPort() &&
-          entry->getPort().phyPortID() == portID &&
-          entry->getClassID().has_value()) {
-        removeNeighborFromLocalCacheForEntry(entry.get());
-        if constexpr (std::is_same_v<AddrT, MacAddress>) {
-          auto removeMacClassIDFn =
-              [vlanID, entry](const std::shared_ptr<SwitchState>& state) {
-                return MacTableUtils::removeClassIDForEntry(
-                    state, vlanID, entry.get());
-              };
-
-          sw_->updateState("remove classID: ", std::move(removeMacClassIDFn));
-        } else {
-          auto updater = sw_->getNeighborUpdater();
-          updater->updateEntryClassID(vlanID, entry.get()->getIP());
-        }
-      }
+    auto entry = getTable<AddrT>(vlan)->getNodeIf(addr);
+    /*
+     * At this point in time, queue-per-host fix is needed (and thus
+     * supported) for physical link only.
+     */
+    if (entry && entry->getPort().isPhysicalPort() &&
+        entry->getPort().phyPortID() == portID &&
+        entry->getClassID().has_value()) {
+      removeNeighborFromLocalCacheForEntry(entry.get());
+      scheduleClassIDUpdate(vlanID, entry.get());
     }
   }
 }
@@ -322,23 +467,26 @@ template <typename AddrT>
 void LookupClassUpdater::repopulateClassIdsForResolvedNeighbors(
     const std::shared_ptr<SwitchState>& switchState,
     PortID portID) {
-  auto port = switchState->getPorts()->getPortIf(portID);
-  for (auto vlanMember : port->getVlans()) {
-    auto vlanID = vlanMember.first;
+  auto& portIndex = getPortIndex<AddrT>();
+  auto iter = portIndex.find(portID);
+  if (iter == portIndex.end()) {
+    return;
+  }
+
+  for (const auto& [vlanID, addr] : iter->second) {
     auto vlan = switchState->getVlans()->getVlanIf(vlanID);
     if (!vlan) {
       continue;
     }
 
-    for (const auto& entry : *getTable<AddrT>(vlan)) {
-      /*
-       * At this point in time, queue-per-host fix is needed (and thus
-       * supported) for physical link only.
-       */
-      if (entry->getPort().isPhysicalPort() &&
-          entry->getPort().phyPortID() == portID) {
-        updateNeighborClassID(switchState, vlanID, entry.get());
-      }
+    auto entry = getTable<AddrT>(vlan)->getNodeIf(addr);
+    /*
+     * At this point in time, queue-per-host fix is needed (and thus
+     * supported) for physical link only.
+     */
+    if (entry && entry->getPort().isPhysicalPort() &&
+        entry->getPort().phyPortID() == portID) {
+      updateNeighborClassID(switchState, vlanID, entry.get());
     }
   }
 }
@@ -400,6 +548,9 @@ void LookupClassUpdater::processPortRemoved(
 
   port2MacEntries_.erase(portID);
   port2ClassIDAndCount_.erase(portID);
+  port2Macs_.erase(portID);
+  port2ArpNeighbors_.erase(portID);
+  port2NdpNeighbors_.erase(portID);
 }
 
 void LookupClassUpdater::processPortChanged(
@@ -527,9 +678,11 @@ void LookupClassUpdater::updateStateObserverLocalCacheHelper(
     const std::shared_ptr<Port>& port) {
   for (const auto& entry : *(getTable<AddrT>(vlan))) {
     if (entry->getPort().isPhysicalPort() &&
-        entry->getPort().phyPortID() == port->getID() &&
-        entry->getClassID().has_value()) {
-      updateStateObserverLocalCacheForEntry(entry.get());
+        entry->getPort().phyPortID() == port->getID()) {
+      addToPortIndex<AddrT>(vlan->getID(), entry.get());
+      if (entry->getClassID().has_value()) {
+        updateStateObserverLocalCacheForEntry(entry.get());
+      }
     }
   }
 }
@@ -570,6 +723,8 @@ void LookupClassUpdater::stateUpdated(const StateDelta& stateDelta) {
   processNeighborUpdates<folly::IPAddressV4>(stateDelta);
 
   processPortUpdates(stateDelta);
+
+  flushClassIDUpdates();
 }
 
 } // namespace facebook::fboss
@@ -3,8 +3,15 @@
 #pragma once
 
 #include "fboss/agent/StateObserver.h"
+#include "fboss/agent/state/PortDescriptor.h"
 #include "fboss/agent/state/StateDelta.h"
 
+#include <boost/container/flat_set.hpp>
+
+#include <optional>
+#include <utility>
+#include <vector>
+
 namespace facebook::fboss {
 
 class LookupClassUpdater : public AutoRegisterStateObserver {
@@ -23,6 +30,27 @@ class LookupClassUpdater : public AutoRegisterStateObserver {
  private:
   using ClassID2Count = boost::container::flat_map<cfg::AclLookupClass, int>;
 
+  /*
+   * classID to associate with (or disassociate from, if std::nullopt) a MAC
+   * or neighbor entry, keyed by MAC for MAC entries and by IP for ARP/NDP
+   * entries.
+   */
+  template <typename AddrT>
+  struct ClassIDUpdate {
+    VlanID vlan;
+    AddrT addr;
+    PortDescriptor port;
+    std::optional<cfg::AclLookupClass> classID;
+  };
+  template <typename AddrT>
+  using ClassIDUpdates = std::vector<ClassIDUpdate<AddrT>>;
+
+  template <typename AddrT>
+  using PortNeighbors = boost::container::flat_set<std::pair<VlanID, AddrT>>;
+  template <typename AddrT>
+  using Port2Neighbors =
+      boost::container::flat_map<PortID, PortNeighbors<AddrT>>;
+
   template <typename AddrT>
   void processNeighborUpdates(const StateDelta& stateDelta);
 
@@ -58,6 +86,19 @@ class LookupClassUpdater : public AutoRegisterStateObserver {
       VlanID vlan,
       const RemovedEntryT* removedEntry);
 
+  template <typename EntryT>
+  void scheduleClassIDUpdate(
+      VlanID vlan,
+      const EntryT* entry,
+      std::optional<cfg::AclLookupClass> classID = std::nullopt);
+
+  void flushClassIDUpdates();
+
+  template <typename AddrT, typename EntryT>
+  void addToPortIndex(VlanID vlan, const EntryT* entry);
+  template <typename AddrT, typename EntryT>
+  void removeFromPortIndex(VlanID vlan, const EntryT* entry);
+
   cfg::AclLookupClass getClassIDwithMinimumNeighbors(
       ClassID2Count classID2Count) const;
 
@@ -111,6 +152,12 @@ class LookupClassUpdater : public AutoRegisterStateObserver {
   template <typename AddrT>
   auto getTableDelta(const VlanDelta& vlanDelta);
 
+  template <typename AddrT>
+  ClassIDUpdates<AddrT>& getClassIDUpdates();
+
+  template <typename AddrT>
+  Port2Neighbors<AddrT>& getPortIndex();
+
   SwSwitch* sw_;
 
   /*
@@ -137,6 +184,25 @@ class LookupClassUpdater : public AutoRegisterStateObserver {
       flat_map<folly::MacAddress, std::pair<cfg::AclLookupClass, int>>;
   boost::container::flat_map<PortID, Mac2ClassIDAndRefCnt> port2MacEntries_;
 
+  /*
+   * classID changes made while processing a StateDelta. These are applied
+   * to the SwitchState in a single update once the whole delta is processed,
+   * rather than one update per MAC or neighbor.
+   */
+  ClassIDUpdates<folly::MacAddress> macClassIDUpdates_;
+  ClassIDUpdates<folly::IPAddressV4> arpClassIDUpdates_;
+  ClassIDUpdates<folly::IPAddressV6> ndpClassIDUpdates_;
+
+  /*
+   * Index of the MAC entries and reachable neighbors on every physical port,
+   * maintained from StateDeltas, so that changing the lookupClasses of a
+   * port only visits the entries on that port instead of every entry of
+   * every VLAN the port belongs to.
+   */
+  Port2Neighbors<folly::MacAddress> port2Macs_;
+  Port2Neighbors<folly::IPAddressV4> port2ArpNeighbors_;
+  Port2Neighbors<folly::IPAddressV6> port2NdpNeighbors_;
+
   bool inited_{false};
 };
 
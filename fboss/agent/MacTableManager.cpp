@@ -12,8 +12,30 @@
 #include "fboss/agent/L2Entry.h"
 #include "fboss/agent/MacTableUtils.h"
 #include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/state/SwitchState.h"
 
+#include <folly/ExceptionString.h>
+#include <folly/container/F14Map.h>
+#include <folly/logging/xlog.h>
+
+#include <vector>
+
+DEFINE_int32(
+    l2_learning_max_batch_size,
+    4096,
+    "Maximum number of L2 learning updates applied in one state update");
+
+namespace {
+
+uint64_t macVlanKey(const facebook::fboss::L2Entry& l2Entry) {
+  // MACs are 48 bits wide, and VLAN IDs 12 bits
+  return (static_cast<uint64_t>(l2Entry.getVlanID()) << 48) |
+      l2Entry.getMac().u64HBO();
+}
+
+} // namespace
+
 namespace facebook::fboss {
 
 MacTableManager::MacTableManager(SwSwitch* sw) : sw_(sw) {}
@@ -21,14 +43,98 @@ MacTableManager::MacTableManager(SwSwitch* sw) : sw_(sw) {}
 void MacTableManager::handleL2LearningUpdate(
     L2Entry l2Entry,
     L2EntryUpdateType l2EntryUpdateType) {
-  auto updateMacTableFn =
-      [l2Entry, l2EntryUpdateType](const std::shared_ptr<SwitchState>& state) {
-        return MacTableUtils::updateMacTable(state, l2Entry, l2EntryUpdateType);
-      };
+  pendingUpdates_.enqueue({std::move(l2Entry), l2EntryUpdateType});
+  // If a batch is already scheduled, it has not started draining the queue
+  // yet, and will pick up this update
+  if (!batchScheduled_.exchange(true)) {
+    scheduleBatch();
+  }
+}
 
+void MacTableManager::scheduleBatch() {
+  auto updateMacTableFn = [this](const std::shared_ptr<SwitchState>& state) {
+    return applyBatch(state);
+  };
   sw_->updateState(
-      folly::to<std::string>("Programming : ", l2Entry.str()),
-      std::move(updateMacTableFn));
+      "Programming L2 learning updates", std::move(updateMacTableFn));
+}
+
+std::shared_ptr<SwitchState> MacTableManager::applyBatch(
+    const std::shared_ptr<SwitchState>& state) {
+  // Clear the flag before draining, so that updates queued from here on
+  // schedule another batch
+  batchScheduled_.store(false);
+  auto queueDepth = pendingUpdates_.size();
+
+  /*
+   * Updates for the same MAC and VLAN coalesce to what applying them one at
+   * a time would do: an ADD of an existing entry is a no-op, so the first
+   * ADD after the last DELETE wins.
+   */
+  struct Coalesced {
+    L2LearningUpdate update;
+    // Whether the entry must be removed before adding it back, i.e. when
+    // it was aged and learned again in this batch
+    bool deleteFirst{false};
+  };
+  std::vector<Coalesced> updates;
+  folly::F14FastMap<uint64_t, size_t> key2Index;
+  size_t maxBatchSize = std::max(FLAGS_l2_learning_max_batch_size, 1);
+  size_t numDrained = 0;
+  while (numDrained < maxBatchSize) {
+    auto update = pendingUpdates_.try_dequeue();
+    if (!update) {
+      break;
+    }
+    ++numDrained;
+    auto [it, inserted] =
+        key2Index.emplace(macVlanKey(update->l2Entry), updates.size());
+    if (inserted) {
+      updates.push_back({std::move(*update)});
+      continue;
+    }
+    auto& coalesced = updates[it->second];
+    bool prevIsAdd = coalesced.update.l2EntryUpdateType ==
+        L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD;
+    if (update->l2EntryUpdateType ==
+        L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_DELETE) {
+      coalesced.update = std::move(*update);
+      coalesced.deleteFirst = false;
+    } else if (!prevIsAdd) {
+      coalesced.update = std::move(*update);
+      coalesced.deleteFirst = true;
+    }
+  }
+  if (numDrained == maxBatchSize && !batchScheduled_.exchange(true)) {
+    // More updates may be queued, apply them in the next batch
+    scheduleBatch();
+  }
+
+  sw_->stats()->l2LearningBatch(queueDepth, updates.size());
+  if (updates.empty()) {
+    return nullptr;
+  }
+
+  auto newState = state;
+  for (const auto& coalesced : updates) {
+    const auto& update = coalesced.update;
+    // One bad entry must not drop the rest of the batch
+    try {
+      auto entryState = newState;
+      if (coalesced.deleteFirst) {
+        entryState = MacTableUtils::updateMacTable(
+            entryState,
+            update.l2Entry,
+            L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_DELETE);
+      }
+      newState = MacTableUtils::updateMacTable(
+          entryState, update.l2Entry, update.l2EntryUpdateType);
+    } catch (const std::exception& ex) {
+      XLOG(ERR) << "Failed to apply L2 learning update for "
+                << update.l2Entry.str() << ": " << folly::exceptionStr(ex);
+    }
+  }
+  return newState;
 }
 
 } // namespace facebook::fboss
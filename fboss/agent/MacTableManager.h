@@ -11,10 +11,27 @@
 
 #include "fboss/agent/L2Entry.h"
 
+#include <folly/concurrency/UnboundedQueue.h>
+
+#include <atomic>
+#include <memory>
+
 namespace facebook::fboss {
 
 class SwSwitch;
+class SwitchState;
 
+/*
+ * MacTableManager applies the L2 learning callbacks from the HwSwitch to
+ * the MAC tables in the SwitchState.
+ *
+ * Callbacks only queue the update. The queued updates are applied in
+ * batches of up to --l2_learning_max_batch_size entries, by a single state
+ * update that drains the queue. During learning storms, updates queue up
+ * while the previous batch is applied, so the number of state updates
+ * stays small. Updates for the same MAC and VLAN within a batch coalesce
+ * to the same result as applying them one at a time.
+ */
 class MacTableManager {
  public:
   explicit MacTableManager(SwSwitch* sw);
@@ -24,11 +41,22 @@ class MacTableManager {
       L2EntryUpdateType l2EntryUpdateType);
 
  private:
+  struct L2LearningUpdate {
+    L2Entry l2Entry;
+    L2EntryUpdateType l2EntryUpdateType;
+  };
+
   // Forbidden copy constructor and assignment operator
   MacTableManager(MacTableManager const&) = delete;
   MacTableManager& operator=(MacTableManager const&) = delete;
 
+  void scheduleBatch();
+  std::shared_ptr<SwitchState> applyBatch(
+      const std::shared_ptr<SwitchState>& state);
+
   SwSwitch* sw_{nullptr};
+  folly::UMPSCQueue<L2LearningUpdate, false /* MayBlock */> pendingUpdates_;
+  std::atomic<bool> batchScheduled_{false};
 };
 
 } // namespace facebook::fboss
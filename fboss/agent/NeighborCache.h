@@ -22,6 +22,7 @@
 #include <chrono>
 #include <list>
 #include <string>
+#include <vector>
 
 namespace facebook::fboss {
 
@@ -35,9 +36,14 @@ namespace facebook::fboss {
  *
  * This class wraps the common logic for a NeighborCache. It is meant to be
  * extended for ARP/NDP specific caches.
+ *
+ * Entries whose timeouts expire in the same iteration of the neighbor cache
+ * event base loop are processed together at the end of that iteration, so
+ * that the lock is acquired and expired entries are flushed from the
+ * SwitchState once per tick of the timer wheel rather than once per entry.
  */
 template <typename NTable>
-class NeighborCache {
+class NeighborCache : private folly::EventBase::LoopCallback {
   friend class NeighborCacheEntry<NTable>;
 
  public:
@@ -209,9 +215,19 @@ class NeighborCache {
     return impl_->flushEntry(ip);
   }
 
-  void processEntry(AddressType ip) {
+  // This should only be called by a NeighborCacheEntry, on the event base
+  void processEntryLater(AddressType ip) {
+    expiredEntries_.push_back(ip);
+    if (!isLoopCallbackScheduled()) {
+      sw_->getNeighborCacheEvb()->runInLoop(this);
+    }
+  }
+
+  void runLoopCallback() noexcept override {
+    std::vector<AddressType> expired;
+    expired.swap(expiredEntries_);
     std::lock_guard<std::mutex> g(cacheLock_);
-    return impl_->processEntry(ip);
+    impl_->processEntries(expired);
   }
 
   // Has the entry corresponding to ip has been hit in hw
@@ -229,6 +245,8 @@ class NeighborCache {
   std::chrono::seconds staleEntryInterval_;
   std::unique_ptr<NeighborCacheImpl<NTable>> impl_;
   std::mutex cacheLock_;
+  // Only accessed on the neighbor cache event base
+  std::vector<AddressType> expiredEntries_;
 };
 
 } // namespace facebook::fboss
@@ -19,6 +19,7 @@
 #include <folly/IPAddress.h>
 #include <folly/MacAddress.h>
 #include <folly/Random.h>
+#include <folly/io/async/HHWheelTimer.h>
 #include <chrono>
 
 /**
@@ -52,9 +53,11 @@
  * UNINITIALIZED - Placeholder on startup.
  *
  * Once an entry is created, it is responsible for scheduling the timeout for
- * its next update. When that timeout expires, the state machine is run and the
- * next update is scheduled. If the entry ever transitions to the EXPIRED state,
- * we do not schedule another update and the cache will flush the entry.
+ * its next update on the timer wheel of the neighbor cache event base. When
+ * that timeout expires, the cache runs the state machine of all entries that
+ * expired in the same tick of the wheel in one batch, and the next update is
+ * scheduled. If the entry ever transitions to the EXPIRED state, we do not
+ * schedule another update and the cache will flush the entry.
  *
  * There is no locking in this class. Instead, the class relies on the
  * synchronization provided by NeighborCache, which should lock around all calls
@@ -78,7 +81,7 @@ template <typename NTable>
 class NeighborCache;
 
 template <typename NTable>
-class NeighborCacheEntry : private folly::AsyncTimeout {
+class NeighborCacheEntry : private folly::HHWheelTimer::Callback {
  public:
   typedef typename NTable::Entry::AddressType AddressType;
   typedef NeighborCache<NTable> Cache;
@@ -89,8 +92,7 @@ class NeighborCacheEntry : private folly::AsyncTimeout {
       folly::EventBase* evb,
       Cache* cache,
       NeighborEntryState state)
-      : AsyncTimeout(evb),
-        fields_(fields),
+      : fields_(fields),
         cache_(cache),
         evb_(evb),
         probesLeft_(cache_->getMaxNeighborProbes()) {
@@ -238,7 +240,17 @@ class NeighborCacheEntry : private folly::AsyncTimeout {
    * races.
    */
   void timeoutExpired() noexcept override {
-    cache_->processEntry(getIP());
+    cache_->processEntryLater(getIP());
+  }
+
+  /*
+   * The wheel only cancels callbacks when it is destroyed along with the
+   * event base, at which point there is nothing left to process.
+   */
+  void callbackCanceled() noexcept override {}
+
+  void scheduleUpdate(std::chrono::milliseconds timeout) {
+    evb_->timer().scheduleTimeout(this, timeout);
   }
 
   /*
@@ -254,14 +266,14 @@ class NeighborCacheEntry : private folly::AsyncTimeout {
       case NeighborEntryState::REACHABLE:
         lifetime = calculateLifetime();
         expireTime_ = std::chrono::steady_clock::now() + lifetime;
-        scheduleTimeout(lifetime);
+        scheduleUpdate(lifetime);
         break;
       case NeighborEntryState::STALE:
-        scheduleTimeout(std::chrono::seconds(cache_->getStaleEntryInterval()));
+        scheduleUpdate(addJitter(cache_->getStaleEntryInterval()));
         break;
       case NeighborEntryState::PROBE:
       case NeighborEntryState::INCOMPLETE:
-        scheduleTimeout(std::chrono::seconds(1));
+        scheduleUpdate(addJitter(std::chrono::seconds(1)));
         break;
       case NeighborEntryState::EXPIRED:
         // This entry is expired and is already flushed. Don't schedule a
@@ -289,6 +301,19 @@ class NeighborCacheEntry : private folly::AsyncTimeout {
     return std::chrono::milliseconds(lifetime);
   }
 
+  /*
+   * Entries that go STALE or start probing together, e.g. after a port flap
+   * or when a vlan is repopulated, would otherwise check their hit bit and
+   * send out solicitations in the same tick for as long as they live. We
+   * spread them out uniformly between 0.8 * interval & 1.2 * interval.
+   */
+  std::chrono::milliseconds addJitter(
+      std::chrono::milliseconds interval) const {
+    auto spread = interval.count() * 2 / 5;
+    auto jitter = folly::Random::rand32(spread + 1);
+    return std::chrono::milliseconds(interval.count() - spread / 2 + jitter);
+  }
+
   bool hasProbesLeft() const {
     return probesLeft_ > 0;
   }
@@ -213,38 +213,8 @@ void NeighborCacheImpl<NTable>::updateEntryClassID(
     AddressType ip,
     std::optional<cfg::AclLookupClass> classID) {
   auto entry = getCacheEntry(ip);
-
   if (entry) {
     entry->updateClassID(classID);
-
-    auto updateClassIDFn =
-        [this, ip, classID](const std::shared_ptr<SwitchState>& state) {
-          auto vlan = state->getVlans()->getVlanIf(vlanID_).get();
-          std::shared_ptr<SwitchState> newState{state};
-          auto* table = vlan->template getNeighborTable<NTable>().get();
-          auto node = table->getNodeIf(ip);
-
-          if (node) {
-            auto fields = EntryFields(
-                node->getIP(),
-                node->getMac(),
-                node->getPort(),
-                node->getIntfID(),
-                node->getState(),
-                classID);
-            table = table->modify(&vlan, &newState);
-            table->updateEntry(fields);
-          }
-
-          return newState;
-        };
-
-    auto classIDStr = classID.has_value()
-        ? folly::to<std::string>(static_cast<int>(classID.value()))
-        : "None";
-    sw_->updateState(
-        folly::to<std::string>("configure lookup classID: ", classIDStr),
-        std::move(updateClassIDFn));
   }
 }
 
@@ -287,14 +257,19 @@ void NeighborCacheImpl<NTable>::setPendingEntry(AddressType ip, bool force) {
 }
 
 template <typename NTable>
-void NeighborCacheImpl<NTable>::processEntry(AddressType ip) {
-  auto entry = getCacheEntry(ip);
-  if (entry) {
-    entry->process();
-    if (entry->getState() == NeighborEntryState::EXPIRED) {
-      flushEntry(ip);
+void NeighborCacheImpl<NTable>::processEntries(
+    const std::vector<AddressType>& ips) {
+  std::vector<AddressType> expired;
+  for (const auto& ip : ips) {
+    auto entry = getCacheEntry(ip);
+    if (entry) {
+      entry->process();
+      if (entry->getState() == NeighborEntryState::EXPIRED) {
+        expired.push_back(ip);
+      }
     }
   }
+  flushEntries(expired);
 }
 
 template <typename NTable>
@@ -387,6 +362,33 @@ void NeighborCacheImpl<NTable>::flushEntry(AddressType ip, bool* flushed) {
   }
 }
 
+template <typename NTable>
+void NeighborCacheImpl<NTable>::flushEntries(
+    const std::vector<AddressType>& ips) {
+  std::vector<AddressType> removed;
+  for (const auto& ip : ips) {
+    if (removeEntry(ip)) {
+      removed.push_back(ip);
+    }
+  }
+  if (removed.empty()) {
+    return;
+  }
+
+  auto updateFn = [this, removed = std::move(removed)](
+                      const std::shared_ptr<SwitchState>& state)
+      -> std::shared_ptr<SwitchState> {
+    std::shared_ptr<SwitchState> newState{state};
+    bool flushed{false};
+    for (const auto& ip : removed) {
+      flushed |= flushEntryFromSwitchState(&newState, ip);
+    }
+    return flushed ? newState : nullptr;
+  };
+
+  sw_->updateState("remove expired neighbor entries", std::move(updateFn));
+}
+
 template <typename NTable>
 std::unique_ptr<typename NeighborCacheImpl<NTable>::EntryFields>
 NeighborCacheImpl<NTable>::cloneEntryFields(AddressType ip) {
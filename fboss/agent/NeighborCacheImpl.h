@@ -21,6 +21,7 @@
 #include <list>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace facebook::fboss {
 
@@ -83,6 +84,8 @@ class NeighborCacheImpl {
 
   void updateEntryState(AddressType ip, NeighborEntryState state);
 
+  // Only updates the classID kept in the cache, which is used when the
+  // entry is reprogrammed. The caller programs it into the SwitchState.
   void updateEntryClassID(
       AddressType ip,
       std::optional<cfg::AclLookupClass> classID = std::nullopt);
@@ -131,12 +134,16 @@ class NeighborCacheImpl {
   void programEntry(Entry* entry);
   void programPendingEntry(Entry* entry, bool force = false);
 
-  void processEntry(AddressType ip);
+  // Run the state machine of entries whose timeouts expired, and flush
+  // the ones that expired from the SwitchState in a single update
+  void processEntries(const std::vector<AddressType>& ips);
 
   // Pass in a non-null flushed if you care whether an entry
   // was actually flushed from the switch state
   void flushEntry(AddressType ip, bool* flushed = nullptr);
 
+  void flushEntries(const std::vector<AddressType>& ips);
+
   bool flushEntryFromSwitchState(
       std::shared_ptr<SwitchState>* state,
       AddressType ip);
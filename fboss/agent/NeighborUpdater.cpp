@@ -11,9 +11,14 @@
 #include "fboss/agent/ArpCache.h"
 #include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/GleanQueue.h"
 #include "fboss/agent/IPv6Handler.h"
 #include "fboss/agent/NdpCache.h"
+#include "fboss/agent/Platform.h"
 #include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/TxPacket.h"
+#include "fboss/agent/packet/EthHdr.h"
 #include "fboss/agent/state/AggregatePort.h"
 #include "fboss/agent/state/ArpTable.h"
 #include "fboss/agent/state/DeltaFunctions.h"
@@ -25,7 +30,9 @@
 #include "fboss/agent/state/VlanMap.h"
 
 #include <boost/container/flat_map.hpp>
+#include <folly/io/Cursor.h>
 #include <folly/logging/xlog.h>
+#include <algorithm>
 #include <list>
 #include <mutex>
 #include <string>
@@ -76,6 +83,7 @@ void NeighborUpdater::stateUpdated(const StateDelta& delta) {
   CHECK(sw_->getUpdateEvb()->inRunningEventBaseThread());
   for (const auto& entry : delta.getVlansDelta()) {
     sendNeighborUpdates(entry);
+    flushGleanQueue(entry);
     auto oldEntry = entry.getOld();
     auto newEntry = entry.getNew();
 
@@ -153,6 +161,73 @@ void NeighborUpdater::sendNeighborUpdates(const VlanDelta& delta) {
   }
 }
 
+template <typename T>
+void collectResolutionChange(
+    const T& delta,
+    std::vector<IPAddress>* resolved,
+    std::vector<IPAddress>* removed) {
+  for (const auto& entry : delta) {
+    auto oldEntry = entry.getOld();
+    auto newEntry = entry.getNew();
+    if (!newEntry) {
+      removed->push_back(IPAddress(oldEntry->getIP()));
+    } else if (
+        !newEntry->isPending() && (!oldEntry || oldEntry->isPending())) {
+      resolved->push_back(IPAddress(newEntry->getIP()));
+    }
+  }
+}
+
+/*
+ * Send out the packets held for the neighbors that were just resolved, now
+ * that the hardware has their entries and routes them. The packets held for
+ * neighbors that went away without being resolved are dropped.
+ */
+void NeighborUpdater::flushGleanQueue(const VlanDelta& delta) {
+  auto gleanQueue = sw_->getGleanQueue();
+  if (!gleanQueue) {
+    return;
+  }
+  auto vlanID =
+      delta.getNew() ? delta.getNew()->getID() : delta.getOld()->getID();
+  std::vector<IPAddress> resolved;
+  std::vector<IPAddress> removed;
+  collectResolutionChange(delta.getArpDelta(), &resolved, &removed);
+  collectResolutionChange(delta.getNdpDelta(), &resolved, &removed);
+
+  uint64_t dropped = 0;
+  for (const auto& ip : removed) {
+    dropped += gleanQueue->remove(vlanID, ip);
+  }
+  if (dropped) {
+    sw_->stats()->gleanExpired(dropped);
+  }
+
+  auto srcMac = sw_->getPlatform()->getLocalMac();
+  uint64_t flushed = 0;
+  for (const auto& ip : resolved) {
+    for (auto& gleaned : gleanQueue->resolved(vlanID, ip)) {
+      // The minimum packet length is 64, plus 4 for the VLAN tag
+      uint32_t l3Len = gleaned.l3Packet->computeChainDataLength();
+      auto pkt = sw_->allocatePacket(
+          std::max<uint32_t>(EthHdr::SIZE + l3Len, 68));
+      folly::io::RWPrivateCursor cursor(pkt->buf());
+      // Send the packet to the router MAC, for the hardware to route it
+      // now that it has the next hop
+      TxPacket::writeEthHeader(
+          &cursor, gleaned.dstMac, srcMac, gleaned.vlan, gleaned.ethertype);
+      cursor.push(folly::io::Cursor(gleaned.l3Packet.get()), l3Len);
+      // Fill the padding with 0s
+      memset(cursor.writableData(), 0, cursor.length());
+      sw_->sendPacketSwitchedAsync(std::move(pkt));
+      ++flushed;
+    }
+  }
+  if (flushed) {
+    sw_->stats()->gleanFlushed(flushed);
+  }
+}
+
 void NeighborUpdater::portChanged(
     const std::shared_ptr<Port>& oldPort,
     const std::shared_ptr<Port>& newPort) {
@@ -101,6 +101,7 @@ class NeighborUpdater : public AutoRegisterStateObserver {
       const std::shared_ptr<AggregatePort>& oldAggPort,
       const std::shared_ptr<AggregatePort>& newAggPort);
   void sendNeighborUpdates(const VlanDelta& delta);
+  void flushGleanQueue(const VlanDelta& delta);
 
   // Forbidden copy constructor and assignment operator
   NeighborUpdater(NeighborUpdater const&) = delete;
@@ -0,0 +1,285 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxPacketScheduler.h"
+
+#include "fboss/agent/DHCPv4Handler.h"
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/RxPacket.h"
+#include "fboss/agent/packet/DHCPv6Packet.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPProto.h"
+#include "fboss/agent/packet/UDPHeader.h"
+
+#include <fb303/ServiceData.h>
+#include <folly/Conv.h>
+#include <folly/IPAddressV6.h>
+#include <folly/MacAddress.h>
+#include <folly/io/Cursor.h>
+#include <folly/logging/xlog.h>
+#include <folly/system/ThreadName.h>
+
+#include <algorithm>
+
+DEFINE_bool(
+    rx_scheduler,
+    false,
+    "Handle trapped packets on per class worker threads, rather than on the "
+    "thread the HwSwitch delivers them on");
+DEFINE_int32(
+    rx_scheduler_workers,
+    2,
+    "Number of threads handling trapped TTL expired, DHCP and malformed "
+    "packets");
+DEFINE_int32(
+    rx_scheduler_queue_size,
+    4096,
+    "Number of trapped packets queued per class before dropping them");
+DEFINE_int32(
+    rx_scheduler_neighbor_pps,
+    0,
+    "Rate limit for trapped ARP and NDP packets, 0 for no limit");
+DEFINE_int32(
+    rx_scheduler_host_pps,
+    0,
+    "Rate limit for trapped packets to the host, 0 for no limit");
+DEFINE_int32(
+    rx_scheduler_slow_path_pps,
+    10000,
+    "Rate limit for trapped TTL expired, DHCP and malformed packets, "
+    "0 for no limit");
+
+namespace {
+constexpr auto kCounterPrefix = "rx_scheduler.";
+
+facebook::fboss::RxPacketScheduler::ClassConfig makeClassConfig(
+    int32_t ratePps) {
+  facebook::fboss::RxPacketScheduler::ClassConfig config;
+  config.queueSize = FLAGS_rx_scheduler_queue_size;
+  config.ratePps = std::max(ratePps, 0);
+  // Allow bursts of up to 100ms worth of packets
+  config.burstSize = std::max(config.ratePps / 10, 1U);
+  return config;
+}
+} // namespace
+
+namespace facebook::fboss {
+
+RxPacketScheduler::Config RxPacketScheduler::Config::fromFlags() {
+  Config config;
+  config.classes[static_cast<size_t>(RxPacketClass::CONTROL)] =
+      makeClassConfig(0);
+  config.classes[static_cast<size_t>(RxPacketClass::NEIGHBOR)] =
+      makeClassConfig(FLAGS_rx_scheduler_neighbor_pps);
+  config.classes[static_cast<size_t>(RxPacketClass::HOST)] =
+      makeClassConfig(FLAGS_rx_scheduler_host_pps);
+  config.classes[static_cast<size_t>(RxPacketClass::SLOW_PATH)] =
+      makeClassConfig(FLAGS_rx_scheduler_slow_path_pps);
+  config.statelessWorkers = std::max(FLAGS_rx_scheduler_workers, 1);
+  return config;
+}
+
+RxPacketScheduler::RxPacketScheduler(const Config& config, Handler handler)
+    : handler_(std::move(handler)) {
+  for (size_t i = 0; i < kNumRxPacketClasses; ++i) {
+    if (config.classes[i].queueSize == 0) {
+      throw FbossError("RX queue size must be positive");
+    }
+    queues_[i] = std::make_unique<ClassQueue>(config.classes[i]);
+  }
+  orderedGroup_.first = RxPacketClass::CONTROL;
+  orderedGroup_.last = RxPacketClass::NEIGHBOR;
+  hostGroup_.first = RxPacketClass::HOST;
+  hostGroup_.last = RxPacketClass::HOST;
+  statelessGroup_.first = RxPacketClass::SLOW_PATH;
+  statelessGroup_.last = RxPacketClass::SLOW_PATH;
+  startWorkers(&orderedGroup_, 1);
+  // A single thread, for the packets of each flow to stay in order
+  startWorkers(&hostGroup_, 1);
+  startWorkers(&statelessGroup_, std::max(config.statelessWorkers, 1U));
+}
+
+RxPacketScheduler::~RxPacketScheduler() {
+  stop();
+}
+
+void RxPacketScheduler::startWorkers(
+    WorkerGroup* group,
+    uint32_t numThreads) {
+  for (uint32_t i = 0; i < numThreads; ++i) {
+    group->threads.emplace_back([this, group, i] {
+      folly::setThreadName(folly::to<std::string>(
+          "fbossRx", className(group->first), i));
+      workerLoop(group);
+    });
+  }
+}
+
+void RxPacketScheduler::stop() {
+  if (stopping_.exchange(true)) {
+    return;
+  }
+  for (auto group : {&orderedGroup_, &hostGroup_, &statelessGroup_}) {
+    // Wake up every thread, so that it sees stopping_
+    group->pending.post(group->threads.size());
+    for (auto& thread : group->threads) {
+      thread.join();
+    }
+  }
+}
+
+RxPacketClass RxPacketScheduler::classify(const RxPacket* pkt) {
+  try {
+    folly::io::Cursor c(pkt->buf());
+    c += 2 * folly::MacAddress::SIZE;
+    auto ethertype = static_cast<ETHERTYPE>(c.readBE<uint16_t>());
+    if (ethertype == ETHERTYPE::ETHERTYPE_VLAN) {
+      c += 2;
+      ethertype = static_cast<ETHERTYPE>(c.readBE<uint16_t>());
+    }
+
+    switch (ethertype) {
+      case ETHERTYPE::ETHERTYPE_LLDP:
+      case ETHERTYPE::ETHERTYPE_SLOW_PROTOCOLS:
+        return RxPacketClass::CONTROL;
+      case ETHERTYPE::ETHERTYPE_ARP:
+        return RxPacketClass::NEIGHBOR;
+      case ETHERTYPE::ETHERTYPE_IPV4: {
+        auto ihl = c.read<uint8_t>() & 0x0f;
+        c += 7;
+        auto ttl = c.read<uint8_t>();
+        auto proto = static_cast<IP_PROTO>(c.read<uint8_t>());
+        if (ttl <= 1) {
+          return RxPacketClass::SLOW_PATH;
+        }
+        if (proto == IP_PROTO::IP_PROTO_UDP) {
+          // Skip the rest of the header, options included
+          c += ihl * 4 - 10;
+          UDPHeader udpHdr;
+          udpHdr.parse(&c);
+          if (DHCPv4Handler::isDHCPv4Packet(udpHdr)) {
+            return RxPacketClass::SLOW_PATH;
+          }
+        }
+        return RxPacketClass::HOST;
+      }
+      case ETHERTYPE::ETHERTYPE_IPV6: {
+        c += 6;
+        auto nextHeader = static_cast<IP_PROTO>(c.read<uint8_t>());
+        auto hopLimit = c.read<uint8_t>();
+        c += 2 * folly::IPAddressV6::byteCount();
+        if (nextHeader == IP_PROTO::IP_PROTO_IPV6_ICMP) {
+          auto type = c.read<uint8_t>();
+          if (type >=
+                  static_cast<uint8_t>(
+                      ICMPv6Type::ICMPV6_TYPE_NDP_ROUTER_SOLICITATION) &&
+              type <=
+                  static_cast<uint8_t>(
+                      ICMPv6Type::ICMPV6_TYPE_NDP_REDIRECT_MESSAGE)) {
+            return RxPacketClass::NEIGHBOR;
+          }
+        }
+        if (hopLimit <= 1) {
+          return RxPacketClass::SLOW_PATH;
+        }
+        if (nextHeader == IP_PROTO::IP_PROTO_UDP) {
+          UDPHeader udpHdr;
+          udpHdr.parse(&c);
+          if (udpHdr.dstPort == DHCPv6Packet::DHCP6_CLIENT_UDPPORT ||
+              udpHdr.dstPort == DHCPv6Packet::DHCP6_SERVERAGENT_UDPPORT) {
+            return RxPacketClass::SLOW_PATH;
+          }
+        }
+        return RxPacketClass::HOST;
+      }
+      default:
+        break;
+    }
+  } catch (const std::exception&) {
+    // Truncated packets are counted as bogus by their handler
+  }
+  return RxPacketClass::SLOW_PATH;
+}
+
+std::string RxPacketScheduler::className(RxPacketClass cls) {
+  switch (cls) {
+    case RxPacketClass::CONTROL:
+      return "control";
+    case RxPacketClass::NEIGHBOR:
+      return "neighbor";
+    case RxPacketClass::HOST:
+      return "host";
+    case RxPacketClass::SLOW_PATH:
+      return "slow_path";
+  }
+  throw FbossError("Unknown RX packet class ", static_cast<int>(cls));
+}
+
+bool RxPacketScheduler::enqueue(std::unique_ptr<RxPacket> pkt) {
+  if (stopping_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  auto cls = classify(pkt.get());
+  auto& classQueue = queue(cls);
+  const auto& config = classQueue.config;
+  if (config.ratePps &&
+      !classQueue.policer.consume(1, config.ratePps, config.burstSize)) {
+    classQueue.policed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (!classQueue.queue.write(std::move(pkt))) {
+    classQueue.queueFull.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  classQueue.queued.fetch_add(1, std::memory_order_relaxed);
+  group(cls).pending.post();
+  return true;
+}
+
+bool RxPacketScheduler::dequeue(
+    WorkerGroup* group,
+    std::unique_ptr<RxPacket>* pkt) {
+  auto first = static_cast<size_t>(group->first);
+  auto last = static_cast<size_t>(group->last);
+  for (auto i = first; i <= last; ++i) {
+    if (queues_[i]->queue.read(*pkt)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RxPacketScheduler::workerLoop(WorkerGroup* group) {
+  while (true) {
+    group->pending.wait();
+    std::unique_ptr<RxPacket> pkt;
+    // Each post is for one packet, but a packet queued by a concurrent
+    // writer may not be readable yet
+    while (!dequeue(group, &pkt)) {
+      if (stopping_.load(std::memory_order_acquire)) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+    handler_(std::move(pkt));
+  }
+}
+
+void RxPacketScheduler::publishStats() const {
+  for (size_t i = 0; i < kNumRxPacketClasses; ++i) {
+    auto cls = static_cast<RxPacketClass>(i);
+    auto prefix = folly::to<std::string>(kCounterPrefix, className(cls));
+    fb303::fbData->setCounter(prefix + ".queued", numQueued(cls));
+    fb303::fbData->setCounter(prefix + ".policed", numPoliced(cls));
+    fb303::fbData->setCounter(prefix + ".queue_full", numQueueFull(cls));
+  }
+}
+
+} // namespace facebook::fboss
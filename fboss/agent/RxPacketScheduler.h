@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/MPMCQueue.h>
+#include <folly/TokenBucket.h>
+#include <folly/synchronization/LifoSem.h>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace facebook::fboss {
+
+class RxPacket;
+
+/*
+ * Classes of trapped packets, in decreasing order of priority.
+ */
+enum class RxPacketClass : uint8_t {
+  // LACP and LLDP, which keep links and LAGs up
+  CONTROL,
+  // ARP and NDP
+  NEIGHBOR,
+  // Everything else sent to the host, e.g. routing protocols
+  HOST,
+  // TTL/hop limit expired, DHCP and malformed packets
+  SLOW_PATH,
+};
+
+constexpr size_t kNumRxPacketClasses = 4;
+
+/*
+ * RxPacketScheduler moves the handling of trapped packets off the thread
+ * the HwSwitch delivers them on, so that a flood of one class of packets
+ * does not hold up the others.
+ *
+ * Each class has its own bounded lock-free queue and policer. Packets are
+ * dropped when the policer of their class is out of tokens or their queue
+ * is full. CONTROL and NEIGHBOR packets are handled by a single thread, so
+ * that they are processed in order, with CONTROL packets served first.
+ * HOST packets, e.g. the TCP segments of BGP sessions, must reach the host
+ * in the order they were received too, so they get a thread of their own.
+ * Only SLOW_PATH packets carry no ordering requirements, and are handled by
+ * a pool of worker threads.
+ */
+class RxPacketScheduler {
+ public:
+  using Handler = std::function<void(std::unique_ptr<RxPacket>)>;
+
+  struct ClassConfig {
+    uint32_t queueSize{4096};
+    // Packets per second allowed through the policer, 0 to not police
+    uint32_t ratePps{0};
+    uint32_t burstSize{0};
+  };
+
+  struct Config {
+    std::array<ClassConfig, kNumRxPacketClasses> classes;
+    // Number of threads handling SLOW_PATH packets
+    uint32_t statelessWorkers{2};
+
+    static Config fromFlags();
+  };
+
+  RxPacketScheduler(const Config& config, Handler handler);
+  ~RxPacketScheduler();
+
+  /*
+   * Classify a packet by looking at its ethertype, and at the IP header
+   * for IPv4 and IPv6 packets.
+   */
+  static RxPacketClass classify(const RxPacket* pkt);
+
+  static std::string className(RxPacketClass cls);
+
+  /*
+   * Queue a packet for its handler. Returns false if the packet was
+   * dropped.
+   */
+  bool enqueue(std::unique_ptr<RxPacket> pkt);
+
+  /*
+   * Stop the worker threads. Packets still queued are dropped.
+   */
+  void stop();
+
+  uint64_t numQueued(RxPacketClass cls) const {
+    return queue(cls).queued.load(std::memory_order_relaxed);
+  }
+  uint64_t numPoliced(RxPacketClass cls) const {
+    return queue(cls).policed.load(std::memory_order_relaxed);
+  }
+  uint64_t numQueueFull(RxPacketClass cls) const {
+    return queue(cls).queueFull.load(std::memory_order_relaxed);
+  }
+
+  /*
+   * Export the per class counters to fb303.
+   */
+  void publishStats() const;
+
+ private:
+  struct ClassQueue {
+    explicit ClassQueue(const ClassConfig& config)
+        : config(config), queue(config.queueSize) {}
+
+    const ClassConfig config;
+    folly::MPMCQueue<std::unique_ptr<RxPacket>> queue;
+    folly::DynamicTokenBucket policer;
+    std::atomic<uint64_t> queued{0};
+    std::atomic<uint64_t> policed{0};
+    std::atomic<uint64_t> queueFull{0};
+  };
+
+  // The threads serving a contiguous range of classes
+  struct WorkerGroup {
+    RxPacketClass first;
+    RxPacketClass last;
+    folly::LifoSem pending;
+    std::vector<std::thread> threads;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  RxPacketScheduler(RxPacketScheduler const&) = delete;
+  RxPacketScheduler& operator=(RxPacketScheduler const&) = delete;
+
+  ClassQueue& queue(RxPacketClass cls) {
+    return *queues_[static_cast<size_t>(cls)];
+  }
+  const ClassQueue& queue(RxPacketClass cls) const {
+    return *queues_[static_cast<size_t>(cls)];
+  }
+  WorkerGroup& group(RxPacketClass cls) {
+    if (cls <= orderedGroup_.last) {
+      return orderedGroup_;
+    }
+    return cls <= hostGroup_.last ? hostGroup_ : statelessGroup_;
+  }
+  void startWorkers(WorkerGroup* group, uint32_t numThreads);
+  bool dequeue(WorkerGroup* group, std::unique_ptr<RxPacket>* pkt);
+  void workerLoop(WorkerGroup* group);
+
+  Handler handler_;
+  std::array<std::unique_ptr<ClassQueue>, kNumRxPacketClasses> queues_;
+  WorkerGroup orderedGroup_;
+  WorkerGroup hostGroup_;
+  WorkerGroup statelessGroup_;
+  std::atomic<bool> stopping_{false};
+};
+
+} // namespace facebook::fboss
@@ -10,7 +10,9 @@
 
 #include "fboss/agent/StandaloneRibConversions.h"
 
+#include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/rib/ForwardingInformationBaseUpdater.h"
+#include "fboss/agent/state/SwitchState.h"
 
 namespace facebook::fboss {
 
@@ -40,12 +42,20 @@ static void dynamicFibUpdate(
     facebook::fboss::RouterID vrf,
     const facebook::fboss::rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
     const facebook::fboss::rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const std::vector<folly::CIDRNetwork>* affectedPrefixes,
     void* cookie) {
   rib::ForwardingInformationBaseUpdater fibUpdater(
-      vrf, v4NetworkToRoute, v6NetworkToRoute);
+      vrf, v4NetworkToRoute, v6NetworkToRoute, affectedPrefixes);
 
   auto sw = static_cast<facebook::fboss::SwSwitch*>(cookie);
-  sw->updateStateBlocking("", std::move(fibUpdater));
+  sw->updateStateBlocking(
+      "", [sw, &fibUpdater](const std::shared_ptr<SwitchState>& state) {
+        auto newState = fibUpdater(state);
+        sw->stats()->fibUpdate(
+            fibUpdater.getLastUpdateDuration(),
+            fibUpdater.getNumChangedPrefixes());
+        return newState;
+      });
 }
 
 void syncFibWithStandaloneRib(
@@ -15,6 +15,7 @@
 #include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/Constants.h"
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/GleanQueue.h"
 #include "fboss/agent/HwSwitch.h"
 #include "fboss/agent/IPv4Handler.h"
 #include "fboss/agent/IPv6Handler.h"
@@ -34,6 +35,7 @@
 #include "fboss/agent/RestartTimeTracker.h"
 #include "fboss/agent/RouteUpdateLogger.h"
 #include "fboss/agent/RxPacket.h"
+#include "fboss/agent/RxPacketScheduler.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/ThriftHandler.h"
 #include "fboss/agent/TunManager.h"
@@ -73,6 +75,9 @@
 #include <exception>
 #include <tuple>
 
+DECLARE_bool(glean_queue);
+DECLARE_bool(rx_scheduler);
+
 using folly::EventBase;
 using folly::SocketAddress;
 using folly::StringPiece;
@@ -99,6 +104,11 @@ DEFINE_int32(
     distribution_timeout_ms,
     1000,
     "Timeout for sending to distribution_service (ms)");
+DEFINE_bool(
+    pipelined_state_updates,
+    false,
+    "Run StateUpdate functions on a separate thread, so the next SwitchState "
+    "is prepared while the hardware is programmed with the previous one");
 
 namespace {
 
@@ -162,6 +172,7 @@ class ChannelCloser : public CloseCallback {
 SwSwitch::SwSwitch(std::unique_ptr<Platform> platform)
     : hw_(platform->getHwSwitch()),
       platform_(std::move(platform)),
+      pipelinedStateUpdates_(FLAGS_pipelined_state_updates),
       closer_(new ChannelCloser(this)),
       arp_(new ArpHandler(this)),
       ipv4_(new IPv4Handler(this)),
@@ -183,6 +194,17 @@ SwSwitch::SwSwitch(std::unique_ptr<Platform> platform)
 
   // doesnt need to be guarded, only accessed by 1 event base
   pcapPusher_ = nullptr;
+
+  if (FLAGS_rx_scheduler) {
+    rxScheduler_ = std::make_unique<RxPacketScheduler>(
+        RxPacketScheduler::Config::fromFlags(),
+        [this](std::unique_ptr<RxPacket> pkt) {
+          handlePacketNoThrow(std::move(pkt));
+        });
+  }
+  if (FLAGS_glean_queue) {
+    gleanQueue_ = std::make_unique<GleanQueue>(GleanQueue::Config::fromFlags());
+  }
 }
 
 void SwSwitch::destroyPushClient() {
@@ -224,6 +246,11 @@ void SwSwitch::stop() {
   // while we are destroying ourselves
   hw_->unregisterCallbacks();
 
+  // Drain the packet handling threads before the handlers go away
+  if (rxScheduler_) {
+    rxScheduler_->stop();
+  }
+
   // Stop tunMgr so we don't get any packets to process
   // in software that were sent to the switch ip or were
   // routed from kernel to the front panel tunnel interface.
@@ -368,6 +395,14 @@ void SwSwitch::getProductInfo(ProductInfo& productInfo) const {
 void SwSwitch::updateStats() {
   updateRouteStats();
   updatePortInfo();
+  if (rxScheduler_) {
+    rxScheduler_->publishStats();
+  }
+  if (gleanQueue_) {
+    if (auto expired = gleanQueue_->expire()) {
+      stats()->gleanExpired(expired);
+    }
+  }
   try {
     getHw()->updateStats(stats());
   } catch (const std::exception& ex) {
@@ -487,6 +522,13 @@ void SwSwitch::init(std::unique_ptr<TunManager> tunMgr, SwitchFlags flags) {
   } else {
     auto alpmInitState = setupAlpmState(initialStateDesired);
     if (alpmInitState) {
+      if (pipelinedStateUpdates_) {
+        // applyUpdate() leaves the desired state to prepareStateUpdates()
+        // when pipelining, so set it here, before any update is prepared,
+        // for the updates to build on top of the ALPM routes rather than
+        // delete them.
+        setDesiredState(alpmInitState);
+      }
       // If setupAlpmInitState caused a new switchState to get
       // generated, applyIt
       // send a state update to h/w
@@ -690,7 +732,12 @@ void SwSwitch::updateState(unique_ptr<StateUpdate> update) {
   // Signal the update thread that updates are pending.
   // We call runInEventBaseThread() with a static function pointer since this
   // is more efficient than having to allocate a new bound function object.
-  updateEventBase_.runInEventBaseThread(handlePendingUpdatesHelper, this);
+  if (pipelinedStateUpdates_) {
+    statePrepareEventBase_.runInEventBaseThread(
+        prepareStateUpdatesHelper, this);
+  } else {
+    updateEventBase_.runInEventBaseThread(handlePendingUpdatesHelper, this);
+  }
 }
 
 void SwSwitch::queueStateUpdateForGettingHwInSync(
@@ -739,62 +786,40 @@ void SwSwitch::handlePendingUpdatesHelper(SwSwitch* sw) {
   sw->handlePendingUpdates();
 }
 
-void SwSwitch::handlePendingUpdates() {
-  // Get the list of updates to run.
-  //
+void SwSwitch::getPendingUpdates(StateUpdateList* updates) {
   // We might pull multiple updates off the list at once if several updates
   // were scheduled before we had a chance to process them.  In some cases we
   // might also end up finding 0 updates to process if a previous
-  // handlePendingUpdates() call processed multiple updates.
-  StateUpdateList updates;
-  {
-    folly::SpinLockGuard guard(pendingUpdatesLock_);
-    // When deciding how many elements to pull off the pendingUpdates_
-    // list, we pull as many as we can, while making sure we don't
-    // include any updates after an update that does not allow
-    // coalescing.
-    auto iter = pendingUpdates_.begin();
-    while (iter != pendingUpdates_.end()) {
-      StateUpdate* update = &(*iter);
-      ++iter;
-      if (!update->allowsCoalescing()) {
-        break;
-      }
+  // call processed multiple updates.
+  folly::SpinLockGuard guard(pendingUpdatesLock_);
+  // When deciding how many elements to pull off the pendingUpdates_
+  // list, we pull as many as we can, while making sure we don't
+  // include any updates after an update that does not allow
+  // coalescing.
+  auto iter = pendingUpdates_.begin();
+  while (iter != pendingUpdates_.end()) {
+    StateUpdate* update = &(*iter);
+    ++iter;
+    if (!update->allowsCoalescing()) {
+      break;
     }
-    updates.splice(
-        updates.begin(), pendingUpdates_, pendingUpdates_.begin(), iter);
-  }
-
-  // handlePendingUpdates() is invoked once for each update, but a previous
-  // call might have already processed everything.  If we don't have anything
-  // to do just return early.
-  if (updates.empty()) {
-    return;
   }
+  updates->splice(
+      updates->begin(), pendingUpdates_, pendingUpdates_.begin(), iter);
+}
 
-  // This function should never be called with valid updates while we are
-  // not initialized yet
-  DCHECK(isInitialized());
-
-  std::shared_ptr<SwitchState> oldAppliedState;
-  std::shared_ptr<SwitchState> oldDesiredState;
-  // Call all of the update functions to prepare the new SwitchState
-  std::tie(oldAppliedState, oldDesiredState) = getStates();
-  // We start with the old applied state, and apply state updates one at a
-  // time. The first state update applied is one from oldAppliedState ->
-  // oldDesiredState. This is the one we always enqueue at the front of the
-  // queue whenever applied and desired states diverge. After that, other
-  // supplied state updates are applied (that were spliced above).
-  auto newDesiredState = oldAppliedState;
-  auto iter = updates.begin();
-  while (iter != updates.end()) {
+shared_ptr<SwitchState> SwSwitch::applyStateUpdates(
+    shared_ptr<SwitchState> state,
+    StateUpdateList* updates) {
+  auto iter = updates->begin();
+  while (iter != updates->end()) {
     StateUpdate* update = &(*iter);
     ++iter;
 
     shared_ptr<SwitchState> intermediateState;
     XLOG(INFO) << "preparing state update " << update->getName();
     try {
-      intermediateState = update->applyUpdate(newDesiredState);
+      intermediateState = update->applyUpdate(state);
     } catch (const std::exception& ex) {
       // Call the update's onError() function, and then immediately delete
       // it (therefore removing it from the intrusive list).  This way we won't
@@ -811,9 +836,38 @@ void SwSwitch::handlePendingUpdates() {
       // ever fails partway through it can't have partially modified our
       // existing state, leaving it in an invalid state.
       intermediateState->publish();
-      newDesiredState = intermediateState;
+      state = intermediateState;
     }
   }
+  return state;
+}
+
+void SwSwitch::handlePendingUpdates() {
+  // Get the list of updates to run.
+  StateUpdateList updates;
+  getPendingUpdates(&updates);
+
+  // handlePendingUpdates() is invoked once for each update, but a previous
+  // call might have already processed everything.  If we don't have anything
+  // to do just return early.
+  if (updates.empty()) {
+    return;
+  }
+
+  // This function should never be called with valid updates while we are
+  // not initialized yet
+  DCHECK(isInitialized());
+
+  std::shared_ptr<SwitchState> oldAppliedState;
+  std::shared_ptr<SwitchState> oldDesiredState;
+  // Call all of the update functions to prepare the new SwitchState
+  std::tie(oldAppliedState, oldDesiredState) = getStates();
+  // We start with the old applied state, and apply state updates one at a
+  // time. The first state update applied is one from oldAppliedState ->
+  // oldDesiredState. This is the one we always enqueue at the front of the
+  // queue whenever applied and desired states diverge. After that, other
+  // supplied state updates are applied (that were spliced above).
+  auto newDesiredState = applyStateUpdates(oldAppliedState, &updates);
 
   // Now apply the update and notify subscribers
   if (newDesiredState != oldAppliedState) {
@@ -849,6 +903,100 @@ void SwSwitch::handlePendingUpdates() {
   }
 }
 
+void SwSwitch::prepareStateUpdatesHelper(SwSwitch* sw) {
+  sw->prepareStateUpdates();
+}
+
+void SwSwitch::prepareStateUpdates() {
+  DCHECK(statePrepareEventBase_.isInEventBaseThread());
+  auto prepared = std::make_unique<PreparedStateUpdates>();
+  getPendingUpdates(&prepared->updates);
+  if (prepared->updates.empty()) {
+    return;
+  }
+  DCHECK(isInitialized());
+
+  // Unlike handlePendingUpdates(), build on top of the desired state rather
+  // than the applied one. The desired state may be ahead of the hardware by
+  // the batches still queued for (or being applied by) the update thread.
+  // Any part of the desired state that failed to make it to the hardware is
+  // retried by applyPreparedStateUpdates(), since it always computes the
+  // delta from the applied state.
+  prepared->allowsCoalescing = prepared->updates.back().allowsCoalescing();
+  auto oldDesiredState = getDesiredState();
+  prepared->desiredState =
+      applyStateUpdates(oldDesiredState, &prepared->updates);
+  if (prepared->updates.empty()) {
+    // All of the updates failed
+    return;
+  }
+  if (prepared->desiredState != oldDesiredState) {
+    setDesiredState(prepared->desiredState);
+  }
+
+  {
+    folly::SpinLockGuard guard(preparedUpdatesLock_);
+    preparedUpdates_.push_back(std::move(prepared));
+  }
+  updateEventBase_.runInEventBaseThread(applyPreparedStateUpdatesHelper, this);
+}
+
+void SwSwitch::applyPreparedStateUpdatesHelper(SwSwitch* sw) {
+  sw->applyPreparedStateUpdates();
+}
+
+void SwSwitch::applyPreparedStateUpdates() {
+  // Collapse all the batches prepared since we last ran into a single
+  // hardware update, stopping after a batch that does not allow coalescing.
+  StateUpdateList updates;
+  std::shared_ptr<SwitchState> newDesiredState;
+  {
+    folly::SpinLockGuard guard(preparedUpdatesLock_);
+    while (!preparedUpdates_.empty()) {
+      auto prepared = std::move(preparedUpdates_.front());
+      preparedUpdates_.pop_front();
+      updates.splice(updates.end(), prepared->updates);
+      newDesiredState = prepared->desiredState;
+      if (!prepared->allowsCoalescing) {
+        break;
+      }
+    }
+  }
+  if (updates.empty()) {
+    return;
+  }
+
+  auto oldAppliedState = getAppliedState();
+  if (newDesiredState != oldAppliedState) {
+    if (newDesiredState->getGeneration() <= oldAppliedState->getGeneration()) {
+      // The hardware returned a partially applied state last time around,
+      // which may have a larger gen# than the desired states built since.
+      newDesiredState = newDesiredState->clone();
+      newDesiredState->inheritGeneration(*oldAppliedState);
+      newDesiredState->publish();
+    }
+    auto newAppliedState = applyUpdate(oldAppliedState, newDesiredState);
+    bool newOutOfSync = (newAppliedState != newDesiredState);
+    fb303::fbData->setCounter("hw_out_of_sync", newOutOfSync);
+    if (newOutOfSync) {
+      // The desired state already has what we failed to apply, and the next
+      // batch computes its delta from the applied state, so the update need
+      // not change anything. It only makes sure a batch runs to retry.
+      queueStateUpdateForGettingHwInSync(
+          "state update for failed hardware application",
+          [](const std::shared_ptr<SwitchState>& /*oldState*/) {
+            return std::shared_ptr<SwitchState>();
+          });
+    }
+  }
+
+  while (!updates.empty()) {
+    unique_ptr<StateUpdate> update(&updates.front());
+    updates.pop_front();
+    update->onSuccess();
+  }
+}
+
 void SwSwitch::setStateInternal(
     std::shared_ptr<SwitchState> newAppliedState,
     std::shared_ptr<SwitchState> newDesiredState) {
@@ -870,6 +1018,13 @@ void SwSwitch::setDesiredState(std::shared_ptr<SwitchState> newDesiredState) {
   desiredStateDontUseDirectly_.swap(newDesiredState);
 }
 
+void SwSwitch::setAppliedState(std::shared_ptr<SwitchState> newAppliedState) {
+  CHECK(bool(newAppliedState));
+  CHECK(newAppliedState->isPublished());
+  folly::SpinLockGuard guard(stateLock_);
+  appliedStateDontUseDirectly_.swap(newAppliedState);
+}
+
 std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
     const shared_ptr<SwitchState>& oldState,
     const shared_ptr<SwitchState>& newState) {
@@ -917,7 +1072,13 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
                 << folly::exceptionStr(ex);
   }
 
-  setStateInternal(newAppliedState, newState);
+  if (pipelinedStateUpdates_) {
+    // The desired state has already been set by prepareStateUpdates(), and
+    // may have moved past newState since.
+    setAppliedState(newAppliedState);
+  } else {
+    setStateInternal(newAppliedState, newState);
+  }
 
   // Notifies all observers of the current state update. We notify them that
   // the state changed to "desired state", even if the whole state might not
@@ -1005,6 +1166,17 @@ void SwSwitch::setPortStatusCounter(PortID port, bool up) {
 }
 
 void SwSwitch::packetReceived(std::unique_ptr<RxPacket> pkt) noexcept {
+  if (rxScheduler_) {
+    PortID port = pkt->getSrcPort();
+    if (!rxScheduler_->enqueue(std::move(pkt))) {
+      portStats(port)->pktDropped();
+    }
+    return;
+  }
+  handlePacketNoThrow(std::move(pkt));
+}
+
+void SwSwitch::handlePacketNoThrow(std::unique_ptr<RxPacket> pkt) noexcept {
   PortID port = pkt->getSrcPort();
   try {
     handlePacket(std::move(pkt));
@@ -1140,6 +1312,11 @@ void SwSwitch::linkStateChanged(PortID portId, bool up) {
 void SwSwitch::startThreads() {
   backgroundThread_.reset(new std::thread(
       [=] { this->threadLoop("fbossBgThread", &backgroundEventBase_); }));
+  if (pipelinedStateUpdates_) {
+    statePrepareThread_.reset(new std::thread([=] {
+      this->threadLoop("fbossStatePrepareThread", &statePrepareEventBase_);
+    }));
+  }
   updateThread_.reset(new std::thread(
       [=] { this->threadLoop("fbossUpdateThread", &updateEventBase_); }));
   packetTxThread_.reset(new std::thread(
@@ -1166,6 +1343,10 @@ void SwSwitch::stopThreads() {
     backgroundEventBase_.runInEventBaseThread(
         [this] { backgroundEventBase_.terminateLoopSoon(); });
   }
+  if (statePrepareThread_) {
+    statePrepareEventBase_.runInEventBaseThread(
+        [this] { statePrepareEventBase_.terminateLoopSoon(); });
+  }
   if (updateThread_) {
     updateEventBase_.runInEventBaseThread(
         [this] { updateEventBase_.terminateLoopSoon(); });
@@ -1189,6 +1370,9 @@ void SwSwitch::stopThreads() {
   if (backgroundThread_) {
     backgroundThread_->join();
   }
+  if (statePrepareThread_) {
+    statePrepareThread_->join();
+  }
   if (updateThread_) {
     updateThread_->join();
   }
@@ -26,6 +26,7 @@
 #include <optional>
 
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -36,6 +37,7 @@ namespace facebook::fboss {
 class ArpHandler;
 class ChannelCloser;
 class IPv4Handler;
+class GleanQueue;
 class IPv6Handler;
 class LinkAggregationManager;
 class LldpManager;
@@ -47,6 +49,7 @@ class PortDescriptor;
 class PortStats;
 class PortUpdateHandler;
 class RxPacket;
+class RxPacketScheduler;
 class SwitchState;
 class SwitchStats;
 class StateDelta;
@@ -530,6 +533,14 @@ class SwSwitch : public HwSwitch::Callback {
     return nUpdater_.get();
   }
 
+  /*
+   * Get the GleanQueue holding packets for unresolved next hops, or
+   * nullptr if such packets are dropped.
+   */
+  GleanQueue* getGleanQueue() {
+    return gleanQueue_.get();
+  }
+
   /*
    * Get the PktCaptureManager object.
    */
@@ -700,6 +711,8 @@ class SwSwitch : public HwSwitch::Callback {
 
   void setDesiredState(std::shared_ptr<SwitchState> newDesiredState);
 
+  void setAppliedState(std::shared_ptr<SwitchState> newAppliedState);
+
   void publishInitTimes(std::string name, const float& time);
   void updatePortInfo();
   void updateRouteStats();
@@ -707,9 +720,31 @@ class SwSwitch : public HwSwitch::Callback {
   void setSwitchRunState(SwitchRunState desiredState);
   SwitchStats* createSwitchStats();
   void handlePacket(std::unique_ptr<RxPacket> pkt);
+  void handlePacketNoThrow(std::unique_ptr<RxPacket> pkt) noexcept;
 
   static void handlePendingUpdatesHelper(SwSwitch* sw);
   void handlePendingUpdates();
+  void getPendingUpdates(StateUpdateList* updates);
+  std::shared_ptr<SwitchState> applyStateUpdates(
+      std::shared_ptr<SwitchState> state,
+      StateUpdateList* updates);
+
+  /*
+   * The two stages of the pipelined update loop, used when
+   * pipelinedStateUpdates_ is set.
+   *
+   * prepareStateUpdates() runs on the state prepare thread. It applies the
+   * pending update functions on top of the latest desired state and hands
+   * the result to applyPreparedStateUpdates(), which runs on the update
+   * thread, programs the hardware and notifies the state observers.  This
+   * lets the next batch of updates be prepared while the hardware is being
+   * programmed with the previous one.
+   */
+  static void prepareStateUpdatesHelper(SwSwitch* sw);
+  void prepareStateUpdates();
+  static void applyPreparedStateUpdatesHelper(SwSwitch* sw);
+  void applyPreparedStateUpdates();
+
   std::shared_ptr<SwitchState> applyUpdate(
       const std::shared_ptr<SwitchState>& oldState,
       const std::shared_ptr<SwitchState>& newState);
@@ -774,6 +809,20 @@ class SwSwitch : public HwSwitch::Callback {
   folly::SpinLock pendingUpdatesLock_;
   StateUpdateList pendingUpdates_;
 
+  /*
+   * Batches of state updates whose functions have already been run by
+   * prepareStateUpdates(), waiting to be applied to the hardware. Only used
+   * when pipelinedStateUpdates_ is set.
+   */
+  struct PreparedStateUpdates {
+    std::shared_ptr<SwitchState> desiredState;
+    StateUpdateList updates;
+    bool allowsCoalescing{true};
+  };
+  folly::SpinLock preparedUpdatesLock_;
+  std::deque<std::unique_ptr<PreparedStateUpdates>> preparedUpdates_;
+  const bool pipelinedStateUpdates_;
+
   /*
    * The current switch state: modelled as two states:
    *
@@ -829,6 +878,13 @@ class SwSwitch : public HwSwitch::Callback {
   folly::EventBase updateEventBase_;
   std::unique_ptr<ThreadHeartbeat> updThreadHeartbeat_;
 
+  /*
+   * A thread for running StateUpdate functions ahead of the update thread.
+   * Only started when pipelinedStateUpdates_ is set.
+   */
+  std::unique_ptr<std::thread> statePrepareThread_;
+  folly::EventBase statePrepareEventBase_;
+
   /*
    * A thread dedicated to LACP processing.
    */
@@ -882,6 +938,13 @@ class SwSwitch : public HwSwitch::Callback {
 
   std::unique_ptr<LookupClassUpdater> lookupClassUpdater_;
   std::unique_ptr<MacTableManager> macTableManager_;
+
+  // Only set with --rx_scheduler, otherwise packets are handled inline
+  std::unique_ptr<RxPacketScheduler> rxScheduler_;
+
+  // Only set with --glean_queue, otherwise packets for unresolved next hops
+  // are dropped
+  std::unique_ptr<GleanQueue> gleanQueue_;
 };
 
 } // namespace facebook::fboss
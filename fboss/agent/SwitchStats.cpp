@@ -78,8 +78,36 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           kCounterPrefix + "ip.dst_lookup_failure",
           SUM,
           RATE),
+      gleanQueued_(map, kCounterPrefix + "glean.queued", SUM, RATE),
+      gleanQueueFull_(map, kCounterPrefix + "glean.queue_full", SUM, RATE),
+      gleanFlushed_(map, kCounterPrefix + "glean.flushed", SUM, RATE),
+      gleanExpired_(map, kCounterPrefix + "glean.expired", SUM, RATE),
+      gleanRequestSuppressed_(
+          map,
+          kCounterPrefix + "glean.request_suppressed",
+          SUM,
+          RATE),
       updateState_(map, kCounterPrefix + "state_update.us", 50000, 0, 1000000),
       routeUpdate_(map, kCounterPrefix + "route_update.us", 50, 0, 500),
+      fibUpdate_(map, kCounterPrefix + "fib_update.us", 1000, 0, 1000000),
+      fibChangedPrefixes_(
+          map,
+          kCounterPrefix + "fib_update.changed_prefixes",
+          100,
+          0,
+          100000),
+      l2LearningQueueDepth_(
+          map,
+          kCounterPrefix + "l2_learning.queue_depth",
+          1000,
+          0,
+          100000),
+      l2LearningBatchSize_(
+          map,
+          kCounterPrefix + "l2_learning.batch_size",
+          100,
+          0,
+          10000),
       bgHeartbeatDelay_(
           map,
           kCounterPrefix + "bg_heartbeat_delay.ms",
@@ -222,6 +222,23 @@ class SwitchStats : public boost::noncopyable {
     dstLookupFailure_.addValue(1);
   }
 
+  void gleanQueued() {
+    gleanQueued_.addValue(1);
+  }
+  void gleanQueueFull() {
+    gleanQueueFull_.addValue(1);
+  }
+  void gleanFlushed(uint64_t packets) {
+    gleanFlushed_.addValue(packets);
+  }
+  void gleanExpired(uint64_t packets) {
+    gleanExpired_.addValue(packets);
+    trapPktDrops_.addValue(packets);
+  }
+  void gleanRequestSuppressed() {
+    gleanRequestSuppressed_.addValue(1);
+  }
+
   void stateUpdate(std::chrono::microseconds us) {
     updateState_.addValue(us.count());
   }
@@ -234,6 +251,16 @@ class SwitchStats : public boost::noncopyable {
     routeUpdate_.addRepeatedValue(us.count() / routes, routes);
   }
 
+  void fibUpdate(std::chrono::microseconds us, uint64_t changedPrefixes) {
+    fibUpdate_.addValue(us.count());
+    fibChangedPrefixes_.addValue(changedPrefixes);
+  }
+
+  void l2LearningBatch(uint64_t queueDepth, uint64_t batchSize) {
+    l2LearningQueueDepth_.addValue(queueDepth);
+    l2LearningBatchSize_.addValue(batchSize);
+  }
+
   void bgHeartbeatDelay(int delay) {
     bgHeartbeatDelay_.addValue(delay);
   }
@@ -406,6 +433,18 @@ class SwitchStats : public boost::noncopyable {
   TLTimeseries dstLookupFailureV6_;
   TLTimeseries dstLookupFailure_;
 
+  /**
+   * Packets held until their next hop is resolved, dropped because the
+   * glean queue was full, sent out once the next hop was resolved, and
+   * dropped because it was not resolved in time
+   */
+  TLTimeseries gleanQueued_;
+  TLTimeseries gleanQueueFull_;
+  TLTimeseries gleanFlushed_;
+  TLTimeseries gleanExpired_;
+  // ARP requests and neighbor solicitations not sent as one was outstanding
+  TLTimeseries gleanRequestSuppressed_;
+
   /**
    * Histogram for time used for SwSwitch::updateState() (in ms)
    */
@@ -416,6 +455,20 @@ class SwitchStats : public boost::noncopyable {
    */
   TLHistogram routeUpdate_;
 
+  /**
+   * Time taken to update the FIB from the standalone RIB (in microseconds),
+   * and the number of FIB routes added, changed or removed by the update
+   */
+  TLHistogram fibUpdate_;
+  TLHistogram fibChangedPrefixes_;
+
+  /**
+   * L2 learning updates queued when a batch is applied, and the number of
+   * MACs updated by the batch
+   */
+  TLHistogram l2LearningQueueDepth_;
+  TLHistogram l2LearningBatchSize_;
+
   /**
    * Background thread heartbeat delay (ms)
    */
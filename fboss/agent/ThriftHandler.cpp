@@ -136,12 +136,20 @@ void dynamicFibUpdate(
     facebook::fboss::RouterID vrf,
     const facebook::fboss::rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
     const facebook::fboss::rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const std::vector<folly::CIDRNetwork>* affectedPrefixes,
     void* cookie) {
   facebook::fboss::rib::ForwardingInformationBaseUpdater fibUpdater(
-      vrf, v4NetworkToRoute, v6NetworkToRoute);
+      vrf, v4NetworkToRoute, v6NetworkToRoute, affectedPrefixes);
 
   auto sw = static_cast<facebook::fboss::SwSwitch*>(cookie);
-  sw->updateStateBlocking("", std::move(fibUpdater));
+  sw->updateStateBlocking(
+      "", [sw, &fibUpdater](const std::shared_ptr<SwitchState>& state) {
+        auto newState = fibUpdater(state);
+        sw->stats()->fibUpdate(
+            fibUpdater.getLastUpdateDuration(),
+            fibUpdater.getNumChangedPrefixes());
+        return newState;
+      });
 }
 
 void fillPortStats(PortInfoThrift& portInfo, int numPortQs) {
@@ -1219,7 +1227,11 @@ void ThriftHandler::startPktCapture(unique_ptr<CaptureInfo> info) {
   ensureConfigured();
   auto* mgr = sw_->getCaptureMgr();
   auto capture = make_unique<PktCapture>(
-      info->name, info->maxPackets, info->direction, info->filter);
+      info->name,
+      info->maxPackets,
+      info->direction,
+      info->filter,
+      info->snaplen);
   mgr->startCapture(std::move(capture));
 }
 
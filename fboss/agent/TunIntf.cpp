@@ -22,9 +22,11 @@ extern "C" {
 #include <sys/types.h>
 }
 
+#include <fb303/ThreadCachedServiceData.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/io/async/EventHandler.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
 #include "fboss/agent/NlError.h"
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SwSwitch.h"
@@ -32,6 +34,30 @@ extern "C" {
 #include "fboss/agent/TxPacket.h"
 #include "fboss/agent/packet/EthHdr.h"
 
+#include <shared_mutex>
+#include <thread>
+
+DEFINE_bool(
+    tun_batched_io,
+    false,
+    "Open multi-queue tun interfaces and read/write host packets in batches");
+DEFINE_int32(
+    tun_io_queues,
+    4,
+    "Number of queues to open per tun interface with --tun_batched_io");
+DEFINE_int32(
+    tun_io_batch_size,
+    64,
+    "Max packets read from the host per batch with --tun_batched_io");
+DEFINE_int32(
+    tun_tx_queue_depth,
+    1024,
+    "Max packets waiting to be written to the host per tun queue with "
+    "--tun_batched_io");
+
+using facebook::fb303::AVG;
+using facebook::fb303::SUM;
+
 namespace facebook::fboss {
 
 namespace {
@@ -59,6 +85,15 @@ struct iplink_req {
 #ifndef IN6_ADDR_GEN_MODE_NONE
 #define IN6_ADDR_GEN_MODE_NONE 1
 #endif
+// Available since kernel-4.15
+#ifndef IFF_NAPI
+#define IFF_NAPI 0x0010
+#endif
+
+const std::string kRxBatchSize = "host_rx.batch_size";
+const std::string kRxDrops = "host_rx.drops";
+const std::string kTxBatchSize = "host_tx.batch_size";
+const std::string kTxDrops = "host_tx.drops";
 
 } // anonymous namespace
 
@@ -73,7 +108,8 @@ TunIntf::TunIntf(
       name_(util::createTunIntfName(ifID)),
       ifID_(ifID),
       ifIndex_(ifIndex),
-      mtu_(mtu) {
+      mtu_(mtu),
+      batchedIO_(FLAGS_tun_batched_io) {
   DCHECK(sw) << "NULL pointer to SwSwitch.";
   DCHECK(evb) << "NULL pointer to EventBase";
 
@@ -105,7 +141,8 @@ TunIntf::TunIntf(
       ifID_(ifID),
       status_(status),
       addrs_(addr),
-      mtu_(mtu) {
+      mtu_(mtu),
+      batchedIO_(FLAGS_tun_batched_io) {
   DCHECK(sw) << "NULL pointer to SwSwitch.";
   DCHECK(evb) << "NULL pointer to EventBase";
 
@@ -176,6 +213,9 @@ TunIntf::~TunIntf() {
 
 void TunIntf::stop() {
   unregisterHandler();
+  for (auto& queue : extraQueues_) {
+    queue->unregisterHandler();
+  }
 }
 
 void TunIntf::start() {
@@ -183,47 +223,118 @@ void TunIntf::start() {
     changeHandlerFD(folly::NetworkSocket::fromFd(fd_));
     registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
   }
+  for (auto& queue : extraQueues_) {
+    if (!queue->isHandlerRegistered()) {
+      queue->registerHandler(
+          folly::EventHandler::READ | folly::EventHandler::PERSIST);
+    }
+  }
 }
 
-void TunIntf::openFD() {
-  fd_ = open(kTunDev.c_str(), O_RDWR);
-  sysCheckError(fd_, "Cannot open ", kTunDev.c_str());
-  SCOPE_FAIL {
-    closeFD();
-  };
+int TunIntf::openQueueFD(short flags) const {
+  int fd = open(kTunDev.c_str(), O_RDWR);
+  sysCheckError(fd, "Cannot open ", kTunDev.c_str());
 
   struct ifreq ifr;
   memset(&ifr, 0, sizeof(ifr));
-  // Flags: IFF_TUN   - TUN device (no Ethernet headers)
-  //        IFF_NO_PI - Do not provide packet information
-  ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  ifr.ifr_flags = flags;
   bzero(ifr.ifr_name, sizeof(ifr.ifr_name));
   size_t len = std::min(name_.size(), sizeof(ifr.ifr_name));
   memmove(ifr.ifr_name, name_.c_str(), len);
-  auto ret = ioctl(fd_, TUNSETIFF, (void*)&ifr);
-  sysCheckError(ret, "Failed to create/attach interface ", name_);
-
-  // Set configured MTU
-  setMtu(mtu_);
+  auto ret = ioctl(fd, TUNSETIFF, (void*)&ifr);
+  if (ret < 0) {
+    auto err = errno;
+    close(fd);
+    return -err;
+  }
 
   // make fd non-blocking
-  auto flags = fcntl(fd_, F_GETFL);
-  sysCheckError(flags, "Failed to get flags from fd ", fd_);
-  flags |= O_NONBLOCK;
-  ret = fcntl(fd_, F_SETFL, flags);
+  auto fdFlags = fcntl(fd, F_GETFL);
+  sysCheckError(fdFlags, "Failed to get flags from fd ", fd);
+  fdFlags |= O_NONBLOCK;
+  ret = fcntl(fd, F_SETFL, fdFlags);
   sysCheckError(
-      ret, "Failed to set non-blocking flags ", flags, " to fd ", fd_);
-  flags = fcntl(fd_, F_GETFD);
-  sysCheckError(flags, "Failed to get flags from fd ", fd_);
-  flags |= FD_CLOEXEC;
-  ret = fcntl(fd_, F_SETFD, flags);
+      ret, "Failed to set non-blocking flags ", fdFlags, " to fd ", fd);
+  fdFlags = fcntl(fd, F_GETFD);
+  sysCheckError(fdFlags, "Failed to get flags from fd ", fd);
+  fdFlags |= FD_CLOEXEC;
+  ret = fcntl(fd, F_SETFD, fdFlags);
   sysCheckError(
-      ret, "Failed to set close-on-exec flags ", flags, " to fd ", fd_);
+      ret, "Failed to set close-on-exec flags ", fdFlags, " to fd ", fd);
+  return fd;
+}
+
+void TunIntf::openFD() {
+  // Flags: IFF_TUN   - TUN device (no Ethernet headers)
+  //        IFF_NO_PI - Do not provide packet information
+  short flags = IFF_TUN | IFF_NO_PI;
+  if (batchedIO_) {
+    // IFF_MULTI_QUEUE - Allow more than one fd on the interface, so that
+    //                   host packets are spread across queues and writes
+    //                   from different threads do not share a queue
+    // IFF_NAPI        - Kernel processes packets written by us in NAPI
+    //                   batches instead of one at a time
+    // Older kernels reject IFF_NAPI, and an interface created without
+    // IFF_MULTI_QUEUE (e.g. by a previous version) rejects it, so fall
+    // back to whatever the kernel accepts.
+    for (short extra : {IFF_MULTI_QUEUE | IFF_NAPI, IFF_MULTI_QUEUE, 0}) {
+      fd_ = openQueueFD(flags | extra);
+      if (fd_ != -EINVAL) {
+        flags |= extra;
+        break;
+      }
+    }
+  } else {
+    fd_ = openQueueFD(flags);
+    if (fd_ == -EINVAL) {
+      // The interface was created with IFF_MULTI_QUEUE by an earlier run
+      // with --tun_batched_io, and rejects fds without it
+      fd_ = openQueueFD(flags | IFF_MULTI_QUEUE);
+    }
+  }
+  if (fd_ < 0) {
+    auto err = -fd_;
+    fd_ = -1;
+    throw SysError(err, "Failed to create/attach interface ", name_);
+  }
+  SCOPE_FAIL {
+    closeFD();
+  };
 
-  XLOG(INFO) << "Create/attach to tun interface " << name_ << " @ fd " << fd_;
+  // Set configured MTU
+  setMtu(mtu_);
+
+  txQueues_.push_back(std::make_unique<TxQueue>(fd_));
+  if (batchedIO_ && (flags & IFF_MULTI_QUEUE)) {
+    for (int i = 1; i < FLAGS_tun_io_queues; ++i) {
+      int fd = openQueueFD(flags);
+      if (fd < 0) {
+        throw SysError(-fd, "Failed to attach queue to interface ", name_);
+      }
+      extraQueues_.push_back(
+          std::make_unique<QueueHandler>(this, getEventBase(), fd));
+      txQueues_.push_back(std::make_unique<TxQueue>(fd));
+    }
+  }
+
+  XLOG(INFO) << "Create/attach to tun interface " << name_ << " @ fd " << fd_
+             << " with " << getNumQueues() << " queue(s)"
+             << ((flags & IFF_NAPI) ? ", napi" : "");
 }
 
 void TunIntf::closeFD() noexcept {
+  {
+    // Waits for the threads writing to the queues to be done with them
+    std::unique_lock<folly::SharedMutex> guard(txQueuesLock_);
+    txQueues_.clear();
+  }
+  for (auto& queue : extraQueues_) {
+    queue->unregisterHandler();
+    auto ret = close(queue->getFd());
+    sysLogError(ret, "Failed to close fd ", queue->getFd(), " for ", name_);
+  }
+  extraQueues_.clear();
+
   auto ret = close(fd_);
   sysLogError(ret, "Failed to close fd ", fd_, " for interface ", name_);
   if (ret == 0) {
@@ -315,6 +426,10 @@ void TunIntf::disableIPv6AddrGenMode(int ifIndex) {
 
 void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
   CHECK(fd_ != -1);
+  if (batchedIO_) {
+    readPacketBatch(fd_);
+    return;
+  }
 
   // Since this is L3 packet size, we should also reserve some space for L2
   // header, which is 18 bytes (including one vlan tag)
@@ -325,11 +440,15 @@ void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
   try {
     while (sent + dropped < kMaxSentOneTime) {
       std::unique_ptr<TxPacket> pkt;
-      pkt = sw_->allocateL3TxPacket(mtu_);
+      // Room for one byte more than the MTU: the kernel truncates a packet
+      // which does not fit in the read, so a read filling the buffer means
+      // the packet was too large.
+      pkt = sw_->allocateL3TxPacket(mtu_ + 1);
       auto buf = pkt->buf();
+      const auto readLen = std::min<uint64_t>(buf->tailroom(), mtu_ + 1);
       int ret = 0;
       do {
-        ret = read(fd_, buf->writableTail(), buf->tailroom());
+        ret = read(fd_, buf->writableTail(), readLen);
       } while (ret == -1 && errno == EINTR);
       if (ret < 0) {
         if (errno != EAGAIN) {
@@ -344,10 +463,10 @@ void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
         // in debug mode.
         DCHECK(false) << "Unexpected event. Nothing to read.";
         break;
-      } else if (ret > buf->tailroom()) {
-        // The pkt is larger than the buffer. We don't have complete packet.
+      } else if (ret > mtu_) {
+        // The pkt is larger than the MTU. We don't have complete packet.
         // It shall not happen unless the MTU is mis-match. Drop the packet.
-        XLOG(ERR) << "Too large packet (" << ret << " > " << buf->tailroom()
+        XLOG(ERR) << "Too large packet (" << ret << " > " << mtu_
                   << ") received from host. Drop the packet.";
         ++dropped;
       } else {
@@ -366,11 +485,100 @@ void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
     unregisterHandler();
   }
 
+  rxPackets_ += sent;
+  rxDrops_ += dropped;
+  ++rxBatches_;
+
   XLOG(DBG4) << "Forwarded " << sent << " packets (" << bytes
              << " bytes) from host @ fd " << fd_ << " for interface " << name_
              << " dropped:" << dropped;
 }
 
+void TunIntf::readPacketBatch(int fd) noexcept {
+  const size_t batchSize = std::max(FLAGS_tun_io_batch_size, 1);
+  // One byte more than the MTU, to tell a truncated packet from one of
+  // exactly the MTU, as in handlerReady()
+  const uint32_t bufSize = std::max(mtu_, 0) + 1;
+  rxRing_.resize(batchSize);
+
+  size_t received = 0;
+  int dropped = 0;
+  uint64_t bytes = 0;
+  bool fdFail = false;
+  try {
+    // Replace the packets handed over by the previous batch, or too small
+    // for the MTU, up front, so that the reads are issued back to back.
+    // Packets left over by the read that hit EAGAIN are kept for next time.
+    for (auto& pkt : rxRing_) {
+      if (!pkt || pkt->buf()->tailroom() < bufSize) {
+        pkt = sw_->allocateL3TxPacket(bufSize);
+      }
+    }
+    while (received < batchSize) {
+      auto buf = rxRing_[received]->buf();
+      int ret = 0;
+      do {
+        ret = read(fd, buf->writableTail(), bufSize);
+      } while (ret == -1 && errno == EINTR);
+      if (ret < 0) {
+        if (errno != EAGAIN) {
+          sysLogError(ret, "Failed to read on ", fd);
+          // Cannot continue read on this fd
+          fdFail = true;
+        }
+        break;
+      } else if (ret == 0) {
+        DCHECK(false) << "Unexpected event. Nothing to read.";
+        break;
+      } else if (ret > mtu_) {
+        // The packet is reused for the next read
+        XLOG(ERR) << "Too large packet (" << ret << " > " << mtu_
+                  << ") received from host. Drop the packet.";
+        ++dropped;
+      } else {
+        buf->append(ret);
+        bytes += ret;
+        ++received;
+      }
+    }
+  } catch (const std::exception& ex) {
+    XLOG_EVERY_MS(ERR, 1000) << "Hit some error when reading packets :"
+                             << folly::exceptionStr(ex);
+  }
+
+  // The packets were read in place, so hand them over as they are
+  size_t sent = 0;
+  for (; sent < received; ++sent) {
+    sw_->sendL3Packet(std::move(rxRing_[sent]), ifID_);
+  }
+
+  if (fdFail) {
+    if (fd == fd_) {
+      unregisterHandler();
+    } else {
+      for (auto& queue : extraQueues_) {
+        if (queue->getFd() == fd) {
+          queue->unregisterHandler();
+        }
+      }
+    }
+  }
+
+  rxPackets_ += sent;
+  rxDrops_ += dropped;
+  ++rxBatches_;
+  tcData().addStatValue(
+      folly::to<std::string>(name_, ".", kRxBatchSize), sent, AVG);
+  if (dropped) {
+    tcData().addStatValue(
+        folly::to<std::string>(name_, ".", kRxDrops), dropped, SUM);
+  }
+
+  XLOG(DBG4) << "Forwarded " << sent << " packets (" << bytes
+             << " bytes) from host @ fd " << fd << " for interface " << name_
+             << " dropped:" << dropped;
+}
+
 bool TunIntf::sendPacketToHost(std::unique_ptr<RxPacket> pkt) {
   CHECK(fd_ != -1);
   const int l2Len = EthHdr::SIZE;
@@ -378,15 +586,29 @@ bool TunIntf::sendPacketToHost(std::unique_ptr<RxPacket> pkt) {
   auto buf = pkt->buf();
   if (buf->length() <= l2Len) {
     XLOG(ERR) << "Received a too small packet with length " << buf->length();
+    ++txDrops_;
     return false;
   }
 
   // skip L2 header
   buf->trimStart(l2Len);
 
+  if (batchedIO_) {
+    return queueToHost(std::move(pkt));
+  }
+  if (!writeToHost(fd_, buf)) {
+    ++txDrops_;
+    return false;
+  }
+  ++txPackets_;
+  ++txBatches_;
+  return true;
+}
+
+bool TunIntf::writeToHost(int fd, const folly::IOBuf* buf) {
   int ret = 0;
   do {
-    ret = write(fd_, buf->data(), buf->length());
+    ret = write(fd, buf->data(), buf->length());
   } while (ret == -1 && errno == EINTR);
   if (ret < 0) {
     sysLogError(ret, "Failed to send packet to host from Interface ", ifID_);
@@ -402,4 +624,82 @@ bool TunIntf::sendPacketToHost(std::unique_ptr<RxPacket> pkt) {
   return true;
 }
 
+bool TunIntf::queueToHost(std::unique_ptr<RxPacket> pkt) {
+  std::shared_lock<folly::SharedMutex> guard(txQueuesLock_);
+  if (txQueues_.empty()) {
+    // The fds are being closed
+    ++txDrops_;
+    return false;
+  }
+  // Spread writer threads across the queues, so threads only combine their
+  // writes with other threads mapped to the same queue.
+  auto idx = std::hash<std::thread::id>()(std::this_thread::get_id()) %
+      txQueues_.size();
+  auto queue = txQueues_[idx].get();
+  {
+    std::lock_guard<std::mutex> queueGuard(queue->lock);
+    if (queue->pending.size() >=
+        static_cast<size_t>(std::max(FLAGS_tun_tx_queue_depth, 1))) {
+      ++txDrops_;
+      tcData().addStatValue(
+          folly::to<std::string>(name_, ".", kTxDrops), 1, SUM);
+      return false;
+    }
+    queue->pending.push_back(std::move(pkt));
+    if (queue->writing) {
+      // The thread currently writing will pick this packet up
+      return true;
+    }
+    queue->writing = true;
+  }
+  drainTxQueue(queue);
+  return true;
+}
+
+void TunIntf::drainTxQueue(TxQueue* queue) {
+  // Called with txQueuesLock_ held shared
+  std::vector<std::unique_ptr<RxPacket>> batch;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> guard(queue->lock);
+      if (queue->pending.empty()) {
+        queue->writing = false;
+        return;
+      }
+      batch.swap(queue->pending);
+    }
+    uint64_t sent = 0;
+    uint64_t dropped = 0;
+    for (const auto& pkt : batch) {
+      if (writeToHost(queue->fd, pkt->buf())) {
+        ++sent;
+      } else {
+        ++dropped;
+      }
+    }
+    batch.clear();
+
+    txPackets_ += sent;
+    txDrops_ += dropped;
+    ++txBatches_;
+    tcData().addStatValue(
+        folly::to<std::string>(name_, ".", kTxBatchSize), sent, AVG);
+    if (dropped) {
+      tcData().addStatValue(
+          folly::to<std::string>(name_, ".", kTxDrops), dropped, SUM);
+    }
+  }
+}
+
+TunIntf::Stats TunIntf::getStats() const {
+  Stats stats;
+  stats.rxPackets = rxPackets_.load();
+  stats.rxBatches = rxBatches_.load();
+  stats.rxDrops = rxDrops_.load();
+  stats.txPackets = txPackets_.load();
+  stats.txBatches = txBatches_.load();
+  stats.txDrops = txDrops_.load();
+  return stats;
+}
+
 } // namespace facebook::fboss
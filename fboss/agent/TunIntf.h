@@ -9,19 +9,40 @@
  */
 #pragma once
 
+#include <folly/SharedMutex.h>
+#include <folly/io/IOBuf.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/io/async/EventHandler.h>
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/state/StateUtils.h"
 #include "fboss/agent/types.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace facebook::fboss {
 
 class SwSwitch;
 class RxPacket;
+class TxPacket;
 
 class TunIntf : private folly::EventHandler {
  public:
+  /**
+   * Packet counters for the interface. The rx direction is host to switch,
+   * tx is switch to host.
+   */
+  struct Stats {
+    uint64_t rxPackets{0};
+    uint64_t rxBatches{0};
+    uint64_t rxDrops{0};
+    uint64_t txPackets{0};
+    uint64_t txBatches{0};
+    uint64_t txDrops{0};
+  };
+
   /**
    * Creates a TunIntf object of already existing linux interface. Initial
    * status is set to `false` for discovered interfaces because we do not
@@ -89,7 +110,11 @@ class TunIntf : private folly::EventHandler {
    * Unlike other methods, which are called on thread that serves the evb,
    * this function can be called from any thread.
    *
-   * @return true The packet is sent to host
+   * With --tun_batched_io, the packet is queued and written to the host
+   * together with packets queued concurrently by other threads. Packets
+   * which fail to be written later are counted in Stats::txDrops.
+   *
+   * @return true The packet is sent (or queued to be sent) to host
    *         false The packet is dropped due to errors
    */
   bool sendPacketToHost(std::unique_ptr<RxPacket> pkt);
@@ -123,7 +148,54 @@ class TunIntf : private folly::EventHandler {
     return status_;
   }
 
+  Stats getStats() const;
+
+  /**
+   * Number of fds (queues) opened on the interface. This is more than one
+   * only with --tun_batched_io on kernels supporting multi-queue tun.
+   */
+  size_t getNumQueues() const {
+    return extraQueues_.size() + 1;
+  }
+
  private:
+  /**
+   * Read handler for the additional queues of a multi-queue interface. The
+   * first queue is served by TunIntf itself.
+   */
+  class QueueHandler : public folly::EventHandler {
+   public:
+    QueueHandler(TunIntf* intf, folly::EventBase* evb, int fd)
+        : folly::EventHandler(evb, folly::NetworkSocket::fromFd(fd)),
+          intf_(intf),
+          fd_(fd) {}
+
+    void handlerReady(uint16_t /*events*/) noexcept override {
+      intf_->readPacketBatch(fd_);
+    }
+
+    int getFd() const {
+      return fd_;
+    }
+
+   private:
+    TunIntf* intf_;
+    int fd_;
+  };
+
+  /**
+   * Packets waiting to be written to the host on one queue. Whichever
+   * thread finds the queue idle becomes the writer and drains the packets
+   * queued by all other threads in the meantime.
+   */
+  struct TxQueue {
+    explicit TxQueue(int fd) : fd(fd) {}
+    const int fd;
+    std::mutex lock;
+    std::vector<std::unique_ptr<RxPacket>> pending;
+    bool writing{false};
+  };
+
   /**
    * Callback for event on Tun interface's read socket-fd
    * Override's folly::EventHandler handlerReady callback.
@@ -137,6 +209,26 @@ class TunIntf : private folly::EventHandler {
   void openFD();
   void closeFD() noexcept;
 
+  /**
+   * Open an fd attached to the interface with the given TUNSETIFF flags.
+   * Returns -errno if the kernel rejects the flags.
+   */
+  int openQueueFD(short flags) const;
+
+  /**
+   * Read up to --tun_io_batch_size packets from fd into the packets of
+   * rxRing_, then forward them to the switch.
+   */
+  void readPacketBatch(int fd) noexcept;
+
+  /**
+   * Write a L3 packet to the host on fd.
+   */
+  bool writeToHost(int fd, const folly::IOBuf* buf);
+
+  bool queueToHost(std::unique_ptr<RxPacket> pkt);
+  void drainTxQueue(TxQueue* queue);
+
   /**
    * In newer kernel an interface is automatically gets link-local IPv6 address
    * because of IPv6 autoconf and FBOSS (we) assign one more.
@@ -163,6 +255,26 @@ class TunIntf : private folly::EventHandler {
    */
   int fd_{-1};
   int mtu_{-1};
+
+  /**
+   * State used with --tun_batched_io only.
+   */
+  const bool batchedIO_{false};
+  std::vector<std::unique_ptr<QueueHandler>> extraQueues_;
+  std::vector<std::unique_ptr<TxQueue>> txQueues_;
+  // Held shared by threads queueing to or draining txQueues_, and exclusive
+  // by closeFD(), so the queues and their fds outlive any write to them
+  folly::SharedMutex txQueuesLock_;
+  // Packets read from the host, allocated ahead of the reads on the evb
+  // thread and handed over to the switch as they are
+  std::vector<std::unique_ptr<TxPacket>> rxRing_;
+
+  std::atomic<uint64_t> rxPackets_{0};
+  std::atomic<uint64_t> rxBatches_{0};
+  std::atomic<uint64_t> rxDrops_{0};
+  std::atomic<uint64_t> txPackets_{0};
+  std::atomic<uint64_t> txBatches_{0};
+  std::atomic<uint64_t> txDrops_{0};
 };
 
 } // namespace facebook::fboss
@@ -27,7 +27,14 @@ class PcapPkt;
 class PcapFile {
  public:
   PcapFile();
-  explicit PcapFile(folly::StringPiece path, bool overwriteExisting = false);
+  /*
+   * Packets longer than snaplen are truncated to snaplen bytes. A snaplen of
+   * 0 writes whole packets.
+   */
+  explicit PcapFile(
+      folly::StringPiece path,
+      bool overwriteExisting = false,
+      uint32_t snaplen = 0);
   ~PcapFile();
 
   void close();
@@ -41,7 +48,7 @@ class PcapFile {
 
  private:
   struct PktHeader {
-    explicit PktHeader(const PcapPkt& pkt);
+    PktHeader(const PcapPkt& pkt, uint32_t snaplen);
 
     uint32_t timeSec{0};
     uint32_t timeUsec{0};
@@ -56,6 +63,7 @@ class PcapFile {
   static int openFlags(bool overwriteExisting);
 
   folly::File file_;
+  uint32_t snaplen_{0};
 };
 
 } // namespace facebook::fboss
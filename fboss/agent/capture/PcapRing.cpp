@@ -0,0 +1,131 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/capture/PcapRing.h"
+
+#include "fboss/agent/RxPacket.h"
+#include "fboss/agent/TxPacket.h"
+
+#include <algorithm>
+
+namespace facebook::fboss {
+
+PcapRing::PcapRing(uint32_t pktCapacity) : pktCapacity_(pktCapacity) {}
+
+PcapRing::~PcapRing() {}
+
+PcapRing::ProducerRing* PcapRing::localRing() {
+  auto& ring = *localRing_;
+  if (!ring) {
+    ring = std::make_shared<ProducerRing>(pktCapacity_);
+    std::lock_guard<std::mutex> guard(ringsMutex_);
+    rings_.push_back(ring);
+  }
+  return ring.get();
+}
+
+template <typename PktType>
+void PcapRing::addPktInternal(const PktType* pkt) {
+  auto ring = localRing();
+  if (!ring->ring.write(pkt)) {
+    ring->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  wakeReader();
+}
+
+void PcapRing::wakeReader() {
+  // Pairs with the fence in wait(): either the reader sees what was added
+  // before going to sleep, or we see it asleep here and wake it up.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (readerSleeping_.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> guard(sleepMutex_);
+    readerSleeping_.store(false, std::memory_order_relaxed);
+    sleepCV_.notify_one();
+  }
+}
+
+void PcapRing::addPkt(const RxPacket* pkt) {
+  addPktInternal(pkt);
+}
+
+void PcapRing::addPkt(const TxPacket* pkt) {
+  addPktInternal(pkt);
+}
+
+void PcapRing::finish() {
+  finished_.store(true, std::memory_order_release);
+  wakeReader();
+}
+
+uint64_t PcapRing::numDropped() const {
+  std::lock_guard<std::mutex> guard(ringsMutex_);
+  uint64_t dropped = 0;
+  for (const auto& ring : rings_) {
+    dropped += ring->dropped.load(std::memory_order_relaxed);
+  }
+  return dropped;
+}
+
+void PcapRing::drain(std::vector<PcapPkt>* pkts) {
+  std::lock_guard<std::mutex> guard(ringsMutex_);
+  size_t ringsRead = 0;
+  for (const auto& ring : rings_) {
+    auto before = pkts->size();
+    while (auto pkt = ring->ring.frontPtr()) {
+      pkts->push_back(std::move(*pkt));
+      ring->ring.popFront();
+    }
+    ringsRead += pkts->size() > before ? 1 : 0;
+  }
+  if (ringsRead > 1) {
+    // Each ring is in order, but packets from different threads interleave
+    std::stable_sort(
+        pkts->begin(), pkts->end(), [](const auto& lhs, const auto& rhs) {
+          return lhs.timestamp() < rhs.timestamp();
+        });
+  }
+}
+
+bool PcapRing::empty() const {
+  std::lock_guard<std::mutex> guard(ringsMutex_);
+  for (const auto& ring : rings_) {
+    if (!ring->ring.isEmpty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PcapRing::wait(std::vector<PcapPkt>* pkts) {
+  pkts->clear();
+  while (true) {
+    // Read the flag before draining, so that packets added before finish()
+    // are always returned.
+    bool finished = isFinished();
+    drain(pkts);
+    if (!pkts->empty()) {
+      return true;
+    }
+    if (finished) {
+      return false;
+    }
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    readerSleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (empty() && !isFinished()) {
+      sleepCV_.wait(lock, [this]() {
+        return !readerSleeping_.load(std::memory_order_relaxed);
+      });
+    }
+    readerSleeping_.store(false, std::memory_order_relaxed);
+  }
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/capture/PcapPkt.h"
+
+#include <folly/ProducerConsumerQueue.h>
+#include <folly/ThreadLocal.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace facebook::fboss {
+
+class RxPacket;
+class TxPacket;
+
+/*
+ * PcapRing transfers captured packets from the threads sending and receiving
+ * packets to a single reader thread that writes them out, like PcapQueue,
+ * but without taking a lock or waking the reader on the packet path.
+ *
+ * Each thread adding packets gets its own single-producer/single-consumer
+ * ring the first time it adds one, so producers never contend with each
+ * other.  The PcapPkt in the ring holds a clone of the packet IOBuf, so the
+ * packet data is not copied.  Packets are dropped once the ring of the
+ * adding thread is full.
+ *
+ * The reader blocks on a condition variable when all rings are empty.
+ * Producers only take the lock to wake it up when it is asleep. There can
+ * only be a single reader.
+ */
+class PcapRing {
+ public:
+  /*
+   * pktCapacity is the capacity of each per-thread ring.
+   */
+  explicit PcapRing(uint32_t pktCapacity);
+  ~PcapRing();
+
+  uint32_t getPktCapacity() const {
+    return pktCapacity_;
+  }
+
+  void addPkt(const RxPacket* pkt);
+  void addPkt(const TxPacket* pkt);
+
+  /*
+   * finish() signals that no more packets will be added.
+   *
+   * This causes wait() to return false in the reader thread once the packets
+   * currently in the rings have been read.
+   */
+  void finish();
+  bool isFinished() const {
+    return finished_.load(std::memory_order_acquire);
+  }
+
+  /*
+   * Return the number of packets dropped because a ring was full.
+   */
+  uint64_t numDropped() const;
+
+  /*
+   * Wait for packets from any of the rings and move them to pkts, in
+   * timestamp order.
+   *
+   * Returns false once finish() has been called and all packets have been
+   * read.
+   */
+  bool wait(std::vector<PcapPkt>* pkts);
+
+ private:
+  struct ProducerRing {
+    explicit ProducerRing(uint32_t capacity) : ring(capacity + 1) {}
+
+    // ProducerConsumerQueue keeps one slot empty
+    folly::ProducerConsumerQueue<PcapPkt> ring;
+    std::atomic<uint64_t> dropped{0};
+  };
+
+  // Forbidden copy constructor and assignment operator
+  PcapRing(PcapRing const&) = delete;
+  PcapRing& operator=(PcapRing const&) = delete;
+
+  template <typename PktType>
+  void addPktInternal(const PktType* pkt);
+  ProducerRing* localRing();
+  void drain(std::vector<PcapPkt>* pkts);
+  bool empty() const;
+  void wakeReader();
+
+  const uint32_t pktCapacity_{0};
+  std::atomic<bool> finished_{false};
+
+  folly::ThreadLocal<std::shared_ptr<ProducerRing>> localRing_;
+
+  // Protects rings_. Producers only take it when adding their first packet.
+  mutable std::mutex ringsMutex_;
+  std::vector<std::shared_ptr<ProducerRing>> rings_;
+
+  // Set by the reader, under sleepMutex_, before it waits on sleepCV_ for
+  // packets. Cleared by whoever wakes it up.
+  std::atomic<bool> readerSleeping_{false};
+  std::mutex sleepMutex_;
+  std::condition_variable sleepCV_;
+};
+
+} // namespace facebook::fboss
@@ -13,19 +13,30 @@
 
 #include <folly/String.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+DECLARE_int32(fboss_pcap_queue_depth);
 
 using folly::StringPiece;
 
+namespace {
+uint32_t ringCapacity(uint32_t maxBufferedPkts) {
+  return maxBufferedPkts == 0 ? FLAGS_fboss_pcap_queue_depth : maxBufferedPkts;
+}
+} // namespace
+
 namespace facebook::fboss {
 
-PcapWriter::PcapWriter(uint32_t maxBufferedPkts) : queue_(maxBufferedPkts) {}
+PcapWriter::PcapWriter(uint32_t maxBufferedPkts)
+    : queue_(ringCapacity(maxBufferedPkts)) {}
 
 PcapWriter::PcapWriter(
     StringPiece path,
     bool overwriteExisting,
-    uint32_t maxBufferedPkts)
-    : file_(path, overwriteExisting),
-      queue_(maxBufferedPkts),
+    uint32_t maxBufferedPkts,
+    uint32_t snaplen)
+    : file_(path, overwriteExisting, snaplen),
+      queue_(ringCapacity(maxBufferedPkts)),
       thread_(&PcapWriter::threadMain, this) {}
 
 PcapWriter::~PcapWriter() {
@@ -40,8 +51,11 @@ PcapWriter::~PcapWriter() {
   }
 }
 
-void PcapWriter::start(folly::StringPiece path, bool overwriteExisting) {
-  file_ = PcapFile(path, overwriteExisting);
+void PcapWriter::start(
+    folly::StringPiece path,
+    bool overwriteExisting,
+    uint32_t snaplen) {
+  file_ = PcapFile(path, overwriteExisting, snaplen);
   thread_ = std::thread(&PcapWriter::threadMain, this);
 }
 
@@ -70,6 +84,8 @@ void PcapWriter::threadMain() {
 }
 
 void PcapWriter::writeLoop() {
+  // Each wait() returns everything buffered since the last one, so the
+  // packets are written to the file with a single large writev() call.
   std::vector<PcapPkt> pkts;
   while (true) {
     pkts.clear();
@@ -10,17 +10,18 @@
 #pragma once
 
 #include "fboss/agent/capture/PcapFile.h"
-#include "fboss/agent/capture/PcapQueue.h"
+#include "fboss/agent/capture/PcapRing.h"
 
 #include <thread>
 
 namespace facebook::fboss {
 
 /*
- * PcapWriter listes to a PcapQueue and writes the packets it receives
+ * PcapWriter listes to a PcapRing and writes the packets it receives
  * to a pcap file.
  *
  * It performs blocking disk I/O, so it performs the writes in its own thread.
+ * addPkt() is safe to call from any number of threads, and does not block.
  */
 class PcapWriter {
  public:
@@ -28,41 +29,33 @@ class PcapWriter {
   explicit PcapWriter(
       folly::StringPiece path,
       bool overwriteExisting = false,
-      uint32_t maxBufferedPkts = 0);
+      uint32_t maxBufferedPkts = 0,
+      uint32_t snaplen = 0);
   virtual ~PcapWriter();
 
-  void start(folly::StringPiece path, bool overwriteExisting = false);
-
   /*
-   * Get the mutex protecting this PcapWriter.
-   *
-   * This is exposed to allow callers to also protect their own data
-   * with the same mutex if desired.  Callers should call addPktLocked()
-   * instead of addPkt() when they are already holding the PcapWriter mutex.
+   * Packets longer than snaplen are truncated in the file. A snaplen of 0
+   * writes whole packets.
    */
-  std::mutex& mutex() const {
-    return queue_.mutex();
-  }
+  void start(
+      folly::StringPiece path,
+      bool overwriteExisting = false,
+      uint32_t snaplen = 0);
 
   void addPkt(const RxPacket* pkt) {
     queue_.addPkt(pkt);
   }
-  void addPktLocked(const RxPacket* pkt) {
-    queue_.addPktLocked(pkt);
-  }
   void addPkt(const TxPacket* pkt) {
     queue_.addPkt(pkt);
   }
-  void addPktLocked(const TxPacket* pkt) {
-    queue_.addPktLocked(pkt);
-  }
   void finish();
 
   /*
    * Return the number of packets dropped.
    *
    * Packets will be dropped if the writer thread cannot write packets
-   * to disk as fast as they are being added.
+   * to disk as fast as they are being added, and maxBufferedPkts packets
+   * are buffered for a thread adding packets.
    */
   uint64_t numDropped() const {
     return queue_.numDropped();
@@ -78,7 +71,7 @@ class PcapWriter {
   void writeLoop();
 
   PcapFile file_;
-  PcapQueue queue_;
+  PcapRing queue_;
   std::exception_ptr ex_;
   std::thread thread_;
 };
@@ -9,7 +9,10 @@
  */
 #include "fboss/agent/capture/PktCapture.h"
 
+#include "fboss/agent/packet/Ethertype.h"
+
 #include <folly/Conv.h>
+#include <folly/io/Cursor.h>
 #include <folly/logging/xlog.h>
 #include <sstream>
 
@@ -17,6 +20,32 @@ using folly::StringPiece;
 
 namespace facebook::fboss {
 
+bool PacketFilter::etherTypePasses(const folly::IOBuf* buf) const {
+  if (etherTypes_.empty()) {
+    return true;
+  }
+  // Skip the dst and src mac, and look past a 802.1q tag if there is one
+  folly::io::Cursor cursor(buf);
+  uint16_t etherType;
+  if (!cursor.canAdvance(12)) {
+    return false;
+  }
+  cursor.skip(12);
+  if (!cursor.tryReadBE<uint16_t>(etherType)) {
+    return false;
+  }
+  if (etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN)) {
+    if (!cursor.canAdvance(2)) {
+      return false;
+    }
+    cursor.skip(2);
+    if (!cursor.tryReadBE<uint16_t>(etherType)) {
+      return false;
+    }
+  }
+  return etherTypes_.find(etherType) != etherTypes_.end();
+}
+
 PktCapture::PktCapture(
     folly::StringPiece name,
     uint64_t maxPackets,
@@ -28,14 +57,23 @@ PktCapture::PktCapture(
     uint64_t maxPackets,
     CaptureDirection direction,
     const CaptureFilter& captureFilter)
+    : PktCapture(name, maxPackets, direction, captureFilter, 0) {}
+
+PktCapture::PktCapture(
+    folly::StringPiece name,
+    uint64_t maxPackets,
+    CaptureDirection direction,
+    const CaptureFilter& captureFilter,
+    uint32_t snaplen)
     : name_(name.str()),
       maxPackets_(maxPackets),
       direction_(direction),
-      packetFilter_(captureFilter) {}
+      packetFilter_(captureFilter),
+      snaplen_(snaplen) {}
 
 void PktCapture::start(StringPiece path) {
   XLOG(INFO) << "starting packet capture " << toString();
-  writer_.start(path, true);
+  writer_.start(path, true, snaplen_);
 }
 
 void PktCapture::stop() {
@@ -43,23 +81,32 @@ void PktCapture::stop() {
   XLOG(INFO) << "Stopped packet capture " << toString(true);
 }
 
+bool PktCapture::reservePacket() {
+  return numPackets_.fetch_add(1, std::memory_order_relaxed) < maxPackets_;
+}
+
 bool PktCapture::packetReceived(const RxPacket* pkt) {
-  std::lock_guard<std::mutex> guard(writer_.mutex());
   if (direction_ != CaptureDirection::CAPTURE_ONLY_TX &&
-      true == packetFilter_.passes(pkt)) {
+      packetFilter_.passes(pkt)) {
+    if (!reservePacket()) {
+      return false;
+    }
     ++numPacketsReceived_;
-    writer_.addPktLocked(pkt);
+    writer_.addPkt(pkt);
   }
-  return (numPacketsSent_ + numPacketsReceived_) < maxPackets_;
+  return numPackets_.load(std::memory_order_relaxed) < maxPackets_;
 }
 
 bool PktCapture::packetSent(const TxPacket* pkt) {
-  std::lock_guard<std::mutex> guard(writer_.mutex());
-  if (direction_ != CaptureDirection::CAPTURE_ONLY_RX) {
+  if (direction_ != CaptureDirection::CAPTURE_ONLY_RX &&
+      packetFilter_.passes(pkt)) {
+    if (!reservePacket()) {
+      return false;
+    }
     ++numPacketsSent_;
-    writer_.addPktLocked(pkt);
+    writer_.addPkt(pkt);
   }
-  return (numPacketsSent_ + numPacketsReceived_) < maxPackets_;
+  return numPackets_.load(std::memory_order_relaxed) < maxPackets_;
 }
 
 std::string PktCapture::toString(bool withStats) const {
@@ -71,7 +118,8 @@ std::string PktCapture::toString(bool withStats) const {
                                                                   : "TX only"));
   if (withStats) {
     ss << ", Packet received:" << numPacketsReceived_
-       << ", Packet sent:" << numPacketsSent_;
+       << ", Packet sent:" << numPacketsSent_
+       << ", Packet dropped:" << numDropped();
   }
   return ss.str();
 }
@@ -14,6 +14,7 @@
 
 #include <boost/container/flat_set.hpp>
 #include <folly/Range.h>
+#include <atomic>
 #include <string>
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/TxPacket.h"
@@ -25,29 +26,50 @@ class RxPacketFilter {
   explicit RxPacketFilter(const RxCaptureFilter& rxCaptureFilter)
       : cosQueues_(
             rxCaptureFilter.get_cosQueues().begin(),
-            rxCaptureFilter.get_cosQueues().end()) {}
+            rxCaptureFilter.get_cosQueues().end()),
+        srcPorts_(
+            rxCaptureFilter.get_srcPorts().begin(),
+            rxCaptureFilter.get_srcPorts().end()) {}
   bool passes(const RxPacket* pkt) const {
     return (
-        cosQueues_.empty() ||
-        cosQueues_.find(static_cast<CpuCosQueueId>(pkt->cosQueue())) !=
-            cosQueues_.end());
+        (cosQueues_.empty() ||
+         cosQueues_.find(static_cast<CpuCosQueueId>(pkt->cosQueue())) !=
+             cosQueues_.end()) &&
+        (srcPorts_.empty() ||
+         srcPorts_.find(static_cast<int32_t>(pkt->getSrcPort())) !=
+             srcPorts_.end()));
   }
 
  private:
   boost::container::flat_set<CpuCosQueueId> cosQueues_;
+  boost::container::flat_set<int32_t> srcPorts_;
 };
 
+/*
+ * Filters are evaluated on the packet path before a packet is queued for
+ * writing, so that packets which are not captured cost as little as
+ * possible.
+ */
 class PacketFilter {
  public:
   explicit PacketFilter(const CaptureFilter& captureFilter)
-      : rxPacketFilter_(captureFilter.get_rxCaptureFilter()) {}
+      : rxPacketFilter_(captureFilter.get_rxCaptureFilter()),
+        etherTypes_(
+            captureFilter.get_etherTypes().begin(),
+            captureFilter.get_etherTypes().end()) {}
 
-  bool passes(const RxPacket* pkt) {
-    return rxPacketFilter_.passes(pkt);
+  bool passes(const RxPacket* pkt) const {
+    return rxPacketFilter_.passes(pkt) && etherTypePasses(pkt->buf());
+  }
+  bool passes(const TxPacket* pkt) const {
+    return etherTypePasses(pkt->buf());
   }
 
  private:
+  bool etherTypePasses(const folly::IOBuf* buf) const;
+
   RxPacketFilter rxPacketFilter_;
+  boost::container::flat_set<int32_t> etherTypes_;
 };
 
 /*
@@ -69,12 +91,32 @@ class PktCapture {
     return name_;
   }
 
+  PktCapture(
+      folly::StringPiece name,
+      uint64_t maxPackets,
+      CaptureDirection direction,
+      const CaptureFilter& captureFilter,
+      uint32_t snaplen);
+
   void start(folly::StringPiece path);
   void stop();
 
+  /*
+   * Capture a packet. Safe to call from any number of threads concurrently.
+   *
+   * Returns false once maxPackets packets have been captured.
+   */
   bool packetReceived(const RxPacket* pkt);
   bool packetSent(const TxPacket* pkt);
 
+  /*
+   * Packets matching the capture which were dropped because the writer
+   * could not keep up.
+   */
+  uint64_t numDropped() const {
+    return writer_.numDropped();
+  }
+
   std::string toString(bool withStats = false) const;
 
  private:
@@ -82,15 +124,18 @@ class PktCapture {
   PktCapture(PktCapture const&) = delete;
   PktCapture& operator=(PktCapture const&) = delete;
 
+  // Reserve a slot for one more packet, returns false if the capture is full
+  bool reservePacket();
+
   const std::string name_;
 
-  // Note: the rest of the state in this class is protcted by
-  // the PcapWriter's mutex.
   PcapWriter writer_;
   uint64_t maxPackets_{0};
-  uint64_t numPacketsReceived_{0};
-  uint64_t numPacketsSent_{0};
+  std::atomic<uint64_t> numPackets_{0};
+  std::atomic<uint64_t> numPacketsReceived_{0};
+  std::atomic<uint64_t> numPacketsSent_{0};
   CaptureDirection direction_{CaptureDirection::CAPTURE_TX_RX};
-  PacketFilter packetFilter_;
+  const PacketFilter packetFilter_;
+  uint32_t snaplen_{0};
 };
 } // namespace facebook::fboss
@@ -10,11 +10,11 @@
 #pragma once
 
 #include <folly/Range.h>
+#include <folly/SharedMutex.h>
 
 #include <atomic>
 #include <map>
 #include <memory>
-#include <mutex>
 #include <string>
 
 namespace facebook::fboss {
@@ -89,7 +89,11 @@ class PktCaptureManager {
 
   std::atomic<bool> capturesRunning_{false};
 
-  std::mutex mutex_;
+  /*
+   * Packets are handed to the active captures holding the lock in shared
+   * mode, so threads receiving or sending packets do not serialize on it.
+   */
+  folly::SharedMutexWritePriority mutex_;
   std::string captureDir_;
   std::map<std::string, std::unique_ptr<PktCapture>> activeCaptures_;
   std::map<std::string, std::unique_ptr<PktCapture>> inactiveCaptures_;
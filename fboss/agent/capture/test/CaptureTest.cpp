@@ -268,3 +268,38 @@ TEST(CaptureTest, FullCapture) {
   //
   // EXPECT_BUF_EQ(updatedIpPktData, pcapPkts.at(4).data);
 }
+
+TEST(CaptureTest, PacketFilter) {
+  // ARP request, with a 802.1q tag
+  auto arpPkt = MockRxPacket::fromHex(
+      // dst mac, src mac
+      "ff ff ff ff ff ff  02 05 00 00 01 02"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // ARP, htype: ethernet, ptype: IPv4, hlen: 6, plen: 4
+      "08 06  00 01  08 00  06  04");
+  arpPkt->setSrcPort(PortID(3));
+  // IPv4, untagged
+  auto ipPkt = MockRxPacket::fromHex(
+      // dst mac, src mac
+      "02 00 01 00 00 01  02 00 02 01 02 03"
+      // IPv4
+      "08 00"
+      // Version(4), IHL(5), DSCP(0), ECN(0), Total Length(20)
+      "45  00  00 14");
+  ipPkt->setSrcPort(PortID(1));
+
+  CaptureFilter arpOnly;
+  arpOnly.etherTypes = {0x0806};
+  EXPECT_TRUE(PacketFilter(arpOnly).passes(arpPkt.get()));
+  EXPECT_FALSE(PacketFilter(arpOnly).passes(ipPkt.get()));
+
+  CaptureFilter port1Only;
+  port1Only.rxCaptureFilter.srcPorts = {1};
+  EXPECT_FALSE(PacketFilter(port1Only).passes(arpPkt.get()));
+  EXPECT_TRUE(PacketFilter(port1Only).passes(ipPkt.get()));
+
+  // No criteria captures everything
+  EXPECT_TRUE(PacketFilter(CaptureFilter()).passes(arpPkt.get()));
+  EXPECT_TRUE(PacketFilter(CaptureFilter()).passes(ipPkt.get()));
+}
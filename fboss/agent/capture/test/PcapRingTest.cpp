@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/capture/PcapRing.h"
+#include "fboss/agent/capture/PcapPkt.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace facebook::fboss;
+
+namespace {
+
+std::unique_ptr<MockRxPacket> makePacket() {
+  auto pkt = MockRxPacket::fromHex(
+      // dst mac, src mac
+      "02 00 01 00 00 01  02 00 02 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00 00 01"
+      // IPv4
+      "08 00"
+      // Version(4), IHL(5), DSCP(0), ECN(0), Total Length(20)
+      "45  00  00 14"
+      // Identification(0), Flags(0), Fragment offset(0)
+      "00 00  00 00"
+      // TTL(31), Protocol(6), Checksum (0, fake)
+      "1F  06  00 00"
+      // Source IP (1.2.3.4)
+      "01 02 03 04"
+      // Destination IP (10.0.0.10)
+      "0a 00 00 0a");
+  pkt->padToLength(68);
+  pkt->setSrcPort(PortID(1));
+  pkt->setSrcVlan(VlanID(1));
+  return pkt;
+}
+
+void pktWaitThread(PcapRing* ring, std::vector<PcapPkt>* results) {
+  std::vector<PcapPkt> pkts;
+  while (ring->wait(&pkts)) {
+    for (PcapPkt& pkt : pkts) {
+      results->push_back(std::move(pkt));
+    }
+  }
+}
+
+} // unnamed namespace
+
+TEST(PcapRingTest, MultipleProducers) {
+  const int kThreads = 4;
+  const int kPktsPerThread = 1000;
+  PcapRing ring(kPktsPerThread);
+  std::vector<PcapPkt> waitedPkts;
+
+  std::thread waiter([&]() { pktWaitThread(&ring, &waitedPkts); });
+
+  auto pkt = makePacket();
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kThreads; ++i) {
+    producers.emplace_back([&]() {
+      for (int n = 0; n < kPktsPerThread; ++n) {
+        ring.addPkt(pkt.get());
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  ring.finish();
+  waiter.join();
+
+  // Each thread has its own ring, large enough for all of its packets
+  EXPECT_EQ(0, ring.numDropped());
+  ASSERT_EQ(kThreads * kPktsPerThread, waitedPkts.size());
+  for (const auto& waitedPkt : waitedPkts) {
+    EXPECT_TRUE(waitedPkt.isRx());
+    // The packet data is shared with the original packet, not copied
+    EXPECT_EQ(pkt->buf()->data(), waitedPkt.buf()->data());
+  }
+}
+
+TEST(PcapRingTest, Drop) {
+  PcapRing ring(2);
+  auto pkt = makePacket();
+  for (int n = 0; n < 5; ++n) {
+    ring.addPkt(pkt.get());
+  }
+  EXPECT_EQ(3, ring.numDropped());
+
+  ring.finish();
+  std::vector<PcapPkt> pkts;
+  EXPECT_TRUE(ring.wait(&pkts));
+  EXPECT_EQ(2, pkts.size());
+  EXPECT_FALSE(ring.wait(&pkts));
+}
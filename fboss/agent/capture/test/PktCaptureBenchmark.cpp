@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+/*
+ * Measure the overhead packet captures add to the rx path, by handling ARP
+ * requests with 0, 1 and 4 captures running.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+#include <folly/experimental/TestUtil.h>
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/capture/PktCapture.h"
+#include "fboss/agent/capture/PktCaptureManager.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/state/ArpResponseTable.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+
+#include <limits>
+
+DECLARE_string(persistent_state_dir);
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+using folly::IPAddressV4;
+using folly::MacAddress;
+using std::make_shared;
+using std::make_unique;
+using std::shared_ptr;
+using std::unique_ptr;
+
+namespace {
+
+unique_ptr<SwSwitch> sw;
+unique_ptr<MockRxPacket> arpRequest;
+
+unique_ptr<SwSwitch> setupSwitch() {
+  MacAddress localMac("02:00:01:00:00:01");
+  auto sw = make_unique<SwSwitch>(make_unique<SimPlatform>(localMac, 10));
+  sw->init(nullptr /* No custom TunManager */);
+
+  auto updateFn = [&](const shared_ptr<SwitchState>& oldState) {
+    auto state = oldState->clone();
+
+    auto vlan1 = make_shared<Vlan>(VlanID(1), "Vlan1");
+    state->addVlan(vlan1);
+    for (int idx = 1; idx < 10; ++idx) {
+      vlan1->addPort(PortID(idx), false);
+    }
+    auto intf1 = make_shared<Interface>(
+        InterfaceID(1),
+        RouterID(0),
+        VlanID(1),
+        "interface1",
+        localMac,
+        9000,
+        false, /* is virtual */
+        false /* is state_sync disabled*/);
+    Interface::Addresses addrs1;
+    addrs1.emplace(IPAddress("10.0.0.1"), 24);
+    intf1->setAddresses(addrs1);
+    state->addIntf(intf1);
+
+    auto respTable1 = make_shared<ArpResponseTable>();
+    respTable1->setEntry(IPAddressV4("10.0.0.1"), localMac, InterfaceID(1));
+    state->getVlans()->getVlan(VlanID(1))->setArpResponseTable(respTable1);
+    return state;
+  };
+
+  sw->updateStateBlocking("setup", updateFn);
+  return sw;
+}
+
+void init() {
+  sw = setupSwitch();
+
+  // ARP request for 10.0.0.1
+  arpRequest = MockRxPacket::fromHex(
+      // dst mac, src mac
+      "ff ff ff ff ff ff  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // ARP, htype: ethernet, ptype: IPv4, hlen: 6, plen: 4
+      "08 06  00 01  08 00  06  04"
+      // ARP Request
+      "00 01"
+      // Sender MAC
+      "00 02 00 01 02 03"
+      // Sender IP: 10.0.0.15
+      "0a 00 00 0f"
+      // Target MAC
+      "00 00 00 00 00 00"
+      // Target IP: 10.0.0.1
+      "0a 00 00 01");
+  arpRequest->padToLength(68);
+  arpRequest->setSrcPort(PortID(1));
+  arpRequest->setSrcVlan(VlanID(1));
+}
+
+void rxWithCaptures(size_t numIters, int numCaptures) {
+  auto* mgr = sw->getCaptureMgr();
+  BENCHMARK_SUSPEND {
+    for (int i = 0; i < numCaptures; ++i) {
+      mgr->startCapture(make_unique<PktCapture>(
+          folly::to<std::string>("bench", i),
+          std::numeric_limits<uint32_t>::max(),
+          CaptureDirection::CAPTURE_TX_RX));
+    }
+  }
+
+  for (size_t n = 0; n < numIters; ++n) {
+    sw->packetReceived(arpRequest->clone());
+  }
+
+  BENCHMARK_SUSPEND {
+    for (int i = 0; i < numCaptures; ++i) {
+      mgr->forgetCapture(folly::to<std::string>("bench", i));
+    }
+  }
+}
+
+} // unnamed namespace
+
+BENCHMARK(RxNoCapture, numIters) {
+  rxWithCaptures(numIters, 0);
+}
+
+BENCHMARK_RELATIVE(RxOneCapture, numIters) {
+  rxWithCaptures(numIters, 1);
+}
+
+BENCHMARK_RELATIVE(RxFourCaptures, numIters) {
+  rxWithCaptures(numIters, 4);
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  // Captures are written under the persistent state dir
+  folly::test::TemporaryDirectory tmpDir;
+  FLAGS_persistent_state_dir = tmpDir.path().string();
+
+  init();
+  folly::runBenchmarks();
+  sw.reset();
+  return 0;
+}
@@ -9,6 +9,7 @@
  */
 #include "fboss/agent/hw/bcm/BcmPort.h"
 
+#include <atomic>
 #include <chrono>
 #include <map>
 
@@ -48,6 +49,12 @@ using std::chrono::system_clock;
 
 using facebook::stats::MonotonicCounter;
 
+DEFINE_bool(
+    bulk_port_stats,
+    false,
+    "Read all counters of a port with a single SDK call when collecting "
+    "port stats, instead of one call per counter");
+
 namespace {
 
 bool hasPortQueueChanges(
@@ -96,6 +103,52 @@ static const std::vector<opennsl_stat_val_t> kOutPktLengthStats = {
     snmpOpenNSLTransmittedPkts9217to16383Octets,
 };
 
+/*
+ * The port counters collected every stats cycle, and where they are stored
+ * in HwPortStats.
+ */
+struct PortStat {
+  folly::StringPiece key;
+  opennsl_stat_val_t type;
+  int64_t HwPortStats::*field;
+};
+static const std::vector<PortStat> kPortStats = {
+    {kInBytes(), opennsl_spl_snmpIfHCInOctets, &HwPortStats::inBytes_},
+    {kInUnicastPkts(),
+     opennsl_spl_snmpIfHCInUcastPkts,
+     &HwPortStats::inUnicastPkts_},
+    {kInMulticastPkts(),
+     opennsl_spl_snmpIfHCInMulticastPkts,
+     &HwPortStats::inMulticastPkts_},
+    {kInBroadcastPkts(),
+     opennsl_spl_snmpIfHCInBroadcastPkts,
+     &HwPortStats::inBroadcastPkts_},
+    {kInDiscardsRaw(),
+     opennsl_spl_snmpIfInDiscards,
+     &HwPortStats::inDiscardsRaw_},
+    {kInErrors(), opennsl_spl_snmpIfInErrors, &HwPortStats::inErrors_},
+    {kInIpv4HdrErrors(),
+     opennsl_spl_snmpIpInHdrErrors,
+     &HwPortStats::inIpv4HdrErrors_},
+    {kInIpv6HdrErrors(),
+     opennsl_spl_snmpIpv6IfStatsInHdrErrors,
+     &HwPortStats::inIpv6HdrErrors_},
+    {kInPause(), opennsl_spl_snmpDot3InPauseFrames, &HwPortStats::inPause_},
+    {kOutBytes(), opennsl_spl_snmpIfHCOutOctets, &HwPortStats::outBytes_},
+    {kOutUnicastPkts(),
+     opennsl_spl_snmpIfHCOutUcastPkts,
+     &HwPortStats::outUnicastPkts_},
+    {kOutMulticastPkts(),
+     opennsl_spl_snmpIfHCOutMulticastPkts,
+     &HwPortStats::outMulticastPkts_},
+    {kOutBroadcastPkts(),
+     opennsl_spl_snmpIfHCOutBroadcastPckts,
+     &HwPortStats::outBroadcastPkts_},
+    {kOutDiscards(), opennsl_spl_snmpIfOutDiscards, &HwPortStats::outDiscards_},
+    {kOutErrors(), opennsl_spl_snmpIfOutErrors, &HwPortStats::outErrors_},
+    {kOutPause(), opennsl_spl_snmpDot3OutPauseFrames, &HwPortStats::outPause_},
+};
+
 MonotonicCounter* BcmPort::getPortCounterIf(folly::StringPiece statKey) {
   auto pcitr = portCounters_.find(statKey.str());
   return pcitr != portCounters_.end() ? &pcitr->second : nullptr;
@@ -161,11 +214,8 @@ void BcmPort::reinitPortStats(const std::shared_ptr<Port>& swPort) {
   outPktLengths_ = histMap->getOrCreateLockableHistogram(
       statName("out_pkt_lengths", portName), &pktLenHist);
 
-  {
-    auto lockedPortStatsPtr = lastPortStats_.wlock();
-    *lockedPortStatsPtr =
-        BcmPortStats(queueManager_->getNumQueues(cfg::StreamType::UNICAST));
-  }
+  publishPortStats(
+      BcmPortStats(queueManager_->getNumQueues(cfg::StreamType::UNICAST)));
 }
 
 BcmPort::BcmPort(
@@ -669,11 +719,8 @@ void BcmPort::updateStats() {
   auto now = duration_cast<seconds>(system_clock::now().time_since_epoch());
 
   HwPortStats curPortStats, lastPortStats;
-  {
-    auto lockedPortStats = lastPortStats_.rlock();
-    if (lockedPortStats->has_value()) {
-      lastPortStats = curPortStats = (*lockedPortStats)->portStats();
-    }
+  if (auto lastStats = lastPortStats_.load()) {
+    lastPortStats = curPortStats = lastStats->portStats();
   }
 
   // All stats start with a unitialized (-1) value. If there are no in discards
@@ -683,75 +730,15 @@ void BcmPort::updateStats() {
       curPortStats.inDiscards_ == hardware_stats_constants::STAT_UNINITIALIZED()
       ? 0
       : curPortStats.inDiscards_;
-  updateStat(
-      now, kInBytes(), opennsl_spl_snmpIfHCInOctets, &curPortStats.inBytes_);
-  updateStat(
-      now,
-      kInUnicastPkts(),
-      opennsl_spl_snmpIfHCInUcastPkts,
-      &curPortStats.inUnicastPkts_);
-  updateStat(
-      now,
-      kInMulticastPkts(),
-      opennsl_spl_snmpIfHCInMulticastPkts,
-      &curPortStats.inMulticastPkts_);
-  updateStat(
-      now,
-      kInBroadcastPkts(),
-      opennsl_spl_snmpIfHCInBroadcastPkts,
-      &curPortStats.inBroadcastPkts_);
-  updateStat(
-      now,
-      kInDiscardsRaw(),
-      opennsl_spl_snmpIfInDiscards,
-      &curPortStats.inDiscardsRaw_);
-  updateStat(
-      now, kInErrors(), opennsl_spl_snmpIfInErrors, &curPortStats.inErrors_);
-  updateStat(
-      now,
-      kInIpv4HdrErrors(),
-      opennsl_spl_snmpIpInHdrErrors,
-      &curPortStats.inIpv4HdrErrors_);
-  updateStat(
-      now,
-      kInIpv6HdrErrors(),
-      opennsl_spl_snmpIpv6IfStatsInHdrErrors,
-      &curPortStats.inIpv6HdrErrors_);
-  updateStat(
-      now,
-      kInPause(),
-      opennsl_spl_snmpDot3InPauseFrames,
-      &curPortStats.inPause_);
-  // Egress Stats
-  updateStat(
-      now, kOutBytes(), opennsl_spl_snmpIfHCOutOctets, &curPortStats.outBytes_);
-  updateStat(
-      now,
-      kOutUnicastPkts(),
-      opennsl_spl_snmpIfHCOutUcastPkts,
-      &curPortStats.outUnicastPkts_);
-  updateStat(
-      now,
-      kOutMulticastPkts(),
-      opennsl_spl_snmpIfHCOutMulticastPkts,
-      &curPortStats.outMulticastPkts_);
-  updateStat(
-      now,
-      kOutBroadcastPkts(),
-      opennsl_spl_snmpIfHCOutBroadcastPckts,
-      &curPortStats.outBroadcastPkts_);
-  updateStat(
-      now,
-      kOutDiscards(),
-      opennsl_spl_snmpIfOutDiscards,
-      &curPortStats.outDiscards_);
-  updateStat(
-      now, kOutErrors(), opennsl_spl_snmpIfOutErrors, &curPortStats.outErrors_);
-  updateStat(
-      now,
-      kOutPause(),
-      opennsl_spl_snmpDot3OutPauseFrames,
-      &curPortStats.outPause_);
+  bool bulk = FLAGS_bulk_port_stats;
+  if (bulk) {
+    updateStatsBulk(now, &curPortStats);
+  } else {
+    for (const auto& portStat : kPortStats) {
+      updateStat(
+          now, portStat.key, portStat.type, &(curPortStats.*portStat.field));
+    }
+  }
 
   updateBcmStats(now, &curPortStats);
 
@@ -775,10 +762,7 @@ void BcmPort::updateStats() {
   auto inDiscards = getPortCounterIf(kInDiscards());
   inDiscards->updateValue(now, curPortStats.inDiscards_);
 
-  {
-    auto lockedLastPortStatsPtr = lastPortStats_.wlock();
-    *lockedLastPortStatsPtr = BcmPortStats(curPortStats, now);
-  }
+  publishPortStats(BcmPortStats(std::move(curPortStats), now));
 
   // Update the queue length stat
   uint32_t qlength;
@@ -794,9 +778,12 @@ void BcmPort::updateStats() {
     // or a dynamic counter for this.
   }
 
-  // Update the packet length histograms
-  updatePktLenHist(now, &inPktLengths_, kInPktLengthStats);
-  updatePktLenHist(now, &outPktLengths_, kOutPktLengthStats);
+  // Update the packet length histograms. In bulk mode these were read along
+  // with the other port counters.
+  if (!bulk) {
+    updatePktLenHist(now, &inPktLengths_, kInPktLengthStats);
+    updatePktLenHist(now, &outPktLengths_, kOutPktLengthStats);
+  }
 
   // Update any platform specific port counters
   getPlatformPort()->updateStats();
@@ -822,6 +809,47 @@ void BcmPort::updateStat(
   *statVal = value;
 }
 
+void BcmPort::updateStatsBulk(
+    std::chrono::seconds now,
+    HwPortStats* curPortStats) {
+  // Read the port counters and both packet length histograms in one call
+  static const std::vector<opennsl_stat_val_t> kBulkStats = [] {
+    std::vector<opennsl_stat_val_t> stats;
+    for (const auto& portStat : kPortStats) {
+      stats.push_back(portStat.type);
+    }
+    stats.insert(
+        stats.end(), kInPktLengthStats.begin(), kInPktLengthStats.end());
+    stats.insert(
+        stats.end(), kOutPktLengthStats.begin(), kOutPktLengthStats.end());
+    return stats;
+  }();
+  std::vector<uint64_t> counters(kBulkStats.size());
+  // opennsl_stat_multi_get() unfortunately doesn't correctly const qualify
+  // it's stats arguments right now.
+  auto ret = opennsl_stat_multi_get(
+      unit_,
+      port_,
+      kBulkStats.size(),
+      const_cast<opennsl_stat_val_t*>(kBulkStats.data()),
+      counters.data());
+  if (OPENNSL_FAILURE(ret)) {
+    XLOG(ERR) << "Failed to get stats for port " << port_ << " :"
+              << opennsl_errmsg(ret);
+    return;
+  }
+
+  auto counter = counters.begin();
+  for (const auto& portStat : kPortStats) {
+    getPortCounterIf(portStat.key)->updateValue(now, *counter);
+    curPortStats->*portStat.field = *counter;
+    ++counter;
+  }
+  addPktLenHist(now, &inPktLengths_, &*counter, kInPktLengthStats.size());
+  counter += kInPktLengthStats.size();
+  addPktLenHist(now, &outPktLengths_, &*counter, kOutPktLengthStats.size());
+}
+
 bool BcmPort::isMmuLossy() const {
   return hw_->getMmuState() == BcmSwitch::MmuState::MMU_LOSSY;
 }
@@ -844,9 +872,16 @@ void BcmPort::updatePktLenHist(
     return;
   }
 
-  // Update the histogram
+  addPktLenHist(now, hist, counters, stats.size());
+}
+
+void BcmPort::addPktLenHist(
+    std::chrono::seconds now,
+    fb303::ExportedHistogramMapImpl::LockableHistogram* hist,
+    const uint64_t* counters,
+    size_t numCounters) {
   auto guard = hist->makeLockGuard();
-  for (int idx = 0; idx < stats.size(); ++idx) {
+  for (int idx = 0; idx < numCounters; ++idx) {
     hist->addValueLocked(guard, now.count(), idx, counters[idx]);
   }
 }
@@ -865,7 +900,7 @@ BcmPort::BcmPortStats::BcmPortStats(
     HwPortStats portStats,
     std::chrono::seconds timeRetrieved)
     : BcmPortStats() {
-  portStats_ = portStats;
+  portStats_ = std::move(portStats);
   timeRetrieved_ = timeRetrieved;
 }
 
@@ -878,19 +913,34 @@ std::chrono::seconds BcmPort::BcmPortStats::timeRetrieved() const {
 }
 
 std::optional<HwPortStats> BcmPort::getPortStats() const {
-  auto bcmStats = lastPortStats_.rlock();
-  if (!bcmStats->has_value()) {
+  auto bcmStats = lastPortStats_.load();
+  if (!bcmStats) {
     return std::nullopt;
   }
-  return (*bcmStats)->portStats();
+  return bcmStats->portStats();
 }
 
 std::chrono::seconds BcmPort::getTimeRetrieved() const {
-  auto bcmStats = lastPortStats_.rlock();
-  if (!bcmStats->has_value()) {
+  auto bcmStats = lastPortStats_.load();
+  if (!bcmStats) {
     return std::chrono::seconds(0);
   }
-  return (*bcmStats)->timeRetrieved();
+  return bcmStats->timeRetrieved();
+}
+
+void BcmPort::publishPortStats(BcmPortStats&& stats) {
+  std::lock_guard<std::mutex> guard(spareStatsLock_);
+  // Reuse the previous snapshot's buffer once no reader holds it any more,
+  // so that steady state collection does not allocate.
+  if (spareStats_ && spareStats_.use_count() == 1) {
+    // Pairs with the release of the last reader's reference
+    std::atomic_thread_fence(std::memory_order_acquire);
+    *spareStats_ = std::move(stats);
+  } else {
+    spareStats_ = std::make_shared<BcmPortStats>(std::move(stats));
+  }
+  auto previous = lastPortStats_.exchange(std::move(spareStats_));
+  spareStats_ = std::const_pointer_cast<BcmPortStats>(std::move(previous));
 }
 
 void BcmPort::applyMirrorAction(
@@ -942,10 +992,9 @@ void BcmPort::destroyAllPortStats() {
   }
   queueManager_->destroyQueueCounters();
 
-  {
-    auto lockedPortStatsPtr = lastPortStats_.wlock();
-    *lockedPortStatsPtr = std::nullopt;
-  }
+  std::lock_guard<std::mutex> guard(spareStatsLock_);
+  lastPortStats_.store(nullptr);
+  spareStats_.reset();
 }
 
 void BcmPort::enableStatCollection(const std::shared_ptr<Port>& port) {
@@ -27,6 +27,7 @@ extern "C" {
 
 #include <folly/Range.h>
 #include <folly/Synchronized.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
 #include <mutex>
 #include <utility>
 
@@ -180,9 +181,8 @@ class BcmPort {
 
  private:
   class BcmPortStats {
-    // All actions or instantiations of this class need to be done in a
-    // thread-safe way (for example, the way that locking is done on
-    // lastPortStats_) - the class itself does not guarantee this on it's own
+    // Published snapshots are immutable, see lastPortStats_ - the class
+    // itself does not guarantee thread safety on it's own
    public:
     BcmPortStats() {
       portStats_.inDiscards_ = 0;
@@ -213,11 +213,22 @@ class BcmPort {
       folly::StringPiece statName,
       opennsl_stat_val_t type,
       int64_t* portStatVal);
+  /*
+   * Read all port counters, including the packet length histograms, with a
+   * single SDK call.
+   */
+  void updateStatsBulk(std::chrono::seconds now, HwPortStats* curPortStats);
   void updateBcmStats(std::chrono::seconds now, HwPortStats* curPortStats);
   void updatePktLenHist(
       std::chrono::seconds now,
       fb303::ExportedHistogramMapImpl::LockableHistogram* hist,
       const std::vector<opennsl_stat_val_t>& stats);
+  void addPktLenHist(
+      std::chrono::seconds now,
+      fb303::ExportedHistogramMapImpl::LockableHistogram* hist,
+      const uint64_t* counters,
+      size_t numCounters);
+  void publishPortStats(BcmPortStats&& stats);
   void initCustomStats() const;
   // Set stats that are either FB specific, not available in
   // open source opennsl release.
@@ -276,7 +287,14 @@ class BcmPort {
   fb303::ExportedHistogramMapImpl::LockableHistogram inPktLengths_;
   fb303::ExportedHistogramMapImpl::LockableHistogram outPktLengths_;
 
-  folly::Synchronized<std::optional<BcmPortStats>> lastPortStats_;
+  // The last collected stats. Readers load the snapshot without locking,
+  // while the stats thread fills the spare buffer and swaps the two.
+  folly::atomic_shared_ptr<const BcmPortStats> lastPortStats_;
+  // Publishing also happens on the update thread when stats are
+  // (re)initialized or destroyed, so the spare buffer and the swap are
+  // guarded by spareStatsLock_.
+  std::mutex spareStatsLock_;
+  std::shared_ptr<BcmPortStats> spareStats_;
   folly::Synchronized<std::shared_ptr<Port>> programmedSettings_;
 
   std::atomic<bool> statCollectionEnabled_{false};
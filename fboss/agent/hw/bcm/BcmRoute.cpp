@@ -16,6 +16,7 @@ extern "C" {
 #include <folly/IPAddress.h>
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
+#include <folly/hash/Hash.h>
 #include <folly/logging/xlog.h>
 #include "fboss/agent/Constants.h"
 #include "fboss/agent/hw/bcm/BcmError.h"
@@ -270,18 +271,24 @@ BcmRoute::~BcmRoute() {
   }
 }
 
-bool BcmRouteTable::Key::operator<(const Key& k2) const {
-  if (vrf < k2.vrf) {
-    return true;
-  } else if (vrf > k2.vrf) {
-    return false;
-  }
-  if (mask < k2.mask) {
-    return true;
-  } else if (mask > k2.mask) {
-    return false;
-  }
-  return network < k2.network;
+BcmRouteTable::Key::Key(
+    opennsl_vrf_t vrf,
+    const folly::IPAddress& network,
+    uint8_t mask)
+    : vrf(vrf), mask(mask), v6(network.isV6()) {
+  memcpy(addr.data(), network.bytes(), network.byteCount());
+}
+
+bool BcmRouteTable::Key::operator==(const Key& k2) const {
+  return vrf == k2.vrf && mask == k2.mask && v6 == k2.v6 && addr == k2.addr;
+}
+
+size_t BcmRouteTable::KeyHash::operator()(const Key& key) const {
+  uint64_t hi;
+  uint64_t lo;
+  memcpy(&hi, key.addr.data(), sizeof(hi));
+  memcpy(&lo, key.addr.data() + sizeof(hi), sizeof(lo));
+  return folly::hash::hash_combine(hi, lo, key.vrf, key.mask, key.v6);
 }
 
 BcmRouteTable::BcmRouteTable(BcmSwitch* hw) : hw_(hw) {}
@@ -292,7 +299,7 @@ BcmRoute* BcmRouteTable::getBcmRouteIf(
     opennsl_vrf_t vrf,
     const folly::IPAddress& network,
     uint8_t mask) const {
-  Key key{network, mask, vrf};
+  Key key(vrf, network, mask);
   auto iter = fib_.find(key);
   if (iter == fib_.end()) {
     return nullptr;
@@ -321,7 +328,7 @@ template <typename RouteT>
 void BcmRouteTable::addRoute(opennsl_vrf_t vrf, const RouteT* route) {
   const auto& prefix = route->prefix();
 
-  Key key{folly::IPAddress(prefix.network), prefix.mask, vrf};
+  Key key(vrf, folly::IPAddress(prefix.network), prefix.mask);
   auto ret = fib_.emplace(key, nullptr);
   if (ret.second) {
     SCOPE_FAIL {
@@ -341,7 +348,7 @@ void BcmRouteTable::addRoute(opennsl_vrf_t vrf, const RouteT* route) {
 template <typename RouteT>
 void BcmRouteTable::deleteRoute(opennsl_vrf_t vrf, const RouteT* route) {
   const auto& prefix = route->prefix();
-  Key key{folly::IPAddress(prefix.network), prefix.mask, vrf};
+  Key key(vrf, folly::IPAddress(prefix.network), prefix.mask);
   auto iter = fib_.find(key);
   if (iter == fib_.end()) {
     throw FbossError("Failed to delete a non-existing route ", route->str());
@@ -349,9 +356,40 @@ void BcmRouteTable::deleteRoute(opennsl_vrf_t vrf, const RouteT* route) {
   fib_.erase(iter);
 }
 
+template <typename RouteT>
+void BcmRouteTable::addRoutes(
+    opennsl_vrf_t vrf,
+    const std::vector<std::shared_ptr<RouteT>>& routes) {
+  fib_.reserve(fib_.size() + routes.size());
+  for (const auto& route : routes) {
+    addRoute(vrf, route.get());
+  }
+}
+
+template <typename RouteT>
+void BcmRouteTable::deleteRoutes(
+    opennsl_vrf_t vrf,
+    const std::vector<std::shared_ptr<RouteT>>& routes) {
+  for (const auto& route : routes) {
+    deleteRoute(vrf, route.get());
+  }
+}
+
 template void BcmRouteTable::addRoute(opennsl_vrf_t, const RouteV4*);
 template void BcmRouteTable::addRoute(opennsl_vrf_t, const RouteV6*);
 template void BcmRouteTable::deleteRoute(opennsl_vrf_t, const RouteV4*);
 template void BcmRouteTable::deleteRoute(opennsl_vrf_t, const RouteV6*);
+template void BcmRouteTable::addRoutes(
+    opennsl_vrf_t,
+    const std::vector<std::shared_ptr<RouteV4>>&);
+template void BcmRouteTable::addRoutes(
+    opennsl_vrf_t,
+    const std::vector<std::shared_ptr<RouteV6>>&);
+template void BcmRouteTable::deleteRoutes(
+    opennsl_vrf_t,
+    const std::vector<std::shared_ptr<RouteV4>>&);
+template void BcmRouteTable::deleteRoutes(
+    opennsl_vrf_t,
+    const std::vector<std::shared_ptr<RouteV6>>&);
 
 } // namespace facebook::fboss
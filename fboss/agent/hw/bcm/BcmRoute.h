@@ -20,7 +20,11 @@ extern "C" {
 #include "fboss/agent/state/RouteNextHopEntry.h"
 #include "fboss/agent/types.h"
 
-#include <boost/container/flat_map.hpp>
+#include <folly/container/F14Map.h>
+
+#include <array>
+#include <memory>
+#include <vector>
 
 namespace facebook::fboss {
 
@@ -113,17 +117,46 @@ class BcmRouteTable {
   template <typename RouteT>
   void deleteRoute(opennsl_vrf_t vrf, const RouteT* route);
 
+  /*
+   * Add (or update) or delete all the routes of a route delta at once. The
+   * table is grown once for the whole batch instead of rehashing while the
+   * routes are added.
+   */
+  template <typename RouteT>
+  void addRoutes(
+      opennsl_vrf_t vrf,
+      const std::vector<std::shared_ptr<RouteT>>& routes);
+  template <typename RouteT>
+  void deleteRoutes(
+      opennsl_vrf_t vrf,
+      const std::vector<std::shared_ptr<RouteT>>& routes);
+
+  size_t size() const {
+    return fib_.size();
+  }
+
  private:
+  /*
+   * The prefix is packed into a fixed size byte array, so that keys hash and
+   * compare without going through folly::IPAddress.
+   */
   struct Key {
-    folly::IPAddress network;
-    uint8_t mask;
+    Key(opennsl_vrf_t vrf, const folly::IPAddress& network, uint8_t mask);
+
+    std::array<uint8_t, 16> addr{};
     opennsl_vrf_t vrf;
-    bool operator<(const Key& k2) const;
+    uint8_t mask;
+    bool v6;
+    bool operator==(const Key& k2) const;
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
   };
 
   BcmSwitch* hw_;
 
-  boost::container::flat_map<Key, std::unique_ptr<BcmRoute>> fib_;
+  // Lookups, adds and deletes are O(1) regardless of the table size
+  folly::F14FastMap<Key, std::unique_ptr<BcmRoute>, KeyHash> fib_;
 };
 
 } // namespace facebook::fboss
@@ -9,23 +9,53 @@
  */
 #include "BcmSflowExporter.h"
 
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include <iostream>
 #include <vector>
 
 #include <fcntl.h>
 #include <ifaddrs.h>
+#include <sys/socket.h>
 
+#include <fb303/ThreadCachedServiceData.h>
 #include <folly/Range.h>
+#include <folly/ScopeGuard.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <optional>
 
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/hw/bcm/BcmPort.h"
+#include "fboss/agent/hw/bcm/BcmPortTable.h"
 
 using namespace std;
+using facebook::fb303::AVG;
+using facebook::fb303::SUM;
+
+DEFINE_bool(
+    sflow_v5_export,
+    false,
+    "Export sampled packets to sFlow collectors as sFlow v5 datagrams, "
+    "many samples to a datagram, rather than one SflowPacketInfo each");
+DEFINE_int32(
+    sflow_v5_max_datagram_size,
+    1400,
+    "Maximum size of the sFlow v5 datagrams sent to collectors");
+DEFINE_int32(
+    sflow_v5_flush_interval_ms,
+    100,
+    "Longest time an sFlow v5 sample is held back to share its datagram "
+    "with the samples that follow it");
+DEFINE_int32(
+    sflow_v5_counter_interval_s,
+    20,
+    "Interval at which sFlow v5 interface counter samples are exported for "
+    "the ports with sampling enabled");
 
 namespace {
 std::optional<folly::IPAddress> getLocalIPv6FromWhoAmI() {
@@ -107,64 +137,135 @@ folly::IPAddress getLocalIPv6() {
 
 namespace facebook::fboss {
 
-BcmSflowExporter::BcmSflowExporter(const folly::SocketAddress& address)
-    : address_(address) {
-  SCOPE_FAIL {
-    close(socket_);
-  };
+namespace {
+
+// Longest packet header we put in a flow sample
+constexpr uint32_t kMaxSampledHeaderSize = 128;
+// ifType of an ethernet interface, see RFC 2863
+constexpr uint32_t kIfTypeEthernet = 6;
+constexpr uint32_t kIfDirectionFullDuplex = 1;
+
+const std::string kDatagrams = "sflow.datagrams";
+const std::string kFlowSamples = "sflow.flow_samples";
+const std::string kCounterSamples = "sflow.counter_samples";
+const std::string kSamplesPerDatagram = "sflow.samples_per_datagram";
+const std::string kDroppedSamples = "sflow.dropped_samples";
+const std::string kSendErrors = "sflow.send_errors";
+
+/*
+ * Create a non-blocking UDP socket for sending to addresses of family. An
+ * AF_INET6 socket can be made dual stack, to also send to IPv4 addresses
+ * in their v4-mapped form.
+ */
+int createUDPSocket(sa_family_t family, bool dualStack = false) {
+  // bind the socket to any address.
+  folly::SocketAddress localAddr;
+
+  switch (family) {
+    case AF_INET6:
+      localAddr = folly::SocketAddress("::", 0);
+      break;
+    case AF_INET:
+      localAddr = folly::SocketAddress("0.0.0.0", 0);
+      break;
+    default:
+      throw FbossError("Unsupported address family for exporter target");
+  }
 
-  socket_ = ::socket(address_.getFamily(), SOCK_DGRAM, IPPROTO_UDP);
+  int sock = ::socket(family, SOCK_DGRAM, IPPROTO_UDP);
 
-  if (socket_ == -1) {
+  if (sock == -1) {
     throw FbossError("Error creating UDP socket: ", folly::errnoStr(errno));
   }
 
+  SCOPE_FAIL {
+    close(sock);
+  };
+
   // put the socket in non-blocking mode
-  if (fcntl(socket_, F_SETFL, O_NONBLOCK) != 0) {
+  if (fcntl(sock, F_SETFL, O_NONBLOCK) != 0) {
     throw FbossError(
         "Failed to put socket in non-blocking mode: ", folly::errnoStr(errno));
   }
 
   // put the socket in reuse mode
   int val = 1;
-  if (setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val)) != 0) {
+  if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val)) != 0) {
     throw FbossError(
         "Failed to put socket in reuse_addr mode: ", folly::errnoStr(errno));
   }
 
   // put the socket in port reuse mode
   val = 1;
-  if (setsockopt(socket_, SOL_SOCKET, SO_REUSEPORT, &val, sizeof(val)) != 0) {
+  if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &val, sizeof(val)) != 0) {
     throw FbossError(
         "Failed to put socket in reuse_port mode: ", folly::errnoStr(errno));
   }
 
-  // bind the socket.
-  folly::SocketAddress localAddr;
-
-  switch (address.getFamily()) {
-    case AF_INET6:
-      localAddr = folly::SocketAddress("::", 0);
-      break;
-    case AF_INET:
-      localAddr = folly::SocketAddress("0.0.0.0", 0);
-      break;
-    default:
-      throw FbossError("Unsupported address family for exporter target");
+  if (dualStack) {
+    val = 0;
+    if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &val, sizeof(val)) != 0) {
+      throw FbossError(
+          "Failed to put socket in dual stack mode: ", folly::errnoStr(errno));
+    }
   }
 
   sockaddr_storage addrStorage;
   localAddr.getAddress(&addrStorage);
   sockaddr* saddr = reinterpret_cast<sockaddr*>(&addrStorage);
-  if (bind(socket_, saddr, localAddr.getActualSize()) != 0) {
+  if (bind(sock, saddr, localAddr.getActualSize()) != 0) {
     throw FbossError(
-        "Failed to bind the async udp socket for ",
-        address_.describe(),
+        "Failed to bind the async udp socket to ",
+        localAddr.describe(),
         ": ",
         folly::errnoStr(errno));
   }
+  return sock;
+}
+
+// Stats we have not read yet are -1
+uint32_t toCounter32(int64_t stat) {
+  return stat < 0 ? 0 : static_cast<uint32_t>(stat);
+}
+
+uint64_t toCounter64(int64_t stat) {
+  return stat < 0 ? 0 : stat;
+}
+
+std::optional<sflow::IfCounters> getIfCounters(BcmPort* bcmPort) {
+  auto stats = bcmPort->getPortStats();
+  if (!stats) {
+    return std::nullopt;
+  }
+  sflow::IfCounters counters{};
+  counters.ifIndex = bcmPort->getPortID();
+  counters.ifType = kIfTypeEthernet;
+  // Port speeds are in Mbps
+  counters.ifSpeed = static_cast<uint64_t>(bcmPort->getSpeed()) * 1000000;
+  counters.ifDirection = kIfDirectionFullDuplex;
+  // Bit 0 is the admin status and bit 1 the operational status
+  counters.ifStatus =
+      (bcmPort->isEnabled() ? 0x1 : 0) | (bcmPort->isUp() ? 0x2 : 0);
+  counters.ifInOctets = toCounter64(stats->inBytes_);
+  counters.ifInUcastPkts = toCounter32(stats->inUnicastPkts_);
+  counters.ifInMulticastPkts = toCounter32(stats->inMulticastPkts_);
+  counters.ifInBroadcastPkts = toCounter32(stats->inBroadcastPkts_);
+  counters.ifInDiscards = toCounter32(stats->inDiscards_);
+  counters.ifInErrors = toCounter32(stats->inErrors_);
+  counters.ifOutOctets = toCounter64(stats->outBytes_);
+  counters.ifOutUcastPkts = toCounter32(stats->outUnicastPkts_);
+  counters.ifOutMulticastPkts = toCounter32(stats->outMulticastPkts_);
+  counters.ifOutBroadcastPkts = toCounter32(stats->outBroadcastPkts_);
+  counters.ifOutDiscards = toCounter32(stats->outDiscards_);
+  counters.ifOutErrors = toCounter32(stats->outErrors_);
+  return counters;
 }
 
+} // namespace
+
+BcmSflowExporter::BcmSflowExporter(const folly::SocketAddress& address)
+    : address_(address), socket_(createUDPSocket(address.getFamily())) {}
+
 ssize_t BcmSflowExporter::sendUDPDatagram(iovec* vec, const size_t iovec_len) {
   XLOG(DBG4) << "Sending an sFlow packet to " << address_.describe();
 
@@ -195,19 +296,40 @@ BcmSflowExporter::~BcmSflowExporter() {
   }
 }
 
+BcmSflowExporterTable::BcmSflowExporterTable() {
+  if (!FLAGS_sflow_v5_export) {
+    return;
+  }
+  try {
+    socket_ = createUDPSocket(AF_INET6, true /* dualStack */);
+  } catch (const fboss::thrift::FbossBaseError& ex) {
+    XLOG(ERR) << "Could not create socket for sFlow v5 export, reason: "
+              << folly::exceptionStr(ex);
+  }
+}
+
+BcmSflowExporterTable::~BcmSflowExporterTable() {
+  if (socket_ != -1) {
+    close(socket_);
+  }
+}
+
 bool BcmSflowExporterTable::contains(
     const shared_ptr<SflowCollector>& c) const {
+  std::lock_guard<std::mutex> guard(lock_);
   auto iter = map_.find(c->getID());
   return iter != map_.end();
 }
 
 size_t BcmSflowExporterTable::size() const {
+  std::lock_guard<std::mutex> guard(lock_);
   return map_.size();
 }
 
 void BcmSflowExporterTable::addExporter(const shared_ptr<SflowCollector>& c) {
   try {
     auto exporter = make_unique<BcmSflowExporter>(c->getAddress());
+    std::lock_guard<std::mutex> guard(lock_);
     map_.emplace(c->getID(), move(exporter));
   } catch (const fboss::thrift::FbossBaseError& ex) {
     XLOG(ERR) << "Could not add exporter: "
@@ -222,6 +344,7 @@ void BcmSflowExporterTable::addExporter(const shared_ptr<SflowCollector>& c) {
 
 void BcmSflowExporterTable::removeExporter(const std::string& id) {
   XLOG(INFO) << "Removed sFlow exporter " << id;
+  std::lock_guard<std::mutex> guard(lock_);
   map_.erase(id);
 }
 
@@ -229,6 +352,10 @@ void BcmSflowExporterTable::updateSamplingRates(
     PortID id,
     int64_t inRate,
     int64_t outRate) {
+  // We piggyback the update of local IPv6
+  auto localIP = getLocalIPv6();
+
+  std::lock_guard<std::mutex> guard(lock_);
   std::pair<int64_t, int64_t> rates(inRate, outRate);
   auto it = port2samplingRates_.find(id);
   if (it != port2samplingRates_.end()) {
@@ -237,16 +364,27 @@ void BcmSflowExporterTable::updateSamplingRates(
     port2samplingRates_.insert(std::make_pair(id, rates));
   }
 
-  // We piggyback the update of local IPv6
-  localIP_ = getLocalIPv6();
+  if (localIP != localIP_) {
+    // The agent address is in the datagram header, so the samples we have
+    // go out with the old address and the next ones in a new datagram.
+    flush();
+    builder_.reset();
+    localIP_ = localIP;
+  }
 }
 
 void BcmSflowExporterTable::sendToAll(const SflowPacketInfo& info) {
+  std::lock_guard<std::mutex> guard(lock_);
   if (map_.empty()) {
     XLOG(DBG1)
         << "zero sFlow collectors with sflow enabled, skipping sample export";
     return;
   }
+  if (FLAGS_sflow_v5_export) {
+    addFlowSample(info);
+    flushIfDue(Clock::now());
+    return;
+  }
   // Serialize info to a string and wrap it in an IOBuf for sending
   string output;
   apache::thrift::BinarySerializer::serialize(info, &output);
@@ -268,4 +406,215 @@ void BcmSflowExporterTable::sendToAll(const SflowPacketInfo& info) {
   }
 }
 
+void BcmSflowExporterTable::exportCounterSamples(
+    const BcmPortTable* portTable) {
+  if (!FLAGS_sflow_v5_export) {
+    return;
+  }
+  auto now = Clock::now();
+  std::vector<PortID> ports;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    auto interval = std::chrono::seconds(FLAGS_sflow_v5_counter_interval_s);
+    if (map_.empty() || now - lastCounterExport_ < interval) {
+      flushIfDue(now);
+      return;
+    }
+    lastCounterExport_ = now;
+    for (const auto& portAndRates : port2samplingRates_) {
+      if (portAndRates.second.first > 0 || portAndRates.second.second > 0) {
+        ports.push_back(portAndRates.first);
+      }
+    }
+  }
+
+  // Read the port state from the SDK without holding up the flow samples
+  std::vector<sflow::IfCounters> portCounters;
+  for (auto port : ports) {
+    auto bcmPort = portTable->getBcmPortIf(port);
+    if (!bcmPort) {
+      continue;
+    }
+    try {
+      auto counters = getIfCounters(bcmPort);
+      if (counters) {
+        portCounters.push_back(*counters);
+      }
+    } catch (const fboss::thrift::FbossBaseError& ex) {
+      XLOG(DBG1) << "Skipping sFlow counter sample for port " << port
+                 << ", reason: " << folly::exceptionStr(ex);
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(lock_);
+  for (const auto& counters : portCounters) {
+    addCounterSample(counters);
+  }
+  flushIfDue(now);
+}
+
+template <typename AddFn>
+void BcmSflowExporterTable::addSample(AddFn addTo) {
+  if (!builder_) {
+    builder_ = std::make_unique<sflow::DatagramBuilder>(
+        localIP_,
+        0 /* subAgentID */,
+        std::max(FLAGS_sflow_v5_max_datagram_size, 0));
+  }
+  if (builder_->empty()) {
+    oldestSample_ = Clock::now();
+  }
+  if (addTo(*builder_)) {
+    return;
+  }
+  flush();
+  oldestSample_ = Clock::now();
+  if (!addTo(*builder_)) {
+    XLOG(DBG1) << "sFlow sample does not fit in a datagram of "
+               << FLAGS_sflow_v5_max_datagram_size << " bytes, dropping it";
+    tcData().addStatValue(kDroppedSamples, 1, SUM);
+  }
+}
+
+void BcmSflowExporterTable::addFlowSample(const SflowPacketInfo& info) {
+  auto ingress = info.ingressSampled;
+  PortID port(static_cast<uint16_t>(ingress ? info.srcPort : info.dstPort));
+  uint32_t samplingRate = 0;
+  auto rates = port2samplingRates_.find(port);
+  if (rates != port2samplingRates_.end()) {
+    samplingRate = ingress ? rates->second.first : rates->second.second;
+  }
+  auto sequenceNumber = ++flowSampleSeqs_[port];
+
+  sflow::SampledHeader hdr;
+  hdr.protocol = sflow::HeaderProtocol::ETHERNET_ISO88023;
+  hdr.frameLength = info.frameLength;
+  hdr.stripped = 0;
+  hdr.headerLength =
+      std::min<size_t>(info.packetData.size(), kMaxSampledHeaderSize);
+  hdr.header = reinterpret_cast<const sflow::byte*>(info.packetData.data());
+  // The header follows 16 bytes of protocol and lengths
+  std::array<sflow::byte, 16 + kMaxSampledHeaderSize> hdrData;
+  auto hdrBuf = folly::IOBuf::wrapBuffer(hdrData.data(), hdrData.size());
+  folly::io::RWPrivateCursor cursor(hdrBuf.get());
+  hdr.serialize(&cursor);
+
+  sflow::FlowRecord record;
+  record.flowFormat = sflow::kSampledHeaderFormat;
+  record.flowDataLen = hdrData.size() - cursor.length();
+  record.flowData = hdrData.data();
+
+  sflow::FlowSample sample;
+  sample.sequenceNumber = sequenceNumber;
+  sample.sourceID = port;
+  sample.samplingRate = samplingRate;
+  // We only see the samples, so estimate the packets they were taken from
+  sample.samplePool = sequenceNumber * samplingRate;
+  sample.drops = 0;
+  sample.input = static_cast<uint16_t>(info.srcPort);
+  sample.output = static_cast<uint16_t>(info.dstPort);
+  sample.flowRecordsCnt = 1;
+  sample.flowRecords = &record;
+
+  addSample([&sample](sflow::DatagramBuilder& builder) {
+    return builder.addFlowSample(sample);
+  });
+  tcData().addStatValue(kFlowSamples, 1, SUM);
+}
+
+void BcmSflowExporterTable::addCounterSample(
+    const sflow::IfCounters& counters) {
+  std::array<sflow::byte, 88> countersData;
+  DCHECK_EQ(countersData.size(), counters.size());
+  auto countersBuf =
+      folly::IOBuf::wrapBuffer(countersData.data(), countersData.size());
+  folly::io::RWPrivateCursor cursor(countersBuf.get());
+  counters.serialize(&cursor);
+
+  sflow::CounterRecord record;
+  record.counterFormat = sflow::kIfCountersFormat;
+  record.counterDataLen = countersData.size();
+  record.counterData = countersData.data();
+
+  sflow::CountersSample sample;
+  sample.sequenceNumber = ++counterSampleSeqs_[PortID(counters.ifIndex)];
+  sample.sourceID = counters.ifIndex;
+  sample.counterRecordsCnt = 1;
+  sample.counterRecords = &record;
+
+  addSample([&sample](sflow::DatagramBuilder& builder) {
+    return builder.addCountersSample(sample);
+  });
+  tcData().addStatValue(kCounterSamples, 1, SUM);
+}
+
+void BcmSflowExporterTable::flushIfDue(Clock::time_point now) {
+  auto interval = std::chrono::milliseconds(FLAGS_sflow_v5_flush_interval_ms);
+  if (builder_ && !builder_->empty() && now - oldestSample_ >= interval) {
+    flush();
+  }
+}
+
+void BcmSflowExporterTable::flush() {
+  if (!builder_ || builder_->empty()) {
+    return;
+  }
+  auto numSamples = builder_->numSamples();
+  auto uptime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    Clock::now() - start_)
+                    .count();
+  auto datagram = builder_->finish(++datagramSeq_, uptime);
+  tcData().addStatValue(kDatagrams, 1, SUM);
+  tcData().addStatValue(kSamplesPerDatagram, numSamples, AVG);
+
+  // Every collector gets the same datagram, in a single sendmmsg() call
+  iovec vec;
+  vec.iov_base = datagram->writableData();
+  vec.iov_len = datagram->length();
+  std::vector<sockaddr_storage> addrs(map_.size());
+  std::vector<mmsghdr> msgs(map_.size());
+  size_t i = 0;
+  for (const auto& c : map_) {
+    const auto& address = c.second->getAddress();
+    // Our socket is dual stack, so IPv4 collectors take v4-mapped addresses
+    folly::SocketAddress mapped(
+        folly::IPAddress::createIPv6(address.getIPAddress()),
+        address.getPort());
+    auto& msg = msgs[i].msg_hdr;
+    msg.msg_name = reinterpret_cast<void*>(&addrs[i]);
+    msg.msg_namelen = mapped.getAddress(&addrs[i]);
+    msg.msg_iov = &vec;
+    msg.msg_iovlen = 1;
+    ++i;
+  }
+
+  size_t sent = 0;
+  size_t failed = 0;
+  while (sent + failed < msgs.size()) {
+    if (socket_ == -1) {
+      failed = msgs.size() - sent;
+      break;
+    }
+    auto offset = sent + failed;
+    auto ret =
+        ::sendmmsg(socket_, msgs.data() + offset, msgs.size() - offset, 0);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // Skip the collector we failed to send to and carry on with the rest
+      XLOG(DBG1) << "Failed sending sFlow datagram to a collector, reason: "
+                 << folly::errnoStr(errno);
+      ++failed;
+      continue;
+    }
+    sent += ret;
+  }
+  if (failed) {
+    tcData().addStatValue(kSendErrors, failed, SUM);
+  }
+  XLOG(DBG4) << "Sent sFlow datagram of " << numSamples << " samples and "
+             << vec.iov_len << " bytes to " << sent << " collectors";
+}
+
 } // namespace facebook::fboss
@@ -9,17 +9,23 @@
  */
 #pragma once
 
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include <folly/IPAddress.h>
 #include <folly/SocketAddress.h>
 
 #include "fboss/agent/if/gen-cpp2/sflow_types.h"
+#include "fboss/agent/packet/SflowDatagramBuilder.h"
 #include "fboss/agent/state/SflowCollector.h"
 #include "fboss/agent/types.h"
 
 namespace facebook::fboss {
 
+class BcmPortTable;
+
 class BcmSflowExporter {
  public:
   /*
@@ -35,6 +41,10 @@ class BcmSflowExporter {
    */
   ssize_t sendUDPDatagram(iovec* vec, const size_t iovec_len);
 
+  const folly::SocketAddress& getAddress() const {
+    return address_;
+  }
+
  private:
   // no copy or assignment
   BcmSflowExporter(BcmSflowExporter const&) = delete;
@@ -44,10 +54,19 @@ class BcmSflowExporter {
   int socket_{-1};
 };
 
+/*
+ * By default each sampled packet is sent to the collectors as a serialized
+ * SflowPacketInfo of its own. With --sflow_v5_export the samples are
+ * encoded as sFlow v5 flow samples instead, and packed together with
+ * periodic interface counter samples into datagrams of up to
+ * --sflow_v5_max_datagram_size bytes. A datagram is sent once the next
+ * sample does not fit in it, or once it has been held for
+ * --sflow_v5_flush_interval_ms, to all collectors in one sendmmsg() call.
+ */
 class BcmSflowExporterTable {
  public:
-  BcmSflowExporterTable() = default;
-  ~BcmSflowExporterTable() = default;
+  BcmSflowExporterTable();
+  ~BcmSflowExporterTable();
 
   bool contains(const std::shared_ptr<SflowCollector>& collector) const;
   size_t size() const;
@@ -58,17 +77,54 @@ class BcmSflowExporterTable {
 
   void sendToAll(const SflowPacketInfo& info);
 
+  /*
+   * Add counter samples for the ports with sampling enabled if they are
+   * due, and send the datagram if it has been held long enough. Called
+   * periodically, after the port stats are updated. Only used for sFlow v5
+   * export.
+   */
+  void exportCounterSamples(const BcmPortTable* portTable);
+
  private:
+  using Clock = std::chrono::steady_clock;
+
   // no copy or assignment
   BcmSflowExporterTable(BcmSflowExporterTable const&) = delete;
   BcmSflowExporterTable& operator=(BcmSflowExporterTable const&) = delete;
 
+  /*
+   * The methods below are for sFlow v5 export, and must be called with
+   * lock_ held.
+   */
+  void addFlowSample(const SflowPacketInfo& info);
+  void addCounterSample(const sflow::IfCounters& counters);
+  // Add a sample with addTo(builder), which returns false if the sample
+  // does not fit, in which case the datagram is sent first
+  template <typename AddFn>
+  void addSample(AddFn addTo);
+  // Send the datagram if its oldest sample has been held long enough
+  void flushIfDue(Clock::time_point now);
+  // Send the samples added so far to all collectors
+  void flush();
+
+  // Protects map_, localIP_ and the sFlow v5 export state below
+  mutable std::mutex lock_;
   std::unordered_map<std::string, std::unique_ptr<BcmSflowExporter>> map_;
   std::unordered_map<
       PortID,
       std::pair<int64_t /* ingress rate */, int64_t /* egress rate */>>
       port2samplingRates_;
-  folly::IPAddress localIP_;
+  folly::IPAddress localIP_{"::"};
+
+  const Clock::time_point start_{Clock::now()};
+  std::unique_ptr<sflow::DatagramBuilder> builder_;
+  uint32_t datagramSeq_{0};
+  std::unordered_map<PortID, uint32_t> flowSampleSeqs_;
+  std::unordered_map<PortID, uint32_t> counterSampleSeqs_;
+  Clock::time_point oldestSample_;
+  Clock::time_point lastCounterExport_{start_};
+  // Dual stack socket shared by all collectors
+  int socket_{-1};
 };
 
 } // namespace facebook::fboss
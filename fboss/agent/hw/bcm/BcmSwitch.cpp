@@ -1932,19 +1932,65 @@ void BcmSwitch::processRemovedFibRoutes(const StateDelta& delta) {
     CHECK(oldFib);
     RouterID vrf = oldFib->getID();
 
-    forEachRemoved(
-        fibDelta.getV4FibDelta(),
-        &BcmSwitch::processRemovedRoute<RouteV4>,
-        this,
-        vrf);
-    forEachRemoved(
-        fibDelta.getV6FibDelta(),
-        &BcmSwitch::processRemovedRoute<RouteV6>,
-        this,
-        vrf);
+    processRemovedFibDelta<RouteV4>(vrf, fibDelta.getV4FibDelta());
+    processRemovedFibDelta<RouteV6>(vrf, fibDelta.getV6FibDelta());
   }
 }
 
+template <typename RouteT, typename FibDeltaT>
+void BcmSwitch::processRemovedFibDelta(
+    const RouterID& vrf,
+    const FibDeltaT& fibDelta) {
+  std::vector<shared_ptr<RouteT>> removed;
+  forEachRemoved(fibDelta, [&](const shared_ptr<RouteT>& route) {
+    XLOG(DBG3) << "removing route entry @ vrf " << vrf << " " << route->str();
+    if (!route->isResolved()) {
+      XLOG(DBG1) << "Non-resolved route HW programming is skipped";
+      return;
+    }
+    removed.push_back(route);
+  });
+  routeTable_->deleteRoutes(getBcmVrfId(vrf), removed);
+}
+
+template <typename RouteT, typename FibDeltaT>
+void BcmSwitch::processAddedChangedFibDelta(
+    const RouterID& vrf,
+    const FibDeltaT& fibDelta) {
+  std::vector<shared_ptr<RouteT>> removed;
+  std::vector<shared_ptr<RouteT>> added;
+  forEachChanged(
+      fibDelta,
+      [&](const shared_ptr<RouteT>& oldRoute,
+          const shared_ptr<RouteT>& newRoute) {
+        XLOG(DBG3) << "changing route entry @ vrf " << vrf
+                   << " from old: " << oldRoute->str()
+                   << "to new: " << newRoute->str();
+        if (newRoute->isResolved()) {
+          added.push_back(newRoute);
+          return;
+        }
+        // if the new route is not resolved, delete it instead of changing it
+        XLOG(DBG1) << "Non-resolved route HW programming is skipped";
+        if (oldRoute->isResolved()) {
+          removed.push_back(oldRoute);
+        }
+      },
+      [&](const shared_ptr<RouteT>& route) {
+        XLOG(DBG3) << "adding route entry @ vrf " << vrf << " "
+                   << route->str();
+        // if the new route is not resolved, ignore it
+        if (!route->isResolved()) {
+          XLOG(DBG1) << "Non-resolved route HW programming is skipped";
+          return;
+        }
+        added.push_back(route);
+      },
+      [](const shared_ptr<RouteT>& /*deletedRoute*/) {});
+  routeTable_->deleteRoutes(getBcmVrfId(vrf), removed);
+  routeTable_->addRoutes(getBcmVrfId(vrf), added);
+}
+
 void BcmSwitch::processAddedChangedRoutes(
     const StateDelta& delta,
     std::shared_ptr<SwitchState>* appliedState) {
@@ -2029,21 +2075,8 @@ void BcmSwitch::processAddedChangedFibRoutes(
     CHECK(newFib);
     RouterID vrf = newFib->getID();
 
-    forEachChanged(
-        fibDelta.getV4FibDelta(),
-        &BcmSwitch::processChangedRoute<RouteV4>,
-        &BcmSwitch::processAddedRoute<RouteV4>,
-        [&](BcmSwitch*, const RouterID&, const shared_ptr<RouteV4>&) {},
-        this,
-        vrf);
-
-    forEachChanged(
-        fibDelta.getV6FibDelta(),
-        &BcmSwitch::processChangedRoute<RouteV6>,
-        &BcmSwitch::processAddedRoute<RouteV6>,
-        [&](BcmSwitch*, const RouterID&, const shared_ptr<RouteV6>&) {},
-        this,
-        vrf);
+    processAddedChangedFibDelta<RouteV4>(vrf, fibDelta.getV4FibDelta());
+    processAddedChangedFibDelta<RouteV6>(vrf, fibDelta.getV6FibDelta());
   }
 }
 
@@ -2196,6 +2229,7 @@ void BcmSwitch::updateThreadLocalPortStats(
 
 void BcmSwitch::updateGlobalStats() {
   portTable_->updatePortStats();
+  sFlowExporterTable_->exportCounterSamples(portTable_.get());
   trunkTable_->updateStats();
   bcmStatUpdater_->updateStats();
 
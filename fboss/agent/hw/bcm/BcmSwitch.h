@@ -601,6 +601,16 @@ class BcmSwitch : public BcmSwitchIf {
   void processAddedChangedFibRoutes(
       const StateDelta& delta,
       std::shared_ptr<SwitchState>* appliedState);
+  /*
+   * Collect the routes of one FIB delta and hand them to the route table
+   * in bulk.
+   */
+  template <typename RouteT, typename FibDeltaT>
+  void processRemovedFibDelta(const RouterID& vrf, const FibDeltaT& fibDelta);
+  template <typename RouteT, typename FibDeltaT>
+  void processAddedChangedFibDelta(
+      const RouterID& vrf,
+      const FibDeltaT& fibDelta);
 
   void processQosChanges(const StateDelta& delta);
 
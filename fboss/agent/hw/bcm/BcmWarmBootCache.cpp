@@ -9,6 +9,7 @@
  */
 #include "BcmWarmBootCache.h"
 #include <algorithm>
+#include <chrono>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -85,6 +86,20 @@ folly::IPAddress getFullMaskIPv6Address() {
   return folly::IPAddress(folly::IPAddressV6(
       folly::IPAddressV6::fetchMask(folly::IPAddressV6::bitCount())));
 }
+
+/*
+ * Run fn and record how long it took, in msecs, under name in timings.
+ * Warm boot populate and clear times are logged per table so that the
+ * control plane downtime of a warm boot can be broken down.
+ */
+template <typename Fn>
+void timeTable(folly::dynamic& timings, const char* name, Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  std::chrono::duration<double, std::milli> msecs =
+      std::chrono::steady_clock::now() - start;
+  timings[name] = msecs.count();
+}
 } // namespace
 
 namespace facebook::fboss {
@@ -441,52 +456,72 @@ void BcmWarmBootCache::populate(std::optional<folly::dynamic> warmBootState) {
   opennsl_l3_info_t l3Info;
   opennsl_l3_info_t_init(&l3Info);
   opennsl_l3_info(hw_->getUnit(), &l3Info);
-  // Traverse V4 hosts
-  rv = opennsl_l3_host_traverse(
-      hw_->getUnit(),
-      0,
-      0,
-      l3Info.l3info_max_host,
-      hostTraversalCallback,
-      this);
-  bcmCheckError(rv, "Failed to traverse v4 hosts");
-  // Traverse V6 hosts
-  rv = opennsl_l3_host_traverse(
-      hw_->getUnit(),
-      OPENNSL_L3_IP6,
-      0,
-      // Diag shell uses this for getting # of v6 host entries
-      l3Info.l3info_max_host / 2,
-      hostTraversalCallback,
-      this);
-  bcmCheckError(rv, "Failed to traverse v6 hosts");
-  // Traverse V4 routes
-  rv = opennsl_l3_route_traverse(
-      hw_->getUnit(),
-      0,
-      0,
-      l3Info.l3info_max_route,
-      routeTraversalCallback,
-      this);
-  bcmCheckError(rv, "Failed to traverse v4 routes");
-  // Traverse V6 routes
-  rv = opennsl_l3_route_traverse(
-      hw_->getUnit(),
-      OPENNSL_L3_IP6,
-      0,
-      // Diag shell uses this for getting # of v6 route entries
-      l3Info.l3info_max_route / 2,
-      routeTraversalCallback,
-      this);
-  bcmCheckError(rv, "Failed to traverse v6 routes");
-  // Get egress entries.
-  rv =
-      opennsl_l3_egress_traverse(hw_->getUnit(), egressTraversalCallback, this);
-  bcmCheckError(rv, "Failed to traverse egress");
-  // Traverse ecmp egress entries
-  rv = opennsl_l3_egress_ecmp_traverse(
-      hw_->getUnit(), ecmpEgressTraversalCallback, this);
-  bcmCheckError(rv, "Failed to traverse ecmp egress");
+  folly::dynamic timings = folly::dynamic::object;
+  timeTable(timings, "hosts", [&]() {
+    // Traverse V4 hosts
+    rv = opennsl_l3_host_traverse(
+        hw_->getUnit(),
+        0,
+        0,
+        l3Info.l3info_max_host,
+        hostTraversalCallback,
+        this);
+    bcmCheckError(rv, "Failed to traverse v4 hosts");
+    // Traverse V6 hosts
+    rv = opennsl_l3_host_traverse(
+        hw_->getUnit(),
+        OPENNSL_L3_IP6,
+        0,
+        // Diag shell uses this for getting # of v6 host entries
+        l3Info.l3info_max_host / 2,
+        hostTraversalCallback,
+        this);
+    bcmCheckError(rv, "Failed to traverse v6 hosts");
+    vrfIp2Host_.build();
+  });
+  timeTable(timings, "routes", [&]() {
+    // Traverse V4 routes
+    rv = opennsl_l3_route_traverse(
+        hw_->getUnit(),
+        0,
+        0,
+        l3Info.l3info_max_route,
+        routeTraversalCallback,
+        this);
+    bcmCheckError(rv, "Failed to traverse v4 routes");
+    // Traverse V6 routes
+    rv = opennsl_l3_route_traverse(
+        hw_->getUnit(),
+        OPENNSL_L3_IP6,
+        0,
+        // Diag shell uses this for getting # of v6 route entries
+        l3Info.l3info_max_route / 2,
+        routeTraversalCallback,
+        this);
+    bcmCheckError(rv, "Failed to traverse v6 routes");
+    vrfPrefix2Route_.build();
+    vrfAndIP2Route_.build();
+  });
+  timeTable(timings, "egress", [&]() {
+    // Get egress entries.
+    rv = opennsl_l3_egress_traverse(
+        hw_->getUnit(), egressTraversalCallback, this);
+    bcmCheckError(rv, "Failed to traverse egress");
+    auto duplicates = egressId2Egress_.build();
+    CHECK(duplicates == 0) << "Double callback for " << duplicates
+                           << " egress ids";
+  });
+  timeTable(timings, "ecmp", [&]() {
+    // Traverse ecmp egress entries
+    rv = opennsl_l3_egress_ecmp_traverse(
+        hw_->getUnit(), ecmpEgressTraversalCallback, this);
+    bcmCheckError(rv, "Failed to traverse ecmp egress");
+  });
+  XLOG(INFO) << "Warm boot cache populated " << vrfIp2Host_.size()
+             << " hosts, " << vrfPrefix2Route_.size() + vrfAndIP2Route_.size()
+             << " routes, " << egressId2Egress_.size() << " egress and "
+             << egressIds2Ecmp_.size()
+             << " ecmp entries, msecs: " << folly::toJson(timings);
 
   // populate acls, acl stats
   populateAcls(
@@ -530,7 +565,7 @@ int BcmWarmBootCache::hostTraversalCallback(
       ? IPAddress::fromBinary(
             ByteRange(host->l3a_ip6_addr, sizeof(host->l3a_ip6_addr)))
       : IPAddress::fromLongHBO(host->l3a_ip_addr);
-  cache->vrfIp2Host_[make_pair(host->l3a_vrf, ip)] = *host;
+  cache->vrfIp2Host_.stage(make_pair(host->l3a_vrf, ip), *host);
   XLOG(DBG1) << "Adding egress id: " << host->l3a_intf << " to " << ip
              << " mapping";
   return 0;
@@ -542,8 +577,6 @@ int BcmWarmBootCache::egressTraversalCallback(
     opennsl_l3_egress_t* egress,
     void* userData) {
   BcmWarmBootCache* cache = static_cast<BcmWarmBootCache*>(userData);
-  CHECK(cache->egressId2Egress_.find(egressId) == cache->egressId2Egress_.end())
-      << "Double callback for egress id: " << egressId;
   // Look up egressId in egressIdsInWarmBootFile_
   // to populate both dropEgressId_ and toCPUEgressId_.
   auto egressIdItr = cache->egressIdsInWarmBootFile_.find(egressId);
@@ -552,7 +585,7 @@ int BcmWarmBootCache::egressTraversalCallback(
     // reference it.
     XLOG(DBG1) << "Adding bcm egress entry for: " << *egressIdItr
                << " which is referenced by at least one host or route entry.";
-    cache->egressId2Egress_[egressId] = *egress;
+    cache->egressId2Egress_.stage(egressId, *egress);
   } else {
     // found egress ID that is not used by any host entry, we shall
     // only have two of them. One is for drop and the other one is for TO CPU.
@@ -599,12 +632,13 @@ int BcmWarmBootCache::routeTraversalCallback(
       ((isIPv6 && mask == getFullMaskIPv6Address()) ||
        (!isIPv6 && mask == getFullMaskIPv4Address()))) {
     // This is a host route.
-    cache->vrfAndIP2Route_[make_pair(route->l3a_vrf, ip)] = *route;
+    cache->vrfAndIP2Route_.stage(make_pair(route->l3a_vrf, ip), *route);
     XLOG(DBG3) << "Adding host route found in route table. vrf: "
                << route->l3a_vrf << " ip: " << ip << " mask: " << mask;
   } else {
     // Other routes that cannot be put into host table / CAM.
-    cache->vrfPrefix2Route_[make_tuple(route->l3a_vrf, ip, mask)] = *route;
+    cache->vrfPrefix2Route_.stage(
+        make_tuple(route->l3a_vrf, ip, mask), *route);
     XLOG(DBG3) << "In vrf : " << route->l3a_vrf << " adding route for : " << ip
                << " mask: " << mask;
   }
@@ -676,91 +710,104 @@ void BcmWarmBootCache::clear() {
   XLOG(DBG1) << "Warm boot: removing unreferenced entries";
   dumpedSwSwitchState_.reset();
   hwSwitchEcmp2EgressIds_.clear();
+  folly::dynamic timings = folly::dynamic::object;
   // First delete routes (fully qualified and others).
   //
   // Nothing references routes, but routes reference ecmp egress and egress
   // entries which are deleted later
-  for (auto vrfPfxAndRoute : vrfPrefix2Route_) {
-    XLOG(DBG1) << "Deleting unreferenced route in vrf:"
-               << std::get<0>(vrfPfxAndRoute.first)
-               << " for prefix : " << std::get<1>(vrfPfxAndRoute.first) << "/"
-               << std::get<2>(vrfPfxAndRoute.first);
-    auto rv = opennsl_l3_route_delete(hw_->getUnit(), &(vrfPfxAndRoute.second));
-    bcmLogFatal(
-        rv,
-        hw_,
-        "failed to delete unreferenced route in vrf:",
-        std::get<0>(vrfPfxAndRoute.first),
-        " for prefix : ",
-        std::get<1>(vrfPfxAndRoute.first),
-        "/",
-        std::get<2>(vrfPfxAndRoute.first));
-  }
-  vrfPrefix2Route_.clear();
-  for (auto vrfIPAndRoute : vrfAndIP2Route_) {
-    XLOG(DBG1) << "Deleting fully qualified unreferenced route in vrf: "
-               << vrfIPAndRoute.first.first
-               << " prefix: " << vrfIPAndRoute.first.second;
-    auto rv = opennsl_l3_route_delete(hw_->getUnit(), &(vrfIPAndRoute.second));
-    bcmLogFatal(
-        rv,
-        hw_,
-        "failed to delete fully qualified unreferenced route in vrf: ",
-        vrfIPAndRoute.first.first,
-        " prefix: ",
-        vrfIPAndRoute.first.second);
-  }
-  vrfAndIP2Route_.clear();
+  timeTable(timings, "routes", [&]() {
+    vrfPrefix2Route_.forEachUnclaimed([&](auto vrfPfxAndRoute) {
+      XLOG(DBG1) << "Deleting unreferenced route in vrf:"
+                 << std::get<0>(vrfPfxAndRoute.first) << " for prefix : "
+                 << std::get<1>(vrfPfxAndRoute.first) << "/"
+                 << std::get<2>(vrfPfxAndRoute.first);
+      auto rv =
+          opennsl_l3_route_delete(hw_->getUnit(), &(vrfPfxAndRoute.second));
+      bcmLogFatal(
+          rv,
+          hw_,
+          "failed to delete unreferenced route in vrf:",
+          std::get<0>(vrfPfxAndRoute.first),
+          " for prefix : ",
+          std::get<1>(vrfPfxAndRoute.first),
+          "/",
+          std::get<2>(vrfPfxAndRoute.first));
+    });
+    vrfPrefix2Route_.clear();
+    vrfAndIP2Route_.forEachUnclaimed([&](auto vrfIPAndRoute) {
+      XLOG(DBG1) << "Deleting fully qualified unreferenced route in vrf: "
+                 << vrfIPAndRoute.first.first
+                 << " prefix: " << vrfIPAndRoute.first.second;
+      auto rv =
+          opennsl_l3_route_delete(hw_->getUnit(), &(vrfIPAndRoute.second));
+      bcmLogFatal(
+          rv,
+          hw_,
+          "failed to delete fully qualified unreferenced route in vrf: ",
+          vrfIPAndRoute.first.first,
+          " prefix: ",
+          vrfIPAndRoute.first.second);
+    });
+    vrfAndIP2Route_.clear();
+  });
 
   // purge any lingering label FIB entries
   removeUnclaimedLabelSwitchActions();
 
   // Delete bcm host entries. Nobody references bcm hosts, but
   // hosts reference egress objects
-  for (auto vrfIpAndHost : vrfIp2Host_) {
-    XLOG(DBG1) << "Deleting host entry in vrf: " << vrfIpAndHost.first.first
-               << " for : " << vrfIpAndHost.first.second;
-    auto rv = opennsl_l3_host_delete(hw_->getUnit(), &vrfIpAndHost.second);
-    bcmLogFatal(
-        rv,
-        hw_,
-        "failed to delete host entry in vrf: ",
-        vrfIpAndHost.first.first,
-        " for : ",
-        vrfIpAndHost.first.second);
-  }
-  vrfIp2Host_.clear();
+  timeTable(timings, "hosts", [&]() {
+    vrfIp2Host_.forEachUnclaimed([&](auto vrfIpAndHost) {
+      XLOG(DBG1) << "Deleting host entry in vrf: " << vrfIpAndHost.first.first
+                 << " for : " << vrfIpAndHost.first.second;
+      auto rv = opennsl_l3_host_delete(hw_->getUnit(), &vrfIpAndHost.second);
+      bcmLogFatal(
+          rv,
+          hw_,
+          "failed to delete host entry in vrf: ",
+          vrfIpAndHost.first.first,
+          " for : ",
+          vrfIpAndHost.first.second);
+    });
+    vrfIp2Host_.clear();
+  });
 
   // Both routes and host entries (which have been deleted earlier) can refer
   // to ecmp egress objects.  Ecmp egress objects in turn refer to egress
   // objects which we delete later
-  for (auto idsAndEcmp : egressIds2Ecmp_) {
-    auto& ecmp = idsAndEcmp.second;
-    XLOG(DBG1) << "Deleting ecmp egress object  " << ecmp.ecmp_intf
-               << " pointing to : " << toEgressIdsStr(idsAndEcmp.first);
-    auto rv = opennsl_l3_egress_ecmp_destroy(hw_->getUnit(), &ecmp);
-    bcmLogFatal(
-        rv,
-        hw_,
-        "failed to destroy ecmp egress object :",
-        ecmp.ecmp_intf,
-        " referring to ",
-        toEgressIdsStr(idsAndEcmp.first));
-  }
-  egressIds2Ecmp_.clear();
+  timeTable(timings, "ecmp", [&]() {
+    for (auto idsAndEcmp : egressIds2Ecmp_) {
+      auto& ecmp = idsAndEcmp.second;
+      XLOG(DBG1) << "Deleting ecmp egress object  " << ecmp.ecmp_intf
+                 << " pointing to : " << toEgressIdsStr(idsAndEcmp.first);
+      auto rv = opennsl_l3_egress_ecmp_destroy(hw_->getUnit(), &ecmp);
+      bcmLogFatal(
+          rv,
+          hw_,
+          "failed to destroy ecmp egress object :",
+          ecmp.ecmp_intf,
+          " referring to ",
+          toEgressIdsStr(idsAndEcmp.first));
+    }
+    egressIds2Ecmp_.clear();
+  });
 
   // Delete bcm egress entries. These are referenced by routes, ecmp egress
   // and host objects all of which we deleted above. Egress objects in turn
   // my point to a interface which we delete later
-  for (auto egressIdAndEgress : egressId2Egress_) {
-    // This is not used yet
-    XLOG(DBG1) << "Deleting egress object: " << egressIdAndEgress.first;
-    auto rv =
-        opennsl_l3_egress_destroy(hw_->getUnit(), egressIdAndEgress.first);
-    bcmLogFatal(
-        rv, hw_, "failed to destroy egress object ", egressIdAndEgress.first);
-  }
-  egressId2Egress_.clear();
+  timeTable(timings, "egress", [&]() {
+    egressId2Egress_.forEachUnclaimed([&](const auto& egressIdAndEgress) {
+      // This is not used yet
+      XLOG(DBG1) << "Deleting egress object: " << egressIdAndEgress.first;
+      auto rv =
+          opennsl_l3_egress_destroy(hw_->getUnit(), egressIdAndEgress.first);
+      bcmLogFatal(
+          rv, hw_, "failed to destroy egress object ", egressIdAndEgress.first);
+    });
+    egressId2Egress_.clear();
+  });
+  XLOG(INFO) << "Warm boot cache cleared unclaimed entries, msecs: "
+             << folly::toJson(timings);
 
   // delete any MPLS tunnels
   removeUnclaimedLabeledTunnels();
@@ -22,10 +22,12 @@ extern "C" {
 #include <folly/dynamic.h>
 #include <folly/logging/xlog.h>
 #include <algorithm>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 #include "fboss/agent/hw/bcm/BcmMirror.h"
 #include "fboss/agent/hw/bcm/BcmQosMap.h"
@@ -126,6 +128,101 @@ class BcmWarmBootCache {
   typedef boost::container::flat_map<VlanID, opennsl_if_t>
       Vlan2BcmIfIdInWarmBootFile;
 
+  /*
+   * The host, route and egress tables can hold hundreds of thousands of
+   * entries, so they are not built one insertion at a time. Entries found
+   * while traversing h/w are staged in a vector, which is sorted and adopted
+   * into the flat_map in a single pass once the traversal is done.
+   *
+   * Erasing an entry from the middle of a flat_map moves every entry after
+   * it, so programmed entries are only marked as claimed, and find() no
+   * longer returns them. clear() then walks each table once, in key order,
+   * and removes the unclaimed entries from h/w.
+   */
+  template <typename MapT>
+  class WarmBootTable {
+   public:
+    using key_type = typename MapT::key_type;
+    using mapped_type = typename MapT::mapped_type;
+    using const_iterator = typename MapT::const_iterator;
+
+    /*
+     * Stage an entry found in h/w. If the same key is staged more than once,
+     * the last entry wins.
+     */
+    void stage(key_type key, const mapped_type& value) {
+      staged_.emplace_back(std::move(key), value);
+    }
+    /*
+     * Sort the staged entries and adopt them into the table. Returns the
+     * number of duplicate keys that were dropped.
+     */
+    size_t build() {
+      std::stable_sort(
+          staged_.begin(), staged_.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+          });
+      // Keep the last of each run of equal keys
+      auto out = staged_.begin();
+      for (auto in = staged_.begin(); in != staged_.end(); ++in) {
+        auto next = std::next(in);
+        if (next != staged_.end() && !(in->first < next->first)) {
+          continue;
+        }
+        if (out != in) {
+          *out = std::move(*in);
+        }
+        ++out;
+      }
+      size_t duplicates = std::distance(out, staged_.end());
+      staged_.erase(out, staged_.end());
+      entries_.insert(
+          boost::container::ordered_unique_range,
+          std::make_move_iterator(staged_.begin()),
+          std::make_move_iterator(staged_.end()));
+      claimed_.assign(entries_.size(), false);
+      staged_.clear();
+      staged_.shrink_to_fit();
+      return duplicates;
+    }
+    const_iterator begin() const {
+      return entries_.begin();
+    }
+    const_iterator end() const {
+      return entries_.end();
+    }
+    const_iterator find(const key_type& key) const {
+      auto itr = entries_.find(key);
+      if (itr != entries_.end() && claimed_[itr - entries_.begin()]) {
+        return entries_.end();
+      }
+      return itr;
+    }
+    void claim(const_iterator itr) {
+      claimed_[itr - entries_.begin()] = true;
+    }
+    template <typename Fn>
+    void forEachUnclaimed(Fn fn) const {
+      for (auto itr = entries_.begin(); itr != entries_.end(); ++itr) {
+        if (!claimed_[itr - entries_.begin()]) {
+          fn(*itr);
+        }
+      }
+    }
+    size_t size() const {
+      return entries_.size();
+    }
+    void clear() {
+      entries_.clear();
+      claimed_.clear();
+    }
+
+   private:
+    MapT entries_;
+    std::vector<bool> claimed_;
+    std::vector<std::pair<key_type, mapped_type>> staged_;
+  };
+
   typedef boost::container::flat_map<VrfAndIP, opennsl_l3_host_t> VrfAndIP2Host;
   typedef boost::container::flat_map<VrfAndPrefix, opennsl_l3_route_t>
       VrfAndPrefix2Route;
@@ -319,7 +416,7 @@ class BcmWarmBootCache {
   void programmed(EgressId2EgressCitr citr) {
     XLOG(DBG1) << "Programmed egress entry: " << citr->first
                << ". Removing from warmboot cache.";
-    egressId2Egress_.erase(citr->first);
+    egressId2Egress_.claim(citr);
   }
 
   using LabelStackKey2TunnelIdCitr = LabelStackKey2TunnelId::const_iterator;
@@ -356,7 +453,7 @@ class BcmWarmBootCache {
     XLOG(DBG1) << "Programmed host for vrf : " << vrhitr->first.first
                << " ip : " << vrhitr->first.second
                << " removing from warm boot cache ";
-    vrfIp2Host_.erase(vrhitr);
+    vrfIp2Host_.claim(vrhitr);
   }
   /*
    * Iterators and find functions for finding opennsl_l3_route_t
@@ -385,7 +482,7 @@ class BcmWarmBootCache {
                << "  prefix: " << std::get<1>(vrpitr->first) << "/"
                << std::get<2>(vrpitr->first)
                << " removing from warm boot cache ";
-    vrfPrefix2Route_.erase(vrpitr);
+    vrfPrefix2Route_.claim(vrpitr);
   }
 
   /**
@@ -407,7 +504,7 @@ class BcmWarmBootCache {
     XLOG(DBG1) << "Programmed host route, removing from warm boot cache. "
                << "vrf: " << citr->first.first << " "
                << "ip: " << citr->first.second;
-    vrfAndIP2Route_.erase(citr);
+    vrfAndIP2Route_.claim(citr);
   }
 
   /*
@@ -608,14 +705,14 @@ class BcmWarmBootCache {
   MplsNextHop2EgressIdInWarmBootFile mplsNextHops2EgressIdInWarmBootFile_;
 
   // The host table in HW
-  VrfAndIP2Host vrfIp2Host_;
+  WarmBootTable<VrfAndIP2Host> vrfIp2Host_;
   // These are routes from defip table that are not fully qualified (not /32 or
   // /128).
-  VrfAndPrefix2Route vrfPrefix2Route_;
+  WarmBootTable<VrfAndPrefix2Route> vrfPrefix2Route_;
   // These are the fully qualified routes stored in defip table (/32 and /128
   // routes).
-  VrfAndIP2Route vrfAndIP2Route_;
-  EgressId2Egress egressId2Egress_;
+  WarmBootTable<VrfAndIP2Route> vrfAndIP2Route_;
+  WarmBootTable<EgressId2Egress> egressId2Egress_;
   EgressIds2Ecmp egressIds2Ecmp_;
   LabelStackKey2TunnelId labelStackKey2TunnelId_;
   opennsl_if_t dropEgressId_;
@@ -1,6 +1,7 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
 #include "fboss/agent/hw/bcm/BcmWarmBootHelper.h"
 
+#include "fboss/agent/BinaryDynamic.h"
 #include "fboss/agent/SysError.h"
 #include "fboss/agent/Utils.h"
 
@@ -19,6 +20,13 @@ DEFINE_string(
     switch_state_file,
     "switch_state",
     "File for dumping switch state JSON in on exit");
+DEFINE_bool(
+    binary_warm_boot_state,
+    false,
+    "Dump the switch state on exit in the binary format rather than JSON. "
+    "Either format can be read back on warm boot, but versions older than "
+    "the binary format can only read JSON, so only enable this once rolling "
+    "back to those is no longer needed");
 
 namespace {
 constexpr auto wbFlagPrefix = "can_warm_boot_";
@@ -130,17 +138,16 @@ bool DiscBackedBcmWarmBootHelper::checkAndClearWarmBootFlags() {
 
 bool DiscBackedBcmWarmBootHelper::storeWarmBootState(
     const folly::dynamic& switchState) {
-  warmBootStateWritten_ =
-      dumpStateToFile(warmBootSwitchStateFile(), switchState);
+  warmBootStateWritten_ = FLAGS_binary_warm_boot_state
+      ? dumpBinaryStateToFile(warmBootSwitchStateFile(), switchState)
+      : dumpStateToFile(warmBootSwitchStateFile(), switchState);
   return warmBootStateWritten_;
 }
 
 folly::dynamic DiscBackedBcmWarmBootHelper::getWarmBootState() const {
-  std::string warmBootJson;
-  auto ret = folly::readFile(warmBootSwitchStateFile().c_str(), warmBootJson);
-  sysCheckError(
-      ret, "Unable to read switch state from : ", warmBootSwitchStateFile());
-  return folly::parseJson(warmBootJson);
+  // The state file is mmap'ed and may be in either format, depending on what
+  // the previous run was configured to write.
+  return readStateFromFile(warmBootSwitchStateFile());
 }
 
 } // namespace facebook::fboss
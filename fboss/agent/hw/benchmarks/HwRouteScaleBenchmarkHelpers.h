@@ -12,11 +12,27 @@
 #include "fboss/agent/hw/test/ConfigFactory.h"
 #include "fboss/agent/hw/test/HwSwitchEnsemble.h"
 #include "fboss/agent/hw/test/HwSwitchEnsembleFactory.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
+#include "fboss/agent/state/SwitchState.h"
 
 #include <folly/Benchmark.h>
+#include <folly/logging/xlog.h>
+
+#include <chrono>
 
 namespace facebook::fboss {
 
+namespace detail {
+inline size_t fibRouteCount(const std::shared_ptr<SwitchState>& state) {
+  size_t count = 0;
+  for (const auto& fibContainer : *state->getFibs()) {
+    count += fibContainer->getFibV4()->size();
+    count += fibContainer->getFibV6()->size();
+  }
+  return count;
+}
+} // namespace detail
+
 /*
  * Helper function to benchmark speed of route insertion, deletion
  * in HW. This function inits the ASIC, generate switch states for
@@ -38,8 +54,21 @@ void routeAddDelBenchmarker(bool measureAdd) {
     // for adding routes to h/w
     suspender.dismiss();
   }
+  // Log the time per route added for each chunk of routes, which should
+  // stay flat as the route table fills up
+  auto prevRouteCount = detail::fibRouteCount(ensemble->getProgrammedState());
   for (auto& state : states) {
+    auto start = std::chrono::steady_clock::now();
     ensemble->applyNewState(state);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    auto routeCount = detail::fibRouteCount(state);
+    if (measureAdd && routeCount > prevRouteCount) {
+      XLOG(DBG2) << "Added " << routeCount - prevRouteCount << " routes, "
+                 << elapsed.count() / (routeCount - prevRouteCount)
+                 << "ns per route, total " << routeCount;
+    }
+    prevRouteCount = routeCount;
   }
   // We are about to blow away all routes, before that
   // - Deactivate benchmark measurement if we are measuring
@@ -16,6 +16,9 @@
 
 #include <folly/Benchmark.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+#include <chrono>
 
 namespace facebook::fboss {
 
@@ -31,19 +34,38 @@ namespace facebook::fboss {
  *   iteration (by letting it pick number of iterations), and calculating
  *   cost of a single iterations does not seem to have more fidelity
  */
-BENCHMARK(HwStatsCollection) {
+void statsCollection(bool bulk) {
+  constexpr auto kIterations = 10'000;
   folly::BenchmarkSuspender suspender;
   static auto ensemble =
       createHwEnsemble(HwSwitch::FeaturesDesired::LINKSCAN_DESIRED);
   auto hwSwitch = ensemble->getHwSwitch();
   auto config =
       utility::onePortPerVlanConfig(hwSwitch, ensemble->masterLogicalPortIds());
+  // Only switches that can read all counters of a port at once know this
+  // flag, setting it is a no-op for the others
+  gflags::SetCommandLineOption("bulk_port_stats", bulk ? "true" : "false");
   SwitchStats dummy;
   suspender.dismiss();
-  for (auto i = 0; i < 10'000; ++i) {
+  auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < kIterations; ++i) {
     hwSwitch->updateStats(&dummy);
   }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  suspender.rehire();
+  XLOG(INFO) << (bulk ? "Bulk" : "Per counter")
+             << " stats collection: " << elapsed.count() / kIterations
+             << "us per cycle";
   ensemble->applyInitialConfigAndBringUpPorts(config);
 }
 
+BENCHMARK(HwStatsCollection) {
+  statsCollection(false);
+}
+
+BENCHMARK_RELATIVE(HwStatsCollectionBulk) {
+  statsCollection(true);
+}
+
 } // namespace facebook::fboss
@@ -8,7 +8,9 @@
  *
  */
 
+#include "fboss/agent/BinaryDynamic.h"
 #include "fboss/agent/Platform.h"
+#include "fboss/agent/Utils.h"
 #include "fboss/agent/hw/test/ConfigFactory.h"
 #include "fboss/agent/hw/test/HwSwitchEnsemble.h"
 #include "fboss/agent/hw/test/HwSwitchEnsembleFactory.h"
@@ -22,6 +24,9 @@
 #include <folly/init/Init.h>
 #include <folly/json.h>
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <chrono>
 #include <iostream>
 
@@ -46,6 +51,52 @@ class StopWatch {
  private:
   std::chrono::time_point<std::chrono::steady_clock> startTime_;
 };
+
+template <typename Fn>
+double timeMsecs(Fn fn) {
+  auto startTime = std::chrono::steady_clock::now();
+  fn();
+  std::chrono::duration<double, std::milli> durationMillseconds =
+      std::chrono::steady_clock::now() - startTime;
+  return durationMillseconds.count();
+}
+
+/*
+ * Compare the cost of writing and reading back the warm boot state in the
+ * JSON and binary formats. This only times encoding to and decoding from
+ * the file, not the time from exit until the agent is ready again, which
+ * also includes rebuilding the SwitchState and initializing the hardware.
+ */
+void compareStateFormats(
+    const folly::dynamic& switchState,
+    const std::string& dir) {
+  folly::dynamic results = folly::dynamic::object;
+  for (auto binary : {false, true}) {
+    auto format = binary ? "binary" : "json";
+    auto file = folly::to<std::string>(dir, "/warm_boot_state.", format);
+    auto writeMsecs = timeMsecs([&]() {
+      CHECK(
+          binary ? facebook::fboss::dumpBinaryStateToFile(file, switchState)
+                 : facebook::fboss::dumpStateToFile(file, switchState));
+    });
+    auto readMsecs =
+        timeMsecs([&]() { facebook::fboss::readStateFromFile(file); });
+    struct stat st;
+    CHECK_EQ(0, stat(file.c_str(), &st));
+    unlink(file.c_str());
+    if (FLAGS_json) {
+      results[folly::to<std::string>(format, "_write_msecs")] = writeMsecs;
+      results[folly::to<std::string>(format, "_read_msecs")] = readMsecs;
+      results[folly::to<std::string>(format, "_bytes")] = st.st_size;
+    } else {
+      XLOG(INFO) << format << " state write msecs: " << writeMsecs
+                 << " read msecs: " << readMsecs << " bytes: " << st.st_size;
+    }
+  }
+  if (FLAGS_json) {
+    std::cout << results << std::endl;
+  }
+}
 } // namespace
 namespace facebook::fboss {
 
@@ -94,6 +145,9 @@ void runBenchmark() {
                   .back();
   }
   ensemble->applyNewState(toApply);
+  compareStateFormats(
+      ensemble->getProgrammedState()->toFollyDynamic(),
+      ensemble->getPlatform()->getVolatileStateDir());
   // Static such that the object destructor runs as late as possible. In
   // Static such that the object destructor runs as late as possible. In
   // particular in this case, destructor (and thus the duration calculation)
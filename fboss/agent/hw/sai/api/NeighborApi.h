@@ -14,6 +14,7 @@
 #include "fboss/agent/hw/sai/api/AddressUtil.h"
 #include "fboss/agent/hw/sai/api/SaiAttribute.h"
 #include "fboss/agent/hw/sai/api/SaiAttributeDataTypes.h"
+#include "fboss/agent/hw/sai/api/SaiVersion.h"
 
 #include <folly/IPAddress.h>
 #include <folly/MacAddress.h>
@@ -118,6 +119,70 @@ class NeighborApi : public SaiApi<NeighborApi> {
       const sai_attribute_t* attr) {
     return api_->set_neighbor_entry_attribute(neighborEntry.entry(), attr);
   }
+  /*
+   * The bulk neighbor api only exists in newer SAI versions, on older ones
+   * SaiApi programs the batch one neighbor at a time.
+   */
+  sai_status_t _bulkCreate(
+      const std::vector<SaiNeighborTraits::NeighborEntry>& neighborEntries,
+      const uint32_t* attr_count,
+      const sai_attribute_t** attr_list,
+      sai_status_t* object_statuses) {
+#if SAI_API_VERSION >= SAI_VERSION(1, 8, 0)
+    if (api_->create_neighbor_entries) {
+      auto entries = saiEntries(neighborEntries);
+      return api_->create_neighbor_entries(
+          entries.size(),
+          entries.data(),
+          attr_count,
+          attr_list,
+          SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+          object_statuses);
+    }
+#endif
+    return SAI_STATUS_NOT_IMPLEMENTED;
+  }
+  sai_status_t _bulkRemove(
+      const std::vector<SaiNeighborTraits::NeighborEntry>& neighborEntries,
+      sai_status_t* object_statuses) {
+#if SAI_API_VERSION >= SAI_VERSION(1, 8, 0)
+    if (api_->remove_neighbor_entries) {
+      auto entries = saiEntries(neighborEntries);
+      return api_->remove_neighbor_entries(
+          entries.size(),
+          entries.data(),
+          SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+          object_statuses);
+    }
+#endif
+    return SAI_STATUS_NOT_IMPLEMENTED;
+  }
+  sai_status_t _bulkSetAttribute(
+      const std::vector<SaiNeighborTraits::NeighborEntry>& neighborEntries,
+      const sai_attribute_t* attr_list,
+      sai_status_t* object_statuses) {
+#if SAI_API_VERSION >= SAI_VERSION(1, 8, 0)
+    if (api_->set_neighbor_entries_attribute) {
+      auto entries = saiEntries(neighborEntries);
+      return api_->set_neighbor_entries_attribute(
+          entries.size(),
+          entries.data(),
+          attr_list,
+          SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+          object_statuses);
+    }
+#endif
+    return SAI_STATUS_NOT_IMPLEMENTED;
+  }
+  static std::vector<sai_neighbor_entry_t> saiEntries(
+      const std::vector<SaiNeighborTraits::NeighborEntry>& neighborEntries) {
+    std::vector<sai_neighbor_entry_t> entries;
+    entries.reserve(neighborEntries.size());
+    for (const auto& neighborEntry : neighborEntries) {
+      entries.push_back(*neighborEntry.entry());
+    }
+    return entries;
+  }
 
   sai_neighbor_api_t* api_;
   friend class SaiApi<NeighborApi>;
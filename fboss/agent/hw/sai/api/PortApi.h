@@ -138,6 +138,16 @@ class PortApi : public SaiApi<PortApi> {
         counters);
   }
 
+  sai_status_t _getStatsExt(
+      PortSaiId key,
+      uint32_t num_of_counters,
+      const sai_stat_id_t* counter_ids,
+      sai_stats_mode_t mode,
+      uint64_t* counters) {
+    return api_->get_port_stats_ext(
+        key, num_of_counters, counter_ids, mode, counters);
+  }
+
   sai_port_api_t* api_;
   friend class SaiApi<PortApi>;
 };
@@ -112,6 +112,16 @@ class QueueApi : public SaiApi<QueueApi> {
         counters);
   }
 
+  sai_status_t _getStatsExt(
+      QueueSaiId key,
+      uint32_t num_of_counters,
+      const sai_stat_id_t* counter_ids,
+      sai_stats_mode_t mode,
+      uint64_t* counters) {
+    return api_->get_queue_stats_ext(
+        key, num_of_counters, counter_ids, mode, counters);
+  }
+
   sai_queue_api_t* api_;
   friend class SaiApi<QueueApi>;
 };
@@ -114,6 +114,60 @@ class RouteApi : public SaiApi<RouteApi> {
       const sai_attribute_t* attr) {
     return api_->set_route_entry_attribute(routeEntry.entry(), attr);
   }
+  sai_status_t _bulkCreate(
+      const std::vector<SaiRouteTraits::RouteEntry>& routeEntries,
+      const uint32_t* attr_count,
+      const sai_attribute_t** attr_list,
+      sai_status_t* object_statuses) {
+    if (!api_->create_route_entries) {
+      return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+    auto entries = saiEntries(routeEntries);
+    return api_->create_route_entries(
+        entries.size(),
+        entries.data(),
+        attr_count,
+        attr_list,
+        SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+        object_statuses);
+  }
+  sai_status_t _bulkRemove(
+      const std::vector<SaiRouteTraits::RouteEntry>& routeEntries,
+      sai_status_t* object_statuses) {
+    if (!api_->remove_route_entries) {
+      return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+    auto entries = saiEntries(routeEntries);
+    return api_->remove_route_entries(
+        entries.size(),
+        entries.data(),
+        SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+        object_statuses);
+  }
+  sai_status_t _bulkSetAttribute(
+      const std::vector<SaiRouteTraits::RouteEntry>& routeEntries,
+      const sai_attribute_t* attr_list,
+      sai_status_t* object_statuses) {
+    if (!api_->set_route_entries_attribute) {
+      return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+    auto entries = saiEntries(routeEntries);
+    return api_->set_route_entries_attribute(
+        entries.size(),
+        entries.data(),
+        attr_list,
+        SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+        object_statuses);
+  }
+  static std::vector<sai_route_entry_t> saiEntries(
+      const std::vector<SaiRouteTraits::RouteEntry>& routeEntries) {
+    std::vector<sai_route_entry_t> entries;
+    entries.reserve(routeEntries.size());
+    for (const auto& routeEntry : routeEntries) {
+      entries.push_back(*routeEntry.entry());
+    }
+    return entries;
+  }
 
   sai_route_api_t* api_;
   friend class SaiApi<RouteApi>;
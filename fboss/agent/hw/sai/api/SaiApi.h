@@ -20,6 +20,7 @@
 #include <folly/logging/xlog.h>
 
 #include <boost/variant.hpp>
+#include <glog/logging.h>
 
 #include <exception>
 #include <stdexcept>
@@ -108,6 +109,102 @@ class SaiApi {
                << "]:" << folly::logging::objectToString(key);
   }
 
+  /*
+   * Bulk create, remove and set for objects whose AdapterKey is an entry
+   * struct (routes, neighbors, ...). Every object in the batch is attempted,
+   * even if some of them fail, and a status is returned per object instead
+   * of throwing, so the caller can tell which objects were programmed.
+   *
+   * If the adapter does not implement the bulk api for an object type, the
+   * objects are programmed one at a time.
+   */
+  template <typename SaiObjectTraits>
+  std::enable_if_t<
+      AdapterKeyIsEntryStruct<SaiObjectTraits>::value,
+      std::vector<sai_status_t>>
+  bulkCreate(
+      const std::vector<typename SaiObjectTraits::AdapterKey>& entries,
+      const std::vector<typename SaiObjectTraits::CreateAttributes>&
+          createAttributes) {
+    static_assert(
+        std::is_same_v<typename SaiObjectTraits::SaiApiT, ApiT>,
+        "invalid traits for the api");
+    CHECK_EQ(entries.size(), createAttributes.size());
+    std::vector<std::vector<sai_attribute_t>> saiAttributeTs;
+    std::vector<uint32_t> attrCounts;
+    std::vector<const sai_attribute_t*> attrLists;
+    saiAttributeTs.reserve(entries.size());
+    attrCounts.reserve(entries.size());
+    attrLists.reserve(entries.size());
+    for (const auto& attributes : createAttributes) {
+      saiAttributeTs.push_back(saiAttrs(attributes));
+      attrCounts.push_back(saiAttributeTs.back().size());
+      attrLists.push_back(saiAttributeTs.back().data());
+    }
+    std::vector<sai_status_t> statuses(entries.size(), SAI_STATUS_NOT_EXECUTED);
+    if (entries.empty()) {
+      return statuses;
+    }
+    sai_status_t status = impl()._bulkCreate(
+        entries, attrCounts.data(), attrLists.data(), statuses.data());
+    if (status == SAI_STATUS_NOT_IMPLEMENTED) {
+      for (size_t i = 0; i < entries.size(); ++i) {
+        statuses[i] = impl()._create(
+            entries[i], attrCounts[i], saiAttributeTs[i].data());
+      }
+    }
+    logBulkErrors(entries, statuses, "Failed to create sai entity");
+    return statuses;
+  }
+
+  template <typename AdapterKeyT>
+  std::vector<sai_status_t> bulkRemove(const std::vector<AdapterKeyT>& keys) {
+    static_assert(
+        IsSaiEntryStruct<AdapterKeyT>::value,
+        "bulk remove is only supported for entry structs");
+    std::vector<sai_status_t> statuses(keys.size(), SAI_STATUS_NOT_EXECUTED);
+    if (keys.empty()) {
+      return statuses;
+    }
+    sai_status_t status = impl()._bulkRemove(keys, statuses.data());
+    if (status == SAI_STATUS_NOT_IMPLEMENTED) {
+      for (size_t i = 0; i < keys.size(); ++i) {
+        statuses[i] = impl()._remove(keys[i]);
+      }
+    }
+    logBulkErrors(keys, statuses, "Failed to remove sai object");
+    return statuses;
+  }
+
+  // Set one attribute on each object, attrs[i] on keys[i]
+  template <typename AdapterKeyT, typename AttrT>
+  std::vector<sai_status_t> bulkSetAttribute(
+      const std::vector<AdapterKeyT>& keys,
+      const std::vector<AttrT>& attrs) {
+    static_assert(
+        IsSaiEntryStruct<AdapterKeyT>::value,
+        "bulk set is only supported for entry structs");
+    CHECK_EQ(keys.size(), attrs.size());
+    std::vector<sai_attribute_t> saiAttributeTs;
+    saiAttributeTs.reserve(attrs.size());
+    for (const auto& attr : attrs) {
+      saiAttributeTs.push_back(*saiAttr(attr));
+    }
+    std::vector<sai_status_t> statuses(keys.size(), SAI_STATUS_NOT_EXECUTED);
+    if (keys.empty()) {
+      return statuses;
+    }
+    sai_status_t status = impl()._bulkSetAttribute(
+        keys, saiAttributeTs.data(), statuses.data());
+    if (status == SAI_STATUS_NOT_IMPLEMENTED) {
+      for (size_t i = 0; i < keys.size(); ++i) {
+        statuses[i] = impl()._setAttribute(keys[i], &saiAttributeTs[i]);
+      }
+    }
+    logBulkErrors(keys, statuses, "Failed to set sai attribute");
+    return statuses;
+  }
+
   /*
    * We can do getAttribute on top of more complicated types than just
    * attributes. For example, if we overload on tuples and optionals, we
@@ -176,17 +273,58 @@ class SaiApi {
   getStats(const typename SaiObjectTraits::AdapterKey& key) {
     std::vector<uint64_t> counters;
     counters.resize(SaiObjectTraits::CounterIds.size());
+    getStats<SaiObjectTraits>(key, counters.data());
+    return counters;
+  }
+
+  /*
+   * Same as above, reading the counters into a buffer the caller owns,
+   * which must hold SaiObjectTraits::CounterIds.size() counters.
+   */
+  template <typename SaiObjectTraits>
+  std::enable_if_t<SaiObjectHasStats<SaiObjectTraits>::value, void> getStats(
+      const typename SaiObjectTraits::AdapterKey& key,
+      uint64_t* counters) {
     sai_status_t status = impl()._getStats(
         key,
-        counters.size(),
+        SaiObjectTraits::CounterIds.size(),
         SaiObjectTraits::CounterIds.data(),
         SaiObjectTraits::CounterMode,
-        counters.data());
+        counters);
     saiApiCheckError(status, ApiT::ApiType, "Failed to get stats");
-    return counters;
+  }
+
+  /*
+   * Read all the counters of an object into a buffer the caller owns, which
+   * must hold SaiObjectTraits::CounterIds.size() counters. The status is
+   * returned rather than checked, so that callers can tell when the adapter
+   * does not support the requested mode.
+   */
+  template <typename SaiObjectTraits>
+  std::enable_if_t<SaiObjectHasStats<SaiObjectTraits>::value, sai_status_t>
+  getStatsExt(
+      const typename SaiObjectTraits::AdapterKey& key,
+      sai_stats_mode_t mode,
+      uint64_t* counters) {
+    return impl()._getStatsExt(
+        key,
+        SaiObjectTraits::CounterIds.size(),
+        SaiObjectTraits::CounterIds.data(),
+        mode,
+        counters);
   }
 
  private:
+  template <typename AdapterKeyT>
+  void logBulkErrors(
+      const std::vector<AdapterKeyT>& keys,
+      const std::vector<sai_status_t>& statuses,
+      const char* msg) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      saiLogError(statuses[i], ApiT::ApiType, msg, " ", keys[i].toString());
+    }
+  }
+
   ApiT& impl() {
     return static_cast<ApiT&>(*this);
   }
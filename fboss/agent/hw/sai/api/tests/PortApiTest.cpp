@@ -220,3 +220,33 @@ TEST_F(PortApiTest, portKeys) {
   std::sort(keys.begin(), keys.end());
   EXPECT_EQ(keys, portIds);
 }
+
+TEST_F(PortApiTest, getStats) {
+  auto portId = createPort(100000, {42}, true);
+  fs->pm.get(portId).stats[SAI_PORT_STAT_IF_IN_OCTETS] = 1000;
+  fs->pm.get(portId).stats[SAI_PORT_STAT_IF_OUT_OCTETS] = 2000;
+  auto counters = portApi->getStats<SaiPortTraits>(portId);
+  EXPECT_EQ(counters.size(), SaiPortTraits::CounterIds.size());
+  EXPECT_EQ(counters[0], 1000);
+  // Reading without clearing leaves the counters in place
+  counters = portApi->getStats<SaiPortTraits>(portId);
+  EXPECT_EQ(counters[0], 1000);
+  // Or into a buffer of our own
+  std::vector<uint64_t> buf(SaiPortTraits::CounterIds.size());
+  portApi->getStats<SaiPortTraits>(portId, buf.data());
+  EXPECT_EQ(buf, counters);
+}
+
+TEST_F(PortApiTest, getStatsExtReadAndClear) {
+  auto portId = createPort(100000, {42}, true);
+  fs->pm.get(portId).stats[SAI_PORT_STAT_IF_IN_OCTETS] = 1000;
+  std::vector<uint64_t> counters(SaiPortTraits::CounterIds.size());
+  auto status = portApi->getStatsExt<SaiPortTraits>(
+      portId, SAI_STATS_MODE_READ_AND_CLEAR, counters.data());
+  EXPECT_EQ(status, SAI_STATUS_SUCCESS);
+  EXPECT_EQ(counters[0], 1000);
+  status = portApi->getStatsExt<SaiPortTraits>(
+      portId, SAI_STATS_MODE_READ_AND_CLEAR, counters.data());
+  EXPECT_EQ(status, SAI_STATUS_SUCCESS);
+  EXPECT_EQ(counters[0], 0);
+}
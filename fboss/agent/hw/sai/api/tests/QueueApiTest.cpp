@@ -73,3 +73,20 @@ TEST_F(QueueApiTest, removeQueue) {
   queueApi->remove(saiQueueId);
   EXPECT_EQ(fs->qm.map().size(), numCpuQueues);
 }
+
+TEST_F(QueueApiTest, getStatsExtReadAndClear) {
+  PortSaiId saiPortId{1};
+  auto saiQueueId = createQueue(saiPortId, true, 4);
+  fs->qm.get(saiQueueId).stats[SAI_QUEUE_STAT_PACKETS] = 10;
+  std::vector<uint64_t> counters(SaiQueueTraits::CounterIds.size());
+  auto status = queueApi->getStatsExt<SaiQueueTraits>(
+      saiQueueId, SAI_STATS_MODE_READ, counters.data());
+  EXPECT_EQ(status, SAI_STATUS_SUCCESS);
+  EXPECT_EQ(counters[0], 10);
+  status = queueApi->getStatsExt<SaiQueueTraits>(
+      saiQueueId, SAI_STATS_MODE_READ_AND_CLEAR, counters.data());
+  EXPECT_EQ(status, SAI_STATUS_SUCCESS);
+  EXPECT_EQ(counters[0], 10);
+  EXPECT_EQ(fs->qm.get(saiQueueId).stats[SAI_QUEUE_STAT_PACKETS], 0);
+  queueApi->remove(saiQueueId);
+}
@@ -129,3 +129,44 @@ TEST_F(RouteApiTest, routeKeys) {
   EXPECT_EQ(routeKeys.size(), 1);
   EXPECT_EQ(routeKeys[0], r);
 }
+
+TEST_F(RouteApiTest, bulkCreateRemoveRoutes) {
+  std::vector<SaiRouteTraits::RouteEntry> routes;
+  std::vector<SaiRouteTraits::CreateAttributes> attributes;
+  for (auto i = 0; i < 10; ++i) {
+    folly::CIDRNetwork prefix(
+        folly::IPAddress(folly::to<std::string>("10.0.", i, ".0")), 24);
+    routes.emplace_back(0, 0, prefix);
+    attributes.push_back({SAI_PACKET_ACTION_FORWARD, i + 1});
+  }
+  auto statuses = routeApi->bulkCreate<SaiRouteTraits>(routes, attributes);
+  EXPECT_EQ(std::vector<sai_status_t>(10, SAI_STATUS_SUCCESS), statuses);
+  EXPECT_EQ(getObjectCount<SaiRouteTraits>(0), 10);
+  for (auto i = 0; i < 10; ++i) {
+    EXPECT_EQ(
+        routeApi->getAttribute(
+            routes[i], SaiRouteTraits::Attributes::NextHopId()),
+        i + 1);
+  }
+
+  std::vector<SaiRouteTraits::Attributes::NextHopId> nextHops(
+      routes.size(), SaiRouteTraits::Attributes::NextHopId(42));
+  statuses = routeApi->bulkSetAttribute(routes, nextHops);
+  EXPECT_EQ(std::vector<sai_status_t>(10, SAI_STATUS_SUCCESS), statuses);
+  EXPECT_EQ(
+      routeApi->getAttribute(
+          routes[5], SaiRouteTraits::Attributes::NextHopId()),
+      42);
+
+  // Remove half the routes, then all of them. Each object gets its own
+  // status, and a failure does not stop the rest of the batch.
+  std::vector<SaiRouteTraits::RouteEntry> half(
+      routes.begin(), routes.begin() + 5);
+  statuses = routeApi->bulkRemove(half);
+  EXPECT_EQ(std::vector<sai_status_t>(5, SAI_STATUS_SUCCESS), statuses);
+  statuses = routeApi->bulkRemove(routes);
+  for (auto i = 0; i < 10; ++i) {
+    EXPECT_EQ(i < 5 ? SAI_STATUS_FAILURE : SAI_STATUS_SUCCESS, statuses[i]);
+  }
+  EXPECT_EQ(getObjectCount<SaiRouteTraits>(0), 0);
+}
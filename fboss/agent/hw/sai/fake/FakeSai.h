@@ -59,6 +59,31 @@ struct FakeSai {
   sai_object_id_t getCpuPort();
 };
 
+/*
+ * Run a bulk api call as object_count individual calls, filling in
+ * object_statuses as the SAI bulk api specifies for the error mode.
+ */
+template <typename Fn>
+sai_status_t bulkOperation(
+    uint32_t object_count,
+    sai_bulk_op_error_mode_t mode,
+    sai_status_t* object_statuses,
+    Fn fn) {
+  sai_status_t ret = SAI_STATUS_SUCCESS;
+  for (uint32_t i = 0; i < object_count; ++i) {
+    if (ret != SAI_STATUS_SUCCESS &&
+        mode == SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR) {
+      object_statuses[i] = SAI_STATUS_NOT_EXECUTED;
+      continue;
+    }
+    object_statuses[i] = fn(i);
+    if (object_statuses[i] != SAI_STATUS_SUCCESS) {
+      ret = SAI_STATUS_FAILURE;
+    }
+  }
+  return ret;
+}
+
 } // namespace facebook::fboss
 
 sai_status_t sai_api_initialize(
@@ -228,6 +228,45 @@ sai_status_t get_port_attribute_fn(
   return SAI_STATUS_SUCCESS;
 }
 
+sai_status_t get_port_stats_ext_fn(
+    sai_object_id_t port_id,
+    uint32_t num_of_counters,
+    const sai_stat_id_t* counter_ids,
+    sai_stats_mode_t mode,
+    uint64_t* counters) {
+  auto fs = FakeSai::getInstance();
+  auto& port = fs->pm.get(port_id);
+  for (uint32_t i = 0; i < num_of_counters; ++i) {
+    auto& stat = port.stats[counter_ids[i]];
+    counters[i] = stat;
+    if (mode == SAI_STATS_MODE_READ_AND_CLEAR) {
+      stat = 0;
+    }
+  }
+  return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t get_port_stats_fn(
+    sai_object_id_t port_id,
+    uint32_t num_of_counters,
+    const sai_stat_id_t* counter_ids,
+    uint64_t* counters) {
+  return get_port_stats_ext_fn(
+      port_id, num_of_counters, counter_ids, SAI_STATS_MODE_READ, counters);
+}
+
+sai_status_t clear_port_stats_fn(
+    sai_object_id_t port_id,
+    uint32_t num_of_counters,
+    const sai_stat_id_t* counter_ids) {
+  auto fs = FakeSai::getInstance();
+  auto& port = fs->pm.get(port_id);
+  for (uint32_t i = 0; i < num_of_counters; ++i) {
+    port.stats[counter_ids[i]] = 0;
+  }
+  return SAI_STATUS_SUCCESS;
+}
+
 namespace facebook::fboss {
 
 static sai_port_api_t _port_api;
@@ -237,6 +276,9 @@ void populate_port_api(sai_port_api_t** port_api) {
   _port_api.remove_port = &remove_port_fn;
   _port_api.set_port_attribute = &set_port_attribute_fn;
   _port_api.get_port_attribute = &get_port_attribute_fn;
+  _port_api.get_port_stats = &get_port_stats_fn;
+  _port_api.get_port_stats_ext = &get_port_stats_ext_fn;
+  _port_api.clear_port_stats = &clear_port_stats_fn;
   *port_api = &_port_api;
 }
 
@@ -36,6 +36,7 @@ class FakePort {
   sai_port_media_type_t mediaType{SAI_PORT_MEDIA_TYPE_NOT_PRESENT};
   sai_vlan_id_t vlanId{0};
   std::vector<sai_object_id_t> queueIdList;
+  std::unordered_map<sai_stat_id_t, uint64_t> stats;
 };
 
 using FakePortManager = FakeManager<sai_object_id_t, FakePort>;
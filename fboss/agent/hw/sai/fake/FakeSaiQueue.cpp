@@ -127,6 +127,45 @@ sai_status_t get_queue_attribute_fn(
   return SAI_STATUS_SUCCESS;
 }
 
+sai_status_t get_queue_stats_ext_fn(
+    sai_object_id_t queue_id,
+    uint32_t num_of_counters,
+    const sai_stat_id_t* counter_ids,
+    sai_stats_mode_t mode,
+    uint64_t* counters) {
+  auto fs = FakeSai::getInstance();
+  auto& queue = fs->qm.get(queue_id);
+  for (uint32_t i = 0; i < num_of_counters; ++i) {
+    auto& stat = queue.stats[counter_ids[i]];
+    counters[i] = stat;
+    if (mode == SAI_STATS_MODE_READ_AND_CLEAR) {
+      stat = 0;
+    }
+  }
+  return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t get_queue_stats_fn(
+    sai_object_id_t queue_id,
+    uint32_t num_of_counters,
+    const sai_stat_id_t* counter_ids,
+    uint64_t* counters) {
+  return get_queue_stats_ext_fn(
+      queue_id, num_of_counters, counter_ids, SAI_STATS_MODE_READ, counters);
+}
+
+sai_status_t clear_queue_stats_fn(
+    sai_object_id_t queue_id,
+    uint32_t num_of_counters,
+    const sai_stat_id_t* counter_ids) {
+  auto fs = FakeSai::getInstance();
+  auto& queue = fs->qm.get(queue_id);
+  for (uint32_t i = 0; i < num_of_counters; ++i) {
+    queue.stats[counter_ids[i]] = 0;
+  }
+  return SAI_STATUS_SUCCESS;
+}
+
 namespace facebook::fboss {
 
 static sai_queue_api_t _queue_api;
@@ -136,6 +175,9 @@ void populate_queue_api(sai_queue_api_t** queue_api) {
   _queue_api.remove_queue = &remove_queue_fn;
   _queue_api.set_queue_attribute = &set_queue_attribute_fn;
   _queue_api.get_queue_attribute = &get_queue_attribute_fn;
+  _queue_api.get_queue_stats = &get_queue_stats_fn;
+  _queue_api.get_queue_stats_ext = &get_queue_stats_ext_fn;
+  _queue_api.clear_queue_stats = &clear_queue_stats_fn;
   *queue_api = &_queue_api;
 }
 
@@ -38,6 +38,7 @@ class FakeQueue {
   sai_object_id_t bufferProfileId;
   sai_object_id_t schedulerProfileId;
   sai_object_id_t id;
+  std::unordered_map<sai_stat_id_t, uint64_t> stats;
 };
 
 using FakeQueueManager = FakeManager<sai_object_id_t, FakeQueue>;
@@ -146,7 +146,7 @@ typename std::
  * moved from. If it is live, destroying the SaiObject removes the
  * corresponding object from SAI.
  *
- * A SaiObject can be constructed in three ways:
+ * A SaiObject can be constructed in four ways:
  * 1. By loading it from the SAI adapter using the AdapterKey. This can be
  *    thought of as the SaiObject taking control of an existing object in SAI.
  * 2. By creating a new object in the SAI adapter using the AdapterHostKey and
@@ -156,7 +156,10 @@ typename std::
  *    SaiObject manages a given SAI object. (N.B., there is no general hard
  *    guarantee for this property -- a user could load the same SaiObject more
  *    than once).
- * In all three cases, (excepting the unlikely event of moving from a non-live
+ * 4. By taking over an object that was already created in the SAI adapter
+ *    with known AdapterKey, AdapterHostKey and CreateAttributes, as is done
+ *    for objects created with the bulk api.
+ * In all four cases, (excepting the unlikely event of moving from a non-live
  * SaiObject), the newly constructed SaiObject is live and stores the
  * appropriate values of AdapterHostKey, AdapterKey, and CreateAttributes.
  *
@@ -196,6 +199,17 @@ class SaiObject {
     live_ = true;
   }
 
+  // Take over an object that was already created in the SAI adapter with
+  // these attributes, e.g. as part of a bulk create.
+  SaiObject(
+      const typename SaiObjectTraits::AdapterKey& adapterKey,
+      const typename SaiObjectTraits::AdapterHostKey& adapterHostKey,
+      const typename SaiObjectTraits::CreateAttributes& attributes)
+      : live_(true),
+        adapterKey_(adapterKey),
+        adapterHostKey_(adapterHostKey),
+        attributes_(attributes) {}
+
   // Forbid copy construction and copy assignment
   SaiObject(const SaiObject& other) = delete;
   SaiObject& operator=(const SaiObject& other) = delete;
@@ -242,6 +256,18 @@ class SaiObject {
     attributes_ = newAttributes;
   }
 
+  /*
+   * Record new attribute values which were already programmed in the SAI
+   * adapter, e.g. with a bulk set.
+   */
+  void setProgrammedAttributes(
+      const typename SaiObjectTraits::CreateAttributes& newAttributes) {
+    if (UNLIKELY(!live_)) {
+      XLOG(FATAL) << "Attempted to setAttributes on non-live SaiObject";
+    }
+    attributes_ = newAttributes;
+  }
+
   void release() {
     live_ = false;
   }
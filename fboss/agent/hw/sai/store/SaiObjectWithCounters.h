@@ -33,11 +33,40 @@ class SaiObjectWithCounters : public SaiObject<SaiObjectTraits> {
       sai_object_id_t switchId)
       : SaiObject<SaiObjectTraits>(adapterHostKey, attributes, switchId) {}
 
+  /*
+   * Read the counters. In SAI_STATS_MODE_READ_AND_CLEAR the adapter returns
+   * the increments since the last read, which are added up so that
+   * getStats() stays cumulative. The _ext stats call that takes a mode is
+   * optional in SAI, so only that mode uses it. If the adapter does not
+   * support clearing on read, this falls back to SAI_STATS_MODE_READ.
+   *
+   * Returns the mode that was used, which callers pass to later reads.
+   */
   template <typename T = SaiObjectTraits>
-  void updateStats() {
+  sai_stats_mode_t updateStats(sai_stats_mode_t mode = T::CounterMode) {
     static_assert(SaiObjectHasStats<T>::value, "invalid traits for the api");
-    auto& api = SaiApiTable::getInstance()->getApi<typename T::SaiApiT>();
-    counters_ = api.template getStats<T>(this->adapterKey());
+    using ApiT = typename T::SaiApiT;
+    auto& api = SaiApiTable::getInstance()->getApi<ApiT>();
+    if (counters_.empty()) {
+      counters_.resize(T::CounterIds.size());
+    }
+    if (mode == SAI_STATS_MODE_READ_AND_CLEAR) {
+      increments_.resize(counters_.size());
+      auto status = api.template getStatsExt<T>(
+          this->adapterKey(), mode, increments_.data());
+      if (status != SAI_STATUS_NOT_SUPPORTED &&
+          status != SAI_STATUS_NOT_IMPLEMENTED) {
+        saiApiCheckError(status, ApiT::ApiType, "Failed to get stats");
+        for (size_t i = 0; i < counters_.size(); ++i) {
+          counters_[i] += increments_[i];
+        }
+        return mode;
+      }
+      mode = SAI_STATS_MODE_READ;
+    }
+    // Read into the counters in place, so that no mode allocates per read
+    api.template getStats<T>(this->adapterKey(), counters_.data());
+    return mode;
   }
 
   template <typename T = SaiObjectTraits>
@@ -48,6 +77,7 @@ class SaiObjectWithCounters : public SaiObject<SaiObjectTraits> {
 
  private:
   std::vector<uint64_t> counters_;
+  std::vector<uint64_t> increments_;
 };
 
 } // namespace facebook::fboss
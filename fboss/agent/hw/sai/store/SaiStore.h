@@ -18,6 +18,8 @@
 
 #include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
 extern "C" {
 #include <sai.h>
@@ -104,6 +106,119 @@ class SaiObjectStore {
     return ins.first;
   }
 
+  /*
+   * Batched setObject() for objects keyed by entry structs, e.g. routes.
+   * Objects not yet in the store are created with a single bulk create, and
+   * changed attributes of existing objects are programmed with one bulk set
+   * per attribute.
+   *
+   * The adapter's status for each object is returned in statuses. Objects
+   * that failed to be created are returned as nullptr. Existing objects
+   * only record the attributes the adapter accepted, so that the store
+   * keeps matching the adapter when some attributes fail to be set.
+   */
+  template <typename T = SaiObjectTraits>
+  std::enable_if_t<
+      AdapterKeyIsEntryStruct<T>::value,
+      std::vector<std::shared_ptr<ObjectType>>>
+  bulkSetObjects(
+      const std::vector<typename T::AdapterHostKey>& adapterHostKeys,
+      const std::vector<typename T::CreateAttributes>& attributes,
+      std::vector<sai_status_t>* statuses) {
+    CHECK_EQ(adapterHostKeys.size(), attributes.size());
+    auto& api = SaiApiTable::getInstance()->getApi<typename T::SaiApiT>();
+    std::vector<std::shared_ptr<ObjectType>> objects(adapterHostKeys.size());
+    statuses->assign(adapterHostKeys.size(), SAI_STATUS_SUCCESS);
+
+    std::vector<size_t> created;
+    std::vector<size_t> updated;
+    std::vector<typename T::AdapterKey> createKeys;
+    std::vector<typename T::CreateAttributes> createAttributes;
+    for (size_t i = 0; i < adapterHostKeys.size(); ++i) {
+      objects[i] = objects_.ref(adapterHostKeys[i]);
+      if (objects[i]) {
+        updated.push_back(i);
+      } else {
+        created.push_back(i);
+        createKeys.push_back(adapterHostKeys[i]);
+        createAttributes.push_back(attributes[i]);
+      }
+    }
+
+    auto createStatuses =
+        api.template bulkCreate<T>(createKeys, createAttributes);
+    for (size_t j = 0; j < created.size(); ++j) {
+      auto i = created[j];
+      (*statuses)[i] = createStatuses[j];
+      if (createStatuses[j] == SAI_STATUS_SUCCESS) {
+        auto ins = objects_.refOrEmplace(
+            adapterHostKeys[i],
+            createKeys[j],
+            adapterHostKeys[i],
+            attributes[i]);
+        objects[i] = ins.first;
+      }
+    }
+
+    std::vector<typename T::CreateAttributes> programmed;
+    programmed.reserve(updated.size());
+    for (auto i : updated) {
+      programmed.push_back(objects[i]->attributes());
+    }
+    bulkSetChangedAttributes(
+        objects,
+        attributes,
+        updated,
+        &programmed,
+        statuses,
+        std::make_index_sequence<
+            std::tuple_size_v<typename T::CreateAttributes>>{});
+    for (size_t k = 0; k < updated.size(); ++k) {
+      objects[updated[k]]->setProgrammedAttributes(programmed[k]);
+    }
+    XLOG(DBG5) << "[" << saiObjectTypeToString(SaiObjectTraits::ObjectType)
+               << "] bulk set " << created.size() << " new and "
+               << updated.size() << " existing objects";
+    return objects;
+  }
+
+  /*
+   * Drop a batch of references to objects keyed by entry structs. The
+   * objects which are not referenced anywhere else are removed with a single
+   * bulk remove, rather than one at a time as their references go away.
+   * Returns the objects which the adapter failed to remove. They are still
+   * live, so it is up to the caller to keep them or retry removing them.
+   */
+  template <typename T = SaiObjectTraits>
+  std::enable_if_t<
+      AdapterKeyIsEntryStruct<T>::value,
+      std::vector<std::shared_ptr<ObjectType>>>
+  bulkRemove(std::vector<std::shared_ptr<ObjectType>> objects) {
+    std::vector<typename T::AdapterKey> keys;
+    std::vector<std::shared_ptr<ObjectType>> toRemove;
+    for (auto& object : objects) {
+      if (object.use_count() == 1) {
+        keys.push_back(object->adapterKey());
+        toRemove.push_back(std::move(object));
+      }
+    }
+    objects.clear();
+    auto& api = SaiApiTable::getInstance()->getApi<typename T::SaiApiT>();
+    auto statuses = api.bulkRemove(keys);
+    std::vector<std::shared_ptr<ObjectType>> failed;
+    for (size_t i = 0; i < toRemove.size(); ++i) {
+      if (statuses[i] == SAI_STATUS_SUCCESS) {
+        // Already removed, don't remove again when the reference goes away
+        toRemove[i]->release();
+      } else {
+        XLOG(ERR) << "[" << saiObjectTypeToString(T::ObjectType)
+                  << "] failed to remove object: " << statuses[i];
+        failed.push_back(std::move(toRemove[i]));
+      }
+    }
+    return failed;
+  }
+
   std::shared_ptr<ObjectType> get(
       const typename SaiObjectTraits::AdapterHostKey& adapterHostKey) {
     XLOG(DBG5) << "[" << saiObjectTypeToString(SaiObjectTraits::ObjectType)
@@ -117,6 +232,79 @@ class SaiObjectStore {
   }
 
  private:
+  template <typename AttrT>
+  static AttrT attributeToSet(const AttrT& attr) {
+    return attr;
+  }
+  template <typename AttrT>
+  static AttrT attributeToSet(const std::optional<AttrT>& attr) {
+    // An optional attribute that is no longer set goes back to its default.
+    // The optional attributes of entry objects (e.g. a route's next hop)
+    // all default to zero, i.e. SAI_NULL_OBJECT_ID.
+    return attr ? attr.value() : AttrT(typename AttrT::ValueType{});
+  }
+
+  /*
+   * For each attribute of the CreateAttributes tuple, gather the objects
+   * whose value changed and program them with a single bulk set. The
+   * attributes which were set are recorded in programmed, which holds the
+   * attributes of objects[updated[k]] at index k.
+   */
+  template <size_t... Indices>
+  void bulkSetChangedAttributes(
+      const std::vector<std::shared_ptr<ObjectType>>& objects,
+      const std::vector<typename SaiObjectTraits::CreateAttributes>&
+          attributes,
+      const std::vector<size_t>& updated,
+      std::vector<typename SaiObjectTraits::CreateAttributes>* programmed,
+      std::vector<sai_status_t>* statuses,
+      std::index_sequence<Indices...>) {
+    (bulkSetChangedAttribute<Indices>(
+         objects, attributes, updated, programmed, statuses),
+     ...);
+  }
+
+  template <size_t Index>
+  void bulkSetChangedAttribute(
+      const std::vector<std::shared_ptr<ObjectType>>& objects,
+      const std::vector<typename SaiObjectTraits::CreateAttributes>&
+          attributes,
+      const std::vector<size_t>& updated,
+      std::vector<typename SaiObjectTraits::CreateAttributes>* programmed,
+      std::vector<sai_status_t>* statuses) {
+    using AttrT = decltype(attributeToSet(
+        std::get<Index>(std::declval<
+                        typename SaiObjectTraits::CreateAttributes>())));
+    std::vector<typename SaiObjectTraits::AdapterKey> keys;
+    std::vector<AttrT> attrs;
+    std::vector<size_t> changed;
+    for (size_t k = 0; k < updated.size(); ++k) {
+      auto i = updated[k];
+      const auto& oldAttr = std::get<Index>(objects[i]->attributes());
+      const auto& newAttr = std::get<Index>(attributes[i]);
+      if (oldAttr != newAttr) {
+        keys.push_back(objects[i]->adapterKey());
+        attrs.push_back(attributeToSet(newAttr));
+        changed.push_back(k);
+      }
+    }
+    if (keys.empty()) {
+      return;
+    }
+    auto& api = SaiApiTable::getInstance()
+                    ->getApi<typename SaiObjectTraits::SaiApiT>();
+    auto setStatuses = api.bulkSetAttribute(keys, attrs);
+    for (size_t j = 0; j < changed.size(); ++j) {
+      auto k = changed[j];
+      if (setStatuses[j] == SAI_STATUS_SUCCESS) {
+        std::get<Index>((*programmed)[k]) =
+            std::get<Index>(attributes[updated[k]]);
+      } else {
+        (*statuses)[updated[k]] = setStatuses[j];
+      }
+    }
+  }
+
   std::optional<sai_object_id_t> switchId_;
   UnorderedRefMap<typename SaiObjectTraits::AdapterHostKey, ObjectType>
       objects_;
@@ -93,3 +93,81 @@ TEST_F(SaiStoreTest, routeSetToPunt) {
   EXPECT_EQ(GET_OPT_ATTR(Route, NextHopId, obj.attributes()), 5);
   */
 }
+
+TEST_F(SaiStoreTest, bulkSetAndRemoveRoutes) {
+  auto& store = SaiStore::getInstance()->get<SaiRouteTraits>();
+  SaiStore::getInstance()->setSwitchId(0);
+  std::vector<SaiRouteTraits::RouteEntry> routes;
+  std::vector<SaiRouteTraits::CreateAttributes> attributes;
+  for (auto i = 0; i < 10; ++i) {
+    folly::CIDRNetwork dest(
+        folly::IPAddress(folly::to<std::string>("10.0.", i, ".0")), 24);
+    routes.emplace_back(0, 0, dest);
+    attributes.push_back({SAI_PACKET_ACTION_FORWARD, 5});
+  }
+  // One route exists before the bulk set, and gets updated by it
+  auto existing = store.setObject(routes[0], {SAI_PACKET_ACTION_DROP, 4});
+
+  std::vector<sai_status_t> statuses;
+  auto objects = store.bulkSetObjects(routes, attributes, &statuses);
+  ASSERT_EQ(routes.size(), objects.size());
+  EXPECT_EQ(std::vector<sai_status_t>(10, SAI_STATUS_SUCCESS), statuses);
+  EXPECT_EQ(existing, objects[0]);
+  for (auto i = 0; i < 10; ++i) {
+    EXPECT_EQ(objects[i]->adapterKey(), routes[i]);
+    EXPECT_EQ(GET_OPT_ATTR(Route, NextHopId, objects[i]->attributes()), 5);
+    EXPECT_EQ(
+        saiApiTable->routeApi().getAttribute(
+            routes[i], SaiRouteTraits::Attributes::PacketAction()),
+        SAI_PACKET_ACTION_FORWARD);
+  }
+
+  // Routes still referenced elsewhere are not removed
+  existing.reset();
+  auto kept = objects[9];
+  store.bulkRemove(std::move(objects));
+  EXPECT_EQ(getObjectCount<SaiRouteTraits>(0), 1);
+  EXPECT_EQ(store.get(routes[9]), kept);
+  EXPECT_FALSE(store.get(routes[0]));
+}
+
+TEST_F(SaiStoreTest, bulkSetUnsetsOptionalAttribute) {
+  auto& store = SaiStore::getInstance()->get<SaiRouteTraits>();
+  SaiStore::getInstance()->setSwitchId(0);
+  folly::CIDRNetwork dest(folly::IPAddress("10.10.10.0"), 24);
+  SaiRouteTraits::RouteEntry route(0, 0, dest);
+  auto existing = store.setObject(route, {SAI_PACKET_ACTION_FORWARD, 5});
+
+  std::vector<sai_status_t> statuses;
+  auto objects = store.bulkSetObjects(
+      {route}, {{SAI_PACKET_ACTION_DROP, std::nullopt}}, &statuses);
+  EXPECT_EQ(std::vector<sai_status_t>{SAI_STATUS_SUCCESS}, statuses);
+  EXPECT_EQ(existing, objects[0]);
+  EXPECT_FALSE(std::get<std::optional<SaiRouteTraits::Attributes::NextHopId>>(
+      existing->attributes()));
+  EXPECT_EQ(
+      saiApiTable->routeApi().getAttribute(
+          route, SaiRouteTraits::Attributes::NextHopId()),
+      SAI_NULL_OBJECT_ID);
+}
+
+TEST_F(SaiStoreTest, bulkRemoveKeepsFailedRoutes) {
+  auto& store = SaiStore::getInstance()->get<SaiRouteTraits>();
+  SaiStore::getInstance()->setSwitchId(0);
+  folly::CIDRNetwork dest1(folly::IPAddress("10.10.10.0"), 24);
+  folly::CIDRNetwork dest2(folly::IPAddress("10.10.20.0"), 24);
+  SaiRouteTraits::RouteEntry route1(0, 0, dest1);
+  SaiRouteTraits::RouteEntry route2(0, 0, dest2);
+  std::vector<std::shared_ptr<SaiRoute>> objects;
+  objects.push_back(store.setObject(route1, {SAI_PACKET_ACTION_DROP, 4}));
+  objects.push_back(store.setObject(route2, {SAI_PACKET_ACTION_DROP, 4}));
+  // Removing a route the adapter no longer has fails
+  saiApiTable->routeApi().remove(route2);
+
+  auto failed = store.bulkRemove(std::move(objects));
+  ASSERT_EQ(1, failed.size());
+  EXPECT_EQ(route2, failed[0]->adapterKey());
+  EXPECT_EQ(store.get(route2), failed[0]);
+  EXPECT_FALSE(store.get(route1));
+  failed[0]->release();
+}
@@ -51,15 +51,41 @@ template <typename NeighborEntryT>
 void SaiNeighborManager::changeNeighbor(
     const std::shared_ptr<NeighborEntryT>& oldSwEntry,
     const std::shared_ptr<NeighborEntryT>& newSwEntry) {
+  NeighborBatch batch;
+  changeNeighbor(oldSwEntry, newSwEntry, &batch);
+  programBatch(&batch);
+}
+
+template <typename NeighborEntryT>
+void SaiNeighborManager::addNeighbor(
+    const std::shared_ptr<NeighborEntryT>& swEntry) {
+  NeighborBatch batch;
+  addNeighbor(swEntry, &batch);
+  programBatch(&batch);
+}
+
+template <typename NeighborEntryT>
+void SaiNeighborManager::removeNeighbor(
+    const std::shared_ptr<NeighborEntryT>& swEntry) {
+  NeighborBatch batch;
+  removeNeighbor(swEntry, &batch);
+  programBatch(&batch);
+}
+
+template <typename NeighborEntryT>
+void SaiNeighborManager::changeNeighbor(
+    const std::shared_ptr<NeighborEntryT>& oldSwEntry,
+    const std::shared_ptr<NeighborEntryT>& newSwEntry,
+    NeighborBatch* batch) {
   if (oldSwEntry->isPending() && newSwEntry->isPending()) {
   }
   if (oldSwEntry->isPending() && !newSwEntry->isPending()) {
-    removeNeighbor(oldSwEntry);
-    addNeighbor(newSwEntry);
+    removeNeighbor(oldSwEntry, batch);
+    addNeighbor(newSwEntry, batch);
   }
   if (!oldSwEntry->isPending() && newSwEntry->isPending()) {
-    removeNeighbor(oldSwEntry);
-    addNeighbor(newSwEntry);
+    removeNeighbor(oldSwEntry, batch);
+    addNeighbor(newSwEntry, batch);
     // TODO(borisb): unresolve in next hop group...
   }
   if (!oldSwEntry->isPending() && !newSwEntry->isPending()) {
@@ -68,7 +94,8 @@ void SaiNeighborManager::changeNeighbor(
 
 template <typename NeighborEntryT>
 void SaiNeighborManager::addNeighbor(
-    const std::shared_ptr<NeighborEntryT>& swEntry) {
+    const std::shared_ptr<NeighborEntryT>& swEntry,
+    NeighborBatch* batch) {
   // Handle pending()
   XLOG(INFO) << "addNeighbor " << swEntry->getIP();
   auto saiEntry = saiEntryFromSwEntry(swEntry);
@@ -87,30 +114,22 @@ void SaiNeighborManager::addNeighbor(
       XLOG(INFO) << "skip link local neighbor " << swEntry->getIP();
       return;
     }
-    SaiNeighborTraits::CreateAttributes attributes{swEntry->getMac()};
-    auto& store = SaiStore::getInstance()->get<SaiNeighborTraits>();
     /*
      * program fdb entry before creating neighbor, neighbor requires fdb entry
      */
     auto fdbEntry = managerTable_->fdbManager().addFdbEntry(
         swEntry->getIntfID(), swEntry->getMac(), swEntry->getPort());
-    auto neighbor = store.setObject(saiEntry, attributes);
-    /* add next hop to discovered neighbor over */
-    auto nextHop = managerTable_->nextHopManager().addNextHop(
-        RouterInterfaceSaiId{saiEntry.routerInterfaceId()}, swEntry->getIP());
-    auto neighborHandle = std::make_unique<SaiNeighborHandle>();
-    neighborHandle->neighbor = neighbor;
-    neighborHandle->fdbEntry = fdbEntry;
-    neighborHandle->nextHop = nextHop;
-    handles_.emplace(saiEntry, std::move(neighborHandle));
-    managerTable_->nextHopGroupManager().handleResolvedNeighbor(
-        saiEntry, nextHop->adapterKey());
+    batch->added.push_back(saiEntry);
+    batch->addedAttributes.push_back(
+        SaiNeighborTraits::CreateAttributes{swEntry->getMac()});
+    batch->addedFdbEntries.push_back(std::move(fdbEntry));
   }
 }
 
 template <typename NeighborEntryT>
 void SaiNeighborManager::removeNeighbor(
-    const std::shared_ptr<NeighborEntryT>& swEntry) {
+    const std::shared_ptr<NeighborEntryT>& swEntry,
+    NeighborBatch* batch) {
   if (swEntry->getIP().version() == 6 && swEntry->getIP().isLinkLocal()) {
     /* TODO: investigate and fix adding link local neighbors */
     XLOG(INFO) << "skip link local neighbor " << swEntry->getIP();
@@ -119,11 +138,12 @@ void SaiNeighborManager::removeNeighbor(
 
   XLOG(INFO) << "removeNeighbor " << swEntry->getIP();
   auto saiEntry = saiEntryFromSwEntry(swEntry);
-  auto neighborHandle = getNeighborHandle(saiEntry);
-  if (neighborHandle) {
+  auto itr = handles_.find(saiEntry);
+  if (itr != handles_.end()) {
     managerTable_->nextHopGroupManager().handleUnresolvedNeighbor(
-        saiEntry, neighborHandle->nextHop->adapterKey());
-    handles_.erase(saiEntry);
+        saiEntry, itr->second->nextHop->adapterKey());
+    batch->removed.push_back(std::move(itr->second));
+    handles_.erase(itr);
   } else {
     auto count = unresolvedNeighbors_.erase(saiEntry);
     if (count == 0) {
@@ -134,23 +154,95 @@ void SaiNeighborManager::removeNeighbor(
   }
 }
 
+void SaiNeighborManager::programBatch(NeighborBatch* batch) {
+  auto& store = SaiStore::getInstance()->get<SaiNeighborTraits>();
+  std::vector<std::shared_ptr<SaiNeighbor>> removedNeighbors;
+  removedNeighbors.reserve(batch->removed.size());
+  folly::F14FastMap<
+      SaiNeighborTraits::NeighborEntry,
+      std::unique_ptr<SaiNeighborHandle>>
+      removedHandles;
+  for (auto& neighborHandle : batch->removed) {
+    // The next hop goes before the neighbor it points to. The fdb entry is
+    // kept until the neighbor which requires it is removed.
+    neighborHandle->nextHop.reset();
+    auto saiEntry = neighborHandle->neighbor->adapterKey();
+    removedNeighbors.push_back(std::move(neighborHandle->neighbor));
+    removedHandles.emplace(saiEntry, std::move(neighborHandle));
+  }
+  batch->removed.clear();
+  auto failedNeighbors = store.bulkRemove(std::move(removedNeighbors));
+  // A neighbor which failed to be removed is still programmed, so it gets
+  // its handle back, with a next hop over it again
+  for (auto& neighbor : failedNeighbors) {
+    auto itr = removedHandles.find(neighbor->adapterKey());
+    const auto& saiEntry = itr->first;
+    auto& neighborHandle = itr->second;
+    neighborHandle->neighbor = std::move(neighbor);
+    neighborHandle->nextHop = managerTable_->nextHopManager().addNextHop(
+        RouterInterfaceSaiId{saiEntry.routerInterfaceId()}, saiEntry.ip());
+    managerTable_->nextHopGroupManager().handleResolvedNeighbor(
+        saiEntry, neighborHandle->nextHop->adapterKey());
+    handles_.emplace(saiEntry, std::move(neighborHandle));
+  }
+  removedHandles.clear();
+
+  std::vector<sai_status_t> statuses;
+  auto neighbors =
+      store.bulkSetObjects(batch->added, batch->addedAttributes, &statuses);
+  size_t numFailed = 0;
+  for (size_t i = 0; i < batch->added.size(); ++i) {
+    if (statuses[i] != SAI_STATUS_SUCCESS) {
+      // Roll back the fdb entry programmed for the neighbor
+      batch->addedFdbEntries[i].reset();
+      ++numFailed;
+      continue;
+    }
+    const auto& saiEntry = batch->added[i];
+    /* add next hop to discovered neighbor over */
+    auto nextHop = managerTable_->nextHopManager().addNextHop(
+        RouterInterfaceSaiId{saiEntry.routerInterfaceId()}, saiEntry.ip());
+    auto neighborHandle = std::make_unique<SaiNeighborHandle>();
+    neighborHandle->neighbor = neighbors[i];
+    neighborHandle->fdbEntry = std::move(batch->addedFdbEntries[i]);
+    neighborHandle->nextHop = nextHop;
+    handles_.emplace(saiEntry, std::move(neighborHandle));
+    managerTable_->nextHopGroupManager().handleResolvedNeighbor(
+        saiEntry, nextHop->adapterKey());
+  }
+  if (numFailed || !failedNeighbors.empty()) {
+    throw FbossError(
+        "Failed to program ",
+        numFailed,
+        " of ",
+        batch->added.size(),
+        " neighbors and to remove ",
+        failedNeighbors.size(),
+        " neighbors");
+  }
+}
+
 void SaiNeighborManager::processNeighborDelta(const StateDelta& delta) {
+  // Neighbors are added and removed in bulk once the whole delta is walked
+  NeighborBatch batch;
   for (const auto& vlanDelta : delta.getVlansDelta()) {
-    auto processChanged =
-        [this](const auto& oldNeighbor, const auto& newNeighbor) {
-          changeNeighbor(oldNeighbor, newNeighbor);
-        };
-    auto processAdded = [this](const auto& newNeighbor) {
-      addNeighbor(newNeighbor);
+    auto processChanged = [this, &batch](
+                              const auto& oldNeighbor,
+                              const auto& newNeighbor) {
+      changeNeighbor(oldNeighbor, newNeighbor, &batch);
+    };
+    auto processAdded = [this, &batch](const auto& newNeighbor) {
+      addNeighbor(newNeighbor, &batch);
     };
-    auto processRemoved = [this](const auto& oldNeighbor) {
-      removeNeighbor(oldNeighbor);
+    auto processRemoved = [this, &batch](const auto& oldNeighbor) {
+      removeNeighbor(oldNeighbor, &batch);
     };
     DeltaFunctions::forEachChanged(
         vlanDelta.getArpDelta(), processChanged, processAdded, processRemoved);
     DeltaFunctions::forEachChanged(
         vlanDelta.getNdpDelta(), processChanged, processAdded, processRemoved);
   }
+  programBatch(&batch);
 }
 
 void SaiNeighborManager::clear() {
@@ -66,6 +66,35 @@ class SaiNeighborManager {
   void clear();
 
  private:
+  /*
+   * Neighbors to add and remove, collected while walking a delta so that
+   * they can be programmed with bulk SAI calls.
+   */
+  struct NeighborBatch {
+    std::vector<SaiNeighborTraits::NeighborEntry> added;
+    std::vector<SaiNeighborTraits::CreateAttributes> addedAttributes;
+    std::vector<std::shared_ptr<SaiFdbEntry>> addedFdbEntries;
+    std::vector<std::unique_ptr<SaiNeighborHandle>> removed;
+  };
+
+  template <typename NeighborEntryT>
+  void changeNeighbor(
+      const std::shared_ptr<NeighborEntryT>& oldSwEntry,
+      const std::shared_ptr<NeighborEntryT>& newSwEntry,
+      NeighborBatch* batch);
+
+  template <typename NeighborEntryT>
+  void addNeighbor(
+      const std::shared_ptr<NeighborEntryT>& swEntry,
+      NeighborBatch* batch);
+
+  template <typename NeighborEntryT>
+  void removeNeighbor(
+      const std::shared_ptr<NeighborEntryT>& swEntry,
+      NeighborBatch* batch);
+
+  void programBatch(NeighborBatch* batch);
+
   SaiNeighborHandle* getNeighborHandleImpl(
       const SaiNeighborTraits::NeighborEntry& entry) const;
   SaiManagerTable* managerTable_;
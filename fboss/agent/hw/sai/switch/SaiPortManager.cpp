@@ -22,8 +22,21 @@
 #include "fboss/lib/phy/gen-cpp2/phy_types.h"
 #include "fboss/qsfp_service/if/gen-cpp2/transceiver_types.h"
 
+#include <fb303/ServiceData.h>
 #include <folly/logging/xlog.h>
 
+#include <chrono>
+
+DEFINE_bool(
+    sai_stats_read_and_clear,
+    false,
+    "Read port and queue counters with SAI_STATS_MODE_READ_AND_CLEAR, where "
+    "the adapter supports it");
+
+namespace {
+constexpr auto kStatsCollectionUs = "sai_stats_collection_us";
+} // namespace
+
 namespace facebook::fboss {
 
 sai_port_flow_control_mode_t getSaiPortPauseMode(cfg::PortPause pause) {
@@ -138,7 +151,10 @@ SaiPortManager::SaiPortManager(
     ConcurrentIndices* concurrentIndices)
     : managerTable_(managerTable),
       platform_(platform),
-      concurrentIndices_(concurrentIndices) {}
+      concurrentIndices_(concurrentIndices),
+      statsMode_(
+          FLAGS_sai_stats_read_and_clear ? SAI_STATS_MODE_READ_AND_CLEAR
+                                         : SaiPortTraits::CounterMode) {}
 
 void SaiPortManager::loadPortQueues(SaiPortHandle* portHandle) {
   std::vector<sai_object_id_t> queueList;
@@ -338,23 +354,37 @@ void SaiPortManager::processPortDelta(const StateDelta& stateDelta) {
       delta, processChanged, processAdded, processRemoved);
 }
 
-void SaiPortManager::updateStats() const {
+void SaiPortManager::updateStats() {
+  auto start = std::chrono::steady_clock::now();
+  // Read one object type at a time, all ports and then all queues
+  for (const auto& [portId, handle] : handles_) {
+    statsMode_ = handle->port->updateStats(statsMode_);
+  }
   for (const auto& [portId, handle] : handles_) {
-    handle->port->updateStats();
     managerTable_->queueManager().updateStats(handle->queues);
   }
-}
 
-std::map<PortID, HwPortStats> SaiPortManager::getPortStats() const {
-  std::map<PortID, HwPortStats> portStats;
+  auto portStats = std::make_shared<std::map<PortID, HwPortStats>>();
   for (const auto& [portId, handle] : handles_) {
     auto counters = handle->port->getStats();
     HwPortStats hwPortStats;
     fillHwPortStats(counters, hwPortStats);
     managerTable_->queueManager().getStats(handle->queues, hwPortStats);
-    portStats.emplace(portId, hwPortStats);
+    portStats->emplace(portId, std::move(hwPortStats));
+  }
+  portStats_.store(std::move(portStats));
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  fb303::fbData->setCounter(kStatsCollectionUs, elapsed.count());
+}
+
+std::map<PortID, HwPortStats> SaiPortManager::getPortStats() const {
+  auto portStats = portStats_.load();
+  if (!portStats) {
+    return {};
   }
-  return portStats;
+  return *portStats;
 }
 
 } // namespace facebook::fboss
@@ -20,6 +20,7 @@
 #include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/types.h"
 
+#include "folly/concurrency/AtomicSharedPtr.h"
 #include "folly/container/F14Map.h"
 
 namespace facebook::fboss {
@@ -66,7 +67,15 @@ class SaiPortManager {
       PortID swId,
       const SaiQueueConfig& saiQueueConfig);
   void processPortDelta(const StateDelta& stateDelta);
-  void updateStats() const;
+  /*
+   * Read the counters of all ports, then of all their queues, and publish
+   * them as a new snapshot for getPortStats().
+   */
+  void updateStats();
+  /*
+   * Returns the last published snapshot, without waiting for a collection
+   * in progress.
+   */
   std::map<PortID, HwPortStats> getPortStats() const;
   PortSaiId addCpuPort(PortID portId);
   void changeQueue(
@@ -84,6 +93,8 @@ class SaiPortManager {
   SaiPlatform* platform_;
   ConcurrentIndices* concurrentIndices_;
   folly::F14FastMap<PortID, std::unique_ptr<SaiPortHandle>> handles_;
+  sai_stats_mode_t statsMode_;
+  folly::atomic_shared_ptr<const std::map<PortID, HwPortStats>> portStats_;
 };
 
 } // namespace facebook::fboss
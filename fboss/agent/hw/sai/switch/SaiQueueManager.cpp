@@ -15,6 +15,8 @@
 #include "fboss/agent/hw/sai/switch/SaiSwitchManager.h"
 #include "fboss/lib/TupleUtils.h"
 
+DECLARE_bool(sai_stats_read_and_clear);
+
 namespace facebook::fboss {
 
 namespace detail {
@@ -68,7 +70,11 @@ void fillHwQueueStats(
 SaiQueueManager::SaiQueueManager(
     SaiManagerTable* managerTable,
     const SaiPlatform* platform)
-    : managerTable_(managerTable), platform_(platform) {}
+    : managerTable_(managerTable),
+      platform_(platform),
+      statsMode_(
+          FLAGS_sai_stats_read_and_clear ? SAI_STATS_MODE_READ_AND_CLEAR
+                                         : SaiQueueTraits::CounterMode) {}
 
 void SaiQueueManager::changeQueue(
     SaiQueueHandle* queueHandle,
@@ -137,7 +143,7 @@ SaiQueueHandles SaiQueueManager::loadQueues(
 
 void SaiQueueManager::updateStats(SaiQueueHandles& queueHandles) {
   for (auto& queueHandle : queueHandles) {
-    queueHandle.second->queue->updateStats();
+    statsMode_ = queueHandle.second->queue->updateStats(statsMode_);
   }
 }
 
@@ -56,6 +56,7 @@ class SaiQueueManager {
  private:
   SaiManagerTable* managerTable_;
   const SaiPlatform* platform_;
+  sai_stats_mode_t statsMode_;
 };
 
 } // namespace facebook::fboss
@@ -95,15 +95,12 @@ std::vector<std::shared_ptr<SaiRoute>> SaiRouteManager::makeInterfaceToMeRoutes(
 }
 
 template <typename AddrT>
-void SaiRouteManager::addOrUpdateRoute(
-    SaiRouteHandle* routeHandle,
-    RouterID routerId,
-    const std::shared_ptr<Route<AddrT>>& swRoute) {
-  SaiRouteTraits::RouteEntry entry = routeEntryFromSwRoute(routerId, swRoute);
+SaiRouteTraits::CreateAttributes SaiRouteManager::routeAttributes(
+    const std::shared_ptr<Route<AddrT>>& swRoute,
+    std::shared_ptr<SaiNextHopGroupHandle>* nextHopGroupHandle) {
   auto fwd = swRoute->getForwardInfo();
   sai_int32_t packetAction;
   std::optional<SaiRouteTraits::CreateAttributes> attributes;
-  std::shared_ptr<SaiNextHopGroupHandle> nextHopGroupHandle;
 
   if (fwd.getAction() == NEXTHOPS) {
     packetAction = SAI_PACKET_ACTION_FORWARD;
@@ -137,11 +134,11 @@ void SaiRouteManager::addOrUpdateRoute(
        * SaiNextHopGroup corresponding to ECMP over those next hops. When no
        * route refers to a next hop set, it will be removed in SAI as well.
        */
-      nextHopGroupHandle =
+      *nextHopGroupHandle =
           managerTable_->nextHopGroupManager().incRefOrAddNextHopGroup(
               fwd.getNextHopSet());
       NextHopGroupSaiId nextHopGroupId{
-          nextHopGroupHandle->nextHopGroup->adapterKey()};
+          (*nextHopGroupHandle)->nextHopGroup->adapterKey()};
       attributes = SaiRouteTraits::CreateAttributes{packetAction,
                                                     std::move(nextHopGroupId)};
     }
@@ -156,8 +153,19 @@ void SaiRouteManager::addOrUpdateRoute(
     packetAction = SAI_PACKET_ACTION_DROP;
     attributes = SaiRouteTraits::CreateAttributes{packetAction, std::nullopt};
   }
+  return attributes.value();
+}
+
+template <typename AddrT>
+void SaiRouteManager::addOrUpdateRoute(
+    SaiRouteHandle* routeHandle,
+    RouterID routerId,
+    const std::shared_ptr<Route<AddrT>>& swRoute) {
+  SaiRouteTraits::RouteEntry entry = routeEntryFromSwRoute(routerId, swRoute);
+  std::shared_ptr<SaiNextHopGroupHandle> nextHopGroupHandle;
+  auto attributes = routeAttributes(swRoute, &nextHopGroupHandle);
   auto& store = SaiStore::getInstance()->get<SaiRouteTraits>();
-  auto route = store.setObject(entry, attributes.value());
+  auto route = store.setObject(entry, attributes);
   routeHandle->route = route;
   routeHandle->nextHopGroupHandle = nextHopGroupHandle;
 }
@@ -191,6 +199,17 @@ void SaiRouteManager::removeRoute(
 }
 
 void SaiRouteManager::processRouteDelta(const StateDelta& delta) {
+  /*
+   * Rather than programming routes one at a time, first compute the SAI
+   * attributes of all the added and changed routes in the delta, then remove
+   * the removed routes with one bulk remove and create or update the rest
+   * with one bulk create and a bulk set per attribute.
+   */
+  std::vector<SaiRouteTraits::RouteEntry> entries;
+  std::vector<SaiRouteTraits::CreateAttributes> attributes;
+  std::vector<std::shared_ptr<SaiNextHopGroupHandle>> nextHopGroupHandles;
+  folly::F14FastMap<SaiRouteTraits::RouteEntry, std::unique_ptr<SaiRouteHandle>>
+      removedHandles;
   for (const auto& routeDelta : delta.getRouteTablesDelta()) {
     RouterID routerId;
     if (routeDelta.getOld()) {
@@ -198,15 +217,40 @@ void SaiRouteManager::processRouteDelta(const StateDelta& delta) {
     } else {
       routerId = routeDelta.getNew()->getID();
     }
-    auto processChanged = [this, routerId](
-                              const auto& oldRoute, const auto& newRoute) {
-      changeRoute(routerId, oldRoute, newRoute);
+    auto addOrUpdate = [&](const auto& swRoute) {
+      entries.push_back(routeEntryFromSwRoute(routerId, swRoute));
+      nextHopGroupHandles.emplace_back();
+      attributes.push_back(
+          routeAttributes(swRoute, &nextHopGroupHandles.back()));
+    };
+    auto processChanged = [&](const auto& /* oldRoute */,
+                              const auto& newRoute) {
+      if (handles_.find(routeEntryFromSwRoute(routerId, newRoute)) ==
+          handles_.end()) {
+        throw FbossError(
+            "Failure to update route. Route does not exist ",
+            newRoute->prefix().str());
+      }
+      addOrUpdate(newRoute);
     };
-    auto processAdded = [this, routerId](const auto& newRoute) {
-      addRoute(routerId, newRoute);
+    auto processAdded = [&](const auto& newRoute) {
+      if (handles_.find(routeEntryFromSwRoute(routerId, newRoute)) !=
+          handles_.end()) {
+        throw FbossError(
+            "Failure to add route. A route already exists to ",
+            newRoute->prefix().str());
+      }
+      addOrUpdate(newRoute);
     };
-    auto processRemoved = [this, routerId](const auto& oldRoute) {
-      removeRoute(routerId, oldRoute);
+    auto processRemoved = [&](const auto& oldRoute) {
+      auto itr = handles_.find(routeEntryFromSwRoute(routerId, oldRoute));
+      if (itr == handles_.end()) {
+        throw FbossError(
+            "Failed to remove non-existent route to ",
+            oldRoute->prefix().str());
+      }
+      removedHandles.emplace(itr->first, std::move(itr->second));
+      handles_.erase(itr);
     };
     DeltaFunctions::forEachChanged(
         routeDelta.getRoutesV4Delta(),
@@ -219,6 +263,51 @@ void SaiRouteManager::processRouteDelta(const StateDelta& delta) {
         processAdded,
         processRemoved);
   }
+
+  auto& store = SaiStore::getInstance()->get<SaiRouteTraits>();
+  std::vector<std::shared_ptr<SaiRoute>> removedRoutes;
+  removedRoutes.reserve(removedHandles.size());
+  for (auto& entryAndHandle : removedHandles) {
+    removedRoutes.push_back(std::move(entryAndHandle.second->route));
+  }
+  auto failedRoutes = store.bulkRemove(std::move(removedRoutes));
+  // A route which failed to be removed is still programmed, so it keeps its
+  // handle along with the next hop group it points to
+  for (auto& route : failedRoutes) {
+    auto itr = removedHandles.find(route->adapterKey());
+    itr->second->route = std::move(route);
+    handles_.emplace(itr->first, std::move(itr->second));
+    removedHandles.erase(itr);
+  }
+  // Next hop groups only used by the removed routes go away here
+  removedHandles.clear();
+
+  std::vector<sai_status_t> statuses;
+  auto routes = store.bulkSetObjects(entries, attributes, &statuses);
+  size_t numFailed = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (statuses[i] != SAI_STATUS_SUCCESS) {
+      // A route which failed to be updated keeps its old handle
+      ++numFailed;
+      continue;
+    }
+    auto& routeHandle = handles_[entries[i]];
+    if (!routeHandle) {
+      routeHandle = std::make_unique<SaiRouteHandle>();
+    }
+    routeHandle->route = routes[i];
+    routeHandle->nextHopGroupHandle = std::move(nextHopGroupHandles[i]);
+  }
+  if (numFailed || !failedRoutes.empty()) {
+    throw FbossError(
+        "Failed to program ",
+        numFailed,
+        " of ",
+        entries.size(),
+        " routes and to remove ",
+        failedRoutes.size(),
+        " routes");
+  }
 }
 
 SaiRouteHandle* SaiRouteManager::getRouteHandle(
@@ -74,6 +74,10 @@ class SaiRouteManager {
   SaiRouteHandle* getRouteHandleImpl(
       const SaiRouteTraits::RouteEntry& entry) const;
   template <typename AddrT>
+  SaiRouteTraits::CreateAttributes routeAttributes(
+      const std::shared_ptr<Route<AddrT>>& swRoute,
+      std::shared_ptr<SaiNextHopGroupHandle>* nextHopGroupHandle);
+  template <typename AddrT>
   void addOrUpdateRoute(
       SaiRouteHandle* routeHandle,
       RouterID routerId,
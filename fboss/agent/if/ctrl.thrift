@@ -375,11 +375,15 @@ enum CpuCosQueueId {
 
 struct RxCaptureFilter {
   1: list<CpuCosQueueId> cosQueues
+  # Ports the packet was received on
+  2: list<i32> srcPorts
   # can put additional Rx filters here if need be
 }
 
 struct CaptureFilter {
   1: RxCaptureFilter rxCaptureFilter;
+  # Ethertypes to capture, after any 802.1q tag. Empty captures all.
+  2: list<i32> etherTypes
 }
 
 struct CaptureInfo {
@@ -399,6 +403,11 @@ struct CaptureInfo {
    * set of criteria that packet must meet to be captured
    */
   4: CaptureFilter  filter
+  /*
+   * Only write the first snaplen bytes of each packet. 0 writes whole
+   * packets.
+   */
+  5: i32 snaplen = 0
 }
 
 struct RouteUpdateLoggingInfo {
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/packet/SflowDatagramBuilder.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+using namespace folly;
+using namespace folly::io;
+
+namespace facebook::fboss {
+
+namespace sflow {
+
+namespace {
+
+// Size of opaque data of length len, once padded to XDR blocks
+uint32_t xdrOpaqueSize(uint32_t len) {
+  return (len + XDR_BASIC_BLOCK_SIZE - 1) / XDR_BASIC_BLOCK_SIZE *
+      XDR_BASIC_BLOCK_SIZE;
+}
+
+template <typename Record>
+uint32_t paddedRecordSize(const Record& record, uint32_t dataLen) {
+  return record.size() - dataLen + xdrOpaqueSize(dataLen);
+}
+
+} // namespace
+
+DatagramBuilder::DatagramBuilder(
+    const folly::IPAddress& agentAddress,
+    uint32_t subAgentID,
+    uint32_t maxDatagramSize)
+    : agentAddress_(agentAddress),
+      subAgentID_(subAgentID),
+      maxDatagramSize_(maxDatagramSize),
+      headerSize_(
+          4 /* version */ + sizeIP(agentAddress) + 4 /* subAgentID */ +
+          4 /* sequenceNumber */ + 4 /* uptime */ + 4 /* samplesCnt */) {
+  reset();
+}
+
+bool DatagramBuilder::addFlowSample(const FlowSample& sample) {
+  uint32_t recordsSize = 0;
+  for (int i = 0; i < sample.flowRecordsCnt; i++) {
+    const auto& record = sample.flowRecords[i];
+    recordsSize += paddedRecordSize(record, record.flowDataLen);
+  }
+  return addSample(kFlowSampleFormat, sample, sample.size(recordsSize));
+}
+
+bool DatagramBuilder::addCountersSample(const CountersSample& sample) {
+  uint32_t recordsSize = 0;
+  for (int i = 0; i < sample.counterRecordsCnt; i++) {
+    const auto& record = sample.counterRecords[i];
+    recordsSize += paddedRecordSize(record, record.counterDataLen);
+  }
+  return addSample(kCountersSampleFormat, sample, sample.size(recordsSize));
+}
+
+template <typename Sample>
+bool DatagramBuilder::addSample(
+    DataFormat sampleType,
+    const Sample& sample,
+    uint32_t size) {
+  // The records are padded, so the sample needs no padding of its own
+  DCHECK_EQ(0, size % XDR_BASIC_BLOCK_SIZE);
+  uint64_t recordSize = 4 /* sampleType */ + 4 /* sampleDataLen */ + size;
+  if (headerSize_ + buf_->length() + recordSize > maxDatagramSize_) {
+    return false;
+  }
+  auto offset = buf_->length();
+  buf_->append(recordSize);
+  RWPrivateCursor cursor(buf_.get());
+  cursor.skip(offset);
+  // Serialize the sample in place rather than through SampleRecord, which
+  // would need it serialized into a buffer of its own first
+  serializeDataFormat(&cursor, sampleType);
+  cursor.writeBE<uint32_t>(size);
+  sample.serialize(&cursor);
+  DCHECK(cursor.isAtEnd());
+  ++numSamples_;
+  return true;
+}
+
+std::unique_ptr<IOBuf> DatagramBuilder::finish(
+    uint32_t sequenceNumber,
+    uint32_t uptime) {
+  auto datagram = std::move(buf_);
+  datagram->prepend(headerSize_);
+  RWPrivateCursor cursor(datagram.get());
+  cursor.writeBE<uint32_t>(SampleDatagram::VERSION5);
+  serializeIP(&cursor, agentAddress_);
+  cursor.writeBE<uint32_t>(subAgentID_);
+  cursor.writeBE<uint32_t>(sequenceNumber);
+  cursor.writeBE<uint32_t>(uptime);
+  cursor.writeBE<uint32_t>(numSamples_);
+  reset();
+  return datagram;
+}
+
+void DatagramBuilder::reset() {
+  buf_ = IOBuf::create(std::max(maxDatagramSize_, headerSize_));
+  buf_->advance(headerSize_);
+  numSamples_ = 0;
+}
+
+} // namespace sflow
+
+} // namespace facebook::fboss
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/packet/SflowStructs.h"
+
+#include <folly/IPAddress.h>
+#include <folly/io/IOBuf.h>
+
+#include <memory>
+
+namespace facebook::fboss {
+
+namespace sflow {
+
+/*
+ * DatagramBuilder packs flow and counter samples into sFlow v5 datagrams
+ * of at most maxDatagramSize bytes, so that a collector gets many samples
+ * per UDP packet rather than one.
+ *
+ * Samples are serialized as they are added, into a buffer which has room
+ * for the datagram header in front of them, so finish() only writes the
+ * header and hands out the buffer.
+ */
+class DatagramBuilder {
+ public:
+  DatagramBuilder(
+      const folly::IPAddress& agentAddress,
+      uint32_t subAgentID,
+      uint32_t maxDatagramSize);
+
+  /*
+   * Append a sample to the datagram. Returns false, leaving the datagram
+   * untouched, if the sample does not fit in what is left of it.
+   */
+  bool addFlowSample(const FlowSample& sample);
+  bool addCountersSample(const CountersSample& sample);
+
+  /*
+   * Write the datagram header and return the datagram with the samples
+   * added so far. The builder is then empty, ready for the next datagram.
+   */
+  std::unique_ptr<folly::IOBuf> finish(
+      uint32_t sequenceNumber,
+      uint32_t uptime);
+
+  uint32_t numSamples() const {
+    return numSamples_;
+  }
+  bool empty() const {
+    return numSamples_ == 0;
+  }
+  uint32_t headerSize() const {
+    return headerSize_;
+  }
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  DatagramBuilder(DatagramBuilder const&) = delete;
+  DatagramBuilder& operator=(DatagramBuilder const&) = delete;
+
+  template <typename Sample>
+  bool addSample(DataFormat sampleType, const Sample& sample, uint32_t size);
+  void reset();
+
+  const folly::IPAddress agentAddress_;
+  const uint32_t subAgentID_;
+  const uint32_t maxDatagramSize_;
+  const uint32_t headerSize_;
+  std::unique_ptr<folly::IOBuf> buf_;
+  uint32_t numSamples_{0};
+};
+
+} // namespace sflow
+
+} // namespace facebook::fboss
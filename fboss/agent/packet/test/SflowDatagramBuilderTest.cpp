@@ -0,0 +1,197 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include <folly/IPAddress.h>
+
+#include "fboss/agent/packet/SflowDatagramBuilder.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace facebook::fboss;
+using folly::IOBuf;
+using folly::io::Cursor;
+using folly::io::RWPrivateCursor;
+
+namespace {
+
+const folly::IPAddress kAgentIP("2401:db00:116:3016::1b");
+
+// Serialize obj into a buffer of its own
+template <typename T>
+std::vector<uint8_t> serialize(const T& obj) {
+  std::vector<uint8_t> bytes(1024);
+  auto buf = IOBuf::wrapBuffer(bytes.data(), bytes.size());
+  RWPrivateCursor cursor(buf.get());
+  obj.serialize(&cursor);
+  bytes.resize(bytes.size() - cursor.length());
+  return bytes;
+}
+
+class FlowSampleMaker {
+ public:
+  explicit FlowSampleMaker(uint32_t headerLength)
+      : headerData_(headerLength, 15) {
+    sflow::SampledHeader hdr;
+    hdr.protocol = sflow::HeaderProtocol::ETHERNET_ISO88023;
+    hdr.frameLength = 1500;
+    hdr.stripped = 0;
+    hdr.headerLength = headerLength;
+    hdr.header = headerData_.data();
+    hdrBytes_ = serialize(hdr);
+
+    record_.flowFormat = sflow::kSampledHeaderFormat;
+    record_.flowDataLen = hdrBytes_.size();
+    record_.flowData = hdrBytes_.data();
+
+    sample_.sequenceNumber = 1;
+    sample_.sourceID = 56;
+    sample_.samplingRate = 123;
+    sample_.samplePool = 123;
+    sample_.drops = 0;
+    sample_.input = 56;
+    sample_.output = 6;
+    sample_.flowRecordsCnt = 1;
+    sample_.flowRecords = &record_;
+  }
+
+  const sflow::FlowSample& sample() const {
+    return sample_;
+  }
+
+ private:
+  std::vector<uint8_t> headerData_;
+  std::vector<uint8_t> hdrBytes_;
+  sflow::FlowRecord record_;
+  sflow::FlowSample sample_;
+};
+
+std::vector<uint8_t> toBytes(IOBuf& buf) {
+  auto range = buf.coalesce();
+  return std::vector<uint8_t>(range.begin(), range.end());
+}
+
+} // namespace
+
+TEST(SflowDatagramBuilderTest, HeaderSize) {
+  EXPECT_EQ(40, sflow::DatagramBuilder(kAgentIP, 0, 1400).headerSize());
+  EXPECT_EQ(
+      28,
+      sflow::DatagramBuilder(folly::IPAddress("10.0.0.1"), 0, 1400)
+          .headerSize());
+}
+
+TEST(SflowDatagramBuilderTest, MatchesSampleDatagram) {
+  FlowSampleMaker maker1(11);
+  FlowSampleMaker maker2(64);
+  sflow::DatagramBuilder builder(kAgentIP, 3, 1400);
+  EXPECT_TRUE(builder.empty());
+  EXPECT_TRUE(builder.addFlowSample(maker1.sample()));
+  EXPECT_TRUE(builder.addFlowSample(maker2.sample()));
+  EXPECT_EQ(2, builder.numSamples());
+  auto datagram = builder.finish(7, 1000);
+  EXPECT_TRUE(builder.empty());
+
+  // Serialize the same samples the way the structs do on their own
+  auto sample1 = serialize(maker1.sample());
+  auto sample2 = serialize(maker2.sample());
+  sflow::SampleRecord records[2];
+  records[0].sampleType = sflow::kFlowSampleFormat;
+  records[0].sampleDataLen = sample1.size();
+  records[0].sampleData = sample1.data();
+  records[1].sampleType = sflow::kFlowSampleFormat;
+  records[1].sampleDataLen = sample2.size();
+  records[1].sampleData = sample2.data();
+  sflow::SampleDatagram expected;
+  expected.datagramV5.agentAddress = kAgentIP;
+  expected.datagramV5.subAgentID = 3;
+  expected.datagramV5.sequenceNumber = 7;
+  expected.datagramV5.uptime = 1000;
+  expected.datagramV5.samplesCnt = 2;
+  expected.datagramV5.samples = records;
+
+  auto expectedBytes = serialize(expected);
+  EXPECT_EQ(
+      expected.size(records[0].size() + records[1].size()),
+      expectedBytes.size());
+  EXPECT_EQ(expectedBytes, toBytes(*datagram));
+}
+
+TEST(SflowDatagramBuilderTest, MaxDatagramSize) {
+  // 20 bytes of sampled header make for an 84 byte sample record
+  FlowSampleMaker maker(20);
+  sflow::DatagramBuilder builder(kAgentIP, 0, 40 + 2 * 84);
+  EXPECT_TRUE(builder.addFlowSample(maker.sample()));
+  EXPECT_TRUE(builder.addFlowSample(maker.sample()));
+  EXPECT_FALSE(builder.addFlowSample(maker.sample()));
+  EXPECT_EQ(2, builder.numSamples());
+
+  auto datagram = builder.finish(0, 0);
+  EXPECT_EQ(40 + 2 * 84, datagram->computeChainDataLength());
+  // The samples that did not fit go in the next datagram
+  EXPECT_TRUE(builder.addFlowSample(maker.sample()));
+  EXPECT_EQ(40 + 84, builder.finish(1, 0)->computeChainDataLength());
+
+  // Nothing fits in a datagram smaller than a sample
+  sflow::DatagramBuilder small(kAgentIP, 0, 100);
+  EXPECT_FALSE(small.addFlowSample(maker.sample()));
+  EXPECT_TRUE(small.empty());
+}
+
+TEST(SflowDatagramBuilderTest, CountersSample) {
+  sflow::IfCounters counters{};
+  counters.ifIndex = 56;
+  counters.ifType = 6;
+  counters.ifSpeed = 100000000000;
+  counters.ifInOctets = 0x0102030405060708;
+  counters.ifOutErrors = 9;
+  EXPECT_EQ(88, counters.size());
+  auto countersBytes = serialize(counters);
+  ASSERT_EQ(88, countersBytes.size());
+
+  sflow::CounterRecord record;
+  record.counterFormat = sflow::kIfCountersFormat;
+  record.counterDataLen = countersBytes.size();
+  record.counterData = countersBytes.data();
+  sflow::CountersSample sample;
+  sample.sequenceNumber = 5;
+  sample.sourceID = 56;
+  sample.counterRecordsCnt = 1;
+  sample.counterRecords = &record;
+
+  sflow::DatagramBuilder builder(folly::IPAddress("10.0.0.1"), 0, 1400);
+  EXPECT_TRUE(builder.addCountersSample(sample));
+  auto datagram = builder.finish(1, 2);
+  ASSERT_EQ(28 + 8 + 12 + 8 + 88, datagram->computeChainDataLength());
+
+  Cursor cursor(datagram.get());
+  EXPECT_EQ(5, cursor.readBE<uint32_t>()); // version
+  EXPECT_EQ(1, cursor.readBE<uint32_t>()); // ipv4 type = 1
+  EXPECT_EQ(0x0a000001, cursor.readBE<uint32_t>()); // ipv4 addr
+  cursor.skip(8); // sub agent, seq no.
+  EXPECT_EQ(2, cursor.readBE<uint32_t>()); // uptime
+  EXPECT_EQ(1, cursor.readBE<uint32_t>()); // sample cnt
+  EXPECT_EQ(sflow::kCountersSampleFormat, cursor.readBE<uint32_t>());
+  EXPECT_EQ(12 + 8 + 88, cursor.readBE<uint32_t>()); // data length
+  EXPECT_EQ(5, cursor.readBE<uint32_t>()); // seq no.
+  EXPECT_EQ(56, cursor.readBE<uint32_t>()); // source ID
+  EXPECT_EQ(1, cursor.readBE<uint32_t>()); // record cnt
+  EXPECT_EQ(sflow::kIfCountersFormat, cursor.readBE<uint32_t>());
+  EXPECT_EQ(88, cursor.readBE<uint32_t>()); // counter data length
+  EXPECT_EQ(56, cursor.readBE<uint32_t>()); // ifIndex
+  EXPECT_EQ(6, cursor.readBE<uint32_t>()); // ifType
+  EXPECT_EQ(100000000000, cursor.readBE<uint64_t>()); // ifSpeed
+  cursor.skip(8); // ifDirection, ifStatus
+  EXPECT_EQ(0x0102030405060708, cursor.readBE<uint64_t>()); // ifInOctets
+  cursor.skip(24 + 8 + 16); // in counters, ifOutOctets, out counters
+  EXPECT_EQ(9, cursor.readBE<uint32_t>()); // ifOutErrors
+  EXPECT_EQ(0, cursor.readBE<uint32_t>()); // ifPromiscuousMode
+  EXPECT_TRUE(cursor.isAtEnd());
+}
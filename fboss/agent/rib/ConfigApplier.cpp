@@ -21,6 +21,7 @@ ConfigApplier::ConfigApplier(
     RouterID vrf,
     IPv4NetworkToRouteMap* v4NetworkToRoute,
     IPv6NetworkToRouteMap* v6NetworkToRoute,
+    NextHopDependencyIndex* nextHopDependencies,
     folly::Range<DirectlyConnectedRouteIterator> directlyConnectedRouteRange,
     folly::Range<StaticRouteNoNextHopsIterator> staticCpuRouteRange,
     folly::Range<StaticRouteNoNextHopsIterator> staticDropRouteRange,
@@ -30,6 +31,7 @@ ConfigApplier::ConfigApplier(
     : vrf_(vrf),
       v4NetworkToRoute_(v4NetworkToRoute),
       v6NetworkToRoute_(v6NetworkToRoute),
+      nextHopDependencies_(nextHopDependencies),
       directlyConnectedRouteRange_(directlyConnectedRouteRange),
       staticCpuRouteRange_(staticCpuRouteRange),
       staticDropRouteRange_(staticDropRouteRange),
@@ -41,7 +43,8 @@ ConfigApplier::ConfigApplier(
 }
 
 void ConfigApplier::updateRibAndFib() {
-  RouteUpdater updater(v4NetworkToRoute_, v6NetworkToRoute_);
+  RouteUpdater updater(
+      v4NetworkToRoute_, v6NetworkToRoute_, nextHopDependencies_);
 
   // Enable ALPM
   updater.addRoute(
@@ -107,7 +110,12 @@ void ConfigApplier::updateRibAndFib() {
   // Trigger recrusive resolution
   updater.updateDone();
 
-  fibUpdateCallback_(vrf_, *v4NetworkToRoute_, *v6NetworkToRoute_, cookie_);
+  fibUpdateCallback_(
+      vrf_,
+      *v4NetworkToRoute_,
+      *v6NetworkToRoute_,
+      updater.getAffectedPrefixes(),
+      cookie_);
 }
 
 void ConfigApplier::addInterfaceRoutes(
@@ -46,6 +46,7 @@ class ConfigApplier {
       RouterID vrf,
       IPv4NetworkToRouteMap* v4RouteTable,
       IPv6NetworkToRouteMap* v6RouteTable,
+      NextHopDependencyIndex* nextHopDependencies,
       folly::Range<DirectlyConnectedRouteIterator> directlyConnectedRouteRange,
       folly::Range<StaticRouteNoNextHopsIterator> staticCpuRouteRange,
       folly::Range<StaticRouteNoNextHopsIterator> staticDropRouteRange,
@@ -64,6 +65,7 @@ class ConfigApplier {
   RouterID vrf_;
   IPv4NetworkToRouteMap* v4NetworkToRoute_;
   IPv6NetworkToRouteMap* v6NetworkToRoute_;
+  NextHopDependencyIndex* nextHopDependencies_;
   folly::Range<DirectlyConnectedRouteIterator> directlyConnectedRouteRange_;
   folly::Range<StaticRouteNoNextHopsIterator> staticCpuRouteRange_;
   folly::Range<StaticRouteNoNextHopsIterator> staticDropRouteRange_;
@@ -17,19 +17,24 @@
 #include <folly/logging/xlog.h>
 
 #include <algorithm>
+#include <type_traits>
 
 namespace facebook::fboss::rib {
 
 ForwardingInformationBaseUpdater::ForwardingInformationBaseUpdater(
     RouterID vrf,
     const IPv4NetworkToRouteMap& v4NetworkToRoute,
-    const IPv6NetworkToRouteMap& v6NetworkToRoute)
+    const IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const std::vector<folly::CIDRNetwork>* affectedPrefixes)
     : vrf_(vrf),
       v4NetworkToRoute_(v4NetworkToRoute),
-      v6NetworkToRoute_(v6NetworkToRoute) {}
+      v6NetworkToRoute_(v6NetworkToRoute),
+      affectedPrefixes_(affectedPrefixes) {}
 
 std::shared_ptr<SwitchState> ForwardingInformationBaseUpdater::operator()(
     const std::shared_ptr<SwitchState>& state) {
+  auto start = std::chrono::steady_clock::now();
+  numChangedPrefixes_ = 0;
   std::shared_ptr<SwitchState> nextState(state);
 
   // A ForwardingInformationBaseContainer holds a
@@ -45,19 +50,28 @@ std::shared_ptr<SwitchState> ForwardingInformationBaseUpdater::operator()(
 
   auto nextFibContainer = previousFibContainer->modify(&nextState);
 
-  nextFibContainer->writableFields()->fibV4 =
-      std::shared_ptr<ForwardingInformationBaseV4>(createUpdatedFib(
-          v4NetworkToRoute_, previousFibContainer->getFibV4()));
-
-  nextFibContainer->writableFields()->fibV6 =
-      std::shared_ptr<ForwardingInformationBaseV6>(createUpdatedFib(
-          v6NetworkToRoute_, previousFibContainer->getFibV6()));
+  if (affectedPrefixes_) {
+    nextFibContainer->writableFields()->fibV4 =
+        patchFib(v4NetworkToRoute_, previousFibContainer->getFibV4());
+    nextFibContainer->writableFields()->fibV6 =
+        patchFib(v6NetworkToRoute_, previousFibContainer->getFibV6());
+  } else {
+    nextFibContainer->writableFields()->fibV4 =
+        createUpdatedFib(v4NetworkToRoute_, previousFibContainer->getFibV4());
+    nextFibContainer->writableFields()->fibV6 =
+        createUpdatedFib(v6NetworkToRoute_, previousFibContainer->getFibV6());
+  }
 
+  lastUpdateDuration_ = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  XLOG(DBG3) << "Updated FIB of VRF " << vrf_ << " with "
+             << numChangedPrefixes_ << " changed prefixes in "
+             << lastUpdateDuration_.count() << "us";
   return nextState;
 }
 
 template <typename AddressT>
-std::unique_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
 ForwardingInformationBaseUpdater::createUpdatedFib(
     const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
     const std::shared_ptr<facebook::fboss::ForwardingInformationBase<AddressT>>&
@@ -67,6 +81,7 @@ ForwardingInformationBaseUpdater::createUpdatedFib(
 
   typename facebook::fboss::ForwardingInformationBase<
       AddressT>::Base::NodeContainer updatedFib;
+  size_t numReused = 0;
 
   for (const auto& entry : rib) {
     const facebook::fboss::rib::Route<AddressT>& ribRoute = entry.value();
@@ -86,6 +101,7 @@ ForwardingInformationBaseUpdater::createUpdatedFib(
       if (toFibNextHop(ribRoute.getForwardInfo()) ==
           fibRoute->getForwardInfo()) {
         // Reuse prior FIB route
+        ++numReused;
       } else {
         fibRoute = toFibRoute(ribRoute);
       }
@@ -93,7 +109,7 @@ ForwardingInformationBaseUpdater::createUpdatedFib(
       fibRoute = toFibRoute(ribRoute);
     }
 
-    updatedFib.emplace_hint(updatedFib.cend(), fibPrefix, fibRoute);
+    updatedFib.insert(std::make_pair(fibPrefix, fibRoute));
   }
 
   DCHECK_EQ(
@@ -106,10 +122,73 @@ ForwardingInformationBaseUpdater::createUpdatedFib(
             return entry.value().isResolved();
           }));
 
-  return std::make_unique<ForwardingInformationBase<AddressT>>(
+  // Routes we did not reuse were either added or changed, and the remaining
+  // routes of the prior FIB were removed
+  numChangedPrefixes_ +=
+      (updatedFib.size() - numReused) + (fib->size() - numReused);
+  if (updatedFib.size() == numReused && fib->size() == numReused) {
+    return fib;
+  }
+  return std::make_shared<ForwardingInformationBase<AddressT>>(
       std::move(updatedFib));
 }
 
+template <typename AddressT>
+std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+ForwardingInformationBaseUpdater::patchFib(
+    const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
+    const std::shared_ptr<facebook::fboss::ForwardingInformationBase<AddressT>>&
+        fib) {
+  // Only cloned once the first route actually changes
+  std::shared_ptr<facebook::fboss::ForwardingInformationBase<AddressT>>
+      updatedFib;
+
+  for (const auto& prefix : *affectedPrefixes_) {
+    AddressT network;
+    if constexpr (std::is_same_v<AddressT, folly::IPAddressV4>) {
+      if (!prefix.first.isV4()) {
+        continue;
+      }
+      network = prefix.first.asV4();
+    } else {
+      if (!prefix.first.isV6()) {
+        continue;
+      }
+      network = prefix.first.asV6();
+    }
+
+    facebook::fboss::RoutePrefix<AddressT> fibPrefix{network, prefix.second};
+    auto fibRoute = (updatedFib ? updatedFib : fib)->getNodeIf(fibPrefix);
+    auto ribIt = rib.exactMatch(network, prefix.second);
+    if (ribIt != rib.end() && ribIt->value().isResolved()) {
+      const auto& ribRoute = ribIt->value();
+      if (fibRoute &&
+          toFibNextHop(ribRoute.getForwardInfo()) ==
+              fibRoute->getForwardInfo()) {
+        continue;
+      }
+      if (!updatedFib) {
+        updatedFib = fib->clone();
+      }
+      updatedFib->writableNodes().insert_or_assign(
+          fibPrefix,
+          std::shared_ptr<facebook::fboss::Route<AddressT>>(
+              toFibRoute(ribRoute)));
+    } else if (fibRoute) {
+      // Deleted from the RIB, or no longer resolved
+      if (!updatedFib) {
+        updatedFib = fib->clone();
+      }
+      updatedFib->writableNodes().erase(fibPrefix);
+    } else {
+      continue;
+    }
+    ++numChangedPrefixes_;
+  }
+
+  return updatedFib ? updatedFib : fib;
+}
+
 facebook::fboss::RouteNextHopEntry
 ForwardingInformationBaseUpdater::toFibNextHop(
     const RouteNextHopEntry& ribNextHopEntry) {
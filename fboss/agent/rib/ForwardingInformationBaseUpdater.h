@@ -16,7 +16,11 @@
 #include "fboss/agent/state/RouteNextHopEntry.h"
 #include "fboss/agent/types.h"
 
+#include <folly/IPAddress.h>
+
+#include <chrono>
 #include <memory>
+#include <vector>
 
 namespace facebook::fboss {
 
@@ -28,16 +32,34 @@ namespace facebook::fboss::rib {
 
 class RouteNextHopEntry;
 
+/*
+ * Updates the FIB of a VRF to match its RIB.
+ *
+ * Given the prefixes whose resolution changed since the current FIB was
+ * built, e.g. RouteUpdater::getAffectedPrefixes(), the FIB is cloned and
+ * only those entries are patched. Otherwise the whole FIB is rebuilt from the
+ * RIB. Either way, FIB routes whose forwarding info did not change are
+ * reused, so they don't show up in the resulting StateDelta.
+ */
 class ForwardingInformationBaseUpdater {
  public:
   ForwardingInformationBaseUpdater(
       RouterID vrf,
       const IPv4NetworkToRouteMap& v4NetworkToRoute,
-      const IPv6NetworkToRouteMap& v6NetworkToRoute);
+      const IPv6NetworkToRouteMap& v6NetworkToRoute,
+      const std::vector<folly::CIDRNetwork>* affectedPrefixes = nullptr);
 
   std::shared_ptr<SwitchState> operator()(
       const std::shared_ptr<SwitchState>& state);
 
+  // Number of FIB routes added, changed or removed by the last update
+  size_t getNumChangedPrefixes() const {
+    return numChangedPrefixes_;
+  }
+  std::chrono::microseconds getLastUpdateDuration() const {
+    return lastUpdateDuration_;
+  }
+
   static facebook::fboss::RouteNextHopEntry toFibNextHop(
       const RouteNextHopEntry& ribNextHopEntry);
   template <typename AddrT>
@@ -46,15 +68,24 @@ class ForwardingInformationBaseUpdater {
 
  private:
   template <typename AddressT>
-  std::unique_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+  std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
   createUpdatedFib(
       const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
       const std::shared_ptr<
           facebook::fboss::ForwardingInformationBase<AddressT>>& fib);
+  template <typename AddressT>
+  std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+  patchFib(
+      const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
+      const std::shared_ptr<
+          facebook::fboss::ForwardingInformationBase<AddressT>>& fib);
 
   RouterID vrf_;
   const IPv4NetworkToRouteMap& v4NetworkToRoute_;
   const IPv6NetworkToRouteMap& v6NetworkToRoute_;
+  const std::vector<folly::CIDRNetwork>* affectedPrefixes_{nullptr};
+  size_t numChangedPrefixes_{0};
+  std::chrono::microseconds lastUpdateDuration_{0};
 };
 
 } // namespace facebook::fboss::rib
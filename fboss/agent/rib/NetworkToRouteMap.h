@@ -10,6 +10,7 @@
 #pragma once
 
 #include "fboss/agent/rib/Route.h"
+#include "fboss/lib/CompactRadixTree.h"
 #include "fboss/lib/RadixTree.h"
 
 #include <folly/IPAddress.h>
@@ -19,9 +20,30 @@
 
 namespace facebook::fboss::rib {
 
+/*
+ * The trie engine of the RIB. Building with FBOSS_COMPACT_RADIX_TREE
+ * selects facebook::network::CompactRadixTree, which uses far less memory
+ * per prefix, over facebook::network::RadixTree, here and in RouteTableRib.
+ */
+#ifdef FBOSS_COMPACT_RADIX_TREE
+template <typename AddressT>
+using NetworkToRouteMapRadixTree =
+    facebook::network::CompactRadixTree<AddressT, Route<AddressT>>;
+#else
 template <typename AddressT>
-class NetworkToRouteMap
-    : public facebook::network::RadixTree<AddressT, Route<AddressT>> {
+using NetworkToRouteMapRadixTree =
+    facebook::network::RadixTree<AddressT, Route<AddressT>>;
+#endif
+
+/*
+ * RadixTreeT overrides the trie engine. Both facebook::network::RadixTree
+ * and facebook::network::CompactRadixTree implement the API used by the
+ * RIB.
+ */
+template <
+    typename AddressT,
+    typename RadixTreeT = NetworkToRouteMapRadixTree<AddressT>>
+class NetworkToRouteMap : public RadixTreeT {
   static constexpr auto kRoutes = "routes";
 
  public:
@@ -35,9 +57,8 @@ class NetworkToRouteMap
     return routesObject;
   }
 
-  static NetworkToRouteMap<AddressT> fromFollyDynamic(
-      const folly::dynamic& routes) {
-    NetworkToRouteMap<AddressT> networkToRouteMap;
+  static NetworkToRouteMap fromFollyDynamic(const folly::dynamic& routes) {
+    NetworkToRouteMap networkToRouteMap;
 
     auto routesJson = routes[kRoutes];
     for (const auto& routeJson : routesJson) {
@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
+
+#include <glog/logging.h>
+
+namespace {
+// Highest address in network/mask, i.e. all host bits set
+template <typename AddrT>
+AddrT lastAddressInPrefix(const AddrT& network, uint8_t mask) {
+  auto bytes = network.toByteArray();
+  for (auto bit = static_cast<uint32_t>(mask); bit < AddrT::bitCount();
+       ++bit) {
+    bytes[bit / 8] |= (0x80 >> (bit % 8));
+  }
+  return AddrT(bytes);
+}
+} // namespace
+
+namespace facebook::fboss::rib {
+
+void NextHopDependencyIndex::addDependency(
+    const folly::CIDRNetwork& dependent,
+    const folly::IPAddress& nexthop) {
+  if (nexthop.isV4()) {
+    v4NextHopToDependents_[nexthop.asV4()].insert(dependent);
+  } else {
+    CHECK(nexthop.isV6());
+    v6NextHopToDependents_[nexthop.asV6()].insert(dependent);
+  }
+  dependentToNextHops_[dependent].push_back(nexthop);
+}
+
+void NextHopDependencyIndex::removeDependent(
+    const folly::CIDRNetwork& dependent) {
+  auto it = dependentToNextHops_.find(dependent);
+  if (it == dependentToNextHops_.end()) {
+    return;
+  }
+
+  auto eraseFrom = [&dependent](auto& nexthopToDependents, const auto& addr) {
+    auto nhopIt = nexthopToDependents.find(addr);
+    if (nhopIt == nexthopToDependents.end()) {
+      return;
+    }
+    nhopIt->second.erase(dependent);
+    if (nhopIt->second.empty()) {
+      nexthopToDependents.erase(nhopIt);
+    }
+  };
+
+  for (const auto& nexthop : it->second) {
+    if (nexthop.isV4()) {
+      eraseFrom(v4NextHopToDependents_, nexthop.asV4());
+    } else {
+      eraseFrom(v6NextHopToDependents_, nexthop.asV6());
+    }
+  }
+  dependentToNextHops_.erase(it);
+}
+
+template <typename AddrT>
+void NextHopDependencyIndex::collectDependents(
+    const std::map<AddrT, Dependents>& nexthopToDependents,
+    const AddrT& network,
+    uint8_t mask,
+    std::vector<folly::CIDRNetwork>* dependents) {
+  auto first = network.mask(mask);
+  auto begin = nexthopToDependents.lower_bound(first);
+  auto end =
+      nexthopToDependents.upper_bound(lastAddressInPrefix(first, mask));
+  for (auto it = begin; it != end; ++it) {
+    dependents->insert(dependents->end(), it->second.begin(), it->second.end());
+  }
+}
+
+std::vector<folly::CIDRNetwork> NextHopDependencyIndex::getAffectedPrefixes(
+    const std::vector<folly::CIDRNetwork>& changedPrefixes) const {
+  std::set<folly::CIDRNetwork> affected;
+  std::vector<folly::CIDRNetwork> toVisit(
+      changedPrefixes.begin(), changedPrefixes.end());
+
+  // Every route with a next-hop inside an affected prefix may now resolve
+  // through a different route, or through a route whose resolution changed.
+  // Walk this relation until we reach a fixed point.
+  while (!toVisit.empty()) {
+    auto prefix = toVisit.back();
+    toVisit.pop_back();
+    if (!affected.insert(prefix).second) {
+      continue;
+    }
+
+    std::vector<folly::CIDRNetwork> dependents;
+    if (prefix.first.isV4()) {
+      collectDependents(
+          v4NextHopToDependents_,
+          prefix.first.asV4(),
+          prefix.second,
+          &dependents);
+    } else {
+      collectDependents(
+          v6NextHopToDependents_,
+          prefix.first.asV6(),
+          prefix.second,
+          &dependents);
+    }
+    for (auto& dependent : dependents) {
+      if (affected.find(dependent) == affected.end()) {
+        toVisit.push_back(std::move(dependent));
+      }
+    }
+  }
+
+  return std::vector<folly::CIDRNetwork>(affected.begin(), affected.end());
+}
+
+void NextHopDependencyIndex::clear() {
+  v4NextHopToDependents_.clear();
+  v6NextHopToDependents_.clear();
+  dependentToNextHops_.clear();
+  initialized_ = false;
+}
+
+} // namespace facebook::fboss::rib
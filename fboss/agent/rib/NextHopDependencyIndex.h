@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/IPAddress.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace facebook::fboss::rib {
+
+/*
+ * NextHopDependencyIndex is a reverse index from the (unresolved) next-hop
+ * addresses used by routes in a VRF to the routes that use them.
+ *
+ * A route R which recursively resolves next-hop N through the route P that is
+ * the longest match for N can only change its resolution if
+ * 1. R's own set of next-hops changes,
+ * 2. a prefix covering N is added or removed, thus changing P, or
+ * 3. P's resolution changes.
+ * Given the set of prefixes touched by an update, getAffectedPrefixes()
+ * therefore returns the touched prefixes together with every route which
+ * has a next-hop falling within one of them, transitively. All other routes
+ * keep their previous resolution, so RouteUpdater only has to re-resolve the
+ * returned routes.
+ *
+ * The index is not serialized. Until the first full resolution has populated
+ * it, isInitialized() returns false and RouteUpdater falls back to resolving
+ * every route.
+ */
+class NextHopDependencyIndex {
+ public:
+  using Dependents = std::set<folly::CIDRNetwork>;
+
+  void addDependency(
+      const folly::CIDRNetwork& dependent,
+      const folly::IPAddress& nexthop);
+  void removeDependent(const folly::CIDRNetwork& dependent);
+
+  std::vector<folly::CIDRNetwork> getAffectedPrefixes(
+      const std::vector<folly::CIDRNetwork>& changedPrefixes) const;
+
+  bool isInitialized() const {
+    return initialized_;
+  }
+  void setInitialized() {
+    initialized_ = true;
+  }
+  void clear();
+
+  std::size_t numDependents() const {
+    return dependentToNextHops_.size();
+  }
+
+ private:
+  template <typename AddrT>
+  static void collectDependents(
+      const std::map<AddrT, Dependents>& nexthopToDependents,
+      const AddrT& network,
+      uint8_t mask,
+      std::vector<folly::CIDRNetwork>* dependents);
+
+  std::map<folly::IPAddressV4, Dependents> v4NextHopToDependents_;
+  std::map<folly::IPAddressV6, Dependents> v6NextHopToDependents_;
+  std::map<folly::CIDRNetwork, std::vector<folly::IPAddress>>
+      dependentToNextHops_;
+  bool initialized_{false};
+};
+
+} // namespace facebook::fboss::rib
@@ -37,8 +37,19 @@ static const auto kInterfaceRouteClientId = ClientID::INTERFACE_ROUTE;
 
 RouteUpdater::RouteUpdater(
     IPv4NetworkToRouteMap* v4Routes,
-    IPv6NetworkToRouteMap* v6Routes)
-    : v4Routes_(v4Routes), v6Routes_(v6Routes) {}
+    IPv6NetworkToRouteMap* v6Routes,
+    NextHopDependencyIndex* nextHopDependencies)
+    : v4Routes_(v4Routes),
+      v6Routes_(v6Routes),
+      nextHopDependencies_(nextHopDependencies) {}
+
+template <typename AddressT>
+void RouteUpdater::recordChange(const Prefix<AddressT>& prefix) {
+  if (nextHopDependencies_) {
+    changedPrefixes_.emplace_back(
+        folly::IPAddress(prefix.network), prefix.mask);
+  }
+}
 
 template <typename AddressT>
 void RouteUpdater::addRouteImpl(
@@ -55,12 +66,14 @@ void RouteUpdater::addRouteImpl(
     }
 
     route->update(clientID, entry);
+    recordChange(prefix);
     return;
   }
 
   CHECK(it == routes->end());
   routes->insert(
       prefix.network, prefix.mask, Route<AddressT>(prefix, clientID, entry));
+  recordChange(prefix);
 }
 
 void RouteUpdater::addRoute(
@@ -121,6 +134,7 @@ void RouteUpdater::delRouteImpl(
 
   Route<AddressT>& route = it->value();
   route.delEntryForClient(clientID);
+  recordChange(prefix);
 
   XLOG(DBG3) << "Deleted next-hops for prefix " << prefix.str()
              << "from client " << folly::to<std::string>(clientID);
@@ -153,7 +167,11 @@ void RouteUpdater::removeAllRoutesFromClientImpl(
 
   for (auto it = routes->begin(); it != routes->end(); ++it) {
     auto& route = it->value();
+    if (!route.getEntryForClient(clientID)) {
+      continue;
+    }
     route.delEntryForClient(clientID);
+    recordChange(route.prefix());
     if (route.hasNoEntry()) {
       // The nexthops we removed was the only one.  Delete the route.
       toDelete.push_back(it);
@@ -380,24 +398,82 @@ RouteNextHopSet mergeForwardInfos(
 }
 } // anonymous namespace
 
+void RouteUpdater::lookupNextHopRoutes() {
+  // A route of one address family may have next-hops of the other, so
+  // collect the next-hops of both tables before doing any lookups.
+  collectNextHops(v4Routes_);
+  collectNextHops(v6Routes_);
+  lookupNextHopRoutes(v4Routes_, &v4NextHopToRoute_);
+  lookupNextHopRoutes(v6Routes_, &v6NextHopToRoute_);
+}
+
+template <typename AddressT>
+void RouteUpdater::collectNextHops(const NetworkToRouteMap<AddressT>* routes) {
+  for (const auto& entry : *routes) {
+    const auto bestEntry = entry.value().getBestEntry().second;
+    if (bestEntry->getAction() != RouteForwardAction::NEXTHOPS) {
+      continue;
+    }
+    for (const auto& nh : bestEntry->getNextHopSet()) {
+      // Next hops with an interface are resolved without a route lookup
+      if (nh.intfID().has_value()) {
+        continue;
+      }
+      if (nh.addr().isV4()) {
+        v4NextHopToRoute_.emplace(nh.addr().asV4(), nullptr);
+      } else {
+        v6NextHopToRoute_.emplace(nh.addr().asV6(), nullptr);
+      }
+    }
+  }
+}
+
+template <typename AddressT>
+void RouteUpdater::lookupNextHopRoutes(
+    NetworkToRouteMap<AddressT>* routes,
+    NextHopToRoute<AddressT>* nextHopToRoute) {
+  std::vector<AddressT> nexthops;
+  nexthops.reserve(nextHopToRoute->size());
+  for (const auto& nexthopAndRoute : *nextHopToRoute) {
+    nexthops.push_back(nexthopAndRoute.first);
+  }
+  std::vector<typename NetworkToRouteMap<AddressT>::Iterator> matches;
+  routes->longestMatchBatch(folly::range(nexthops), &matches);
+  for (size_t i = 0; i < nexthops.size(); ++i) {
+    (*nextHopToRoute)[nexthops[i]] =
+        matches[i] == routes->end() ? nullptr : &(matches[i]->value());
+  }
+}
+
+template <typename AddressT>
+Route<AddressT>* FOLLY_NULLABLE RouteUpdater::longestMatch(
+    NetworkToRouteMap<AddressT>* routes,
+    const NextHopToRoute<AddressT>& nextHopToRoute,
+    const AddressT& nh) {
+  auto cached = nextHopToRoute.find(nh);
+  if (cached != nextHopToRoute.end()) {
+    return cached->second;
+  }
+  auto it = routes->longestMatch(nh, nh.bitCount());
+  return it == routes->end() ? nullptr : &(it->value());
+}
+
 template <typename AddressT>
 void RouteUpdater::getFwdInfoFromNhop(
     NetworkToRouteMap<AddressT>* routes,
+    const NextHopToRoute<AddressT>& nextHopToRoute,
     const AddressT& nh,
     const std::optional<LabelForwardingAction>& labelAction,
     bool* hasToCpu,
     bool* hasDrop,
     RouteNextHopSet& fwd) {
-  auto it = routes->longestMatch(nh, nh.bitCount());
-  if (it == routes->end()) {
+  Route<AddressT>* route = longestMatch(routes, nextHopToRoute, nh);
+  if (!route) {
     XLOG(DBG3) << "Could not find subnet for next-hop:  " << nh;
     // Unresolvable next hop
     return;
   }
 
-  Route<AddressT>* route = &(it->value());
-  CHECK(route);
-
   if (route->needResolve()) {
     resolveOne(route);
   }
@@ -436,12 +512,34 @@ void RouteUpdater::getFwdInfoFromNhop(
   }
 }
 
+template <typename AddressT>
+void RouteUpdater::recordDependencies(const Route<AddressT>* route) {
+  folly::CIDRNetwork dependent(
+      folly::IPAddress(route->prefix().network), route->prefix().mask);
+  nextHopDependencies_->removeDependent(dependent);
+
+  const auto bestEntry = route->getBestEntry().second;
+  if (bestEntry->getAction() != RouteForwardAction::NEXTHOPS) {
+    return;
+  }
+  for (const auto& nh : bestEntry->getNextHopSet()) {
+    // Next hops with an interface are resolved without a route lookup
+    if (!nh.intfID().has_value()) {
+      nextHopDependencies_->addDependency(dependent, nh.addr());
+    }
+  }
+}
+
 template <typename AddressT>
 void RouteUpdater::resolveOne(Route<AddressT>* route) {
   // mark this route is in processing. This processing bit shall be cleared
   // in setUnresolvable() or setResolved()
   route->setProcessing();
 
+  if (nextHopDependencies_) {
+    recordDependencies(route);
+  }
+
   bool hasToCpu{false};
   bool hasDrop{false};
   RouteNextHopSet fwd;
@@ -476,6 +574,7 @@ void RouteUpdater::resolveOne(Route<AddressT>* route) {
       if (addr.isV4()) {
         getFwdInfoFromNhop(
             v4Routes_,
+            v4NextHopToRoute_,
             nh.addr().asV4(),
             nh.labelForwardingAction(),
             &hasToCpu,
@@ -485,6 +584,7 @@ void RouteUpdater::resolveOne(Route<AddressT>* route) {
         CHECK(addr.isV6());
         getFwdInfoFromNhop(
             v6Routes_,
+            v6NextHopToRoute_,
             nh.addr().asV6(),
             nh.labelForwardingAction(),
             &hasToCpu,
@@ -535,9 +635,90 @@ void RouteUpdater::updateDoneImpl(NetworkToRouteMap<AddressT>* routes) {
   resolve(routes);
 }
 
+template <typename AddressT>
+Route<AddressT>* FOLLY_NULLABLE RouteUpdater::clearForwardIfPresent(
+    NetworkToRouteMap<AddressT>* routes,
+    const AddressT& network,
+    uint8_t mask) {
+  auto it = routes->exactMatch(network, mask);
+  if (it == routes->end()) {
+    // The route was deleted by this update, so it no longer depends on
+    // anything. Routes which resolved through it are part of the affected set.
+    nextHopDependencies_->removeDependent(
+        folly::CIDRNetwork(folly::IPAddress(network), mask));
+    return nullptr;
+  }
+  Route<AddressT>* route = &(it->value());
+  route->clearForward();
+  return route;
+}
+
+void RouteUpdater::updateDoneIncremental() {
+  affectedPrefixes_ =
+      nextHopDependencies_->getAffectedPrefixes(changedPrefixes_);
+
+  // Invalidate every affected route before resolving any of them, so that a
+  // route never resolves through an affected route's stale forwarding info.
+  std::vector<RouteV4*> v4ToResolve;
+  std::vector<RouteV6*> v6ToResolve;
+  for (const auto& prefix : affectedPrefixes_) {
+    if (prefix.first.isV4()) {
+      auto route =
+          clearForwardIfPresent(v4Routes_, prefix.first.asV4(), prefix.second);
+      if (route) {
+        v4ToResolve.push_back(route);
+      }
+    } else {
+      auto route =
+          clearForwardIfPresent(v6Routes_, prefix.first.asV6(), prefix.second);
+      if (route) {
+        v6ToResolve.push_back(route);
+      }
+    }
+  }
+
+  for (auto route : v4ToResolve) {
+    if (route->needResolve()) {
+      resolveOne(route);
+    }
+  }
+  for (auto route : v6ToResolve) {
+    if (route->needResolve()) {
+      resolveOne(route);
+    }
+  }
+
+  XLOG(DBG3) << "Re-resolved " << affectedPrefixes_.size()
+             << " routes affected by " << changedPrefixes_.size()
+             << " changed prefixes";
+}
+
 void RouteUpdater::updateDone() {
+  if (nextHopDependencies_ && nextHopDependencies_->isInitialized()) {
+    updateDoneIncremental();
+    fullResolution_ = false;
+    changedPrefixes_.clear();
+    return;
+  }
+
+  fullResolution_ = true;
+  affectedPrefixes_.clear();
+  if (nextHopDependencies_) {
+    // Full resolution repopulates the index from scratch
+    nextHopDependencies_->clear();
+  }
+  // Every route is about to be re-resolved, so look up all next-hops up
+  // front. The tables aren't modified while resolving, so the matches stay
+  // valid until we are done.
+  lookupNextHopRoutes();
   updateDoneImpl(v4Routes_);
   updateDoneImpl(v6Routes_);
+  v4NextHopToRoute_.clear();
+  v6NextHopToRoute_.clear();
+  if (nextHopDependencies_) {
+    nextHopDependencies_->setInitialized();
+  }
+  changedPrefixes_.clear();
 }
 
 } // namespace facebook::fboss::rib
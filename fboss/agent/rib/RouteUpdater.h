@@ -13,12 +13,14 @@
 #include "fboss/agent/types.h"
 
 #include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
 #include "fboss/agent/rib/Route.h"
 #include "fboss/agent/rib/RouteNextHopEntry.h"
 #include "fboss/agent/rib/RouteNextHopsMulti.h"
 #include "fboss/agent/rib/RouteTypes.h"
 
 #include <folly/IPAddress.h>
+#include <folly/container/F14Map.h>
 
 namespace facebook::fboss::rib {
 
@@ -45,12 +47,18 @@ namespace facebook::fboss::rib {
  *    only IP nexthops will be in the final ECMP group.
  * 5. If and only if TO_CPU is the only nexthop (directly or indirectly) of
  *    a route, TO_CPU action will be only path in the resolved ECMP group.
+ *
+ * If a NextHopDependencyIndex is supplied, updateDone() only re-resolves the
+ * routes touched by this update and the routes which (recursively) depend on
+ * them. Without one, or while the index has not been populated yet, every
+ * route is re-resolved.
  */
 class RouteUpdater {
  public:
   RouteUpdater(
       IPv4NetworkToRouteMap* v4Routes,
-      IPv6NetworkToRouteMap* v6Routes);
+      IPv6NetworkToRouteMap* v6Routes,
+      NextHopDependencyIndex* nextHopDependencies = nullptr);
 
   void addRoute(
       const folly::IPAddress& network,
@@ -72,9 +80,32 @@ class RouteUpdater {
 
   void updateDone();
 
+  /*
+   * The prefixes re-resolved by the last updateDone(), including the ones
+   * whose routes were deleted, or nullptr if it re-resolved every route.
+   * Routes outside of these kept their previous resolution, so a FIB built
+   * before this update only needs these prefixes patched.
+   */
+  const std::vector<folly::CIDRNetwork>* getAffectedPrefixes() const {
+    return fullResolution_ ? nullptr : &affectedPrefixes_;
+  }
+
  private:
   IPv4NetworkToRouteMap* v4Routes_{nullptr};
   IPv6NetworkToRouteMap* v6Routes_{nullptr};
+  NextHopDependencyIndex* nextHopDependencies_{nullptr};
+  // Prefixes whose set of next-hops was modified by this updater
+  std::vector<folly::CIDRNetwork> changedPrefixes_;
+  // Set by updateDone(), see getAffectedPrefixes()
+  std::vector<folly::CIDRNetwork> affectedPrefixes_;
+  bool fullResolution_{true};
+
+  template <typename AddressT>
+  using NextHopToRoute = folly::F14FastMap<AddressT, Route<AddressT>*>;
+  // Longest match for every next-hop in the RIB, looked up in bulk before a
+  // full re-resolution. Empty otherwise.
+  NextHopToRoute<folly::IPAddressV4> v4NextHopToRoute_;
+  NextHopToRoute<folly::IPAddressV6> v6NextHopToRoute_;
 
   // TODO(samank): rename in original file
   template <typename AddressT>
@@ -98,6 +129,30 @@ class RouteUpdater {
       ClientID clientID);
   template <typename AddressT>
   void updateDoneImpl(NetworkToRouteMap<AddressT>* routes);
+  void updateDoneIncremental();
+
+  template <typename AddressT>
+  void recordChange(const Prefix<AddressT>& prefix);
+  template <typename AddressT>
+  Route<AddressT>* FOLLY_NULLABLE clearForwardIfPresent(
+      NetworkToRouteMap<AddressT>* routes,
+      const AddressT& network,
+      uint8_t mask);
+  template <typename AddressT>
+  void recordDependencies(const Route<AddressT>* route);
+
+  void lookupNextHopRoutes();
+  template <typename AddressT>
+  void collectNextHops(const NetworkToRouteMap<AddressT>* routes);
+  template <typename AddressT>
+  void lookupNextHopRoutes(
+      NetworkToRouteMap<AddressT>* routes,
+      NextHopToRoute<AddressT>* nextHopToRoute);
+  template <typename AddressT>
+  Route<AddressT>* FOLLY_NULLABLE longestMatch(
+      NetworkToRouteMap<AddressT>* routes,
+      const NextHopToRoute<AddressT>& nextHopToRoute,
+      const AddressT& nh);
 
   template <typename AddressT>
   void resolve(NetworkToRouteMap<AddressT>* routes);
@@ -107,6 +162,7 @@ class RouteUpdater {
   template <typename AddressT>
   void getFwdInfoFromNhop(
       NetworkToRouteMap<AddressT>* routes,
+      const NextHopToRoute<AddressT>& nextHopToRoute,
       const AddressT& nh,
       const std::optional<LabelForwardingAction>& labelAction,
       bool* hasToCpu,
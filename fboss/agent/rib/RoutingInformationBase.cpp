@@ -79,6 +79,7 @@ void RoutingInformationBase::reconfigure(
   for (auto& vrfAndRouteTable : *lockedRouteTables) {
     auto vrf = vrfAndRouteTable.first;
     const auto& interfaceRoutes = configRouterIDToInterfaceRoutes.at(vrf);
+    auto lockedRouteTable = vrfAndRouteTable.second->wlock();
 
     // A ConfigApplier object should be independent of the VRF whose routes it
     // is processing. However, because interface and static routes for _all_
@@ -89,8 +90,9 @@ void RoutingInformationBase::reconfigure(
     // processing by the use of boost::filter_iterator.
     ConfigApplier configApplier(
         vrf,
-        &(vrfAndRouteTable.second.v4NetworkToRoute),
-        &(vrfAndRouteTable.second.v6NetworkToRoute),
+        &(lockedRouteTable->v4NetworkToRoute),
+        &(lockedRouteTable->v6NetworkToRoute),
+        &(lockedRouteTable->nextHopDependencies),
         folly::range(interfaceRoutes.cbegin(), interfaceRoutes.cend()),
         folly::range(staticRoutesToCpu.cbegin(), staticRoutesToCpu.cend()),
         folly::range(staticRoutesToNull.cbegin(), staticRoutesToNull.cend()),
@@ -117,15 +119,21 @@ RoutingInformationBase::UpdateStatistics RoutingInformationBase::update(
 
   Timer updateTimer(&stats.duration);
 
-  auto lockedRouteTables = synchronizedRouteTables_.wlock();
+  // Only the set of VRFs needs to be stable while we update routerID's
+  // routes, so updates to other VRFs are free to proceed concurrently.
+  auto lockedRouteTables = synchronizedRouteTables_.rlock();
 
   auto it = lockedRouteTables->find(routerID);
   if (it == lockedRouteTables->end()) {
     throw FbossError("VRF ", routerID, " not configured");
   }
 
+  auto lockedRouteTable = it->second->wlock();
+
   RouteUpdater updater(
-      &(it->second.v4NetworkToRoute), &(it->second.v6NetworkToRoute));
+      &(lockedRouteTable->v4NetworkToRoute),
+      &(lockedRouteTable->v6NetworkToRoute),
+      &(lockedRouteTable->nextHopDependencies));
 
   if (resetClientsRoutes) {
     updater.removeAllRoutesForClient(clientID);
@@ -165,8 +173,9 @@ RoutingInformationBase::UpdateStatistics RoutingInformationBase::update(
 
   fibUpdateCallback(
       routerID,
-      it->second.v4NetworkToRoute,
-      it->second.v6NetworkToRoute,
+      lockedRouteTable->v4NetworkToRoute,
+      lockedRouteTable->v6NetworkToRoute,
+      updater.getAffectedPrefixes(),
       cookie);
 
   return stats;
@@ -179,12 +188,13 @@ folly::dynamic RoutingInformationBase::toFollyDynamic() const {
   for (const auto& routeTable : *lockedRouteTables) {
     auto routerIdStr =
         folly::to<std::string>(static_cast<uint32_t>(routeTable.first));
+    auto lockedRouteTable = routeTable.second->rlock();
     rib[routerIdStr] = folly::dynamic::object;
     rib[routerIdStr][kRouterId] = static_cast<uint32_t>(routeTable.first);
     rib[routerIdStr][kRibV4] =
-        routeTable.second.v4NetworkToRoute.toFollyDynamic();
+        lockedRouteTable->v4NetworkToRoute.toFollyDynamic();
     rib[routerIdStr][kRibV6] =
-        routeTable.second.v6NetworkToRoute.toFollyDynamic();
+        lockedRouteTable->v6NetworkToRoute.toFollyDynamic();
   }
 
   return rib;
@@ -198,10 +208,10 @@ RoutingInformationBase RoutingInformationBase::fromFollyDynamic(
   for (const auto& routeTable : ribJson.items()) {
     lockedRouteTables->insert(std::make_pair(
         RouterID(routeTable.first.asInt()),
-        RouteTable{
+        std::make_unique<SynchronizedRouteTable>(RouteTable{
             IPv4NetworkToRouteMap::fromFollyDynamic(routeTable.second[kRibV4]),
             IPv6NetworkToRouteMap::fromFollyDynamic(routeTable.second[kRibV6]),
-            UpdateStatistics{}}));
+            UpdateStatistics{}})));
   }
 
   return rib;
@@ -209,7 +219,8 @@ RoutingInformationBase RoutingInformationBase::fromFollyDynamic(
 
 void RoutingInformationBase::createVrf(RouterID rid) {
   auto lockedRouteTables = synchronizedRouteTables_.wlock();
-  lockedRouteTables->insert(std::make_pair(rid, RouteTable()));
+  lockedRouteTables->insert(
+      std::make_pair(rid, std::make_unique<SynchronizedRouteTable>()));
 }
 
 std::vector<RouterID> RoutingInformationBase::getVrfList() const {
@@ -224,19 +235,19 @@ std::vector<RouterID> RoutingInformationBase::getVrfList() const {
 std::vector<RouteDetails> RoutingInformationBase::getRouteTableDetails(
     RouterID rid) const {
   std::vector<RouteDetails> routeDetails;
-  SYNCHRONIZED_CONST(synchronizedRouteTables_) {
-    const auto it = synchronizedRouteTables_.find(rid);
-    if (it != synchronizedRouteTables_.end()) {
-      for (auto rit = it->second.v4NetworkToRoute.begin();
-           rit != it->second.v4NetworkToRoute.end();
-           ++rit) {
-        routeDetails.emplace_back(rit->value().toRouteDetails());
-      }
-      for (auto rit = it->second.v6NetworkToRoute.begin();
-           rit != it->second.v6NetworkToRoute.end();
-           ++rit) {
-        routeDetails.emplace_back(rit->value().toRouteDetails());
-      }
+  auto lockedRouteTables = synchronizedRouteTables_.rlock();
+  const auto it = lockedRouteTables->find(rid);
+  if (it != lockedRouteTables->end()) {
+    auto lockedRouteTable = it->second->rlock();
+    for (auto rit = lockedRouteTable->v4NetworkToRoute.begin();
+         rit != lockedRouteTable->v4NetworkToRoute.end();
+         ++rit) {
+      routeDetails.emplace_back(rit->value().toRouteDetails());
+    }
+    for (auto rit = lockedRouteTable->v6NetworkToRoute.begin();
+         rit != lockedRouteTable->v6NetworkToRoute.end();
+         ++rit) {
+      routeDetails.emplace_back(rit->value().toRouteDetails());
     }
   }
   return routeDetails;
@@ -255,7 +266,9 @@ RoutingInformationBase::constructRouteTables(
     const RouterID configVrf = routerIDAndInterfaceRoutes.first;
 
     newRouteTablesIter = newRouteTables.emplace_hint(
-        newRouteTables.cend(), configVrf, RouteTable());
+        newRouteTables.cend(),
+        configVrf,
+        std::make_unique<SynchronizedRouteTable>());
 
     auto oldRouteTablesIter = lockedRouteTables->find(configVrf);
     if (oldRouteTablesIter == lockedRouteTables->end()) {
@@ -277,7 +290,17 @@ bool RoutingInformationBase::operator==(
   const auto& routeTables = synchronizedRouteTables_.rlock();
   const auto& otherTables = other.synchronizedRouteTables_.rlock();
 
-  return *routeTables == *otherTables;
+  if (routeTables->size() != otherTables->size()) {
+    return false;
+  }
+  for (const auto& routeTable : *routeTables) {
+    auto otherIt = otherTables->find(routeTable.first);
+    if (otherIt == otherTables->end() ||
+        *routeTable.second->rlock() != *otherIt->second->rlock()) {
+      return false;
+    }
+  }
+  return true;
 }
 
 } // namespace facebook::fboss::rib
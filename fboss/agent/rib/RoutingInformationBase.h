@@ -12,6 +12,7 @@
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
 #include "fboss/agent/if/gen-cpp2/FbossCtrl.h"
 #include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
 #include "fboss/agent/types.h"
 
 #include <folly/Synchronized.h>
@@ -25,10 +26,16 @@ namespace facebook::fboss::rib {
 
 class RoutingInformationBase {
  public:
+  /*
+   * affectedPrefixes are the prefixes whose resolution may have changed,
+   * see RouteUpdater::getAffectedPrefixes(), or nullptr if any of them may
+   * have.
+   */
   using FibUpdateFunction = std::function<void(
       RouterID vrf,
       const IPv4NetworkToRouteMap& v4NetworkToRoute,
       const IPv6NetworkToRouteMap& v6NetworkToRoute,
+      const std::vector<folly::CIDRNetwork>* affectedPrefixes,
       void* cookie)>;
 
   struct UpdateStatistics {
@@ -40,11 +47,13 @@ class RoutingInformationBase {
   };
 
   /*
-   * `update()` first acquires exclusive ownership of the RIB and executes the
-   * following sequence of actions:
+   * `update()` first acquires exclusive ownership of the VRF `routerID` and
+   * executes the following sequence of actions:
    * 1. Injects and removes routes in `toAdd` and `toDelete`, respectively.
-   * 2. Triggers recursive (IP) resolution.
-   * 3. Updates the FIB synchronously.
+   * 2. Triggers recursive (IP) resolution of the routes affected by the
+   *    update.
+   * 3. Updates the FIB synchronously, passing `fibUpdateCallback` the
+   *    prefixes affected by the update so it can patch just those.
    *
    * If a UnicastRoute does not specify its admin distance, then we derive its
    * admin distance via its clientID.  This is accomplished by a mapping from
@@ -52,6 +61,12 @@ class RoutingInformationBase {
    * this mapping is exposed via SwSwitch, which we can't a dependency on here.
    * The adminDistanceFromClientID allows callsites to propogate admin distances
    * per client.
+   *
+   * Updates to different VRFs hold different locks and may run concurrently.
+   * Each invokes `fibUpdateCallback` for its own VRF while still holding that
+   * VRF's lock. When the callback funnels into SwSwitch::updateStateBlocking(),
+   * the FIB updates of concurrently updated VRFs are coalesced by SwSwitch into
+   * a single state update and hardware programming pass.
    */
   UpdateStatistics update(
       RouterID routerID,
@@ -107,6 +122,10 @@ class RoutingInformationBase {
 
     UpdateStatistics lastUpdateStats_;
 
+    // Derived from the routes above, hence not part of equality or
+    // serialization.
+    NextHopDependencyIndex nextHopDependencies;
+
     bool operator==(const RouteTable& other) const {
       return v4NetworkToRoute == other.v4NetworkToRoute &&
           v6NetworkToRoute == other.v6NetworkToRoute;
@@ -117,13 +136,15 @@ class RoutingInformationBase {
   };
 
   /*
-   * Currently, route updates to separate VRFs are made to be sequential. In the
-   * event FBOSS has to operate in a routing architecture with numerous VRFs,
-   * we can avoid a slow down by a factor of number of VRFs by parallelizing
-   * route updates across VRFs. This can be accomplished simply by associating
-   * the mutex implicit in folly::Synchronized with an individual RouteTable.
+   * Each VRF's RouteTable has its own lock so that route updates to separate
+   * VRFs can proceed in parallel. The outer lock only protects the set of
+   * VRFs: update() and the other accessors hold it shared, while
+   * reconfigure() and createVrf() hold it exclusively to add or remove VRFs.
+   * Lock order is always outer lock first, then the per VRF lock.
    */
-  using RouterIDToRouteTable = boost::container::flat_map<RouterID, RouteTable>;
+  using SynchronizedRouteTable = folly::Synchronized<RouteTable>;
+  using RouterIDToRouteTable = boost::container::
+      flat_map<RouterID, std::unique_ptr<SynchronizedRouteTable>>;
   using SynchronizedRouteTables = folly::Synchronized<RouterIDToRouteTable>;
 
   RouterIDToRouteTable constructRouteTables(
@@ -14,10 +14,13 @@
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 #include "fboss/agent/rib/ForwardingInformationBaseUpdater.h"
 #include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
 #include "fboss/agent/rib/Route.h"
 #include "fboss/agent/rib/RouteNextHop.h"
 #include "fboss/agent/rib/RouteNextHopEntry.h"
 #include "fboss/agent/rib/RouteTypes.h"
+#include "fboss/agent/rib/RouteUpdater.h"
+#include "fboss/agent/rib/RoutingInformationBase.h"
 #include "fboss/agent/state/ForwardingInformationBase.h"
 #include "fboss/agent/state/ForwardingInformationBaseContainer.h"
 #include "fboss/agent/state/ForwardingInformationBaseMap.h"
@@ -32,8 +35,10 @@
 
 #include <folly/IPAddress.h>
 #include <folly/functional/Partial.h>
+#include <folly/synchronization/Baton.h>
 #include <gtest/gtest.h>
 #include <optional>
+#include <thread>
 
 using facebook::fboss::AdminDistance;
 using facebook::fboss::InterfaceID;
@@ -46,9 +51,10 @@ void dynamicFibUpdate(
     facebook::fboss::RouterID vrf,
     const facebook::fboss::rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
     const facebook::fboss::rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const std::vector<folly::CIDRNetwork>* affectedPrefixes,
     void* cookie) {
   facebook::fboss::rib::ForwardingInformationBaseUpdater fibUpdater(
-      vrf, v4NetworkToRoute, v6NetworkToRoute);
+      vrf, v4NetworkToRoute, v6NetworkToRoute, affectedPrefixes);
 
   auto sw = static_cast<facebook::fboss::SwSwitch*>(cookie);
   sw->updateStateBlocking("", std::move(fibUpdater));
@@ -519,6 +525,64 @@ TEST(Rib, Update) {
   EXPECT_FIB_SIZE(state, vrfZero, 4, 4);
 }
 
+// Updates to different VRFs must not serialize on each other: VRF 1 has to be
+// updatable while VRF 0's update (including its FIB callback) is in progress.
+TEST(Rib, ConcurrentVrfUpdates) {
+  using namespace facebook::fboss;
+
+  rib::RoutingInformationBase rib;
+  rib.createVrf(RouterID(0));
+  rib.createVrf(RouterID(1));
+
+  std::vector<UnicastRoute> routes;
+  routes.push_back(createUnicastRoute(
+      folly::IPAddressV4("7.1.0.0"), 16, folly::IPAddressV4("11.11.11.11")));
+
+  folly::Baton<> vrfZeroInCallback;
+  folly::Baton<> vrfOneUpdated;
+
+  std::thread vrfZeroUpdater([&]() {
+    rib.update(
+        RouterID(0),
+        ClientID(10),
+        AdminDistance::EBGP,
+        routes,
+        {},
+        false /* sync */,
+        "vrf 0 update",
+        [&](RouterID /* vrf */,
+            const rib::IPv4NetworkToRouteMap& /* v4NetworkToRoute */,
+            const rib::IPv6NetworkToRouteMap& /* v6NetworkToRoute */,
+            const std::vector<folly::CIDRNetwork>* /* affectedPrefixes */,
+            void* /* cookie */) {
+          vrfZeroInCallback.post();
+          EXPECT_TRUE(vrfOneUpdated.try_wait_for(std::chrono::seconds(10)));
+        },
+        nullptr);
+  });
+
+  vrfZeroInCallback.wait();
+  rib.update(
+      RouterID(1),
+      ClientID(10),
+      AdminDistance::EBGP,
+      routes,
+      {},
+      false /* sync */,
+      "vrf 1 update",
+      [](RouterID /* vrf */,
+         const rib::IPv4NetworkToRouteMap& /* v4NetworkToRoute */,
+         const rib::IPv6NetworkToRouteMap& /* v6NetworkToRoute */,
+         const std::vector<folly::CIDRNetwork>* /* affectedPrefixes */,
+         void* /* cookie */) {},
+      nullptr);
+  vrfOneUpdated.post();
+  vrfZeroUpdater.join();
+
+  EXPECT_EQ(1, rib.getRouteTableDetails(RouterID(0)).size());
+  EXPECT_EQ(1, rib.getRouteTableDetails(RouterID(1)).size());
+}
+
 // There are 3 cases that should be exercised:
 // 1) a route has been added whose prefix _doesn't_ exist in the RIB
 // 2) a route has been added whose prefix exists in the RIB BUT whose
@@ -619,3 +683,98 @@ TEST(ForwardingInformationBaseUpdater, Deduplication) {
   ASSERT_TRUE(route3);
   EXPECT_NE(route, route3);
 }
+
+TEST(ForwardingInformationBaseUpdater, PatchAffectedPrefixes) {
+  using namespace facebook::fboss;
+
+  const RouterID vrfZero{0};
+  rib::IPv4NetworkToRouteMap v4Routes;
+  rib::IPv6NetworkToRouteMap v6Routes;
+  rib::NextHopDependencyIndex nextHopDependencies;
+
+  auto fibMap = std::make_shared<ForwardingInformationBaseMap>();
+  fibMap->addNode(
+      std::make_shared<ForwardingInformationBaseContainer>(vrfZero));
+  auto state = std::make_shared<SwitchState>();
+  state->resetForwardingInformationBases(fibMap);
+
+  auto nextHop = [](const char* addr) {
+    rib::RouteNextHopSet nhops;
+    nhops.emplace(
+        rib::UnresolvedNextHop(folly::IPAddress(addr), rib::ECMP_WEIGHT));
+    return rib::RouteNextHopEntry(std::move(nhops), AdminDistance::EBGP);
+  };
+  auto update = [&](std::function<void(rib::RouteUpdater*)> updateFn) {
+    rib::RouteUpdater updater(&v4Routes, &v6Routes, &nextHopDependencies);
+    updateFn(&updater);
+    updater.updateDone();
+    rib::ForwardingInformationBaseUpdater fibUpdater(
+        vrfZero, v4Routes, v6Routes, updater.getAffectedPrefixes());
+    state->publish();
+    state = fibUpdater(state);
+    return fibUpdater.getNumChangedPrefixes();
+  };
+  auto getFibV4 = [&]() {
+    return state->getFibs()->getFibContainer(vrfZero)->getFibV4();
+  };
+  RoutePrefixV4 bgpPrefix{folly::IPAddressV4("16.0.0.0"), 24};
+  RoutePrefixV4 staticPrefix{folly::IPAddressV4("17.0.0.0"), 24};
+  RoutePrefixV4 newPrefix{folly::IPAddressV4("18.0.0.0"), 24};
+
+  // The first update resolves every route and rebuilds the whole FIB
+  EXPECT_EQ(3, update([&](rib::RouteUpdater* updater) {
+              updater->addInterfaceRoute(
+                  folly::IPAddress("10.0.0.1"),
+                  24,
+                  folly::IPAddress("10.0.0.1"),
+                  InterfaceID(1));
+              updater->addRoute(
+                  bgpPrefix.network,
+                  bgpPrefix.mask,
+                  ClientID::BGPD,
+                  nextHop("10.0.0.2"));
+              updater->addRoute(
+                  staticPrefix.network,
+                  staticPrefix.mask,
+                  ClientID::STATIC_ROUTE,
+                  nextHop("10.0.0.3"));
+            }));
+  auto bgpRoute = getFibV4()->exactMatch(bgpPrefix);
+  auto staticRoute = getFibV4()->exactMatch(staticPrefix);
+  ASSERT_TRUE(bgpRoute);
+  ASSERT_TRUE(staticRoute);
+
+  // Later updates only patch the routes they affect
+  EXPECT_EQ(2, update([&](rib::RouteUpdater* updater) {
+              updater->delRoute(
+                  bgpPrefix.network, bgpPrefix.mask, ClientID::BGPD);
+              updater->addRoute(
+                  newPrefix.network,
+                  newPrefix.mask,
+                  ClientID::BGPD,
+                  nextHop("10.0.0.2"));
+            }));
+  EXPECT_EQ(3, getFibV4()->size());
+  EXPECT_FALSE(getFibV4()->exactMatch(bgpPrefix));
+  EXPECT_TRUE(getFibV4()->exactMatch(newPrefix));
+  EXPECT_EQ(staticRoute, getFibV4()->exactMatch(staticPrefix));
+
+  // Re-adding a route with the same next-hops changes nothing
+  auto fibV4 = getFibV4();
+  EXPECT_EQ(0, update([&](rib::RouteUpdater* updater) {
+              updater->addRoute(
+                  staticPrefix.network,
+                  staticPrefix.mask,
+                  ClientID::STATIC_ROUTE,
+                  nextHop("10.0.0.3"));
+            }));
+  EXPECT_EQ(fibV4, getFibV4());
+
+  // The patched FIB matches one rebuilt from scratch
+  rib::ForwardingInformationBaseUpdater fullUpdater(
+      vrfZero, v4Routes, v6Routes);
+  auto rebuiltState = fullUpdater(state);
+  EXPECT_EQ(0, fullUpdater.getNumChangedPrefixes());
+  EXPECT_EQ(
+      fibV4, rebuiltState->getFibs()->getFibContainer(vrfZero)->getFibV4());
+}
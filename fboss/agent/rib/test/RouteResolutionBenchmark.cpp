@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "common/init/Init.h"
+#include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
+#include "fboss/agent/rib/RouteNextHop.h"
+#include "fboss/agent/rib/RouteNextHopEntry.h"
+#include "fboss/agent/rib/RouteUpdater.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddress.h>
+
+#include <functional>
+
+using namespace facebook::fboss;
+using namespace facebook::fboss::rib;
+
+namespace {
+
+// BGP routes recursively resolve through one of kNumLoopbacks loopback /32s,
+// which are in turn resolved through a directly connected subnet.
+constexpr auto kNumLoopbacks = 64;
+
+folly::IPAddressV4 loopback(uint32_t i) {
+  return folly::IPAddressV4::fromLongHBO((100 << 24) | (i + 1));
+}
+
+folly::IPAddressV4 connectedNeighbor(uint32_t i) {
+  return folly::IPAddressV4::fromLongHBO((10 << 24) | (i + 2));
+}
+
+RouteNextHopEntry nextHopEntry(
+    const folly::IPAddressV4& addr,
+    AdminDistance distance) {
+  RouteNextHopSet nhops;
+  nhops.emplace(UnresolvedNextHop(folly::IPAddress(addr), ECMP_WEIGHT));
+  return RouteNextHopEntry(std::move(nhops), distance);
+}
+
+class RibUnderTest {
+ public:
+  RibUnderTest(std::size_t numRoutes, bool incremental)
+      : incremental_(incremental) {
+    update([numRoutes](RouteUpdater* updater) {
+      updater->addInterfaceRoute(
+          folly::IPAddress("10.0.0.1"),
+          16,
+          folly::IPAddress("10.0.0.1"),
+          InterfaceID(1));
+      for (uint32_t i = 0; i < kNumLoopbacks; ++i) {
+        updater->addRoute(
+            folly::IPAddress(loopback(i)),
+            32,
+            ClientID::OPENR,
+            nextHopEntry(connectedNeighbor(i), AdminDistance::STATIC_ROUTE));
+      }
+      // /24s starting at 16.0.0.0
+      for (uint32_t i = 0; i < numRoutes; ++i) {
+        updater->addRoute(
+            folly::IPAddress(
+                folly::IPAddressV4::fromLongHBO((16 << 24) + (i << 8))),
+            24,
+            ClientID::BGPD,
+            nextHopEntry(loopback(i % kNumLoopbacks), AdminDistance::EBGP));
+      }
+    });
+  }
+
+  void update(std::function<void(RouteUpdater*)> updateFn) {
+    RouteUpdater updater(
+        &v4Routes_,
+        &v6Routes_,
+        incremental_ ? &nextHopDependencies_ : nullptr);
+    updateFn(&updater);
+    updater.updateDone();
+  }
+
+ private:
+  bool incremental_;
+  IPv4NetworkToRouteMap v4Routes_;
+  IPv6NetworkToRouteMap v6Routes_;
+  NextHopDependencyIndex nextHopDependencies_;
+};
+
+/*
+ * Add or remove a prefix that no other route depends on. Only one route
+ * needs to be re-resolved.
+ */
+void unrelatedPrefixFlap(
+    uint32_t iters,
+    std::size_t numRoutes,
+    bool incremental) {
+  folly::BenchmarkSuspender suspender;
+  RibUnderTest rib(numRoutes, incremental);
+  suspender.dismiss();
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    rib.update([i](RouteUpdater* updater) {
+      if (i % 2 == 0) {
+        updater->addRoute(
+            folly::IPAddress("200.0.0.0"),
+            24,
+            ClientID::BGPD,
+            nextHopEntry(loopback(0), AdminDistance::EBGP));
+      } else {
+        updater->delRoute(folly::IPAddress("200.0.0.0"), 24, ClientID::BGPD);
+      }
+    });
+  }
+}
+
+/*
+ * Move one loopback to a different connected neighbor. The routes using that
+ * loopback, i.e. 1/kNumLoopbacks of the table, need to be re-resolved.
+ */
+void loopbackFlap(uint32_t iters, std::size_t numRoutes, bool incremental) {
+  folly::BenchmarkSuspender suspender;
+  RibUnderTest rib(numRoutes, incremental);
+  suspender.dismiss();
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    rib.update([i](RouteUpdater* updater) {
+      updater->addRoute(
+          folly::IPAddress(loopback(0)),
+          32,
+          ClientID::OPENR,
+          nextHopEntry(
+              connectedNeighbor(i % 2 ? 0 : kNumLoopbacks),
+              AdminDistance::STATIC_ROUTE));
+    });
+  }
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(unrelatedPrefixFlap, Full_10k, 10'000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(unrelatedPrefixFlap, Incr_10k, 10'000, true)
+BENCHMARK_NAMED_PARAM(unrelatedPrefixFlap, Full_100k, 100'000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(unrelatedPrefixFlap, Incr_100k, 100'000, true)
+BENCHMARK_NAMED_PARAM(unrelatedPrefixFlap, Full_1M, 1'000'000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(unrelatedPrefixFlap, Incr_1M, 1'000'000, true)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(loopbackFlap, Full_10k, 10'000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(loopbackFlap, Incr_10k, 10'000, true)
+BENCHMARK_NAMED_PARAM(loopbackFlap, Full_100k, 100'000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(loopbackFlap, Incr_100k, 100'000, true)
+BENCHMARK_NAMED_PARAM(loopbackFlap, Full_1M, 1'000'000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(loopbackFlap, Incr_1M, 1'000'000, true)
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
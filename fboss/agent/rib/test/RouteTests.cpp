@@ -11,6 +11,7 @@
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/Utils.h"
 #include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
 #include "fboss/agent/rib/RouteNextHop.h"
 #include "fboss/agent/rib/RouteNextHopEntry.h"
 #include "fboss/agent/rib/RouteTypes.h"
@@ -21,6 +22,7 @@
 #include <folly/logging/xlog.h>
 
 #include <gtest/gtest.h>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -293,6 +295,121 @@ TEST(Route, resolve) {
   }
 }
 
+// Re-resolving only the routes affected by an update must give the same result
+// as re-resolving every route
+TEST(Route, resolveIncremental) {
+  IPv4NetworkToRouteMap v4Full;
+  IPv6NetworkToRouteMap v6Full;
+  IPv4NetworkToRouteMap v4Incremental;
+  IPv6NetworkToRouteMap v6Incremental;
+  NextHopDependencyIndex nextHopDependencies;
+
+  configRoutes(&v4Full, &v6Full);
+  configRoutes(&v4Incremental, &v6Incremental);
+
+  auto update = [&](std::function<void(RouteUpdater*)> updateFn) {
+    RouteUpdater full(&v4Full, &v6Full);
+    updateFn(&full);
+    full.updateDone();
+
+    RouteUpdater incremental(
+        &v4Incremental, &v6Incremental, &nextHopDependencies);
+    updateFn(&incremental);
+    incremental.updateDone();
+
+    EXPECT_TRUE(nextHopDependencies.isInitialized());
+    EXPECT_ROUTES_MATCH(&v4Full, &v4Incremental);
+    EXPECT_ROUTES_MATCH(&v6Full, &v6Incremental);
+  };
+
+  // The first update populates the index through a full resolution
+  update([](RouteUpdater* u) {
+    u->addRoute(
+        IPAddress("10.0.0.0"),
+        24,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"1.1.1.10"}), kDistance));
+    u->addRoute(
+        IPAddress("20.0.0.0"),
+        24,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"10.0.0.1"}), kDistance));
+    u->addRoute(
+        IPAddress("30.0.0.0"),
+        24,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"20.0.0.1", "2.2.2.20"}), kDistance));
+    u->addRoute(
+        IPAddress("5::"),
+        64,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"20.0.0.1"}), kDistance));
+    u->addRoute(
+        IPAddress("40.0.0.0"),
+        24,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"50.0.0.1"}), kDistance));
+  });
+  EXPECT_TRUE(getRoute(v4Incremental, "40.0.0.0/24")->isUnresolvable());
+
+  // A new covering route resolves a previously unresolvable route
+  update([](RouteUpdater* u) {
+    u->addRoute(
+        IPAddress("50.0.0.0"),
+        8,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"3.3.3.30"}), kDistance));
+  });
+  EXPECT_RESOLVED(getRoute(v4Incremental, "40.0.0.0/24"));
+
+  // A more specific route changes the resolution of recursive dependents,
+  // including the v6 route with a v4 next hop
+  update([](RouteUpdater* u) {
+    u->addRoute(
+        IPAddress("10.0.0.0"),
+        28,
+        kClientB,
+        RouteNextHopEntry(makeNextHops({"4.4.4.40"}), kDistance));
+  });
+  EXPECT_FWD_INFO(
+      getRoute(v6Incremental, "5::/64"), InterfaceID(4), "4.4.4.40");
+
+  update([](RouteUpdater* u) {
+    u->delRoute(IPAddress("10.0.0.0"), 28, kClientB);
+  });
+  EXPECT_FWD_INFO(
+      getRoute(v6Incremental, "5::/64"), InterfaceID(1), "1.1.1.10");
+
+  update([](RouteUpdater* u) {
+    u->delRoute(IPAddress("10.0.0.0"), 24, kClientA);
+  });
+  EXPECT_TRUE(getRoute(v4Incremental, "20.0.0.0/24")->isUnresolvable());
+  EXPECT_TRUE(getRoute(v6Incremental, "5::/64")->isUnresolvable());
+  EXPECT_FWD_INFO(
+      getRoute(v4Incremental, "30.0.0.0/24"), InterfaceID(2), "2.2.2.20");
+
+  // Routes forming a loop stay unresolvable
+  update([](RouteUpdater* u) {
+    u->addRoute(
+        IPAddress("60.0.0.0"),
+        8,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"70.0.0.1"}), kDistance));
+    u->addRoute(
+        IPAddress("70.0.0.0"),
+        8,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"60.0.0.1"}), kDistance));
+  });
+  EXPECT_TRUE(getRoute(v4Incremental, "60.0.0.0/8")->isUnresolvable());
+  EXPECT_TRUE(getRoute(v4Incremental, "70.0.0.0/8")->isUnresolvable());
+
+  update([](RouteUpdater* u) {
+    u->removeAllRoutesForClient(kClientA);
+  });
+  EXPECT_EQ(0, nextHopDependencies.numDependents());
+}
+
 TEST(Route, resolveDropToCPUMix) {
   IPv4NetworkToRouteMap v4Routes;
   IPv6NetworkToRouteMap v6Routes;
@@ -1365,6 +1482,87 @@ TEST(Route, serializeRouteTable) {
   EXPECT_ROUTES_MATCH(origV6Routes, &newV6Routes);
 }
 
+template <typename AddressT>
+using CompactNetworkToRouteMap = NetworkToRouteMap<
+    AddressT,
+    facebook::network::CompactRadixTree<AddressT, Route<AddressT>>>;
+
+// NetworkToRouteMap backed by CompactRadixTree, see FBOSS_COMPACT_RADIX_TREE
+TEST(Route, compactNetworkToRouteMap) {
+  CompactNetworkToRouteMap<IPAddressV4> routes;
+  RouteNextHopEntry entry(makeNextHops({"1.1.1.10"}), kDistance);
+  auto addRoute = [&](std::string prefixAsString) {
+    auto prefix = PrefixV4::fromString(prefixAsString);
+    return routes
+        .insert(
+            prefix.network,
+            prefix.mask,
+            Route<IPAddressV4>(prefix, kClientA, entry))
+        .second;
+  };
+  EXPECT_TRUE(addRoute("10.0.0.0/8"));
+  EXPECT_TRUE(addRoute("10.1.0.0/16"));
+  EXPECT_TRUE(addRoute("10.1.1.0/24"));
+  EXPECT_TRUE(addRoute("20.0.0.0/8"));
+  // Adding an existing prefix keeps the existing route
+  EXPECT_FALSE(addRoute("10.1.0.0/16"));
+  EXPECT_EQ(4, routes.size());
+
+  auto exactMatch = routes.exactMatch(IPAddressV4("10.1.0.0"), 16);
+  ASSERT_NE(routes.end(), exactMatch);
+  EXPECT_EQ(PrefixV4::fromString("10.1.0.0/16"), exactMatch->value().prefix());
+  EXPECT_TRUE(exactMatch->value().has(kClientA, entry));
+  EXPECT_EQ(routes.end(), routes.exactMatch(IPAddressV4("10.1.0.0"), 12));
+
+  auto longestMatch = [&](std::string ipAsString) -> std::string {
+    auto it = routes.longestMatch(IPAddressV4(ipAsString), 32);
+    return it == routes.end() ? "" : it->value().prefix().str();
+  };
+  EXPECT_EQ("10.1.1.0/24", longestMatch("10.1.1.1"));
+  EXPECT_EQ("10.1.0.0/16", longestMatch("10.1.2.1"));
+  EXPECT_EQ("10.0.0.0/8", longestMatch("10.2.0.1"));
+  EXPECT_EQ("", longestMatch("30.0.0.1"));
+
+  // Iteration visits every route, each before the more specific ones
+  std::vector<std::string> prefixes;
+  for (const auto& node : routes) {
+    prefixes.push_back(node.value().prefix().str());
+  }
+  EXPECT_EQ(
+      std::vector<std::string>(
+          {"10.0.0.0/8", "10.1.0.0/16", "10.1.1.0/24", "20.0.0.0/8"}),
+      prefixes);
+
+  EXPECT_TRUE(routes.erase(IPAddressV4("10.1.0.0"), 16));
+  EXPECT_FALSE(routes.erase(IPAddressV4("10.1.0.0"), 16));
+  EXPECT_EQ(3, routes.size());
+  EXPECT_EQ(routes.end(), routes.exactMatch(IPAddressV4("10.1.0.0"), 16));
+  EXPECT_EQ("10.1.1.0/24", longestMatch("10.1.1.1"));
+  EXPECT_EQ("10.0.0.0/8", longestMatch("10.1.2.1"));
+}
+
+TEST(Route, serializeCompactNetworkToRouteMap) {
+  CompactNetworkToRouteMap<IPAddressV6> routes;
+  RouteNextHopEntry entry(makeNextHops({"1::10"}), kDistance);
+  for (auto prefixAsString : {"1001::/48", "1001::/64", "2001::/48"}) {
+    auto prefix = PrefixV6::fromString(prefixAsString);
+    routes.insert(
+        prefix.network,
+        prefix.mask,
+        Route<IPAddressV6>(prefix, kClientA, entry));
+  }
+
+  auto newRoutes = CompactNetworkToRouteMap<IPAddressV6>::fromFollyDynamic(
+      routes.toFollyDynamic());
+  EXPECT_EQ(routes.size(), newRoutes.size());
+  for (const auto& node : routes) {
+    const auto& prefix = node.value().prefix();
+    auto it = newRoutes.exactMatch(prefix.network, prefix.mask);
+    ASSERT_NE(newRoutes.end(), it);
+    EXPECT_TRUE(it->value().isSame(&node.value()));
+  }
+}
+
 // Test utility functions for converting RouteNextHopSet to thrift and back
 TEST(RouteTypes, toFromRouteNextHops) {
   RouteNextHopSet nhs;
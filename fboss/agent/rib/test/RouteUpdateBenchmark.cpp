@@ -149,9 +149,10 @@ static void runNewRibTest() {
         [](RouterID vrf,
            const rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
            const rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+           const std::vector<folly::CIDRNetwork>* affectedPrefixes,
            void* cookie) {
           rib::ForwardingInformationBaseUpdater fibUpdater(
-              vrf, v4NetworkToRoute, v6NetworkToRoute);
+              vrf, v4NetworkToRoute, v6NetworkToRoute, affectedPrefixes);
           static_cast<SwSwitch*>(cookie)->updateStateBlocking(
               "", std::move(fibUpdater));
         },
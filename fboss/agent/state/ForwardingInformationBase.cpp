@@ -11,11 +11,27 @@
 
 #include "fboss/agent/state/NodeMap-defs.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+
 namespace facebook::fboss {
 
+namespace {
+// Overlays up to this many changed prefixes, however small the index
+constexpr size_t kMinLpmOverlaySize = 64;
+} // namespace
+
 template <typename AddressT>
 ForwardingInformationBase<AddressT>::ForwardingInformationBase() {}
 
+template <typename AddressT>
+ForwardingInformationBase<AddressT>::ForwardingInformationBase(
+    const ForwardingInformationBase* orig)
+    : Base(orig),
+      parentLpmIndex_(orig->lpmIndex_.load()),
+      parentNodes_(parentLpmIndex_ ? orig->getAllNodes() : NodeContainer()) {}
+
 template <typename AddressT>
 ForwardingInformationBase<AddressT>::~ForwardingInformationBase() {}
 
@@ -30,6 +46,158 @@ template <typename AddressT>
 std::shared_ptr<Route<AddressT>>
 ForwardingInformationBase<AddressT>::longestMatch(
     const AddressT& address) const {
+  if (!this->isPublished()) {
+    return longestMatchByScan(address);
+  }
+  auto index = getLpmIndex();
+  const auto& base = *index->base;
+  for (auto mask : index->masks) {
+    auto network = address.mask(mask);
+    if (!index->overlay.empty()) {
+      auto it = index->overlay.find(RoutePrefix<AddressT>{network, mask});
+      if (it != index->overlay.end()) {
+        if (it->second) {
+          return it->second;
+        }
+        // Removed since the index was built
+        continue;
+      }
+    }
+    auto slot = base.slotOfMask[mask];
+    if (slot < 0) {
+      continue;
+    }
+    const auto& routes = base.byLength[slot].routes;
+    auto it = routes.find(network);
+    if (it != routes.end()) {
+      return it->second;
+    }
+  }
+  return nullptr;
+}
+
+template <typename AddressT>
+void ForwardingInformationBase<AddressT>::publish() {
+  if (this->isPublished()) {
+    return;
+  }
+  if (parentLpmIndex_) {
+    lpmIndex_.store(patchLpmIndex(*parentLpmIndex_, parentNodes_));
+    parentLpmIndex_.reset();
+    parentNodes_.clear();
+  }
+  Base::publish();
+}
+
+template <typename AddressT>
+std::shared_ptr<const typename ForwardingInformationBase<AddressT>::LpmIndex>
+ForwardingInformationBase<AddressT>::getLpmIndex() const {
+  auto index = lpmIndex_.load();
+  if (index) {
+    return index;
+  }
+  std::lock_guard<std::mutex> guard(lpmIndexLock_);
+  index = lpmIndex_.load();
+  if (!index) {
+    index = buildLpmIndex();
+    lpmIndex_.store(index);
+  }
+  return index;
+}
+
+template <typename AddressT>
+std::shared_ptr<const typename ForwardingInformationBase<AddressT>::LpmIndex>
+ForwardingInformationBase<AddressT>::buildLpmIndex() const {
+  auto base = std::make_shared<LpmBase>();
+  std::map<uint8_t, PrefixLengthRoutes, std::greater<uint8_t>> byMask;
+  for (const auto& prefixAndRoute : Base::getAllNodes()) {
+    const auto& prefix = prefixAndRoute.first;
+    auto& prefixLengthRoutes = byMask[prefix.mask];
+    prefixLengthRoutes.mask = prefix.mask;
+    // Like the scan, the first of two prefixes that only differ in their
+    // host bits wins
+    auto network = prefix.network.mask(prefix.mask);
+    base->hasHostBits |= network != prefix.network;
+    prefixLengthRoutes.routes.emplace(network, prefixAndRoute.second);
+  }
+  base->numRoutes = Base::size();
+
+  auto index = std::make_shared<LpmIndex>();
+  base->slotOfMask.resize(AddressT::bitCount() + 1, -1);
+  base->byLength.reserve(byMask.size());
+  for (auto& maskAndRoutes : byMask) {
+    base->slotOfMask[maskAndRoutes.first] = base->byLength.size();
+    index->masks.push_back(maskAndRoutes.first);
+    base->byLength.push_back(std::move(maskAndRoutes.second));
+  }
+  index->base = std::move(base);
+  return index;
+}
+
+template <typename AddressT>
+std::shared_ptr<const typename ForwardingInformationBase<AddressT>::LpmIndex>
+ForwardingInformationBase<AddressT>::patchLpmIndex(
+    const LpmIndex& parentIndex,
+    const NodeContainer& parentNodes) const {
+  if (parentIndex.base->hasHostBits) {
+    return nullptr;
+  }
+  auto index = std::make_shared<LpmIndex>(parentIndex);
+  auto maxOverlaySize =
+      std::max(index->base->numRoutes / 4, kMinLpmOverlaySize);
+  auto overlay = [&index](
+                     const RoutePrefix<AddressT>& prefix,
+                     const std::shared_ptr<Route<AddressT>>& route) {
+    if (prefix.network.mask(prefix.mask) != prefix.network) {
+      return false;
+    }
+    index->overlay.insert_or_assign(prefix, route);
+    auto& masks = index->masks;
+    auto pos = std::lower_bound(
+        masks.begin(), masks.end(), prefix.mask, std::greater<uint8_t>());
+    if (route && (pos == masks.end() || *pos != prefix.mask)) {
+      masks.insert(pos, prefix.mask);
+    }
+    return true;
+  };
+
+  // Walk the prefixes changed since the parent, skipping over the parts of
+  // the route map we still share with it
+  const auto& nodes = Base::getAllNodes();
+  auto oldIt = parentNodes.begin();
+  auto newIt = nodes.begin();
+  while (oldIt != parentNodes.end() || newIt != nodes.end()) {
+    bool overlaid;
+    if (newIt == nodes.end() ||
+        (oldIt != parentNodes.end() && oldIt->first < newIt->first)) {
+      overlaid = overlay(oldIt->first, nullptr);
+      ++oldIt;
+    } else if (oldIt == parentNodes.end() || newIt->first < oldIt->first) {
+      overlaid = overlay(newIt->first, newIt->second);
+      ++newIt;
+    } else if (oldIt->second == newIt->second) {
+      if (!NodeContainer::skipShared(oldIt, newIt)) {
+        ++oldIt;
+        ++newIt;
+      }
+      continue;
+    } else {
+      overlaid = overlay(newIt->first, newIt->second);
+      ++oldIt;
+      ++newIt;
+    }
+    if (!overlaid || index->overlay.size() > maxOverlaySize) {
+      // Rebuild the index on the next lookup instead
+      return nullptr;
+    }
+  }
+  return index;
+}
+
+template <typename AddressT>
+std::shared_ptr<Route<AddressT>>
+ForwardingInformationBase<AddressT>::longestMatchByScan(
+    const AddressT& address) const {
   std::shared_ptr<Route<AddressT>> longestMatchRoute = nullptr;
   // longestCommonLength must be wider than int8_t because it needs to hold
   // values in the range [-1, 128].
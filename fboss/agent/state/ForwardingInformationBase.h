@@ -15,12 +15,26 @@
 
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
+#include <folly/container/F14Map.h>
+
+#include <mutex>
+#include <vector>
 
 namespace facebook::fboss {
 
+/*
+ * FIBs hold every route of a VRF and are updated a few routes at a time, so
+ * they are kept in a PersistentMap. Cloning a FIB to patch the routes changed
+ * by a RIB update then costs O(changes * log n), and so does the StateDelta
+ * between the two FIBs.
+ */
 template <typename AddressT>
-using ForwardingInformationBaseTraits =
-    NodeMapTraits<RoutePrefix<AddressT>, Route<AddressT>>;
+using ForwardingInformationBaseTraits = NodeMapTraits<
+    RoutePrefix<AddressT>,
+    Route<AddressT>,
+    NodeMapNoExtraFields,
+    PersistentMap<RoutePrefix<AddressT>, std::shared_ptr<Route<AddressT>>>>;
 
 template <typename AddressT>
 class ForwardingInformationBase
@@ -34,16 +48,81 @@ class ForwardingInformationBase
   using Base = NodeMapT<
       ForwardingInformationBase<AddressT>,
       ForwardingInformationBaseTraits<AddressT>>;
+  using NodeContainer = typename Base::NodeContainer;
 
   std::shared_ptr<Route<AddressT>> exactMatch(
       const RoutePrefix<AddressT>& prefix) const;
 
+  /*
+   * Published FIBs are looked up through an index, with one hash lookup per
+   * prefix length in use. Unpublished FIBs can still change, so they are
+   * scanned instead.
+   */
   std::shared_ptr<Route<AddressT>> longestMatch(const AddressT& address) const;
 
+  void publish() override;
+
  private:
   // Inherit the constructors required for clone()
   using Base::Base;
   friend class CloneAllocator;
+
+  // Constructor used by clone()
+  explicit ForwardingInformationBase(const ForwardingInformationBase* orig);
+
+  /*
+   * The routes with one prefix length, keyed by their masked network.
+   */
+  struct PrefixLengthRoutes {
+    uint8_t mask{0};
+    folly::F14FastMap<AddressT, std::shared_ptr<Route<AddressT>>> routes;
+  };
+
+  /*
+   * An index of all the routes of one FIB generation. It is only built on
+   * the first lookup that needs it, and is then shared by the following
+   * generations.
+   */
+  struct LpmBase {
+    // Ordered from the longest prefix length to the shortest
+    std::vector<PrefixLengthRoutes> byLength;
+    // Position of each prefix length in byLength, -1 if unused
+    std::vector<int16_t> slotOfMask;
+    size_t numRoutes{0};
+    // Whether two prefixes only differ in their host bits, in which case
+    // changed prefixes cannot be overlaid on top of the index
+    bool hasHostBits{false};
+  };
+
+  /*
+   * A FIB cloned from an indexed one overlays the prefixes changed since
+   * on top of its parent's index when it is published, which costs
+   * O(changes * log n) rather than rebuilding the index. Once the overlay
+   * grows past a quarter of the indexed routes, the index is rebuilt on
+   * the next lookup instead.
+   */
+  struct LpmIndex {
+    std::shared_ptr<const LpmBase> base;
+    // Routes changed since base was built, nullptr for removed ones
+    NodeContainer overlay;
+    // Prefix lengths in base or overlay, longest first
+    std::vector<uint8_t> masks;
+  };
+
+  std::shared_ptr<Route<AddressT>> longestMatchByScan(
+      const AddressT& address) const;
+  std::shared_ptr<const LpmIndex> getLpmIndex() const;
+  std::shared_ptr<const LpmIndex> buildLpmIndex() const;
+  std::shared_ptr<const LpmIndex> patchLpmIndex(
+      const LpmIndex& parentIndex,
+      const NodeContainer& parentNodes) const;
+
+  mutable folly::atomic_shared_ptr<const LpmIndex> lpmIndex_;
+  // Serializes building lpmIndex_ on lookups from several threads
+  mutable std::mutex lpmIndexLock_;
+  // The index and routes of the FIB we were cloned from, until published
+  std::shared_ptr<const LpmIndex> parentLpmIndex_;
+  NodeContainer parentNodes_;
 };
 
 using ForwardingInformationBaseV4 =
@@ -19,7 +19,11 @@
 
 namespace facebook::fboss {
 
-using MacTableTraits = NodeMapTraits<folly::MacAddress, MacEntry>;
+using MacTableTraits = NodeMapTraits<
+    folly::MacAddress,
+    MacEntry,
+    NodeMapNoExtraFields,
+    PersistentMap<folly::MacAddress, std::shared_ptr<MacEntry>>>;
 
 class MacTable : public NodeMapT<MacTable, MacTableTraits> {
  public:
@@ -58,7 +62,7 @@ class MacTable : public NodeMapT<MacTable, MacTableTraits> {
     entry->setMac(mac);
     entry->setPort(portDescr);
     entry->setClassID(classID);
-    it->second = entry;
+    nodes.insert_or_assign(mac, entry);
   }
 
  private:
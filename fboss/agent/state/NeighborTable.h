@@ -30,6 +30,7 @@ struct NeighborTableTraits {
   typedef IPADDR KeyType;
   typedef ENTRY Node;
   typedef NodeMapNoExtraFields ExtraFields;
+  typedef PersistentMap<IPADDR, std::shared_ptr<ENTRY>> NodeContainer;
 
   static KeyType getKey(const std::shared_ptr<Node>& entry) {
     return entry->getIP();
@@ -39,12 +40,9 @@ struct NeighborTableTraits {
 /*
  * A map of IP --> MAC for the IP addresses of other nodes on a VLAN.
  *
- * TODO: We should switch from NodeMap to PrefixMap when the new PrefixMap
- * implementation is ready.
- *
- * Any change to a NodeMap is O(N), so it is really only suitable for small
- * maps that do not change frequently.  Our new PrefixMap implementation will
- * allow us to perform cheaper copy-on-write updates.
+ * Neighbor tables can grow large and change often, so they are backed by a
+ * PersistentMap, which makes cloning the table to add, update or remove a
+ * single entry O(log N) rather than O(N).
  */
 template <typename IPADDR, typename ENTRY, typename SUBCLASS>
 class NeighborTable
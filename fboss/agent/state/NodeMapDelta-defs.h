@@ -30,11 +30,7 @@ NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::Iterator(
       newMap_(newMap),
       value_(nullNode_, nullNode_) {
   // Advance to the first difference
-  while (oldIt_ != oldMap_->end() && newIt_ != newMap_->end() &&
-         *oldIt_ == *newIt_) {
-    ++oldIt_;
-    ++newIt_;
-  }
+  skipUnchanged();
   updateValue();
 }
 
@@ -101,12 +97,21 @@ void NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::advance() {
   }
 
   // Advance past any unchanged nodes.
+  skipUnchanged();
+  updateValue();
+}
+
+template <typename MAP, typename VALUE, typename MAPPOINTERTRAITS>
+void NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::skipUnchanged() {
   while (oldIt_ != oldMap_->end() && newIt_ != newMap_->end() &&
          *oldIt_ == *newIt_) {
-    ++oldIt_;
-    ++newIt_;
+    // Skip whole subtrees shared by the two maps at once, if the
+    // NodeContainer allows it.
+    if (!oldIt_.skipShared(newIt_)) {
+      ++oldIt_;
+      ++newIt_;
+    }
   }
-  updateValue();
 }
 
 } // namespace facebook::fboss
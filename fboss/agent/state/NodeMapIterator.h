@@ -11,6 +11,8 @@
 
 #include <boost/container/flat_map.hpp>
 
+#include "fboss/agent/state/PersistentMap.h"
+
 /*
  * NodeMapIterator is a very small wrapper around flat_map::const_iterator.
  *
@@ -52,6 +54,18 @@ class NodeMapIterator
     return it_ != other.it_;
   }
 
+  /*
+   * Advance this and other past the entries their containers share, when the
+   * containers support structural sharing. Returns false if nothing was
+   * skipped.
+   */
+  bool skipShared(NodeMapIterator& other) {
+    if constexpr (facebook::fboss::IsPersistentMap<NodeContainer>::value) {
+      return NodeContainer::skipShared(it_, other.it_);
+    }
+    return false;
+  }
+
  private:
   typename NodeContainer::const_iterator it_;
 };
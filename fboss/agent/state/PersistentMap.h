@@ -0,0 +1,504 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/small_vector.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace facebook::fboss {
+
+/*
+ * PersistentMap is a sorted map implemented as a copy-on-write B+ tree.
+ *
+ * It is meant to be used as the NodeContainer of NodeMaps that hold a large
+ * number of entries, e.g. ARP, NDP and MAC tables. Copying a PersistentMap
+ * only copies a pointer to the root of the tree, and the tree nodes are then
+ * shared between the copies. Modifying a copy clones the nodes on the path
+ * from the root to the modified entry, so cloning a NodeMap to make a single
+ * change costs O(log n) rather than O(n) with a flat_map.
+ *
+ * The interface is the subset of boost::container::flat_map used by
+ * NodeMapT. Iterators are const, and are invalidated by any modification of
+ * the map.
+ */
+template <typename KeyT, typename ValueT>
+class PersistentMap {
+  struct Node;
+  using NodePtr = std::shared_ptr<const Node>;
+
+ public:
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = std::pair<KeyT, ValueT>;
+  using size_type = size_t;
+  class const_iterator;
+  using iterator = const_iterator;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  const_iterator begin() const;
+  const_iterator end() const {
+    return const_iterator(root_.get());
+  }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  const_iterator find(const KeyT& key) const;
+
+  std::pair<const_iterator, bool> insert(value_type value);
+  template <typename V>
+  std::pair<const_iterator, bool> insert_or_assign(const KeyT& key, V&& value);
+
+  size_t erase(const KeyT& key);
+  void erase(const_iterator pos) {
+    erase(pos->first);
+  }
+
+  void clear() {
+    root_.reset();
+    size_ = 0;
+  }
+
+  /*
+   * If a and b, iterating over two PersistentMaps, are at the same position
+   * of a subtree the two maps share, move both past the end of the largest
+   * such subtree and return true. Entries skipped this way are identical in
+   * both maps.
+   *
+   * This lets NodeMapDelta skip over the unchanged parts of two versions of a
+   * map without visiting them.
+   */
+  static bool skipShared(const_iterator& a, const_iterator& b);
+
+ private:
+  /*
+   * Leaf nodes hold the map entries, in key order. Internal nodes hold their
+   * children, and keys[i] is the lowest key that may be stored under
+   * children[i + 1].
+   *
+   * Nodes are never modified once shared by more than one parent (or map).
+   */
+  struct Node {
+    bool isLeaf() const {
+      return children.empty();
+    }
+    size_t size() const {
+      return isLeaf() ? entries.size() : children.size();
+    }
+    size_t childIndex(const KeyT& key) const {
+      return std::upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+    }
+    typename std::vector<value_type>::const_iterator lowerBound(
+        const KeyT& key) const {
+      return std::lower_bound(
+          entries.begin(),
+          entries.end(),
+          key,
+          [](const value_type& entry, const KeyT& k) {
+            return entry.first < k;
+          });
+    }
+
+    std::vector<value_type> entries;
+    std::vector<KeyT> keys;
+    std::vector<NodePtr> children;
+  };
+
+  static constexpr size_t kMaxNodeSize = 32;
+  static constexpr size_t kMinNodeSize = kMaxNodeSize / 4;
+
+  static Node* mutableNode(NodePtr* node);
+  static std::pair<NodePtr, KeyT> split(Node* node);
+
+  std::optional<std::pair<NodePtr, KeyT>> insertImpl(
+      NodePtr* node,
+      value_type&& value);
+  template <typename V>
+  void assignImpl(NodePtr* node, const KeyT& key, V&& value);
+  void eraseImpl(NodePtr* node, const KeyT& key);
+  void rebalance(Node* parent, size_t childIdx);
+
+  NodePtr root_;
+  size_t size_{0};
+};
+
+template <typename KeyT, typename ValueT>
+class PersistentMap<KeyT, ValueT>::const_iterator {
+ public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename PersistentMap::value_type;
+  using difference_type = ptrdiff_t;
+  using pointer = const value_type*;
+  using reference = const value_type&;
+
+  const_iterator() {}
+  /* implicit */ const_iterator(std::nullptr_t) {}
+
+  reference operator*() const {
+    return path_.back().first->entries[path_.back().second];
+  }
+  pointer operator->() const {
+    return &operator*();
+  }
+
+  const_iterator& operator++() {
+    advance(path_.size());
+    return *this;
+  }
+  const_iterator operator++(int) {
+    const_iterator tmp(*this);
+    ++(*this);
+    return tmp;
+  }
+  const_iterator& operator--();
+  const_iterator operator--(int) {
+    const_iterator tmp(*this);
+    --(*this);
+    return tmp;
+  }
+
+  bool operator==(const const_iterator& other) const {
+    if (path_.empty() || other.path_.empty()) {
+      return path_.empty() && other.path_.empty();
+    }
+    return path_.back() == other.path_.back();
+  }
+  bool operator!=(const const_iterator& other) const {
+    return !operator==(other);
+  }
+
+ private:
+  friend class PersistentMap;
+
+  explicit const_iterator(const Node* root) : root_(root) {}
+
+  /*
+   * Move to the first entry of the subtree at the current position of
+   * path_.back(), which must be valid.
+   */
+  void descendLeftmost() {
+    while (!path_.back().first->isLeaf()) {
+      const auto& [node, idx] = path_.back();
+      path_.emplace_back(node->children[idx].get(), 0);
+    }
+  }
+  void descendRightmost() {
+    while (!path_.back().first->isLeaf()) {
+      const auto& [node, idx] = path_.back();
+      auto child = node->children[idx].get();
+      path_.emplace_back(child, child->size() - 1);
+    }
+  }
+
+  /*
+   * Drop everything below depth in path_, and move to the first entry past
+   * the subtree path_[depth - 1] currently points to.
+   */
+  void advance(size_t depth) {
+    path_.resize(depth);
+    while (!path_.empty()) {
+      auto& [node, idx] = path_.back();
+      if (++idx < node->size()) {
+        descendLeftmost();
+        return;
+      }
+      path_.pop_back();
+    }
+  }
+
+  // root_ is needed to step back from end()
+  const Node* root_{nullptr};
+  // Nodes from the root to the current leaf, along with the index of the
+  // child (or entry) we are at in each. Empty for end().
+  folly::small_vector<std::pair<const Node*, uint32_t>, 6> path_;
+};
+
+template <typename KeyT, typename ValueT>
+typename PersistentMap<KeyT, ValueT>::const_iterator&
+PersistentMap<KeyT, ValueT>::const_iterator::operator--() {
+  if (path_.empty()) {
+    DCHECK(root_);
+    path_.emplace_back(root_, root_->size() - 1);
+    descendRightmost();
+    return *this;
+  }
+  while (path_.back().second == 0) {
+    path_.pop_back();
+    // Decrementing begin() is undefined behavior
+    DCHECK(!path_.empty());
+  }
+  --path_.back().second;
+  descendRightmost();
+  return *this;
+}
+
+template <typename KeyT, typename ValueT>
+typename PersistentMap<KeyT, ValueT>::const_iterator
+PersistentMap<KeyT, ValueT>::begin() const {
+  const_iterator it(root_.get());
+  if (root_) {
+    it.path_.emplace_back(root_.get(), 0);
+    it.descendLeftmost();
+  }
+  return it;
+}
+
+template <typename KeyT, typename ValueT>
+typename PersistentMap<KeyT, ValueT>::const_iterator
+PersistentMap<KeyT, ValueT>::find(const KeyT& key) const {
+  if (!root_) {
+    return end();
+  }
+  const_iterator it(root_.get());
+  auto node = root_.get();
+  while (!node->isLeaf()) {
+    auto idx = node->childIndex(key);
+    it.path_.emplace_back(node, idx);
+    node = node->children[idx].get();
+  }
+  auto entry = node->lowerBound(key);
+  if (entry == node->entries.end() || key < entry->first) {
+    return end();
+  }
+  it.path_.emplace_back(node, entry - node->entries.begin());
+  return it;
+}
+
+template <typename KeyT, typename ValueT>
+std::pair<typename PersistentMap<KeyT, ValueT>::const_iterator, bool>
+PersistentMap<KeyT, ValueT>::insert(value_type value) {
+  auto it = find(value.first);
+  if (it != end()) {
+    return std::make_pair(it, false);
+  }
+  auto key = value.first;
+  if (!root_) {
+    auto leaf = std::make_shared<Node>();
+    leaf->entries.push_back(std::move(value));
+    root_ = std::move(leaf);
+  } else if (auto split = insertImpl(&root_, std::move(value))) {
+    // Root was split, grow the tree by one level
+    auto newRoot = std::make_shared<Node>();
+    newRoot->children.push_back(std::move(root_));
+    newRoot->children.push_back(std::move(split->first));
+    newRoot->keys.push_back(std::move(split->second));
+    root_ = std::move(newRoot);
+  }
+  ++size_;
+  return std::make_pair(find(key), true);
+}
+
+template <typename KeyT, typename ValueT>
+template <typename V>
+std::pair<typename PersistentMap<KeyT, ValueT>::const_iterator, bool>
+PersistentMap<KeyT, ValueT>::insert_or_assign(const KeyT& key, V&& value) {
+  if (find(key) == end()) {
+    return insert(value_type(key, std::forward<V>(value)));
+  }
+  assignImpl(&root_, key, std::forward<V>(value));
+  return std::make_pair(find(key), false);
+}
+
+template <typename KeyT, typename ValueT>
+size_t PersistentMap<KeyT, ValueT>::erase(const KeyT& key) {
+  if (find(key) == end()) {
+    return 0;
+  }
+  eraseImpl(&root_, key);
+  if (root_->size() == 0) {
+    root_.reset();
+  } else if (!root_->isLeaf() && root_->size() == 1) {
+    // Root is left with a single child, shrink the tree by one level
+    root_ = NodePtr(root_->children.front());
+  }
+  --size_;
+  return 1;
+}
+
+template <typename KeyT, typename ValueT>
+bool PersistentMap<KeyT, ValueT>::skipShared(
+    const_iterator& a,
+    const_iterator& b) {
+  // Walk up from the leaves for as long as both paths go through the same
+  // nodes, at the same positions. The two trees may have different heights.
+  size_t shared = 0;
+  while (shared < a.path_.size() && shared < b.path_.size() &&
+         a.path_[a.path_.size() - 1 - shared] ==
+             b.path_[b.path_.size() - 1 - shared]) {
+    ++shared;
+  }
+  if (shared == 0) {
+    return false;
+  }
+  // The topmost shared node is identical in both maps, from the current
+  // position to its end. Move on to its next sibling.
+  a.advance(a.path_.size() - shared);
+  b.advance(b.path_.size() - shared);
+  return true;
+}
+
+template <typename KeyT, typename ValueT>
+typename PersistentMap<KeyT, ValueT>::Node*
+PersistentMap<KeyT, ValueT>::mutableNode(NodePtr* node) {
+  // Nodes are only ever created through make_shared<Node>(), so casting away
+  // const is safe. Nodes reachable from another map or parent must be copied
+  // first.
+  if (node->use_count() != 1) {
+    *node = std::make_shared<Node>(**node);
+  }
+  return const_cast<Node*>(node->get());
+}
+
+template <typename KeyT, typename ValueT>
+std::pair<typename PersistentMap<KeyT, ValueT>::NodePtr, KeyT>
+PersistentMap<KeyT, ValueT>::split(Node* node) {
+  auto right = std::make_shared<Node>();
+  auto mid = node->size() / 2;
+  if (node->isLeaf()) {
+    right->entries.assign(
+        std::make_move_iterator(node->entries.begin() + mid),
+        std::make_move_iterator(node->entries.end()));
+    node->entries.resize(mid);
+    auto key = right->entries.front().first;
+    return std::make_pair(std::move(right), std::move(key));
+  }
+  right->children.assign(
+      std::make_move_iterator(node->children.begin() + mid),
+      std::make_move_iterator(node->children.end()));
+  right->keys.assign(
+      std::make_move_iterator(node->keys.begin() + mid),
+      std::make_move_iterator(node->keys.end()));
+  auto key = std::move(node->keys[mid - 1]);
+  node->children.resize(mid);
+  node->keys.resize(mid - 1);
+  return std::make_pair(std::move(right), std::move(key));
+}
+
+/*
+ * Insert value, which must not be in the map yet, under node. If node
+ * overflows, it is split and the new right sibling is returned along with the
+ * lowest key it may hold.
+ */
+template <typename KeyT, typename ValueT>
+std::optional<
+    std::pair<typename PersistentMap<KeyT, ValueT>::NodePtr, KeyT>>
+PersistentMap<KeyT, ValueT>::insertImpl(NodePtr* nodePtr, value_type&& value) {
+  auto node = mutableNode(nodePtr);
+  if (node->isLeaf()) {
+    auto pos = node->entries.begin() +
+        (node->lowerBound(value.first) - node->entries.cbegin());
+    node->entries.insert(pos, std::move(value));
+  } else {
+    auto idx = node->childIndex(value.first);
+    if (auto split = insertImpl(&node->children[idx], std::move(value))) {
+      node->children.insert(
+          node->children.begin() + idx + 1, std::move(split->first));
+      node->keys.insert(node->keys.begin() + idx, std::move(split->second));
+    }
+  }
+  if (node->size() > kMaxNodeSize) {
+    return split(node);
+  }
+  return std::nullopt;
+}
+
+template <typename KeyT, typename ValueT>
+template <typename V>
+void PersistentMap<KeyT, ValueT>::assignImpl(
+    NodePtr* nodePtr,
+    const KeyT& key,
+    V&& value) {
+  auto node = mutableNode(nodePtr);
+  if (node->isLeaf()) {
+    auto idx = node->lowerBound(key) - node->entries.cbegin();
+    node->entries[idx].second = std::forward<V>(value);
+  } else {
+    assignImpl(
+        &node->children[node->childIndex(key)], key, std::forward<V>(value));
+  }
+}
+
+template <typename KeyT, typename ValueT>
+void PersistentMap<KeyT, ValueT>::eraseImpl(
+    NodePtr* nodePtr,
+    const KeyT& key) {
+  auto node = mutableNode(nodePtr);
+  if (node->isLeaf()) {
+    auto idx = node->lowerBound(key) - node->entries.cbegin();
+    node->entries.erase(node->entries.begin() + idx);
+    return;
+  }
+  auto idx = node->childIndex(key);
+  eraseImpl(&node->children[idx], key);
+  if (node->children[idx]->size() < kMinNodeSize) {
+    rebalance(node, idx);
+  }
+}
+
+/*
+ * Merge the underfull child at childIdx with one of its siblings. If the
+ * result is too large for a single node, split it again evenly.
+ */
+template <typename KeyT, typename ValueT>
+void PersistentMap<KeyT, ValueT>::rebalance(Node* parent, size_t childIdx) {
+  if (parent->children.size() < 2) {
+    // Only the root can have a single child, erase() takes care of it
+    return;
+  }
+  auto leftIdx =
+      childIdx + 1 < parent->children.size() ? childIdx : childIdx - 1;
+  auto left = mutableNode(&parent->children[leftIdx]);
+  // right is shared with the old version of the map, so copy from it
+  const auto& right = *parent->children[leftIdx + 1];
+  if (left->isLeaf()) {
+    left->entries.insert(
+        left->entries.end(), right.entries.begin(), right.entries.end());
+  } else {
+    left->keys.push_back(parent->keys[leftIdx]);
+    left->keys.insert(left->keys.end(), right.keys.begin(), right.keys.end());
+    left->children.insert(
+        left->children.end(), right.children.begin(), right.children.end());
+  }
+  if (left->size() <= kMaxNodeSize) {
+    parent->children.erase(parent->children.begin() + leftIdx + 1);
+    parent->keys.erase(parent->keys.begin() + leftIdx);
+  } else {
+    auto split = PersistentMap::split(left);
+    parent->children[leftIdx + 1] = std::move(split.first);
+    parent->keys[leftIdx] = std::move(split.second);
+  }
+}
+
+template <typename T>
+struct IsPersistentMap : std::false_type {};
+
+template <typename KeyT, typename ValueT>
+struct IsPersistentMap<PersistentMap<KeyT, ValueT>> : std::true_type {};
+
+} // namespace facebook::fboss
@@ -81,17 +81,9 @@ RouteTableRib<AddrT>* RouteTableRib<AddrT>::modify(
       (*state)->getRouteTables()->getRouteTable(id);
   RouteTable* clonedRouteTable = routeTable->modify(state);
 
+  // clone() clones radixTree_ as well, so radixTree_ and nodeMap_ of
+  // the clone are already in sync. We still use the old route pointers.
   auto clonedRib = this->clone();
-  // Generate the radix tree from the cloned nodeMap_. Remember, we haven't
-  // clone every route yet. So we will still use the old route pointer.
-  // Right now only revertNewRouteEntry() needs modify(). The expected result of
-  // modify() is that we have a cloned RouteTableRib return if the current one
-  // is published. To make sure the cloned RouteTableRib works, we need to
-  // ensure radixTree_ and nodeMap_ in sync before we return a newly cloned rib.
-  for (const auto& node : nodeMap_->getAllNodes()) {
-    clonedRib->radixTree_.insert(
-        node.first.network, node.first.mask, node.second);
-  }
   CHECK_EQ(clonedRib->size(), clonedRib->radixTree_.size());
 
   auto clonedRibPtr = clonedRib.get();
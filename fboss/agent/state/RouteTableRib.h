@@ -14,7 +14,8 @@
 #include "fboss/agent/state/NodeMap.h"
 #include "fboss/agent/state/RouteTypes.h"
 #include "fboss/agent/types.h"
-#include "fboss/lib/RadixTree.h"
+#include "fboss/lib/CompactRadixTree.h"
+#include "fboss/lib/PersistentRadixTree.h"
 
 namespace facebook::fboss {
 
@@ -25,9 +26,16 @@ class SwitchState;
 template <typename AddrT>
 class RouteTableRib;
 
+/*
+ * Cloned for every route update, so the routes are kept in a PersistentMap
+ * which clones in O(1) and adds or removes a route in O(log n).
+ */
 template <typename AddrT>
-using RouteTableRibNodeMapTraits =
-    NodeMapTraits<RoutePrefix<AddrT>, Route<AddrT>>;
+using RouteTableRibNodeMapTraits = NodeMapTraits<
+    RoutePrefix<AddrT>,
+    Route<AddrT>,
+    NodeMapNoExtraFields,
+    PersistentMap<RoutePrefix<AddrT>, std::shared_ptr<Route<AddrT>>>>;
 
 template <typename AddrT>
 class RouteTableRibNodeMap : public NodeMapT<
@@ -66,6 +74,26 @@ class RouteTableRibNodeMap : public NodeMapT<
   friend class CloneAllocator;
 };
 
+/*
+ * Trie for the RouteTableRib longest match lookups. It is persistent, so a
+ * cloned RouteTableRib shares the whole tree with the original, and adding
+ * or removing a route copies only the nodes on its path.
+ *
+ * Building with FBOSS_COMPACT_RADIX_TREE uses CompactRadixTree instead,
+ * here and in the RIB (see rib::NetworkToRouteMap). It takes far less
+ * memory per route, but clone() copies the whole tree and dedupRoutes()
+ * walks all of it.
+ */
+#ifdef FBOSS_COMPACT_RADIX_TREE
+template <typename AddrT>
+using RouteTableRibRadixTree =
+    facebook::network::CompactRadixTree<AddrT, std::shared_ptr<Route<AddrT>>>;
+#else
+template <typename AddrT>
+using RouteTableRibRadixTree = facebook::network::
+    PersistentRadixTree<AddrT, std::shared_ptr<Route<AddrT>>>;
+#endif
+
 template <typename AddrT>
 class RouteTableRib : public NodeBase {
  public:
@@ -77,8 +105,7 @@ class RouteTableRib : public NodeBase {
 
   using Prefix = RoutePrefix<AddrT>;
   using RouteType = Route<AddrT>;
-  using RoutesRadixTree =
-      facebook::network::RadixTree<AddrT, std::shared_ptr<Route<AddrT>>>;
+  using RoutesRadixTree = RouteTableRibRadixTree<AddrT>;
 
   bool empty() const {
     return nodeMap_->empty();
@@ -109,15 +136,14 @@ class RouteTableRib : public NodeBase {
     // In this clone(), we make sure the root RouteTableRib version increased by
     // 1. And then we use the default NodeMap clone() to clone the childNode
     // `nodeMap_`, so we don't have to clone every route in `nodeMap_`.
-    // Besides, we don't clone the RadixTree. So that, we can just add/update/
-    // remove routes on nodeMap_ and then call
-    // `cloneToRadixTreeWithForwardClear()` to build the whole radixTree_
-    // after all the changes.
+    // The RadixTree is cloned as well, which shares all its nodes with ours,
+    // so both copies are O(1) and the clone is ready for longest matches.
     auto routeTableRib =
         std::make_shared<RouteTableRib>(getNodeID(), getGeneration() + 1);
     // Note: this is the default NodeMap clone(), only the nodeMap pointer is
     // cloned, while all the routes are still the old route pointer.
     routeTableRib->nodeMap_ = nodeMap_->clone();
+    routeTableRib->radixTree_ = radixTree_.clone();
     return routeTableRib;
   }
 
@@ -143,7 +169,8 @@ class RouteTableRib : public NodeBase {
    * The following functions modify the static state.
    * These should only be called on unpublished objects which are only visible
    * to a single thread.
-   * To add/update/remove a route, we only do it on nodeMap_
+   * These only change nodeMap_, use the *InRadixTree() functions below to
+   * make the same change to radixTree_.
    */
   void addRoute(const std::shared_ptr<Route<AddrT>>& route);
   void updateRoute(const std::shared_ptr<Route<AddrT>>& route);
@@ -152,31 +179,13 @@ class RouteTableRib : public NodeBase {
     return nodeMap_->getRouteIf(prefix);
   }
 
-  void cloneToRadixTreeWithForwardClear() {
-    // We should expect this function is called only before we publish the rib
-    CHECK(!isPublished());
-    radixTree_.clear();
-    for (const auto& node : nodeMap_->getAllNodes()) {
-      auto route = node.second;
-      if (route->isPublished()) {
-        route = route->clone(RouteType::Fields::COPY_PREFIX_AND_NEXTHOPS);
-      }
-      route->clearForward();
-      radixTree_.insert(node.first.network, node.first.mask, route);
-    }
-    CHECK_EQ(size(), radixTree_.size());
-  }
-
   // STRONGLY RECOMMEND to use routes() which returns the NodeMap
-  // routesRadixTree() should only be used in the unit test to check whether
-  // noddeMap_ and radixTree_ in sync
+  // routesRadixTree() should only be used to check whether nodeMap_ and
+  // radixTree_ are in sync, or to find the routes that changed between two
+  // RouteTableRibs with RoutesRadixTree::forEachChanged()
   const RoutesRadixTree& routesRadixTree() const {
     return radixTree_;
   }
-  RoutesRadixTree& writableRoutesRadixTree() {
-    CHECK(!isPublished());
-    return radixTree_;
-  }
 
   std::shared_ptr<Route<AddrT>> longestMatch(const AddrT& nexthop) const {
     auto citr = radixTree_.longestMatch(nexthop, nexthop.bitCount());
@@ -195,15 +204,14 @@ class RouteTableRib : public NodeBase {
     }
   }
   void updateRouteInRadixTree(const std::shared_ptr<Route<AddrT>>& route) {
-    auto itr =
-        radixTree_.exactMatch(route->prefix().network, route->prefix().mask);
-    if (itr == radixTree_.end()) {
+    auto updated =
+        radixTree_.update(route->prefix().network, route->prefix().mask, route);
+    if (!updated) {
       throw FbossError(
           "Update failed, prefix for: ",
           route->str(),
           " not present in RadixTree");
     }
-    itr->value() = route;
   }
   void removeRouteInRadixTree(const std::shared_ptr<Route<AddrT>>& route) {
     auto erased =
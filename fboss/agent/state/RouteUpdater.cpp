@@ -11,6 +11,7 @@
 #include "RouteUpdater.h"
 
 #include <numeric>
+#include <type_traits>
 
 #include <boost/integer/common_factor.hpp>
 
@@ -26,6 +27,7 @@
 #include "fboss/agent/state/RouteTable.h"
 #include "fboss/agent/state/RouteTableMap.h"
 #include "fboss/agent/state/RouteTableRib.h"
+#include "fboss/lib/RadixTree.h"
 
 using boost::container::flat_map;
 using boost::container::flat_set;
@@ -124,6 +126,7 @@ void RouteUpdater::addRouteImpl(
       newRoute = old->clone(
           RouteFields<typename PrefixT::AddressT>::COPY_PREFIX_AND_NEXTHOPS);
       rib->updateRoute(newRoute);
+      rib->updateRouteInRadixTree(newRoute);
     } else {
       newRoute = old;
     }
@@ -132,8 +135,10 @@ void RouteUpdater::addRouteImpl(
   } else {
     auto newRoute = make_shared<RouteT>(prefix, clientId, std::move(entry));
     rib->addRoute(newRoute);
+    rib->addRouteInRadixTree(newRoute);
     XLOG(DBG3) << "Added route " << newRoute->str();
   }
+  ribCloned->changedPrefixes.push_back(prefix);
 }
 
 void RouteUpdater::addRoute(
@@ -198,6 +203,7 @@ void RouteUpdater::delRouteImpl(
   if (old->isPublished()) {
     old = old->clone();
     rib->updateRoute(old);
+    rib->updateRouteInRadixTree(old);
   }
   old->delEntryForClient(clientId);
   // TODO Do I need to publish the change??
@@ -205,8 +211,10 @@ void RouteUpdater::delRouteImpl(
              << " from route " << prefix.str();
   if (old->hasNoEntry()) {
     rib->removeRoute(old);
+    rib->removeRouteInRadixTree(old);
     XLOG(DBG3) << "...and then deleted route " << prefix.str();
   }
+  ribCloned->changedPrefixes.push_back(prefix);
 }
 
 void RouteUpdater::delRoute(
@@ -227,28 +235,35 @@ template <typename AddrT, typename RibT>
 void RouteUpdater::removeAllRoutesForClientImpl(
     RibT* ribCloned,
     ClientID clientId) {
-  auto rib = makeClone(ribCloned);
+  auto rib = ribCloned->rib.get();
 
-  std::vector<std::shared_ptr<Route<AddrT>>> routesToDelete;
+  // Only clone the routes that have nexthops from this client
+  std::vector<std::shared_ptr<Route<AddrT>>> routesToUpdate;
+  for (const auto& route : *rib->routes()) {
+    if (route->getEntryForClient(clientId)) {
+      routesToUpdate.push_back(route);
+    }
+  }
+  if (routesToUpdate.empty()) {
+    return;
+  }
+  rib = makeClone(ribCloned);
 
   // make sure rib is cloned before any change
   CHECK(ribCloned->cloned);
-  for (auto& routeNode : rib->writableRoutes()->writableNodes()) {
-    auto route = routeNode.second;
+  for (auto route : routesToUpdate) {
     if (route->isPublished()) {
       route = route->clone();
-      routeNode.second = route;
+      rib->updateRoute(route);
+      rib->updateRouteInRadixTree(route);
     }
     route->delEntryForClient(clientId);
     if (route->hasNoEntry()) {
       // The nexthops we removed was the only one.  Delete the route.
-      routesToDelete.push_back(routeNode.second);
+      rib->removeRoute(route);
+      rib->removeRouteInRadixTree(route);
     }
-  }
-
-  // Now, delete whatever routes went from 1 nexthoplist to 0.
-  for (std::shared_ptr<Route<AddrT>>& route : routesToDelete) {
-    rib->removeRoute(route);
+    ribCloned->changedPrefixes.push_back(route->prefix());
   }
 }
 
@@ -604,45 +619,143 @@ void RouteUpdater::resolveOne(RouteT* route, ClonedRib* ribCloned) {
              << " route " << route->str();
 }
 
-void RouteUpdater::resolve() {
-  // First, we need to make sure every route of the changed rib is cloned
-  // and the RadixTree of this changed rib is also generated.
-  // The reason why we have to do the same for-loop separately is because the
-  // resolveOne needs radixTree_ to find nexthop, so we have to build the tree
-  // before resolveOne().
-  for (auto& ribCloned : clonedRibs_) {
-    if (ribCloned.second.v4.cloned) {
-      ribCloned.second.v4.rib->cloneToRadixTreeWithForwardClear();
+struct RouteUpdater::AffectedPrefixes {
+  facebook::network::RadixTree<IPAddressV4, bool> v4;
+  facebook::network::RadixTree<IPAddressV6, bool> v6;
+
+  template <typename AddrT>
+  auto& get() {
+    if constexpr (std::is_same_v<AddrT, IPAddressV4>) {
+      return v4;
+    } else {
+      return v6;
     }
-    if (ribCloned.second.v6.cloned) {
-      ribCloned.second.v6.rib->cloneToRadixTreeWithForwardClear();
+  }
+
+  template <typename AddrT>
+  void add(const RoutePrefix<AddrT>& prefix) {
+    get<AddrT>().insert(prefix.network, prefix.mask, true);
+  }
+
+  template <typename AddrT>
+  bool contains(const RoutePrefix<AddrT>& prefix) {
+    auto& prefixes = get<AddrT>();
+    return prefixes.exactMatch(prefix.network, prefix.mask) != prefixes.end();
+  }
+
+  // Whether the route used to resolve nexthop may have changed
+  bool covers(const IPAddress& nexthop) {
+    if (nexthop.isV4()) {
+      return v4.longestMatch(nexthop.asV4(), IPAddressV4::bitCount()) !=
+          v4.end();
     }
+    return v6.longestMatch(nexthop.asV6(), IPAddressV6::bitCount()) !=
+        v6.end();
   }
+};
 
-  // Ideally, just need to resolve the routes that is changed or impacted by
-  // the changed routes.
-  // However, Without copy-on-write RadixTree, it is O(n) to find out the
-  // routes that are changed. In this case, we just simply loop through all
-  // routes and resolve those that are not resolved yet.
-  // TODO(joseph5wu) T23364375 will try to improve it in the future.
-  for (auto& ribCloned : clonedRibs_) {
-    if (ribCloned.second.v4.cloned) {
-      auto rib = ribCloned.second.v4.rib.get();
-      for (auto& routeNode : rib->writableRoutesRadixTree()) {
-        if (routeNode.value()->needResolve()) {
-          resolveOne(routeNode.value().get(), &ribCloned.second);
-        }
-      }
+/*
+ * Add the routes with a nexthop in one of the affected prefixes to them,
+ * since a route added, changed or deleted there may change how the nexthop
+ * resolves. Returns whether any route was added.
+ */
+template <typename RibT>
+bool RouteUpdater::findAffectedRoutes(
+    const RibT* rib,
+    AffectedPrefixes* affected) {
+  bool found = false;
+  for (const auto& route : *rib->routes()) {
+    if (affected->contains(route->prefix())) {
+      continue;
     }
-    if (ribCloned.second.v6.cloned) {
-      auto rib = ribCloned.second.v6.rib.get();
-      for (auto& routeNode : rib->writableRoutesRadixTree()) {
-        if (routeNode.value()->needResolve()) {
-          resolveOne(routeNode.value().get(), &ribCloned.second);
-        }
+    for (const auto& nh : route->getBestEntry().second->getNextHopSet()) {
+      // Nexthops with an interface are resolved without any route
+      if (!nh.intfID().has_value() && affected->covers(nh.addr())) {
+        affected->add(route->prefix());
+        found = true;
+        break;
       }
     }
   }
+  return found;
+}
+
+template <typename AddrT, typename RibT>
+void RouteUpdater::clearAffectedRoutes(
+    RibT* ribCloned,
+    AffectedPrefixes* affected) {
+  const auto& prefixes = affected->get<AddrT>();
+  if (prefixes.size() == 0) {
+    return;
+  }
+  auto rib = makeClone(ribCloned);
+  for (const auto& node : prefixes) {
+    RoutePrefix<AddrT> prefix{node.ipAddress(),
+                              static_cast<uint8_t>(node.masklen())};
+    auto route = rib->exactMatch(prefix);
+    if (!route) {
+      // Deleted
+      continue;
+    }
+    if (route->isPublished()) {
+      route = route->clone(RouteFields<AddrT>::COPY_PREFIX_AND_NEXTHOPS);
+      rib->updateRoute(route);
+      rib->updateRouteInRadixTree(route);
+    }
+    route->clearForward();
+  }
+}
+
+template <typename AddrT, typename RibT>
+void RouteUpdater::resolveAffectedRoutes(
+    RibT* ribCloned,
+    ClonedRib* clonedRib,
+    AffectedPrefixes* affected) {
+  auto rib = ribCloned->rib.get();
+  for (const auto& node : affected->get<AddrT>()) {
+    RoutePrefix<AddrT> prefix{node.ipAddress(),
+                              static_cast<uint8_t>(node.masklen())};
+    auto route = rib->exactMatch(prefix);
+    if (route && route->needResolve()) {
+      resolveOne(route.get(), clonedRib);
+    }
+  }
+}
+
+void RouteUpdater::resolve() {
+  // Only the changed routes, and the routes that resolve through them
+  // directly or recursively, may resolve differently than before. The
+  // RadixTree of each cloned rib is shared with the original rib, except
+  // for the paths to the changed routes, so re-resolving only these routes
+  // costs O(affected routes) clones instead of cloning every route.
+  for (auto& ribCloned : clonedRibs_) {
+    auto& clonedRib = ribCloned.second;
+    if (clonedRib.v4.changedPrefixes.empty() &&
+        clonedRib.v6.changedPrefixes.empty()) {
+      continue;
+    }
+    AffectedPrefixes affected;
+    for (const auto& prefix : clonedRib.v4.changedPrefixes) {
+      affected.add(prefix);
+    }
+    for (const auto& prefix : clonedRib.v6.changedPrefixes) {
+      affected.add(prefix);
+    }
+    bool found;
+    do {
+      found = findAffectedRoutes(clonedRib.v4.rib.get(), &affected);
+      found |= findAffectedRoutes(clonedRib.v6.rib.get(), &affected);
+    } while (found);
+
+    // Clear the forward info of every affected route before resolving any,
+    // as resolveOne() resolves the routes it depends on first
+    clearAffectedRoutes<IPAddressV4>(&clonedRib.v4, &affected);
+    clearAffectedRoutes<IPAddressV6>(&clonedRib.v6, &affected);
+    resolveAffectedRoutes<IPAddressV4>(&clonedRib.v4, &clonedRib, &affected);
+    resolveAffectedRoutes<IPAddressV6>(&clonedRib.v6, &clonedRib, &affected);
+    clonedRib.v4.changedPrefixes.clear();
+    clonedRib.v6.changedPrefixes.clear();
+  }
 }
 
 std::shared_ptr<RouteTableMap> RouteUpdater::updateDone() {
@@ -722,42 +835,42 @@ bool RouteUpdater::dedupRoutes(const RibT* oldRib, RibT* newRib) {
   if (oldRib == newRib) {
     return isSame;
   }
-  const auto oldRoutes = oldRib->routes();
-  auto& newRoutes = newRib->writableRoutesRadixTree();
   // make sure radixTree_ and nodeMap_ has the same size in newRib
-  CHECK_EQ(newRib->size(), newRoutes.size());
+  CHECK_EQ(newRib->size(), newRib->routesRadixTree().size());
+  // newRib was cloned from oldRib, so the routes that differ are the ones
+  // on the paths of their RadixTrees that are no longer shared
+  using RouteT = typename RibT::RouteType;
+  std::vector<std::pair<std::shared_ptr<RouteT>, std::shared_ptr<RouteT>>>
+      changedRoutes;
+  RibT::RoutesRadixTree::forEachChanged(
+      oldRib->routesRadixTree(),
+      newRib->routesRadixTree(),
+      [&](const auto* oldNode, const auto* newNode) {
+        if (!oldNode || !newNode) {
+          // Route added or deleted
+          isSame = false;
+          return;
+        }
+        changedRoutes.emplace_back(oldNode->value(), newNode->value());
+      });
   // Copy routes from old route table if they are
   // same. For matching prefixes, which don't have
   // same attributes inherit the generation number
-  for (const auto& oldRoute : *oldRoutes) {
-    auto newIter = newRoutes.exactMatch(
-        oldRoute->prefix().network, oldRoute->prefix().mask);
-    if (newIter == newRoutes.end()) {
-      isSame = false;
-      continue;
-    }
-    auto& newRoute = newIter->value();
+  for (const auto& routes : changedRoutes) {
+    const auto& oldRoute = routes.first;
+    const auto& newRoute = routes.second;
     if (oldRoute->isSame(newRoute.get())) {
       // both routes are completely same, instead of using the new route,
-      // we re-use the old route. First update oldRoute to radixTree_
-      newIter->value() = oldRoute;
-      // we also need to update the nodeMap_
+      // we re-use the old route.
       newRib->updateRoute(oldRoute);
+      newRib->updateRouteInRadixTree(oldRoute);
     } else {
       isSame = false;
       newRoute->inheritGeneration(*oldRoute);
-      newRib->updateRoute(newRoute);
     }
   }
-  if (newRoutes.size() != oldRoutes->size()) {
-    isSame = false;
-  } else {
-    // If sizes are same we would have already caught any
-    // difference while looking up all routes from oldRoutes
-    // in newRoutes, so do nothing
-  }
   // make sure after change nodeMap_ and radixTree_ size still match
-  CHECK_EQ(newRib->size(), newRoutes.size());
+  CHECK_EQ(newRib->size(), newRib->routesRadixTree().size());
   return isSame;
 }
 
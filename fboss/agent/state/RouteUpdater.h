@@ -20,6 +20,8 @@
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 
+#include <vector>
+
 namespace facebook::fboss {
 
 namespace cfg {
@@ -103,10 +105,14 @@ class RouteUpdater {
     struct RibV4 {
       std::shared_ptr<RouteTableRibV4> rib;
       bool cloned{false};
+      // Prefixes of the routes added, changed or deleted since cloning
+      std::vector<PrefixV4> changedPrefixes;
     } v4;
     struct RibV6 {
       std::shared_ptr<RouteTableRibV6> rib;
       bool cloned{false};
+      // Prefixes of the routes added, changed or deleted since cloning
+      std::vector<PrefixV6> changedPrefixes;
     } v6;
   };
   boost::container::flat_map<RouterID, ClonedRib> clonedRibs_;
@@ -130,8 +136,20 @@ class RouteUpdater {
   template <typename AddrT, typename RibT>
   void removeAllRoutesForClientImpl(RibT* ribCloned, ClientID clientId);
 
-  // resolve all routes that are not resolved yet
+  // Prefixes of the routes that need to be resolved again
+  struct AffectedPrefixes;
+
+  // resolve the changed routes and the routes that depend on them
   void resolve();
+  template <typename RibT>
+  bool findAffectedRoutes(const RibT* rib, AffectedPrefixes* affected);
+  template <typename AddrT, typename RibT>
+  void clearAffectedRoutes(RibT* ribCloned, AffectedPrefixes* affected);
+  template <typename AddrT, typename RibT>
+  void resolveAffectedRoutes(
+      RibT* ribCloned,
+      ClonedRib* clonedRib,
+      AffectedPrefixes* affected);
   template <typename RouteT>
   void resolveOne(RouteT* route, ClonedRib* clonedRib);
   template <typename RtRibT, typename AddrT>
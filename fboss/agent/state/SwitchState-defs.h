@@ -59,7 +59,7 @@ void SwitchState::revertNewRouteEntry(
     clonedRib->removeRoute(newRoute);
     clonedRib->removeRouteInRadixTree(newRoute);
   }
-  CHECK_EQ(clonedRib->size(), clonedRib->writableRoutesRadixTree().size());
+  CHECK_EQ(clonedRib->size(), clonedRib->routesRadixTree().size());
 }
 
 } // namespace facebook::fboss
@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 #include <array>
 #include <memory>
+#include <vector>
 
 namespace {
 
@@ -115,6 +116,22 @@ void CHECK_LPM(
   EXPECT_EQ(route->prefix().mask, mask);
 }
 
+/*
+ * Check that a published copy of the FIB, which is looked up through its
+ * index, finds the same routes as the unpublished FIB, which is scanned.
+ */
+template <typename FibT, typename AddressT>
+void CHECK_PUBLISHED_LPM(
+    const FibT& fib,
+    const std::vector<AddressT>& addresses) {
+  auto publishedFib = fib.clone();
+  publishedFib->publish();
+  for (const auto& address : addresses) {
+    EXPECT_EQ(fib.longestMatch(address), publishedFib->longestMatch(address))
+        << address;
+  }
+}
+
 } // namespace
 
 namespace facebook::fboss {
@@ -153,6 +170,93 @@ TEST_F(ForwardingInformationBaseV6Test, LPMDoesNotExist) {
   EXPECT_EQ(nullptr, fib.longestMatch(address));
 }
 
+TEST_F(ForwardingInformationBaseV4Test, PublishedLPM) {
+  std::vector<folly::IPAddressV4> addresses;
+  for (uint32_t i = 0; i < 256; ++i) {
+    addresses.push_back(folly::IPAddressV4::fromLongHBO(i << 24 | i));
+  }
+  CHECK_PUBLISHED_LPM(fib, addresses);
+
+  fib.publish();
+  CHECK_LPM(fib.longestMatch(folly::IPAddressV4("0.0.0.0")), ip4_0, 4);
+  CHECK_LPM(fib.longestMatch(folly::IPAddressV4("64.1.0.1")), ip4_64, 3);
+  CHECK_LPM(fib.longestMatch(folly::IPAddressV4("161.16.8.1")), ip4_160, 3);
+  EXPECT_EQ(nullptr, fib.longestMatch(folly::IPAddressV4("192.0.0.0")));
+}
+
+TEST_F(ForwardingInformationBaseV6Test, PublishedLPM) {
+  std::vector<folly::IPAddressV6> addresses;
+  std::array<uint8_t, 16> bytes;
+  bytes.fill(0);
+  for (uint32_t i = 0; i < 256; ++i) {
+    bytes[0] = i;
+    bytes[15] = i;
+    addresses.push_back(folly::IPAddressV6::fromBinary(
+        folly::range(bytes.begin(), bytes.end())));
+  }
+  CHECK_PUBLISHED_LPM(fib, addresses);
+
+  fib.publish();
+  CHECK_LPM(fib.longestMatch(folly::IPAddressV6("::")), ip6_0, 4);
+  CHECK_LPM(fib.longestMatch(folly::IPAddressV6("4001:1::")), ip6_64, 3);
+  CHECK_LPM(fib.longestMatch(folly::IPAddressV6("A110:801::")), ip6_160, 3);
+  EXPECT_EQ(nullptr, fib.longestMatch(folly::IPAddressV6("C000::")));
+}
+
+TEST_F(ForwardingInformationBaseV4Test, PublishedIncreasingLPMSequence) {
+  folly::IPAddressV4 address("255.255.255.255");
+  for (uint8_t mask = 0; mask <= address.bitCount(); ++mask) {
+    auto addressWithCurrentMask = address.mask(mask);
+    fib.addNode(createRouteFromPrefix(addressWithCurrentMask, mask));
+    auto publishedFib = fib.clone();
+    publishedFib->publish();
+    CHECK_LPM(
+        publishedFib->longestMatch(address), addressWithCurrentMask, mask);
+  }
+}
+
+TEST_F(ForwardingInformationBaseV4Test, PublishedLPMAcrossGenerations) {
+  std::vector<folly::IPAddressV4> addresses;
+  for (uint32_t i = 0; i < 256; ++i) {
+    addresses.push_back(folly::IPAddressV4::fromLongHBO(i << 24 | i));
+  }
+  auto published = fib.clone();
+  published->publish();
+  // Index the first generation, so that the following ones patch it
+  CHECK_LPM(published->longestMatch(ip4_48), ip4_48, 5);
+
+  for (uint32_t gen = 0; gen < 8; ++gen) {
+    auto next = published->clone();
+    // Add routes in a new /8 each generation, remove the previous
+    // generation's, and replace, remove and re-add routes of the initial
+    // FIB. The last generation adds more routes than the index overlays.
+    auto numRoutes = gen == 7 ? 100 : 4;
+    for (uint32_t i = 0; i < numRoutes; ++i) {
+      next->addNode(createRouteFromPrefix(
+          folly::IPAddressV4::fromLongHBO((gen + 1) << 24 | i << 8), 24));
+      if (gen > 0 && i < 4) {
+        next->removeNode(RoutePrefixV4{
+            folly::IPAddressV4::fromLongHBO(gen << 24 | i << 8), 24});
+      }
+    }
+    next->updateNode(createRouteFromPrefix(ip4_64, 3));
+    if (gen == 3) {
+      next->removeNode(RoutePrefixV4{ip4_72, 6});
+      next->removeNode(RoutePrefixV4{ip4_0, 1});
+    }
+    if (gen == 5) {
+      next->addNode(createRouteFromPrefix(ip4_0, 1));
+    }
+    auto scanned = next->clone();
+    next->publish();
+    for (const auto& address : addresses) {
+      EXPECT_EQ(scanned->longestMatch(address), next->longestMatch(address))
+          << address << " in generation " << gen;
+    }
+    published = next;
+  }
+}
+
 TEST_F(ForwardingInformationBaseV4Test, IncreasingLPMSequence) {
   folly::IPAddressV4 address("255.255.255.255");
   for (uint8_t mask = 0; mask <= address.bitCount(); ++mask) {
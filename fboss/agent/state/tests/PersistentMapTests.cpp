@@ -0,0 +1,188 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/NodeMapDelta-defs.h"
+#include "fboss/agent/state/NodeMapDelta.h"
+#include "fboss/agent/state/PersistentMap.h"
+
+#include <folly/IPAddressV4.h>
+#include <folly/MacAddress.h>
+#include <folly/Random.h>
+#include <gtest/gtest.h>
+
+#include <map>
+
+using namespace facebook::fboss;
+using folly::IPAddressV4;
+using folly::MacAddress;
+
+namespace {
+
+using IntMap = PersistentMap<int, std::shared_ptr<int>>;
+using ReferenceMap = std::map<int, std::shared_ptr<int>>;
+
+void checkEqual(const ReferenceMap& expected, const IntMap& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  auto it = actual.begin();
+  for (const auto& entry : expected) {
+    ASSERT_NE(actual.end(), it);
+    EXPECT_EQ(entry.first, it->first);
+    EXPECT_EQ(entry.second, it->second);
+    ++it;
+  }
+  EXPECT_EQ(actual.end(), it);
+
+  auto rit = actual.rbegin();
+  for (auto expectedRit = expected.rbegin(); expectedRit != expected.rend();
+       ++expectedRit) {
+    ASSERT_NE(actual.rend(), rit);
+    EXPECT_EQ(expectedRit->first, rit->first);
+    ++rit;
+  }
+  EXPECT_EQ(actual.rend(), rit);
+}
+
+/*
+ * Keys of the entries that differ between two maps, found by walking both
+ * maps in order. If skipShared is set, subtrees the maps share are skipped
+ * over, and the number of entries visited anyway is returned in visited.
+ */
+std::vector<int> changedKeys(
+    const IntMap& oldMap,
+    const IntMap& newMap,
+    bool skipShared,
+    size_t* visited = nullptr) {
+  std::vector<int> changed;
+  auto oldIt = oldMap.begin();
+  auto newIt = newMap.begin();
+  size_t numVisited = 0;
+  while (oldIt != oldMap.end() || newIt != newMap.end()) {
+    if (oldIt == oldMap.end() ||
+        (newIt != newMap.end() && newIt->first < oldIt->first)) {
+      changed.push_back(newIt->first);
+      ++newIt;
+    } else if (
+        newIt == newMap.end() ||
+        (oldIt != oldMap.end() && oldIt->first < newIt->first)) {
+      changed.push_back(oldIt->first);
+      ++oldIt;
+    } else if (skipShared && IntMap::skipShared(oldIt, newIt)) {
+      continue;
+    } else {
+      if (oldIt->second != newIt->second) {
+        changed.push_back(oldIt->first);
+      }
+      ++numVisited;
+      ++oldIt;
+      ++newIt;
+    }
+  }
+  if (visited) {
+    *visited = numVisited;
+  }
+  return changed;
+}
+
+} // namespace
+
+TEST(PersistentMap, CompareWithStdMap) {
+  for (auto keyRange : {16, 1024, 65536}) {
+    IntMap actual;
+    ReferenceMap expected;
+    std::vector<std::pair<IntMap, ReferenceMap>> snapshots;
+    for (auto i = 0; i < 10000; ++i) {
+      int key = folly::Random::rand32(keyRange);
+      auto value = std::make_shared<int>(i);
+      switch (folly::Random::rand32(3)) {
+        case 0: {
+          auto result = actual.insert(std::make_pair(key, value));
+          EXPECT_EQ(
+              expected.insert(std::make_pair(key, value)).second,
+              result.second);
+          EXPECT_EQ(key, result.first->first);
+          break;
+        }
+        case 1:
+          EXPECT_EQ(value, actual.insert_or_assign(key, value).first->second);
+          expected[key] = value;
+          break;
+        default:
+          EXPECT_EQ(expected.erase(key), actual.erase(key));
+      }
+      EXPECT_EQ(
+          expected.find(key) == expected.end(),
+          actual.find(key) == actual.end());
+      if (i % 1000 == 0) {
+        snapshots.emplace_back(actual, expected);
+      }
+    }
+    checkEqual(expected, actual);
+    // Changes to the map must not leak into earlier copies
+    for (const auto& snapshot : snapshots) {
+      checkEqual(snapshot.second, snapshot.first);
+    }
+    for (size_t i = 0; i + 1 < snapshots.size(); ++i) {
+      EXPECT_EQ(
+          changedKeys(snapshots[i].first, snapshots[i + 1].first, false),
+          changedKeys(snapshots[i].first, snapshots[i + 1].first, true));
+    }
+  }
+}
+
+TEST(PersistentMap, SkipSharedSubtrees) {
+  IntMap oldMap;
+  for (auto i = 0; i < 100000; ++i) {
+    oldMap.insert(std::make_pair(i * 2, std::make_shared<int>(i)));
+  }
+  auto newMap = oldMap;
+  newMap.insert_or_assign(1000, std::make_shared<int>(-1));
+  newMap.erase(50000);
+  newMap.insert(std::make_pair(150001, std::make_shared<int>(-1)));
+
+  size_t visited = 0;
+  std::vector<int> expected{1000, 50000, 150001};
+  EXPECT_EQ(expected, changedKeys(oldMap, newMap, true, &visited));
+  // Only the entries in the few leaves that were copied are visited
+  EXPECT_LT(visited, 1000);
+  EXPECT_EQ(100000, oldMap.size());
+  EXPECT_EQ(100000, newMap.size());
+}
+
+TEST(PersistentMap, NeighborTableDelta) {
+  auto oldTable = std::make_shared<ArpTable>();
+  for (uint32_t i = 0; i < 10000; ++i) {
+    oldTable->addEntry(
+        IPAddressV4::fromLongHBO((10 << 24) + i),
+        MacAddress::fromHBO(i + 1),
+        PortDescriptor(PortID(1)),
+        InterfaceID(1));
+  }
+  oldTable->publish();
+  auto newTable = oldTable->clone();
+  auto changedIp = IPAddressV4::fromLongHBO((10 << 24) + 5000);
+  newTable->updateEntry(
+      changedIp,
+      MacAddress("02:00:00:00:00:01"),
+      PortDescriptor(PortID(2)),
+      InterfaceID(1));
+  newTable->removeEntry(IPAddressV4::fromLongHBO(10 << 24));
+
+  NodeMapDelta<ArpTable> delta(oldTable.get(), newTable.get());
+  std::vector<std::pair<bool, bool>> changes;
+  for (const auto& change : delta) {
+    changes.emplace_back(
+        change.getOld() != nullptr, change.getNew() != nullptr);
+  }
+  std::vector<std::pair<bool, bool>> expected{{true, false}, {true, true}};
+  EXPECT_EQ(expected, changes);
+  EXPECT_EQ(oldTable->size(), newTable->size() + 1);
+  EXPECT_EQ(
+      MacAddress("02:00:00:00:00:01"), newTable->getEntry(changedIp)->getMac());
+}
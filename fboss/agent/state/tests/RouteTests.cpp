@@ -425,6 +425,70 @@ TEST(Route, resolve) {
   }
 }
 
+TEST(Route, resolveAffectedRoutesOnly) {
+  auto stateV1 = applyInitConfig();
+  ASSERT_NE(nullptr, stateV1);
+
+  auto rid = RouterID(0);
+  RouteUpdater u1(stateV1->getRouteTables());
+  u1.addRoute(
+      rid,
+      IPAddress("40.0.0.0"),
+      8,
+      CLIENT_A,
+      RouteNextHopEntry(makeNextHops({"50.0.0.1"}), DISTANCE));
+  u1.addRoute(
+      rid,
+      IPAddress("50.0.0.0"),
+      8,
+      CLIENT_A,
+      RouteNextHopEntry(makeNextHops({"1.1.1.10"}), DISTANCE));
+  u1.addRoute(
+      rid,
+      IPAddress("60.0.0.0"),
+      8,
+      CLIENT_A,
+      RouteNextHopEntry(makeNextHops({"2.2.2.10"}), DISTANCE));
+  auto tables2 = u1.updateDone();
+  ASSERT_NE(nullptr, tables2);
+  tables2->publish();
+
+  // Move 50.0.0.0/8 to intf 2, which moves 40.0.0.0/8 with it
+  RouteUpdater u2(tables2);
+  u2.addRoute(
+      rid,
+      IPAddress("50.0.0.0"),
+      8,
+      CLIENT_A,
+      RouteNextHopEntry(makeNextHops({"2.2.2.10"}), DISTANCE));
+  auto tables3 = u2.updateDone();
+  ASSERT_NE(nullptr, tables3);
+  EXPECT_NODEMAP_MATCH(tables3);
+  tables3->publish();
+
+  RouteNextHopSet expFwd;
+  expFwd.emplace(
+      ResolvedNextHop(IPAddress("2.2.2.10"), InterfaceID(2), ECMP_WEIGHT));
+  auto r31 = GET_ROUTE_V4(tables3, rid, "40.0.0.0/8");
+  EXPECT_RESOLVED(r31);
+  EXPECT_EQ(expFwd, r31->getForwardInfo().getNextHopSet());
+  EXPECT_EQ(
+      GET_ROUTE_V4(tables2, rid, "60.0.0.0/8"),
+      GET_ROUTE_V4(tables3, rid, "60.0.0.0/8"));
+
+  // Only the paths to the two changed routes were copied
+  std::vector<std::string> changed;
+  RouteTableRib<IPAddressV4>::RoutesRadixTree::forEachChanged(
+      tables2->getRouteTable(rid)->getRibV4()->routesRadixTree(),
+      tables3->getRouteTable(rid)->getRibV4()->routesRadixTree(),
+      [&changed](const auto* oldNode, const auto* newNode) {
+        ASSERT_NE(nullptr, oldNode);
+        ASSERT_NE(nullptr, newNode);
+        changed.push_back(newNode->value()->str());
+      });
+  EXPECT_EQ(2, changed.size());
+}
+
 TEST(Route, resolveDropToCPUMix) {
   auto stateV1 = applyInitConfig();
   ASSERT_NE(nullptr, stateV1);
@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/BinaryDynamic.h"
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/Utils.h"
+
+#include <boost/filesystem.hpp>
+#include <folly/experimental/TestUtil.h>
+#include <folly/json.h>
+#include <gtest/gtest.h>
+
+#include <limits>
+
+using namespace facebook::fboss;
+
+namespace {
+
+folly::ByteRange range(const std::string& str) {
+  return folly::ByteRange(folly::StringPiece(str));
+}
+
+folly::dynamic makeState() {
+  folly::dynamic vlans = folly::dynamic::array;
+  for (auto i = 0; i < 1000; ++i) {
+    vlans.push_back(folly::dynamic::object("vlanId", i)(
+        "vlanName", folly::to<std::string>("vlan", i))("inUse", i % 2 == 0)(
+        "weight", i * 0.5));
+  }
+  return folly::dynamic::object(
+      "swSwitch",
+      folly::dynamic::object("vlans", vlans)("defaultVlan", 1)(
+          "dhcpV4RelaySrc", nullptr))(
+      "hwSwitch",
+      folly::dynamic::object("warmBootCache", folly::dynamic::object)(
+          "minInt", std::numeric_limits<int64_t>::min())(
+          "maxInt", std::numeric_limits<int64_t>::max())("negative", -1));
+}
+
+} // namespace
+
+TEST(BinaryDynamic, RoundTrip) {
+  auto state = makeState();
+  auto encoded = toBinaryDynamic(state);
+  ASSERT_TRUE(isBinaryDynamic(range(encoded)));
+  EXPECT_EQ(state, BinaryDynamicReader(range(encoded)).decode());
+  // Keys are only stored once, so the encoding is smaller than JSON
+  EXPECT_LT(encoded.size(), folly::toJson(state).size());
+
+  // Scalars and non string object keys
+  for (const auto& value :
+       {folly::dynamic(nullptr),
+        folly::dynamic(true),
+        folly::dynamic(""),
+        folly::dynamic(-1.25),
+        folly::dynamic(folly::dynamic::object(1, "one")(2, "two"))}) {
+    auto encodedValue = toBinaryDynamic(value);
+    EXPECT_EQ(value, BinaryDynamicReader(range(encodedValue)).decode());
+  }
+}
+
+TEST(BinaryDynamic, DecodeSubtree) {
+  auto state = makeState();
+  auto encoded = toBinaryDynamic(state);
+  BinaryDynamicReader reader(range(encoded));
+  EXPECT_EQ(state["hwSwitch"], reader.decode({"hwSwitch"}));
+  EXPECT_EQ(state["swSwitch"]["vlans"], reader.decode({"swSwitch", "vlans"}));
+  EXPECT_EQ(1, reader.decode({"swSwitch", "defaultVlan"}));
+  EXPECT_EQ(folly::dynamic(nullptr), reader.decode({"swSwitch", "missing"}));
+  // Path through a non object value
+  EXPECT_EQ(
+      folly::dynamic(nullptr),
+      reader.decode({"swSwitch", "defaultVlan", "foo"}));
+}
+
+TEST(BinaryDynamic, CorruptInput) {
+  auto encoded = toBinaryDynamic(makeState());
+  EXPECT_FALSE(isBinaryDynamic(range("{}")));
+  // Truncated file, footer missing
+  EXPECT_THROW(
+      BinaryDynamicReader(range(encoded.substr(0, encoded.size() - 1))),
+      FbossError);
+  // Newer version than this code understands
+  auto newer = encoded;
+  newer[4] = kBinaryDynamicVersion + 1;
+  EXPECT_THROW(BinaryDynamicReader(range(newer)), FbossError);
+}
+
+TEST(BinaryDynamic, ReadEitherFormat) {
+  folly::test::TemporaryDirectory tmpDir;
+  auto state = makeState();
+  auto jsonFile = (tmpDir.path() / "state.json").string();
+  auto binaryFile = (tmpDir.path() / "state.bin").string();
+  ASSERT_TRUE(dumpStateToFile(jsonFile, state));
+  ASSERT_TRUE(dumpBinaryStateToFile(binaryFile, state));
+  // Warm boot from state written by older versions still works
+  EXPECT_EQ(state, readStateFromFile(jsonFile));
+  EXPECT_EQ(state, readStateFromFile(binaryFile));
+}
+
+TEST(BinaryDynamic, ReplaceStateFile) {
+  folly::test::TemporaryDirectory tmpDir;
+  auto state = makeState();
+  auto binaryFile = (tmpDir.path() / "state.bin").string();
+  ASSERT_TRUE(dumpBinaryStateToFile(binaryFile, folly::dynamic::object));
+  ASSERT_TRUE(dumpBinaryStateToFile(binaryFile, state));
+  EXPECT_EQ(state, readStateFromFile(binaryFile));
+  EXPECT_FALSE(boost::filesystem::exists(binaryFile + ".tmp"));
+
+  // A failed write leaves the previous state in place
+  boost::filesystem::create_directory(binaryFile + ".tmp");
+  EXPECT_FALSE(dumpBinaryStateToFile(binaryFile, folly::dynamic::object));
+  EXPECT_EQ(state, readStateFromFile(binaryFile));
+}
@@ -0,0 +1,141 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+/*
+ * Measure ForwardingInformationBase::longestMatch() on 100k and 1M route
+ * FIBs, scanning an unpublished FIB against the index of a published one.
+ * The FIB holds a default route, a /16 for every 256 /24s and the /24s
+ * themselves, and each lookup hits a random /24 or misses into a /16.
+ *
+ * Also measure a whole FIB update as the RIB applies it: clone the
+ * published FIB, patch the changed routes, publish it and look it up once,
+ * so that the cost of bringing the index up to date is included.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include "fboss/agent/state/ForwardingInformationBase.h"
+#include "fboss/agent/state/Route.h"
+
+#include <vector>
+
+using namespace facebook::fboss;
+using folly::IPAddressV4;
+
+namespace {
+
+constexpr size_t kNumLookups = 1000;
+constexpr uint32_t kBase = 16 << 24;
+
+std::shared_ptr<RouteV4> makeRoute(uint32_t network, uint8_t mask) {
+  RoutePrefixV4 prefix{IPAddressV4::fromLongHBO(network), mask};
+  return std::make_shared<RouteV4>(RouteFields<IPAddressV4>(prefix));
+}
+
+std::shared_ptr<ForwardingInformationBaseV4> makeFib(uint32_t numRoutes) {
+  auto fib = std::make_shared<ForwardingInformationBaseV4>();
+  fib->addNode(makeRoute(0, 0));
+  for (uint32_t i = 0; i < numRoutes; ++i) {
+    if (i % 256 == 0) {
+      fib->addNode(makeRoute(kBase + (i << 8), 16));
+    }
+    fib->addNode(makeRoute(kBase + (i << 8), 24));
+  }
+  return fib;
+}
+
+std::vector<IPAddressV4> makeLookups(uint32_t numRoutes) {
+  std::vector<IPAddressV4> lookups;
+  lookups.reserve(kNumLookups);
+  for (size_t i = 0; i < kNumLookups; ++i) {
+    // One in four lookups falls past the /24s, into the last /16 or the
+    // default route
+    auto subnet = folly::Random::rand32(numRoutes + numRoutes / 4);
+    lookups.push_back(IPAddressV4::fromLongHBO(kBase + (subnet << 8) + 1));
+  }
+  return lookups;
+}
+
+void longestMatch(size_t iters, uint32_t numRoutes, bool published) {
+  folly::BenchmarkSuspender suspender;
+  auto fib = makeFib(numRoutes);
+  if (published) {
+    fib->publish();
+    // Build the index outside of the measurement
+    fib->longestMatch(IPAddressV4::fromLongHBO(kBase));
+  }
+  auto lookups = makeLookups(numRoutes);
+  suspender.dismiss();
+
+  for (size_t n = 0; n < iters; ++n) {
+    folly::doNotOptimizeAway(fib->longestMatch(lookups[n % lookups.size()]));
+  }
+}
+
+void buildIndex(size_t iters, uint32_t numRoutes) {
+  for (size_t n = 0; n < iters; ++n) {
+    folly::BenchmarkSuspender suspender;
+    auto fib = makeFib(numRoutes);
+    fib->publish();
+    suspender.dismiss();
+    folly::doNotOptimizeAway(
+        fib->longestMatch(IPAddressV4::fromLongHBO(kBase)));
+  }
+}
+
+void updateFib(size_t iters, uint32_t numRoutes, uint32_t numChanges) {
+  folly::BenchmarkSuspender suspender;
+  std::shared_ptr<ForwardingInformationBaseV4> fib = makeFib(numRoutes);
+  fib->publish();
+  fib->longestMatch(IPAddressV4::fromLongHBO(kBase));
+  auto lookups = makeLookups(numRoutes);
+  suspender.dismiss();
+
+  for (size_t n = 0; n < iters; ++n) {
+    auto updatedFib = fib->clone();
+    for (uint32_t i = 0; i < numChanges; ++i) {
+      // Replace random /24s, as a next hop change would
+      auto subnet = folly::Random::rand32(numRoutes);
+      auto route = makeRoute(kBase + (subnet << 8), 24);
+      updatedFib->writableNodes().insert_or_assign(route->prefix(), route);
+    }
+    updatedFib->publish();
+    folly::doNotOptimizeAway(
+        updatedFib->longestMatch(lookups[n % lookups.size()]));
+    fib = std::move(updatedFib);
+  }
+}
+
+} // unnamed namespace
+
+BENCHMARK_NAMED_PARAM(longestMatch, Scan_100k, 100'000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(longestMatch, Index_100k, 100'000, true)
+BENCHMARK_NAMED_PARAM(longestMatch, Scan_1M, 1'000'000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(longestMatch, Index_1M, 1'000'000, true)
+
+BENCHMARK_DRAW_LINE();
+
+// The cost of building the index from scratch, paid by the first lookup in
+// a FIB not cloned from an indexed one
+BENCHMARK_NAMED_PARAM(buildIndex, 100k, 100'000)
+BENCHMARK_NAMED_PARAM(buildIndex, 1M, 1'000'000)
+
+BENCHMARK_DRAW_LINE();
+
+// Clone, patch, publish and look up a FIB, per update
+BENCHMARK_NAMED_PARAM(updateFib, 1M_1change, 1'000'000, 1)
+BENCHMARK_NAMED_PARAM(updateFib, 1M_100changes, 1'000'000, 100)
+BENCHMARK_NAMED_PARAM(updateFib, 1M_10kchanges, 1'000'000, 10'000)
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/GleanQueue.h"
+#include "fboss/agent/IPv4Handler.h"
+#include "fboss/agent/packet/IPv4Hdr.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+using folly::IPAddressV4;
+using std::chrono::milliseconds;
+
+namespace {
+
+const IPAddress kNexthop1("10.0.0.1");
+const IPAddress kNexthop2("10.0.0.2");
+const IPAddress kNexthop3("10.0.0.3");
+const folly::MacAddress kRouterMac("02:00:01:00:00:01");
+
+GleanQueue::Config makeConfig() {
+  GleanQueue::Config config;
+  config.maxPacketsPerNexthop = 2;
+  config.maxPacketsPerVlan = 3;
+  config.maxBytes = 1000;
+  config.ttl = milliseconds(100);
+  return config;
+}
+
+GleanQueue::Packet makePacket(uint32_t length) {
+  return GleanQueue::Packet{VlanID(1),
+                            kRouterMac,
+                            IPv4Handler::ETHERTYPE_IPV4,
+                            folly::IOBuf::copyBuffer(std::string(length, 0))};
+}
+
+} // namespace
+
+TEST(GleanQueue, RequestDedup) {
+  GleanQueue queue(makeConfig());
+  auto now = GleanQueue::Clock::now();
+  EXPECT_TRUE(queue.requestNeeded(VlanID(1), kNexthop1, now));
+  EXPECT_FALSE(queue.requestNeeded(VlanID(1), kNexthop1, now));
+  // Requests are per VLAN and next hop
+  EXPECT_TRUE(queue.requestNeeded(VlanID(1), kNexthop2, now));
+  EXPECT_TRUE(queue.requestNeeded(VlanID(2), kNexthop1, now));
+
+  // The request is no longer outstanding after the TTL
+  auto later = now + milliseconds(99);
+  EXPECT_FALSE(queue.requestNeeded(VlanID(1), kNexthop1, later));
+  later = now + milliseconds(100);
+  EXPECT_TRUE(queue.requestNeeded(VlanID(1), kNexthop1, later));
+
+  // Nor once the next hop is resolved
+  queue.resolved(VlanID(1), kNexthop2);
+  EXPECT_TRUE(queue.requestNeeded(VlanID(1), kNexthop2, now));
+}
+
+TEST(GleanQueue, Limits) {
+  GleanQueue queue(makeConfig());
+  auto now = GleanQueue::Clock::now();
+  EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop1, makePacket(100), now));
+  EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop1, makePacket(100), now));
+  // Per next hop limit
+  EXPECT_FALSE(queue.enqueue(VlanID(1), kNexthop1, makePacket(100), now));
+  EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop2, makePacket(100), now));
+  // Per VLAN limit
+  EXPECT_FALSE(queue.enqueue(VlanID(1), kNexthop3, makePacket(100), now));
+  EXPECT_TRUE(queue.enqueue(VlanID(2), kNexthop3, makePacket(600), now));
+  // Memory limit
+  EXPECT_FALSE(queue.enqueue(VlanID(2), kNexthop3, makePacket(200), now));
+  EXPECT_EQ(4, queue.numPackets());
+  EXPECT_EQ(900, queue.numBytes());
+
+  // Taking packets out makes room for more
+  EXPECT_EQ(1, queue.remove(VlanID(2), kNexthop3));
+  EXPECT_TRUE(queue.enqueue(VlanID(2), kNexthop3, makePacket(200), now));
+  EXPECT_EQ(4, queue.numPackets());
+  EXPECT_EQ(500, queue.numBytes());
+}
+
+TEST(GleanQueue, HasRoom) {
+  GleanQueue queue(makeConfig());
+  EXPECT_TRUE(queue.hasRoom(VlanID(1), kNexthop1, 1000));
+  EXPECT_FALSE(queue.hasRoom(VlanID(1), kNexthop1, 1001));
+  EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop1, makePacket(100)));
+  EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop1, makePacket(100)));
+  // Per next hop limit
+  EXPECT_FALSE(queue.hasRoom(VlanID(1), kNexthop1, 100));
+  EXPECT_TRUE(queue.hasRoom(VlanID(1), kNexthop2, 100));
+  // Memory limit
+  EXPECT_FALSE(queue.hasRoom(VlanID(2), kNexthop1, 801));
+  EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop2, makePacket(100)));
+  // Per VLAN limit
+  EXPECT_FALSE(queue.hasRoom(VlanID(1), kNexthop3, 100));
+  EXPECT_TRUE(queue.hasRoom(VlanID(2), kNexthop3, 100));
+  // Checking for room doesn't take it
+  EXPECT_EQ(3, queue.numPackets());
+  EXPECT_EQ(300, queue.numBytes());
+}
+
+TEST(GleanQueue, Resolved) {
+  GleanQueue queue(makeConfig());
+  for (auto length : {100, 200}) {
+    EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop1, makePacket(length)));
+  }
+  EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop2, makePacket(300)));
+
+  auto packets = queue.resolved(VlanID(1), kNexthop1);
+  ASSERT_EQ(2, packets.size());
+  // In the order they were queued
+  EXPECT_EQ(100, packets[0].l3Packet->computeChainDataLength());
+  EXPECT_EQ(200, packets[1].l3Packet->computeChainDataLength());
+  EXPECT_EQ(kRouterMac, packets[0].dstMac);
+  EXPECT_EQ(1, queue.numPackets());
+  EXPECT_EQ(300, queue.numBytes());
+  EXPECT_TRUE(queue.resolved(VlanID(1), kNexthop1).empty());
+  EXPECT_TRUE(queue.resolved(VlanID(2), kNexthop2).empty());
+}
+
+TEST(GleanQueue, Expire) {
+  GleanQueue queue(makeConfig());
+  auto now = GleanQueue::Clock::now();
+  EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop1, makePacket(100), now));
+  EXPECT_TRUE(queue.enqueue(
+      VlanID(1), kNexthop1, makePacket(100), now + milliseconds(50)));
+  EXPECT_TRUE(queue.enqueue(VlanID(1), kNexthop2, makePacket(100), now));
+
+  EXPECT_EQ(0, queue.expire(now + milliseconds(99)));
+  EXPECT_EQ(2, queue.expire(now + milliseconds(100)));
+  EXPECT_EQ(1, queue.numPackets());
+  EXPECT_EQ(1, queue.expire(now + milliseconds(150)));
+  EXPECT_EQ(0, queue.numPackets());
+  EXPECT_EQ(0, queue.numBytes());
+}
+
+TEST(GleanQueue, MakePacket) {
+  IPv4Hdr v4Hdr(
+      IPAddressV4("10.0.0.15"), IPAddressV4("10.1.0.1"), 6 /* TCP */, 4);
+  v4Hdr.ttl = 64;
+  v4Hdr.computeChecksum();
+  auto payload = folly::IOBuf::copyBuffer("\x01\x02\x03\x04");
+  auto gleaned = GleanQueue::makePacket(
+      VlanID(1),
+      kRouterMac,
+      IPv4Handler::ETHERTYPE_IPV4,
+      v4Hdr,
+      folly::io::Cursor(payload.get()),
+      4);
+  EXPECT_EQ(VlanID(1), gleaned.vlan);
+  ASSERT_EQ(v4Hdr.size() + 4, gleaned.l3Packet->computeChainDataLength());
+
+  folly::io::Cursor cursor(gleaned.l3Packet.get());
+  IPv4Hdr parsed(cursor);
+  EXPECT_EQ(v4Hdr, parsed);
+  EXPECT_EQ(0x01020304, cursor.readBE<uint32_t>());
+}
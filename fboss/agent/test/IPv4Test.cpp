@@ -12,10 +12,13 @@
 #include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/GleanQueue.h"
 #include "fboss/agent/IPHeaderV4.h"
 #include "fboss/agent/IPv4Handler.h"
+#include "fboss/agent/NeighborUpdater.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/TxPacket.h"
 #include "fboss/agent/hw/mock/MockHwSwitch.h"
 #include "fboss/agent/hw/mock/MockRxPacket.h"
 #include "fboss/agent/packet/PktUtil.h"
@@ -29,8 +32,11 @@
 #include "fboss/agent/test/TestUtils.h"
 
 #include <boost/cast.hpp>
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+DECLARE_bool(glean_queue);
+
 using namespace facebook::fboss;
 using folly::IPAddress;
 using folly::IPAddressV4;
@@ -48,7 +54,10 @@ using ::testing::Return;
 
 namespace {
 
-unique_ptr<HwTestHandle> setupTestHandle() {
+const MacAddress kPlatformMac("02:01:02:03:04:05");
+
+unique_ptr<HwTestHandle> setupTestHandle(
+    const std::optional<MacAddress>& mac = std::nullopt) {
   auto state = testStateA();
   const auto& vlans = state->getVlans();
   // Set up an arp response entry for VLAN 1, 10.0.0.1,
@@ -58,7 +67,33 @@ unique_ptr<HwTestHandle> setupTestHandle() {
       IPAddressV4("10.0.0.1"), MacAddress("00:02:00:00:00:01"), InterfaceID(1));
   vlans->getVlan(VlanID(1))->setArpResponseTable(respTable1);
 
-  return createTestHandle(state);
+  return createTestHandle(state, mac);
+}
+
+// Matches a frame with exactly the given bytes, once padded to the minimum
+// frame size of 64 bytes plus 4 for the VLAN tag
+TxMatchFn checkFrame(folly::StringPiece hex) {
+  auto frame = PktUtil::parseHexData(hex);
+  PktUtil::padToLength(&frame, 68);
+  return [expected = fbossHexDump(frame)](const TxPacket* pkt) {
+    auto actual = fbossHexDump(pkt->buf());
+    if (actual != expected) {
+      throw FbossError("expected frame ", expected, "; got ", actual);
+    }
+  };
+}
+
+// Checks the ethertype of a frame with a VLAN tag
+TxMatchFn checkEthertype(uint16_t ethertype) {
+  return [=](const TxPacket* pkt) {
+    Cursor c(pkt->buf());
+    c.skip(2 * MacAddress::SIZE + 4);
+    auto pktEthertype = c.readBE<uint16_t>();
+    if (pktEthertype != ethertype) {
+      throw FbossError(
+          "expected ethertype ", ethertype, "; got ", pktEthertype);
+    }
+  };
 }
 
 } // unnamed namespace
@@ -197,3 +232,117 @@ TEST(IPv4Test, Parse) {
   counters.checkDelta(
       SwitchStats::kCounterPrefix + "ipv4.wrong_version.sum", 0);
 }
+
+TEST(IPv4Test, GleanQueue) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_glean_queue = true;
+  auto handle = setupTestHandle(kPlatformMac);
+  auto sw = handle->getSw();
+
+  PortID portID(1);
+  VlanID vlanID(1);
+
+  // Cache the current stats
+  CounterCache counters(sw);
+
+  // The IPv4 packet for 10.0.0.10, whose next hop needs resolving
+  const std::string ipPkt =
+      // Version(4), IHL(5), DSCP(0), ECN(0), Total Length(24)
+      "45  00  00 18"
+      // Identification(0), Flags(0), Fragment offset(0)
+      "00 00  00 00"
+      // TTL(31), Protocol(6), Checksum (0, fake)
+      "1F  06  00 00"
+      // Source IP (1.2.3.4)
+      "01 02 03 04"
+      // Destination IP (10.0.0.10)
+      "0a 00 00 0a"
+      // Payload
+      "01 02 03 04";
+  auto buf = PktUtil::parseHexData(
+      // dst mac, src mac
+      "02 00 01 00 00 01  02 00 02 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00 00 01"
+      // IPv4
+      "08 00" +
+      ipPkt);
+
+  // Receiving the packet sends an ARP request out, and holds on to the
+  // packet rather than dropping it
+  EXPECT_SWITCHED_PKT(sw, "ARP request", checkEthertype(0x0806));
+  handle->rxPacket(make_unique<folly::IOBuf>(buf), portID, vlanID);
+  sw->getNeighborUpdater()->waitForPendingUpdates();
+  waitForStateUpdates(sw);
+
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.drops.sum", 0);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "ipv4.nexthop.sum", 1);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "glean.queued.sum", 1);
+
+  // A packet whose total length exceeds what we received is dropped
+  auto truncated = PktUtil::parseHexData(
+      // dst mac, src mac
+      "02 00 01 00 00 01  02 00 02 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00 00 01"
+      // IPv4
+      "08 00"
+      // Version(4), IHL(5), DSCP(0), ECN(0), Total Length(40)
+      "45  00  00 28"
+      // Identification(0), Flags(0), Fragment offset(0)
+      "00 00  00 00"
+      // TTL(31), Protocol(6), Checksum (0, fake)
+      "1F  06  00 00"
+      // Source IP (1.2.3.4)
+      "01 02 03 04"
+      // Destination IP (10.0.0.10)
+      "0a 00 00 0a"
+      // Payload, 16 bytes short
+      "01 02 03 04");
+  EXPECT_HW_CALL(sw, sendPacketSwitchedAsync_(_)).Times(0);
+  handle->rxPacket(make_unique<folly::IOBuf>(truncated), portID, vlanID);
+  sw->getNeighborUpdater()->waitForPendingUpdates();
+  waitForStateUpdates(sw);
+
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.drops.sum", 1);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "glean.queued.sum", 0);
+
+  // Once the ARP reply resolves the next hop, the packet is sent to the
+  // router MAC for the hardware to route it
+  EXPECT_SWITCHED_PKT(
+      sw,
+      "gleaned packet",
+      checkFrame(
+          // dst mac, src mac
+          "02 00 01 00 00 01  02 01 02 03 04 05"
+          // 802.1q, VLAN 1
+          "81 00 00 01"
+          // IPv4
+          "08 00" +
+          ipPkt));
+  auto arpReply = PktUtil::parseHexData(
+      // dst mac, src mac
+      "00 02 00 00 00 01  02 10 20 30 40 22"
+      // 802.1q, VLAN 1
+      "81 00 00 01"
+      // ARP
+      "08 06"
+      // htype: ethernet, ptype: IPv4, hlen: 6, plen: 4
+      "00 01  08 00  06  04"
+      // ARP reply
+      "00 02"
+      // sender MAC, sender IP (10.0.0.10)
+      "02 10 20 30 40 22  0a 00 00 0a"
+      // target MAC, target IP (10.0.0.1)
+      "00 02 00 00 00 01  0a 00 00 01");
+  PktUtil::padToLength(&arpReply, 68);
+  handle->rxPacket(make_unique<folly::IOBuf>(arpReply), portID, vlanID);
+  sw->getNeighborUpdater()->waitForPendingUpdates();
+  waitForStateUpdates(sw);
+
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "glean.flushed.sum", 1);
+  EXPECT_EQ(0, sw->getGleanQueue()->numPackets());
+}
@@ -92,6 +92,10 @@ class LookupClassUpdaterTest : public ::testing::Test {
     return MacAddress("01:02:03:04:05:07");
   }
 
+  MacAddress kMacAddress3() const {
+    return MacAddress("01:02:03:04:05:08");
+  }
+
   void resolveNeighbor(IPAddress ipAddress, MacAddress macAddress) {
     /*
      * Cause a neighbor entry to resolve by receiving appropriate ARP/NDP, and
@@ -326,6 +330,31 @@ TYPED_TEST(LookupClassUpdaterTest, LookupClassesChange) {
       cfg::AclLookupClass::CLASS_QUEUE_PER_HOST_QUEUE_3);
 }
 
+TYPED_TEST(LookupClassUpdaterTest, LookupClassesChangeMultipleEntries) {
+  this->resolve(this->getIpAddress(), this->kMacAddress());
+  this->resolve(this->getIpAddress2(), this->kMacAddress2());
+  this->resolve(this->getIpAddress3(), this->kMacAddress3());
+
+  // All entries on the port are reassigned in a single state update
+  this->updateLookupClasses(
+      {cfg::AclLookupClass::CLASS_QUEUE_PER_HOST_QUEUE_3,
+       cfg::AclLookupClass::CLASS_QUEUE_PER_HOST_QUEUE_4});
+  this->verifyStateUpdate([=]() {
+    this->verifyClassIDHelper(
+        this->getIpAddress(),
+        this->kMacAddress(),
+        cfg::AclLookupClass::CLASS_QUEUE_PER_HOST_QUEUE_3);
+    this->verifyClassIDHelper(
+        this->getIpAddress2(),
+        this->kMacAddress2(),
+        cfg::AclLookupClass::CLASS_QUEUE_PER_HOST_QUEUE_4);
+    this->verifyClassIDHelper(
+        this->getIpAddress3(),
+        this->kMacAddress3(),
+        cfg::AclLookupClass::CLASS_QUEUE_PER_HOST_QUEUE_3);
+  });
+}
+
 /*
  * Tests that are valid for arp/ndp neighbors only and not for Mac addresses
  */
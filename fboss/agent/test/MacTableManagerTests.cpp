@@ -77,6 +77,29 @@ class MacTableManagerTest : public ::testing::Test {
     });
   }
 
+  /*
+   * Send learning callbacks without waiting for them to be applied, so that
+   * they are applied in the same batch.
+   */
+  void sendMacCbs(
+      const std::vector<folly::MacAddress>& macs,
+      L2EntryUpdateType l2EntryUpdateType,
+      PortID port = PortID(1)) {
+    for (const auto& mac : macs) {
+      auto l2Entry = L2Entry(
+          mac,
+          kVlan(),
+          PortDescriptor(port),
+          L2Entry::L2EntryType::L2_ENTRY_TYPE_PENDING);
+      sw_->l2LearningUpdateReceived(l2Entry, l2EntryUpdateType);
+    }
+  }
+
+  void waitForMacCbs() {
+    waitForBackgroundThread(sw_);
+    waitForStateUpdates(sw_);
+  }
+
   void verifyMacIsDeleted() {
     verifyStateUpdate([=]() {
       auto vlan = sw_->getState()->getVlans()->getVlan(kVlan());
@@ -142,4 +165,51 @@ TEST_F(MacTableManagerTest, SameMacAgedCbTwice) {
   verifyMacIsDeleted();
 }
 
+TEST_F(MacTableManagerTest, MacLearnedAndAgedInOneBatch) {
+  sendMacCbs({kMacAddress()}, L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  sendMacCbs({kMacAddress()}, L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_DELETE);
+  waitForMacCbs();
+
+  verifyMacIsDeleted();
+}
+
+TEST_F(MacTableManagerTest, MacAgedAndLearnedInOneBatch) {
+  triggerMacLearnedCb();
+  sendMacCbs({kMacAddress()}, L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_DELETE);
+  sendMacCbs({kMacAddress()}, L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  waitForMacCbs();
+
+  verifyMacIsAdded();
+}
+
+TEST_F(MacTableManagerTest, MacLearnedOnTwoPortsInOneBatch) {
+  // As when applied one at a time, the first port the MAC is learned on
+  // wins
+  sendMacCbs({kMacAddress()}, L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  sendMacCbs(
+      {kMacAddress()},
+      L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD,
+      PortID(2));
+  waitForMacCbs();
+
+  verifyMacIsAdded();
+}
+
+TEST_F(MacTableManagerTest, ManyMacsLearnedCb) {
+  std::vector<folly::MacAddress> macs;
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    macs.push_back(folly::MacAddress::fromHBO(0x020000000000 + i));
+  }
+  sendMacCbs(macs, L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  waitForMacCbs();
+
+  verifyStateUpdate([=]() {
+    auto vlan = sw_->getState()->getVlans()->getVlan(kVlan());
+    auto* macTable = vlan->getMacTable().get();
+    for (const auto& mac : macs) {
+      EXPECT_NE(nullptr, macTable->getNodeIf(mac));
+    }
+  });
+}
+
 } // namespace facebook::fboss
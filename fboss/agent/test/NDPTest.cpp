@@ -11,6 +11,7 @@
 
 #include "fboss/agent/AddressUtil.h"
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/GleanQueue.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/ThriftHandler.h"
@@ -34,9 +35,12 @@
 #include <folly/IPAddressV6.h>
 #include <folly/MacAddress.h>
 #include <folly/io/Cursor.h>
+#include <gflags/gflags.h>
 #include <netinet/icmp6.h>
 #include <future>
 
+DECLARE_bool(glean_queue);
+
 using namespace facebook::fboss;
 using facebook::network::toBinaryAddress;
 using facebook::network::toIPAddress;
@@ -292,6 +296,19 @@ TxMatchFn checkNeighborSolicitation(
       checkPayload);
 }
 
+// Matches a frame with exactly the given bytes, once padded to the minimum
+// frame size of 64 bytes plus 4 for the VLAN tag
+TxMatchFn checkFrame(StringPiece hex) {
+  auto frame = PktUtil::parseHexData(hex);
+  PktUtil::padToLength(&frame, 68);
+  return [expected = fbossHexDump(frame)](const TxPacket* pkt) {
+    auto actual = fbossHexDump(pkt->buf());
+    if (actual != expected) {
+      throw FbossError("expected frame ", expected, "; got ", actual);
+    }
+  };
+}
+
 typedef std::vector<std::pair<IPAddressV6, uint8_t>> PrefixVector;
 TxMatchFn checkRouterAdvert(
     MacAddress srcMac,
@@ -1653,3 +1670,114 @@ TEST(NdpTest, PortFlapRecover) {
   EXPECT_NE(entry3, nullptr);
   EXPECT_EQ(entry3->isPending(), false);
 }
+
+TEST(NdpTest, GleanQueue) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_glean_queue = true;
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+
+  VlanID vlanID(5);
+  IPAddressV6 targetIP("2401:db00:2110:3004::1:0");
+
+  // Cache the current stats
+  CounterCache counters(sw);
+
+  // The IPv6 packet for a node in the attached subnet, to be resolved
+  const std::string ipPkt =
+      // Version 6, traffic class, flow label
+      "6e 00 00 00"
+      // Payload length: 8
+      "00 08"
+      // Next Header: 17 (UDP), Hop Limit (255)
+      "11 ff"
+      // src addr (2401:db00:2110:1234::1:0)
+      "24 01 db 00 21 10 12 34 00 00 00 00 00 01 00 00"
+      // dst addr (2401:db00:2110:3004::1:0)
+      "24 01 db 00 21 10 30 04 00 00 00 00 00 01 00 00"
+      // source port (53 - DNS), destination port (53 - DNS)
+      "00 35  00 35"
+      // length, checksum (not valid)
+      "00 08  2a 7e";
+  auto pkt = PktUtil::parseHexData(
+      // dst mac, src mac
+      "02 01 02 03 04 05  02 05 73 f9 46 fc"
+      // 802.1q, VLAN 5
+      "81 00 00 05"
+      // IPv6
+      "86 dd" +
+      ipPkt);
+
+  // Receiving the packet sends a neighbor solicitation out, and holds on
+  // to the packet rather than dropping it
+  EXPECT_SWITCHED_PKT(
+      sw,
+      "neighbor solicitation",
+      checkNeighborSolicitation(
+          MacAddress("02:01:02:03:04:05"),
+          IPAddressV6("fe80::0001:02ff:fe03:0405"),
+          MacAddress("33:33:ff:01:00:00"),
+          IPAddressV6("ff02::1:ff01:0"),
+          targetIP,
+          vlanID));
+  WaitForNdpEntryCreation neighborEntryCreate(sw, targetIP, vlanID);
+  handle->rxPacket(make_unique<IOBuf>(pkt), PortID(1), vlanID);
+  EXPECT_TRUE(neighborEntryCreate.wait());
+
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.drops.sum", 0);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "glean.queued.sum", 1);
+
+  // A packet whose payload length exceeds what we received is dropped
+  auto truncated = PktUtil::parseHexData(
+      // dst mac, src mac
+      "02 01 02 03 04 05  02 05 73 f9 46 fc"
+      // 802.1q, VLAN 5
+      "81 00 00 05"
+      // IPv6
+      "86 dd"
+      // Version 6, traffic class, flow label
+      "6e 00 00 00"
+      // Payload length: 24, 16 bytes more than we have
+      "00 18"
+      // Next Header: 17 (UDP), Hop Limit (255)
+      "11 ff"
+      // src addr (2401:db00:2110:1234::1:0)
+      "24 01 db 00 21 10 12 34 00 00 00 00 00 01 00 00"
+      // dst addr (2401:db00:2110:3004::1:0)
+      "24 01 db 00 21 10 30 04 00 00 00 00 00 01 00 00"
+      // source port (53 - DNS), destination port (53 - DNS)
+      "00 35  00 35"
+      // length, checksum (not valid)
+      "00 18  2a 7e");
+  EXPECT_HW_CALL(sw, sendPacketSwitchedAsync_(_)).Times(0);
+  handle->rxPacket(make_unique<IOBuf>(truncated), PortID(1), vlanID);
+  waitForStateUpdates(sw);
+
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.drops.sum", 1);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "glean.queued.sum", 0);
+
+  // Once the advertisement resolves the next hop, the packet is sent to the
+  // router MAC for the hardware to route it
+  EXPECT_SWITCHED_PKT(
+      sw,
+      "gleaned packet",
+      checkFrame(
+          // dst mac, src mac
+          "02 01 02 03 04 05  02 01 02 03 04 05"
+          // 802.1q, VLAN 5
+          "81 00 00 05"
+          // IPv6
+          "86 dd" +
+          ipPkt));
+  WaitForNdpEntryReachable neighborEntryReachable(sw, targetIP, vlanID);
+  sendNeighborAdvertisement(
+      handle.get(), targetIP.str(), "02:10:20:30:40:22", 1, vlanID);
+  EXPECT_TRUE(neighborEntryReachable.wait());
+  waitForStateUpdates(sw);
+
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "glean.flushed.sum", 1);
+  EXPECT_EQ(0, sw->getGleanQueue()->numPackets());
+}
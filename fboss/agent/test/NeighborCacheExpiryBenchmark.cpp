@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+/*
+ * Measure how long the neighbor cache takes to age out 200k pending ARP
+ * entries, which all expire within about a second of each other, and how
+ * many state updates it takes to flush them.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/logging/xlog.h>
+#include <folly/synchronization/Baton.h>
+#include "fboss/agent/StateObserver.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/InterfaceMap.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+
+#include <atomic>
+#include <chrono>
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+using folly::IPAddressV4;
+using folly::MacAddress;
+using std::make_shared;
+using std::make_unique;
+using std::shared_ptr;
+
+namespace {
+
+constexpr uint32_t kNumEntries = 200000;
+const VlanID kVlanID(1);
+
+class ArpTableEmptied : public AutoRegisterStateObserver {
+ public:
+  explicit ArpTableEmptied(SwSwitch* sw)
+      : AutoRegisterStateObserver(sw, "ArpTableEmptied") {}
+
+  void stateUpdated(const StateDelta& delta) override {
+    auto oldVlan = delta.oldState()->getVlans()->getVlanIf(kVlanID);
+    auto newVlan = delta.newState()->getVlans()->getVlanIf(kVlanID);
+    if (!oldVlan || !newVlan) {
+      return;
+    }
+    auto oldSize = oldVlan->getArpTable()->size();
+    auto newSize = newVlan->getArpTable()->size();
+    if (newSize < oldSize) {
+      ++numFlushUpdates;
+      if (newSize == 0) {
+        emptied.post();
+      }
+    }
+  }
+
+  std::atomic<uint32_t> numFlushUpdates{0};
+  folly::Baton<> emptied;
+};
+
+std::unique_ptr<SwSwitch> setupSwitch() {
+  MacAddress localMac("02:00:01:00:00:01");
+  auto sw = make_unique<SwSwitch>(make_unique<SimPlatform>(localMac, 10));
+  sw->init(nullptr /* No custom TunManager */);
+
+  sw->updateStateBlocking(
+      "set neighbor timeouts", [](const shared_ptr<SwitchState>& oldState) {
+        auto state = oldState->clone();
+        state->setArpTimeout(std::chrono::seconds(1));
+        state->setMaxNeighborProbes(1);
+        state->setStaleEntryInterval(std::chrono::seconds(1));
+        return state;
+      });
+  return sw;
+}
+
+std::shared_ptr<SwitchState> addVlanWithPendingEntries(
+    const shared_ptr<SwitchState>& oldState) {
+  auto state = oldState->clone();
+
+  auto vlan = make_shared<Vlan>(kVlanID, "Vlan1");
+  for (int idx = 1; idx < 10; ++idx) {
+    vlan->addPort(PortID(idx), false);
+  }
+  auto intf = make_shared<Interface>(
+      InterfaceID(1),
+      RouterID(0),
+      kVlanID,
+      "interface1",
+      MacAddress("02:00:01:00:00:01"),
+      9000,
+      false, /* is virtual */
+      false /* is state_sync disabled*/);
+  Interface::Addresses addrs;
+  addrs.emplace(IPAddress("10.0.0.1"), 8);
+  intf->setAddresses(addrs);
+  state->addIntf(intf);
+
+  // Pending entries that were never resolved, e.g. from a warm boot. The
+  // neighbor cache picks these up as INCOMPLETE entries when the vlan is
+  // added, and expires them when their only probe times out.
+  auto arpTable = make_shared<ArpTable>();
+  auto base = IPAddressV4("10.1.0.0").toLongHBO();
+  for (uint32_t i = 0; i < kNumEntries; ++i) {
+    arpTable->addPendingEntry(
+        IPAddressV4::fromLongHBO(base + i), InterfaceID(1));
+  }
+  vlan->setArpTable(arpTable);
+  state->addVlan(vlan);
+  return state;
+}
+
+} // unnamed namespace
+
+BENCHMARK(AgeOut200kArpEntries, numIters) {
+  for (size_t n = 0; n < numIters; ++n) {
+    folly::BenchmarkSuspender suspender;
+    auto sw = setupSwitch();
+    ArpTableEmptied observer(sw.get());
+    suspender.dismiss();
+
+    auto start = std::chrono::steady_clock::now();
+    sw->updateStateBlocking(
+        "add vlan with pending entries", addVlanWithPendingEntries);
+    observer.emptied.wait();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    suspender.rehire();
+    XLOG(INFO) << "Aged out " << kNumEntries << " entries in "
+               << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      elapsed)
+                      .count()
+               << "ms with " << observer.numFlushUpdates << " state updates";
+  }
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+/*
+ * Measure how long an LACP packet takes to reach its handler through the
+ * RxPacketScheduler, on its own and under a 100 kpps flood of DHCP packets.
+ * Slow path packets take a few microseconds each to handle, so the flood
+ * saturates the slow path workers.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+#include <folly/logging/xlog.h>
+#include <folly/synchronization/Baton.h>
+#include "fboss/agent/LacpTypes-defs.h"
+#include "fboss/agent/LacpTypes.h"
+#include "fboss/agent/RxPacketScheduler.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/packet/PktFactory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+using namespace facebook::fboss;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+constexpr uint32_t kFloodPps = 100000;
+constexpr auto kFloodBatchInterval = milliseconds(1);
+constexpr auto kSlowPathCost = microseconds(5);
+
+const folly::MacAddress kSrcMac("02:00:00:00:00:01");
+const folly::MacAddress kDstMac("02:00:01:00:00:01");
+
+std::unique_ptr<MockRxPacket> toRxPacket(std::unique_ptr<folly::IOBuf> buf) {
+  auto pkt = std::make_unique<MockRxPacket>(std::move(buf));
+  pkt->padToLength(68);
+  pkt->setSrcPort(PortID(1));
+  pkt->setSrcVlan(VlanID(1));
+  return pkt;
+}
+
+std::unique_ptr<MockRxPacket> makeDhcpPacket() {
+  auto frame = utility::getEthFrame(
+      kSrcMac,
+      kDstMac,
+      folly::IPAddressV4("10.0.0.15"),
+      folly::IPAddressV4("10.0.0.1"),
+      68,
+      67);
+  auto buf = folly::IOBuf::create(frame.length());
+  buf->append(frame.length());
+  folly::io::RWPrivateCursor cursor(buf.get());
+  frame.serialize(cursor);
+  return toRxPacket(std::move(buf));
+}
+
+std::unique_ptr<MockRxPacket> makeLacpPacket() {
+  constexpr size_t kLength = 128;
+  auto buf = folly::IOBuf::create(kLength);
+  buf->append(kLength);
+  std::memset(buf->writableData(), 0, kLength);
+  folly::io::RWPrivateCursor cursor(buf.get());
+  cursor.push(LACPDU::kSlowProtocolsDstMac().bytes(), folly::MacAddress::SIZE);
+  cursor.push(kSrcMac.bytes(), folly::MacAddress::SIZE);
+  cursor.writeBE<uint16_t>(LACPDU::EtherType::SLOW_PROTOCOLS);
+  cursor.writeBE<uint8_t>(LACPDU::EtherSubtype::LACP);
+  LACPDU().to(&cursor);
+  return toRxPacket(std::move(buf));
+}
+
+void lacpLatency(size_t numIters, bool flood) {
+  folly::BenchmarkSuspender suspender;
+  auto lacpPkt = makeLacpPacket();
+  auto dhcpPkt = makeDhcpPacket();
+
+  folly::Baton<> lacpHandled;
+  RxPacketScheduler scheduler(
+      RxPacketScheduler::Config::fromFlags(),
+      [&](std::unique_ptr<RxPacket> pkt) {
+        if (RxPacketScheduler::classify(pkt.get()) ==
+            RxPacketClass::CONTROL) {
+          lacpHandled.post();
+          return;
+        }
+        // Stand in for relaying DHCP or generating ICMP errors
+        auto end = steady_clock::now() + kSlowPathCost;
+        while (steady_clock::now() < end) {
+        }
+      });
+
+  std::atomic<bool> done{false};
+  std::thread flooder;
+  if (flood) {
+    flooder = std::thread([&] {
+      constexpr auto kBatchSize = kFloodPps *
+          std::chrono::duration_cast<microseconds>(kFloodBatchInterval)
+              .count() /
+          1000000;
+      auto next = steady_clock::now();
+      while (!done.load()) {
+        for (uint32_t i = 0; i < kBatchSize; ++i) {
+          scheduler.enqueue(dhcpPkt->clone());
+        }
+        next += kFloodBatchInterval;
+        std::this_thread::sleep_until(next);
+      }
+    });
+    // Let the slow path queue fill up
+    std::this_thread::sleep_for(milliseconds(100));
+  }
+
+  std::vector<nanoseconds::rep> latencies;
+  latencies.reserve(numIters);
+  for (size_t n = 0; n < numIters; ++n) {
+    auto pkt = lacpPkt->clone();
+    suspender.dismiss();
+    auto start = steady_clock::now();
+    scheduler.enqueue(std::move(pkt));
+    lacpHandled.wait();
+    auto elapsed = steady_clock::now() - start;
+    suspender.rehire();
+    lacpHandled.reset();
+    latencies.push_back(
+        std::chrono::duration_cast<nanoseconds>(elapsed).count());
+  }
+
+  done = true;
+  if (flooder.joinable()) {
+    flooder.join();
+  }
+  scheduler.stop();
+
+  std::sort(latencies.begin(), latencies.end());
+  XLOG(INFO) << "LACP latency" << (flood ? " under flood" : "")
+             << ": p50=" << latencies[latencies.size() / 2]
+             << "ns p99=" << latencies[latencies.size() * 99 / 100]
+             << "ns, slow path queued="
+             << scheduler.numQueued(RxPacketClass::SLOW_PATH)
+             << " policed=" << scheduler.numPoliced(RxPacketClass::SLOW_PATH)
+             << " queue_full="
+             << scheduler.numQueueFull(RxPacketClass::SLOW_PATH);
+}
+
+} // unnamed namespace
+
+BENCHMARK(LacpLatencyIdle, numIters) {
+  lacpLatency(numIters, false);
+}
+
+BENCHMARK_RELATIVE(LacpLatencySlowPathFlood, numIters) {
+  lacpLatency(numIters, true);
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxPacketScheduler.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+
+#include <folly/Conv.h>
+#include <folly/Format.h>
+#include <folly/io/Cursor.h>
+#include <folly/synchronization/Baton.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+using namespace facebook::fboss;
+
+namespace {
+
+std::unique_ptr<MockRxPacket> makePacket(folly::StringPiece hex) {
+  auto pkt = MockRxPacket::fromHex(hex);
+  pkt->padToLength(68);
+  pkt->setSrcPort(PortID(1));
+  pkt->setSrcVlan(VlanID(1));
+  return pkt;
+}
+
+std::unique_ptr<MockRxPacket> lacpPacket() {
+  return makePacket(
+      // dst mac, src mac
+      "01 80 c2 00 00 02  02 00 00 00 00 01"
+      // Slow protocols, LACP
+      "88 09  01");
+}
+
+std::unique_ptr<MockRxPacket> arpPacket() {
+  return makePacket(
+      // dst mac, src mac
+      "ff ff ff ff ff ff  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // ARP request
+      "08 06  00 01  08 00  06  04  00 01"
+      "00 02 00 01 02 03  0a 00 00 0f"
+      "00 00 00 00 00 00  0a 00 00 01");
+}
+
+std::unique_ptr<MockRxPacket> ipv4Packet(
+    folly::StringPiece ttl,
+    folly::StringPiece proto,
+    folly::StringPiece l4) {
+  return makePacket(folly::to<std::string>(
+      // dst mac, src mac
+      "02 00 01 00 00 01  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // IPv4
+      "08 00  45 00 00 30  00 00 00 00 ",
+      ttl,
+      proto,
+      "00 00  0a 00 00 0f  0a 00 00 01",
+      l4));
+}
+
+std::unique_ptr<MockRxPacket> ndpPacket() {
+  return makePacket(
+      // dst mac, src mac
+      "33 33 ff 00 00 01  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // IPv6, ICMPv6, hop limit 255
+      "86 dd  60 00 00 00  00 20 3a ff"
+      "fe 80 00 00 00 00 00 00 02 02 00 ff fe 01 02 03"
+      "ff 02 00 00 00 00 00 00 00 00 00 01 ff 00 00 01"
+      // Neighbor solicitation
+      "87 00 00 00  00 00 00 00");
+}
+
+RxPacketScheduler::Config makeConfig(uint32_t slowPathPps = 0) {
+  RxPacketScheduler::Config config;
+  config.classes[static_cast<size_t>(RxPacketClass::SLOW_PATH)].ratePps =
+      slowPathPps;
+  config.classes[static_cast<size_t>(RxPacketClass::SLOW_PATH)].burstSize = 1;
+  return config;
+}
+
+} // unnamed namespace
+
+TEST(RxPacketSchedulerTest, classify) {
+  EXPECT_EQ(
+      RxPacketScheduler::classify(lacpPacket().get()), RxPacketClass::CONTROL);
+  EXPECT_EQ(
+      RxPacketScheduler::classify(arpPacket().get()), RxPacketClass::NEIGHBOR);
+  EXPECT_EQ(
+      RxPacketScheduler::classify(ndpPacket().get()), RxPacketClass::NEIGHBOR);
+  // BGP
+  EXPECT_EQ(
+      RxPacketScheduler::classify(
+          ipv4Packet("40", "06", "c0 01 00 b3").get()),
+      RxPacketClass::HOST);
+  // TTL expired
+  EXPECT_EQ(
+      RxPacketScheduler::classify(
+          ipv4Packet("01", "06", "c0 01 00 b3").get()),
+      RxPacketClass::SLOW_PATH);
+  // DHCP
+  EXPECT_EQ(
+      RxPacketScheduler::classify(
+          ipv4Packet("40", "11", "00 44 00 43 00 1c 00 00").get()),
+      RxPacketClass::SLOW_PATH);
+}
+
+TEST(RxPacketSchedulerTest, handleAllClasses) {
+  constexpr int kNumPkts = 400;
+  std::atomic<int> handled{0};
+  folly::Baton<> done;
+  RxPacketScheduler scheduler(
+      makeConfig(), [&](std::unique_ptr<RxPacket> /*pkt*/) {
+        if (++handled == kNumPkts) {
+          done.post();
+        }
+      });
+  for (int i = 0; i < kNumPkts / 4; ++i) {
+    EXPECT_TRUE(scheduler.enqueue(lacpPacket()));
+    EXPECT_TRUE(scheduler.enqueue(arpPacket()));
+    EXPECT_TRUE(scheduler.enqueue(ipv4Packet("40", "06", "c0 01 00 b3")));
+    EXPECT_TRUE(scheduler.enqueue(ipv4Packet("01", "06", "c0 01 00 b3")));
+  }
+  done.wait();
+  EXPECT_EQ(handled, kNumPkts);
+  EXPECT_EQ(scheduler.numQueued(RxPacketClass::CONTROL), kNumPkts / 4);
+  EXPECT_EQ(scheduler.numQueued(RxPacketClass::NEIGHBOR), kNumPkts / 4);
+  EXPECT_EQ(scheduler.numQueued(RxPacketClass::HOST), kNumPkts / 4);
+  EXPECT_EQ(scheduler.numQueued(RxPacketClass::SLOW_PATH), kNumPkts / 4);
+}
+
+TEST(RxPacketSchedulerTest, hostFlowInOrder) {
+  constexpr uint32_t kNumPkts = 1000;
+  std::vector<uint32_t> seqs;
+  folly::Baton<> done;
+  RxPacketScheduler scheduler(
+      makeConfig(), [&](std::unique_ptr<RxPacket> pkt) {
+        // The TCP sequence number, after the Ethernet, VLAN and IPv4
+        // headers and the TCP ports
+        folly::io::Cursor c(pkt->buf());
+        c += 14 + 4 + 20 + 4;
+        seqs.push_back(c.readBE<uint32_t>());
+        if (seqs.size() == kNumPkts) {
+          done.post();
+        }
+      });
+  for (uint32_t i = 0; i < kNumPkts; ++i) {
+    // Segments of a single BGP session
+    auto seq = folly::sformat(
+        "{:02x} {:02x} {:02x} {:02x}",
+        i >> 24,
+        (i >> 16) & 0xff,
+        (i >> 8) & 0xff,
+        i & 0xff);
+    EXPECT_TRUE(scheduler.enqueue(
+        ipv4Packet("40", "06", folly::to<std::string>("c0 01 00 b3 ", seq))));
+  }
+  done.wait();
+  ASSERT_EQ(kNumPkts, seqs.size());
+  for (uint32_t i = 0; i < kNumPkts; ++i) {
+    EXPECT_EQ(i, seqs[i]);
+  }
+}
+
+TEST(RxPacketSchedulerTest, policeSlowPath) {
+  constexpr int kNumPkts = 100;
+  RxPacketScheduler scheduler(
+      makeConfig(1 /* slowPathPps */), [](std::unique_ptr<RxPacket> /*pkt*/) {
+      });
+  int queued = 0;
+  for (int i = 0; i < kNumPkts; ++i) {
+    queued += scheduler.enqueue(ipv4Packet("01", "06", "c0 01 00 b3"));
+    // Other classes are not policed
+    EXPECT_TRUE(scheduler.enqueue(lacpPacket()));
+  }
+  EXPECT_LT(queued, kNumPkts);
+  EXPECT_EQ(scheduler.numQueued(RxPacketClass::SLOW_PATH), queued);
+  EXPECT_EQ(scheduler.numPoliced(RxPacketClass::SLOW_PATH), kNumPkts - queued);
+  EXPECT_EQ(scheduler.numPoliced(RxPacketClass::CONTROL), 0);
+}
+
+TEST(RxPacketSchedulerTest, dropWhenStopped) {
+  RxPacketScheduler scheduler(
+      makeConfig(), [](std::unique_ptr<RxPacket> /*pkt*/) {});
+  scheduler.stop();
+  EXPECT_FALSE(scheduler.enqueue(lacpPacket()));
+}
@@ -11,6 +11,7 @@
 #include <gtest/gtest.h>
 
 #include "fboss/agent/ArpHandler.h"
+#include "fboss/agent/FbossError.h"
 #include "fboss/agent/Main.h"
 #include "fboss/agent/NeighborUpdater.h"
 #include "fboss/agent/PortStats.h"
@@ -30,6 +31,8 @@
 
 #include <algorithm>
 
+DECLARE_bool(pipelined_state_updates);
+
 using namespace facebook::fboss;
 using folly::IPAddressV4;
 using folly::IPAddressV6;
@@ -58,6 +61,19 @@ class SwSwitchTest : public ::testing::Test {
   std::unique_ptr<HwTestHandle> handle{nullptr};
 };
 
+class SwSwitchPipelinedTest : public SwSwitchTest {
+ public:
+  void SetUp() override {
+    FLAGS_pipelined_state_updates = true;
+    SwSwitchTest::SetUp();
+  }
+
+  void TearDown() override {
+    SwSwitchTest::TearDown();
+    FLAGS_pipelined_state_updates = false;
+  }
+};
+
 TEST_F(SwSwitchTest, GetPortStats) {
   // get port5 portStats for the first time
   EXPECT_EQ(sw->stats()->getPortStats()->size(), 0);
@@ -185,3 +201,89 @@ TEST_F(SwSwitchTest, TestStateNonCoalescing) {
   // 0 neighbor entries expected, i.e. entries must be purged
   verifyReachableCnt(0);
 }
+
+TEST_F(SwSwitchPipelinedTest, HwRejectsUpdateThenAccepts) {
+  CounterCache counters(sw);
+  auto origState = sw->getAppliedState();
+  auto newState = bringAllPortsUp(sw->getAppliedState()->clone());
+  EXPECT_HW_CALL(sw, stateChanged(_)).WillRepeatedly(Return(origState));
+  auto stateUpdateFn = [=](const std::shared_ptr<SwitchState>& /*state*/) {
+    return newState;
+  };
+  sw->updateState("Reject update", stateUpdateFn);
+  waitForStateUpdates(sw);
+  // Desired state moves ahead of the hardware
+  EXPECT_EQ(newState, sw->getDesiredState());
+  EXPECT_EQ(origState, sw->getAppliedState());
+  counters.update();
+  EXPECT_EQ(1, counters.value(SwitchStats::kCounterPrefix + "hw_out_of_sync"));
+  // The next update retries the delta between applied and desired states,
+  // even though it does not change the desired state itself.
+  EXPECT_HW_CALL(sw, stateChanged(_)).WillRepeatedly(Return(newState));
+  sw->updateState("Accept update", stateUpdateFn);
+  waitForStateUpdates(sw);
+  EXPECT_EQ(sw->getAppliedState(), sw->getDesiredState());
+  counters.update();
+  EXPECT_EQ(0, counters.value(SwitchStats::kCounterPrefix + "hw_out_of_sync"));
+}
+
+TEST_F(SwSwitchPipelinedTest, HwResyncQueuedOnFailure) {
+  CounterCache counters(sw);
+  auto origState = sw->getAppliedState();
+  auto newState = bringAllPortsUp(sw->getAppliedState()->clone());
+  EXPECT_HW_CALL(sw, stateChanged(_)).WillRepeatedly(Return(origState));
+  sw->updateState(
+      "Reject update",
+      [=](const std::shared_ptr<SwitchState>& /*state*/) { return newState; });
+  waitForStateUpdates(sw);
+  EXPECT_NE(sw->getAppliedState(), sw->getDesiredState());
+  // The hardware is retried with the next batch, even if all the updates
+  // in it fail, since the failure queued an update of its own.
+  EXPECT_HW_CALL(sw, stateChanged(_)).WillRepeatedly(Return(newState));
+  sw->updateState(
+      "Failed update",
+      [](const std::shared_ptr<SwitchState>& /*state*/)
+          -> std::shared_ptr<SwitchState> {
+        throw FbossError("update failed");
+      });
+  waitForStateUpdates(sw);
+  EXPECT_EQ(sw->getAppliedState(), sw->getDesiredState());
+  counters.update();
+  EXPECT_EQ(0, counters.value(SwitchStats::kCounterPrefix + "hw_out_of_sync"));
+}
+
+TEST_F(SwSwitchPipelinedTest, UpdatesAppliedInOrder) {
+  const PortID kPort1{1};
+  // Each update builds on the state prepared by the previous one, whether
+  // or not the hardware has been programmed with it yet.
+  for (auto i = 0; i < 10; ++i) {
+    sw->updateState(
+        "Toggle port", [=](const std::shared_ptr<SwitchState>& state) {
+          auto newState = state;
+          auto port = newState->getPorts()->getPort(kPort1)->modify(&newState);
+          port->setOperState(i % 2 == 0);
+          return newState;
+        });
+  }
+  waitForStateUpdates(sw);
+  EXPECT_EQ(sw->getAppliedState(), sw->getDesiredState());
+  EXPECT_FALSE(sw->getAppliedState()->getPorts()->getPort(kPort1)->isUp());
+}
+
+TEST_F(SwSwitchPipelinedTest, AlpmRoutesSurviveUpdates) {
+  auto checkAlpmRoutes = [](const std::shared_ptr<SwitchState>& state) {
+    GET_ROUTE_V4(state->getRouteTables(), RouterID(0), "0.0.0.0/0");
+    GET_ROUTE_V6(state->getRouteTables(), RouterID(0), "::/0");
+  };
+  checkAlpmRoutes(sw->getAppliedState());
+  checkAlpmRoutes(sw->getDesiredState());
+  // The first update after init is prepared from the desired state, and
+  // must not delete the default routes added for ALPM from the hardware
+  sw->updateState(
+      "Bring ports up", [](const std::shared_ptr<SwitchState>& state) {
+        return bringAllPortsUp(state->clone());
+      });
+  waitForStateUpdates(sw);
+  EXPECT_EQ(sw->getAppliedState(), sw->getDesiredState());
+  checkAlpmRoutes(sw->getAppliedState());
+}
@@ -0,0 +1,232 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+/*
+ * Measure packets/sec through a local tun interface in both directions:
+ *  - HostToSwitch: packets injected on the tun device with a packet socket
+ *    are read by TunIntf and handed to the switch.
+ *  - SwitchToHost: packets sent with TunIntf::sendPacketToHost() from
+ *    several threads are written to the host.
+ * Each benchmark runs with and without --tun_batched_io. Needs root to
+ * create the tun device.
+ */
+
+extern "C" {
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+}
+
+#include <folly/Benchmark.h>
+#include <folly/ScopeGuard.h>
+#include <folly/io/async/EventBase.h>
+#include <gflags/gflags.h>
+
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/SysError.h"
+#include "fboss/agent/TunIntf.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+
+#include <thread>
+
+DECLARE_bool(tun_batched_io);
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+using folly::MacAddress;
+using std::make_shared;
+using std::make_unique;
+using std::shared_ptr;
+using std::unique_ptr;
+
+namespace {
+
+const InterfaceID kIntfID(1);
+const int kMtu = 1500;
+// Packets injected on the tun device before reading them back, small enough
+// not to overflow the tun device queue
+const int kBurstSize = 64;
+const int kWriterThreads = 4;
+
+// IPv4 UDP 10.0.0.100 -> 10.0.0.2 with 8 bytes of payload
+const std::string kIpPacketHex =
+    "45 00 00 24  00 00 40 00  40 11 26 64  0a 00 00 64  0a 00 00 02"
+    "04 00 04 00  00 10 00 00"
+    "00 01 02 03  04 05 06 07";
+
+unique_ptr<SwSwitch> sw;
+
+unique_ptr<SwSwitch> setupSwitch() {
+  MacAddress localMac("02:00:01:00:00:01");
+  auto sw = make_unique<SwSwitch>(make_unique<SimPlatform>(localMac, 10));
+  sw->init(nullptr /* No custom TunManager */);
+
+  auto updateFn = [&](const shared_ptr<SwitchState>& oldState) {
+    auto state = oldState->clone();
+    auto vlan1 = make_shared<Vlan>(VlanID(1), "Vlan1");
+    state->addVlan(vlan1);
+    for (int idx = 1; idx < 10; ++idx) {
+      vlan1->addPort(PortID(idx), false);
+    }
+    auto intf1 = make_shared<Interface>(
+        kIntfID,
+        RouterID(0),
+        VlanID(1),
+        "interface1",
+        localMac,
+        9000,
+        false, /* is virtual */
+        false /* is state_sync disabled*/);
+    Interface::Addresses addrs1;
+    addrs1.emplace(IPAddress("10.0.0.1"), 24);
+    intf1->setAddresses(addrs1);
+    state->addIntf(intf1);
+    return state;
+  };
+
+  sw->updateStateBlocking("setup", updateFn);
+  return sw;
+}
+
+unique_ptr<TunIntf> createTunIntf(folly::EventBase* evb, bool batched) {
+  FLAGS_tun_batched_io = batched;
+  auto intf = make_unique<TunIntf>(
+      sw.get(), evb, kIntfID, true, Interface::Addresses{}, kMtu);
+  intf->setDelete();
+
+  // Bring the link up so the kernel transmits packets on it
+  auto sock = socket(PF_INET, SOCK_DGRAM, 0);
+  sysCheckError(sock, "Failed to open socket");
+  SCOPE_EXIT {
+    close(sock);
+  };
+  struct ifreq ifr;
+  memset(&ifr, 0, sizeof(ifr));
+  auto name = intf->getName();
+  size_t len = std::min(name.size(), sizeof(ifr.ifr_name));
+  memmove(ifr.ifr_name, name.c_str(), len);
+  ifr.ifr_flags = IFF_UP;
+  sysCheckError(ioctl(sock, SIOCSIFFLAGS, &ifr), "Failed to bring up ", name);
+
+  intf->start();
+  return intf;
+}
+
+void hostToSwitch(size_t numIters, bool batched) {
+  folly::EventBase evb;
+  unique_ptr<TunIntf> intf;
+  int sock = -1;
+  struct sockaddr_ll addr;
+  unique_ptr<MockRxPacket> packet;
+  BENCHMARK_SUSPEND {
+    intf = createTunIntf(&evb, batched);
+    sock = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+    sysCheckError(sock, "Failed to open packet socket");
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_IP);
+    addr.sll_ifindex = intf->getIfIndex();
+    packet = MockRxPacket::fromHex(kIpPacketHex);
+  }
+
+  size_t sent = 0;
+  while (sent < numIters) {
+    auto burst = std::min<size_t>(kBurstSize, numIters - sent);
+    for (size_t i = 0; i < burst; ++i) {
+      auto ret = sendto(
+          sock,
+          packet->buf()->data(),
+          packet->buf()->length(),
+          0,
+          reinterpret_cast<struct sockaddr*>(&addr),
+          sizeof(addr));
+      sysCheckError(ret, "Failed to inject packet on ", intf->getName());
+    }
+    sent += burst;
+    while (true) {
+      auto stats = intf->getStats();
+      if (stats.rxPackets + stats.rxDrops >= sent) {
+        break;
+      }
+      evb.loopOnce();
+    }
+  }
+
+  BENCHMARK_SUSPEND {
+    auto stats = intf->getStats();
+    CHECK_GE(stats.rxPackets + stats.rxDrops, numIters);
+    close(sock);
+    intf.reset();
+  }
+}
+
+void switchToHost(size_t numIters, bool batched) {
+  folly::EventBase evb;
+  unique_ptr<TunIntf> intf;
+  unique_ptr<MockRxPacket> pkt;
+  BENCHMARK_SUSPEND {
+    intf = createTunIntf(&evb, batched);
+    pkt = MockRxPacket::fromHex(
+        // dst mac, src mac, IPv4
+        "02 00 01 00 00 01  00 02 00 01 02 03  08 00" + kIpPacketHex);
+  }
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kWriterThreads; ++t) {
+    writers.emplace_back([&, t]() {
+      for (size_t i = t; i < numIters; i += kWriterThreads) {
+        intf->sendPacketToHost(pkt->clone());
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  BENCHMARK_SUSPEND {
+    auto stats = intf->getStats();
+    CHECK_EQ(stats.txPackets + stats.txDrops, numIters);
+    intf.reset();
+  }
+}
+
+} // unnamed namespace
+
+BENCHMARK(HostToSwitch, numIters) {
+  hostToSwitch(numIters, false);
+}
+
+BENCHMARK_RELATIVE(HostToSwitchBatched, numIters) {
+  hostToSwitch(numIters, true);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(SwitchToHost, numIters) {
+  switchToHost(numIters, false);
+}
+
+BENCHMARK_RELATIVE(SwitchToHostBatched, numIters) {
+  switchToHost(numIters, true);
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  sw = setupSwitch();
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,301 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+#include "fboss/lib/CompactRadixTree.h"
+
+namespace facebook::network {
+
+template <typename IPADDRTYPE, typename T>
+typename CompactRadixTree<IPADDRTYPE, T>::Index
+CompactRadixTree<IPADDRTYPE, T>::longestMatchImpl(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen,
+    bool& foundExact,
+    bool includeNonValueNodes) const {
+  // Can't trust the clients to have 0s in all bits after mask length
+  const auto toMatch = ipaddr.mask(masklen);
+
+  Index parent = kNoNode;
+  Index lastValueNodeSeen = kNoNode;
+  auto curNode = root_;
+  while (curNode != kNoNode) {
+    const auto& node = arena_[curNode];
+    if (node.masklen_ > masklen ||
+        toMatch.mask(node.masklen_) != node.ipAddress_) {
+      // We took one extra step in the hope of getting a better
+      // match but this didn't succeed. So back up one step
+      curNode = parent;
+      break;
+    }
+    if (node.isValueNode()) {
+      lastValueNodeSeen = curNode;
+    }
+    if (node.masklen_ == masklen) {
+      foundExact = node.isValueNode() || includeNonValueNodes;
+      break;
+    }
+    auto child = node.children_[toMatch.getNthMSBit(node.masklen_)];
+    if (child == kNoNode) {
+      break;
+    }
+    parent = curNode;
+    curNode = child;
+  }
+  return includeNonValueNodes ? curNode : lastValueNodeSeen;
+}
+
+template <typename IPADDRTYPE, typename T>
+void CompactRadixTree<IPADDRTYPE, T>::longestMatchBatchImpl(
+    folly::Range<const IPADDRTYPE*> addrs,
+    std::vector<Index>* matches) const {
+  struct Walk {
+    size_t index;
+    Index curNode;
+    Index lastValueNodeSeen;
+  };
+  // Advance walk by one node. Returns false once the walk is done.
+  auto step = [this, &addrs](Walk& walk) {
+    if (walk.curNode == kNoNode) {
+      return false;
+    }
+    const auto& addr = addrs[walk.index];
+    const auto& node = arena_[walk.curNode];
+    if (addr.mask(node.masklen_) != node.ipAddress_) {
+      return false;
+    }
+    if (node.isValueNode()) {
+      walk.lastValueNodeSeen = walk.curNode;
+    }
+    if (node.masklen_ == IPADDRTYPE::bitCount()) {
+      return false;
+    }
+    walk.curNode = node.children_[addr.getNthMSBit(node.masklen_)];
+    if (walk.curNode == kNoNode) {
+      return false;
+    }
+    __builtin_prefetch(&arena_[walk.curNode]);
+    return true;
+  };
+
+  matches->assign(addrs.size(), kNoNode);
+  std::array<Walk, kBatchLookupWidth> walks;
+  size_t numWalks = 0;
+  size_t nextIndex = 0;
+  while (numWalks < walks.size() && nextIndex < addrs.size()) {
+    walks[numWalks++] = Walk{nextIndex++, root_, kNoNode};
+  }
+  while (numWalks > 0) {
+    for (size_t i = 0; i < numWalks;) {
+      auto& walk = walks[i];
+      if (step(walk)) {
+        ++i;
+        continue;
+      }
+      (*matches)[walk.index] = walk.lastValueNodeSeen;
+      if (nextIndex < addrs.size()) {
+        // Start the next lookup in this slot
+        walk = Walk{nextIndex++, root_, kNoNode};
+        ++i;
+      } else {
+        // No lookups left to start, retire this slot
+        walk = walks[--numWalks];
+      }
+    }
+  }
+}
+
+template <typename IPADDRTYPE, typename T>
+template <typename VALUE>
+std::pair<typename CompactRadixTree<IPADDRTYPE, T>::Iterator, bool>
+CompactRadixTree<IPADDRTYPE, T>::insert(
+    const IPADDRTYPE& ipaddr,
+    uint8_t mask,
+    VALUE&& value) {
+  auto foundExact = false;
+  // Can't trust the clients to have 0s in all bits after mask length
+  auto toAdd = ipaddr.mask(mask);
+  auto bestMatch = longestMatchImpl(
+      toAdd, mask, foundExact, true /*include non value nodes*/);
+  if (foundExact) {
+    auto& node = arena_[bestMatch];
+    if (node.isValueNode()) {
+      // Prefix already exists in the tree
+      return std::make_pair(Iterator(this, bestMatch), false);
+    }
+    node.setValue(std::forward<VALUE>(value));
+    ++size_;
+    return std::make_pair(Iterator(this, bestMatch), true);
+  }
+
+  auto newNode = makeNode(toAdd, mask);
+  arena_[newNode].setValue(std::forward<VALUE>(value));
+  if (bestMatch == kNoNode) {
+    // No match found. Either the tree is empty, or the root is not a
+    // less specific prefix of the new node and we need a new root.
+    replaceChild(
+        kNoNode, root_, root_ == kNoNode ? newNode : join(root_, newNode));
+  } else {
+    // New node goes under bestMatch, either in an empty child slot or
+    // joined with the subtree currently in that slot.
+    auto right = toAdd.getNthMSBit(arena_[bestMatch].masklen_);
+    auto bestMatchChild = arena_[bestMatch].children_[right];
+    setChild(
+        bestMatch,
+        right,
+        bestMatchChild == kNoNode ? newNode : join(bestMatchChild, newNode));
+  }
+  ++size_;
+  return std::make_pair(Iterator(this, newNode), true);
+}
+
+template <typename IPADDRTYPE, typename T>
+typename CompactRadixTree<IPADDRTYPE, T>::Index
+CompactRadixTree<IPADDRTYPE, T>::join(Index existing, Index newNode) {
+  const auto& existingNode = arena_[existing];
+  const auto& newNodeRef = arena_[newNode];
+  auto prefix = IPADDRTYPE::longestCommonPrefix(
+      {existingNode.ipAddress_, existingNode.masklen_},
+      {newNodeRef.ipAddress_, newNodeRef.masklen_});
+  // existing can't be a less specific prefix of the new node, else the
+  // longest match for the new node would have been in existing's subtree.
+  DCHECK(
+      prefix.first != existingNode.ipAddress_ ||
+      prefix.second != existingNode.masklen_);
+  auto joint = newNode;
+  if (prefix.first != newNodeRef.ipAddress_ ||
+      prefix.second != newNodeRef.masklen_) {
+    // Need a non value internal node as the parent of existing and
+    // the new node.
+    joint = makeNode(prefix.first, prefix.second);
+    setChild(
+        joint, newNodeRef.ipAddress_.getNthMSBit(prefix.second), newNode);
+  }
+  setChild(
+      joint, existingNode.ipAddress_.getNthMSBit(prefix.second), existing);
+  return joint;
+}
+
+/*
+ * Same as RadixTree::erase, this maintains the invariant that all non value
+ * nodes have 2 children.
+ */
+template <typename IPADDRTYPE, typename T>
+bool CompactRadixTree<IPADDRTYPE, T>::eraseImpl(Index toDelete) {
+  if (toDelete == kNoNode) {
+    return false;
+  }
+  auto& node = arena_[toDelete];
+  CHECK(node.isValueNode());
+  auto parent = node.parent_;
+  auto left = node.children_[0];
+  auto right = node.children_[1];
+  if (left != kNoNode && right != kNoNode) {
+    // The prefix is still needed to join the two children
+    node.value_.reset();
+  } else if (left != kNoNode || right != kNoNode) {
+    // Let toDelete's parent adopt its only child
+    replaceChild(parent, toDelete, left != kNoNode ? left : right);
+    arena_.free(toDelete);
+  } else if (parent == kNoNode) {
+    // Only node in the tree
+    CHECK_EQ(root_, toDelete);
+    root_ = kNoNode;
+    arena_.free(toDelete);
+  } else {
+    auto& parentNode = arena_[parent];
+    if (parentNode.isNonValueNode()) {
+      // Without toDelete, the non value parent would be left with one
+      // child. Replace the parent with toDelete's sibling.
+      auto sibling = parentNode.children_[0] == toDelete
+          ? parentNode.children_[1]
+          : parentNode.children_[0];
+      CHECK_NE(sibling, kNoNode);
+      replaceChild(parentNode.parent_, parent, sibling);
+      arena_.free(parent);
+    } else {
+      parentNode.children_[parentNode.children_[1] == toDelete] = kNoNode;
+    }
+    arena_.free(toDelete);
+  }
+  --size_;
+  return true;
+}
+
+template <typename IPADDRTYPE, typename T>
+bool CompactRadixTree<IPADDRTYPE, T>::subTreesEqual(
+    const CompactRadixTree& r,
+    Index mine,
+    Index theirs) const {
+  if (mine != kNoNode && theirs != kNoNode) {
+    const auto& nodeA = arena_[mine];
+    const auto& nodeB = r.arena_[theirs];
+    return nodeA.equalSansLinks(nodeB) &&
+        subTreesEqual(r, nodeA.children_[0], nodeB.children_[0]) &&
+        subTreesEqual(r, nodeA.children_[1], nodeB.children_[1]);
+  }
+  return mine == kNoNode && theirs == kNoNode;
+}
+
+template <typename IPADDRTYPE, typename T>
+template <typename FUNC>
+void CompactRadixTree<IPADDRTYPE, T>::forEachChanged(
+    const CompactRadixTree& oldTree,
+    const CompactRadixTree& newTree,
+    FUNC&& fn) {
+  const TreeNode* none = nullptr;
+  auto oldItr = oldTree.begin();
+  auto newItr = newTree.begin();
+  // Merge the two walks, which both visit the prefixes in preorder
+  while (!oldItr.atEnd() || !newItr.atEnd()) {
+    if (newItr.atEnd() ||
+        (!oldItr.atEnd() && iteratesBefore(*oldItr, *newItr))) {
+      fn(&*oldItr, none);
+      ++oldItr;
+    } else if (oldItr.atEnd() || iteratesBefore(*newItr, *oldItr)) {
+      fn(none, &*newItr);
+      ++newItr;
+    } else {
+      if (!(oldItr->value() == newItr->value())) {
+        fn(&*oldItr, &*newItr);
+      }
+      ++oldItr;
+      ++newItr;
+    }
+  }
+}
+
+template <typename TREE, typename CURSORNODE>
+void CompactRadixTreeIterator<TREE, CURSORNODE>::increment() {
+  auto previous = kNoNode;
+  auto done = false;
+  while (!done && cursor_ != kNoNode) {
+    const auto& cur = node();
+    if (previous == kNoNode || cur.parent_ == previous) {
+      // Going down the tree
+      previous = cursor_;
+      if (cur.children_[0] != kNoNode) {
+        cursor_ = cur.children_[0];
+      } else if (cur.children_[1] != kNoNode) {
+        cursor_ = cur.children_[1];
+      } else {
+        cursor_ = cur.parent_;
+        continue;
+      }
+    } else if (cur.children_[0] == previous) {
+      // Coming up the tree from left.
+      previous = cursor_;
+      if (cur.children_[1] != kNoNode) {
+        cursor_ = cur.children_[1];
+      } else {
+        cursor_ = cur.parent_;
+        continue;
+      }
+    } else {
+      // Coming up the tree from right
+      previous = cursor_;
+      cursor_ = cur.parent_;
+      continue;
+    }
+    done = cursor_ == kNoNode || node().isValueNode();
+  }
+}
+
+} // namespace facebook::network
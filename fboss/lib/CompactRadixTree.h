@@ -0,0 +1,572 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/Bits.h>
+#include <folly/Conv.h>
+#include <folly/IPAddress.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Range.h>
+
+/*
+ * CompactRadixTree is a path compressed binary trie with the same
+ * insert/erase/longestMatch/exactMatch/iterator API as RadixTree, for
+ * IPAddressV4 or IPAddressV6 keys.
+ *
+ * Where RadixTree allocates every node on the heap and links it with a
+ * unique_ptr per child, a parent pointer and a per node delete callback,
+ * CompactRadixTree keeps all its nodes in an arena owned by the tree and
+ * links them with 32 bit arena indices. Nodes are thus much smaller and
+ * mostly contiguous, which cuts both memory per prefix and cache misses
+ * during lookups. Path compression means a lookup visits one node per
+ * prefix on the path to the match rather than one per bit, i.e. the
+ * stride of each step is the distance between the two prefix lengths.
+ *
+ * Differences from RadixTree:
+ * - Node delete callbacks, custom tree traits and the *WithTrail lookups
+ *   are not supported.
+ * - Iterators refer to their tree, so they are invalidated when the tree is
+ *   moved (but, as with RadixTree, not by inserting or erasing other nodes).
+ */
+
+namespace facebook::network {
+
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTree;
+
+template <typename TREE, typename CURSORNODE>
+class CompactRadixTreeIterator;
+
+/*
+ * Node in CompactRadixTree. As in RadixTree, nodes without a value are
+ * internal nodes joining two subtrees, and always have 2 children.
+ */
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTreeNode {
+ public:
+  using Index = uint32_t;
+  static constexpr Index kNoNode = std::numeric_limits<Index>::max();
+
+  const IPADDRTYPE& ipAddress() const {
+    return ipAddress_;
+  }
+  uint32_t masklen() const {
+    return masklen_;
+  }
+  bool isValueNode() const {
+    return value_.has_value();
+  }
+  bool isNonValueNode() const {
+    return !isValueNode();
+  }
+  bool isLeaf() const {
+    return children_[0] == kNoNode && children_[1] == kNoNode;
+  }
+  const T& value() const {
+    return value_.value();
+  }
+  T& value() {
+    return value_.value();
+  }
+  template <typename VALUE>
+  void setValue(VALUE&& newValue) {
+    value_ = std::forward<VALUE>(newValue);
+  }
+  std::string str(bool printValue = true) const {
+    auto nodeStr = folly::to<std::string>(ipAddress_.str(), "/", masklen_);
+    if (printValue) {
+      nodeStr += isNonValueNode()
+          ? "(*)"
+          : folly::to<std::string>("(", this->value(), ")");
+    }
+    return nodeStr;
+  }
+
+  // Comparison with links (children, parent) ignored
+  bool equalSansLinks(const CompactRadixTreeNode& r) const {
+    return ipAddress_ == r.ipAddress_ && masklen_ == r.masklen_ &&
+        isValueNode() == r.isValueNode() &&
+        (!isValueNode() || this->value() == r.value());
+  }
+
+ private:
+  friend class CompactRadixTree<IPADDRTYPE, T>;
+  template <typename TREE, typename CURSORNODE>
+  friend class CompactRadixTreeIterator;
+
+  IPADDRTYPE ipAddress_;
+  uint8_t masklen_{0};
+  Index parent_{kNoNode};
+  std::array<Index, 2> children_{{kNoNode, kNoNode}};
+  std::optional<T> value_;
+};
+
+/*
+ * Node storage for CompactRadixTree. Nodes are allocated in chunks, each
+ * twice the size of the previous one, so an index maps to its chunk and
+ * offset with a couple of bit operations. Chunks are never reallocated, so
+ * nodes don't move once allocated. Freed nodes are reused by later
+ * allocations.
+ */
+template <typename NODE>
+class CompactRadixTreeArena {
+ public:
+  using Index = typename NODE::Index;
+
+  CompactRadixTreeArena() {}
+  CompactRadixTreeArena(const CompactRadixTreeArena&) = delete;
+  CompactRadixTreeArena& operator=(const CompactRadixTreeArena&) = delete;
+  CompactRadixTreeArena(CompactRadixTreeArena&& r) noexcept {
+    *this = std::move(r);
+  }
+  CompactRadixTreeArena& operator=(CompactRadixTreeArena&& r) noexcept {
+    chunks_ = std::move(r.chunks_);
+    freeList_ = std::move(r.freeList_);
+    allocated_ = r.allocated_;
+    r.clear();
+    return *this;
+  }
+
+  NODE& operator[](Index index) {
+    auto chunk = chunkOf(index);
+    return chunks_[chunk][index - chunkStart(chunk)];
+  }
+  const NODE& operator[](Index index) const {
+    auto chunk = chunkOf(index);
+    return chunks_[chunk][index - chunkStart(chunk)];
+  }
+
+  Index allocate() {
+    if (!freeList_.empty()) {
+      auto index = freeList_.back();
+      freeList_.pop_back();
+      return index;
+    }
+    if (allocated_ == chunkStart(chunks_.size())) {
+      chunks_.push_back(std::make_unique<NODE[]>(chunkSize(chunks_.size())));
+    }
+    CHECK_LT(allocated_, NODE::kNoNode);
+    return allocated_++;
+  }
+
+  void free(Index index) {
+    (*this)[index] = NODE();
+    freeList_.push_back(index);
+  }
+
+  void clear() {
+    chunks_.clear();
+    freeList_.clear();
+    allocated_ = 0;
+  }
+
+  // Copy of the arena, with every node at the same index as in this one
+  CompactRadixTreeArena clone() const {
+    CompactRadixTreeArena copy;
+    for (size_t chunk = 0; chunk < chunks_.size(); ++chunk) {
+      auto size = chunkSize(chunk);
+      copy.chunks_.push_back(std::make_unique<NODE[]>(size));
+      std::copy(
+          chunks_[chunk].get(),
+          chunks_[chunk].get() + size,
+          copy.chunks_[chunk].get());
+    }
+    copy.freeList_ = freeList_;
+    copy.allocated_ = allocated_;
+    return copy;
+  }
+
+  // Number of nodes in use
+  size_t size() const {
+    return allocated_ - freeList_.size();
+  }
+
+  // Bytes allocated for nodes and bookkeeping
+  size_t memoryUsage() const {
+    return chunkStart(chunks_.size()) * sizeof(NODE) +
+        chunks_.capacity() * sizeof(typename decltype(chunks_)::value_type) +
+        freeList_.capacity() * sizeof(Index);
+  }
+
+ private:
+  // The first chunk holds 2^kFirstChunkBits nodes
+  static constexpr auto kFirstChunkBits = 4;
+
+  static size_t chunkSize(size_t chunk) {
+    return size_t(1) << (chunk + kFirstChunkBits);
+  }
+  static size_t chunkStart(size_t chunk) {
+    return ((size_t(1) << chunk) - 1) << kFirstChunkBits;
+  }
+  static size_t chunkOf(Index index) {
+    return folly::findLastSet((index >> kFirstChunkBits) + 1) - 1;
+  }
+
+  std::vector<std::unique_ptr<NODE[]>> chunks_;
+  std::vector<Index> freeList_;
+  Index allocated_{0};
+};
+
+/*
+ * Forward Iterator to traverse a CompactRadixTree in DFS/preorder fashion,
+ * skipping non value nodes.
+ */
+template <typename TREE, typename CURSORNODE>
+class CompactRadixTreeIterator
+    : public std::iterator<std::forward_iterator_tag, CURSORNODE> {
+ public:
+  typedef CURSORNODE TreeNode;
+  using Index = typename std::remove_const_t<CURSORNODE>::Index;
+  static constexpr Index kNoNode = std::remove_const_t<CURSORNODE>::kNoNode;
+
+  // default constructor
+  CompactRadixTreeIterator() {}
+  CompactRadixTreeIterator(TREE* tree, Index cursor)
+      : tree_(tree), cursor_(cursor) {
+    if (cursor_ != kNoNode && node().isNonValueNode()) {
+      increment();
+    }
+  }
+  // Iterator to ConstIterator conversion
+  template <
+      typename OTHERTREE,
+      typename OTHERNODE,
+      typename = std::enable_if_t<std::is_convertible<
+          OTHERTREE*,
+          TREE*>::value>>
+  CompactRadixTreeIterator(
+      const CompactRadixTreeIterator<OTHERTREE, OTHERNODE>& itr)
+      : tree_(itr.tree_), cursor_(itr.cursor_) {}
+
+  CompactRadixTreeIterator& operator++() {
+    checkDereference(); // check if we are already at end
+    increment();
+    return *this;
+  }
+
+  CompactRadixTreeIterator operator++(int) {
+    auto tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  bool operator==(const CompactRadixTreeIterator& r) const {
+    return cursor_ == r.cursor_;
+  }
+
+  bool operator!=(const CompactRadixTreeIterator& r) const {
+    return cursor_ != r.cursor_;
+  }
+
+  CURSORNODE& operator*() const {
+    checkDereference();
+    return node();
+  }
+
+  CURSORNODE* operator->() const {
+    checkDereference();
+    return &node();
+  }
+
+  bool atEnd() const {
+    return cursor_ == kNoNode;
+  }
+
+ private:
+  template <typename OTHERTREE, typename OTHERNODE>
+  friend class CompactRadixTreeIterator;
+  template <typename IPADDRTYPE, typename T>
+  friend class CompactRadixTree;
+
+  CURSORNODE& node() const {
+    return tree_->arena_[cursor_];
+  }
+  void checkDereference() const {
+    CHECK(!atEnd());
+  }
+  void increment();
+
+  TREE* tree_{nullptr};
+  Index cursor_{kNoNode};
+};
+
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTree {
+ public:
+  typedef CompactRadixTreeNode<IPADDRTYPE, T> TreeNode;
+  typedef CompactRadixTreeIterator<CompactRadixTree, TreeNode> Iterator;
+  typedef CompactRadixTreeIterator<const CompactRadixTree, const TreeNode>
+      ConstIterator;
+  using Index = typename TreeNode::Index;
+  static constexpr Index kNoNode = TreeNode::kNoNode;
+
+  static_assert(
+      std::is_same<IPADDRTYPE, folly::IPAddressV4>::value ||
+          std::is_same<IPADDRTYPE, folly::IPAddressV6>::value,
+      "CompactRadixTree supports IPAddressV4 and IPAddressV6 keys");
+
+  CompactRadixTree() {}
+  CompactRadixTree(const CompactRadixTree& r) = delete;
+  CompactRadixTree& operator=(const CompactRadixTree& r) = delete;
+  CompactRadixTree(CompactRadixTree&& r) noexcept {
+    *this = std::move(r);
+  }
+  // Move radix tree onto this
+  CompactRadixTree& operator=(CompactRadixTree&& r) noexcept {
+    arena_ = std::move(r.arena_);
+    root_ = r.root_;
+    size_ = r.size_;
+    r.root_ = kNoNode;
+    r.size_ = 0;
+    return *this;
+  }
+  // Clone this radix tree onto another
+  template <typename U = T>
+  typename std::
+      enable_if<std::is_copy_constructible<U>::value, CompactRadixTree>::type
+      clone() const {
+    static_assert(
+        std::is_same<T, U>::value,
+        "clone template type must be the same as Radix tree value type");
+    CompactRadixTree copy;
+    copy.arena_ = arena_.clone();
+    copy.root_ = root_;
+    copy.size_ = size_;
+    return copy;
+  }
+
+  Iterator begin() {
+    return Iterator(this, root_);
+  }
+  Iterator end() {
+    return Iterator(this, kNoNode);
+  }
+  ConstIterator begin() const {
+    return ConstIterator(this, root_);
+  }
+  ConstIterator end() const {
+    return ConstIterator(this, kNoNode);
+  }
+
+  // Free all nodes and clear the tree.
+  void clear() {
+    arena_.clear();
+    root_ = kNoNode;
+    size_ = 0;
+  }
+
+  /*
+   * Insert a IP, mask, value in tree. Returns inserted node, true
+   * if a node was inserted. If a node for IP, mask already existed
+   * in the tree we return that node, false.
+   */
+  template <typename VALUE>
+  std::pair<Iterator, bool>
+  insert(const IPADDRTYPE& ipaddr, uint8_t masklen, VALUE&& value);
+
+  /*
+   * Replace the value of an existing IP, mask. Returns false if there is
+   * no node for IP, mask in the tree.
+   */
+  template <typename VALUE>
+  bool update(const IPADDRTYPE& ipaddr, uint8_t masklen, VALUE&& value) {
+    auto itr = exactMatch(ipaddr, masklen);
+    if (itr.atEnd()) {
+      return false;
+    }
+    itr->setValue(std::forward<VALUE>(value));
+    return true;
+  }
+
+  // Erase a IP, mask
+  bool erase(const IPADDRTYPE& ipaddr, uint8_t masklen) {
+    return erase(exactMatch(ipaddr, masklen));
+  }
+
+  // Erase node pointed to be iterator
+  bool erase(Iterator itr) {
+    CHECK(itr.atEnd() || itr.tree_ == this);
+    return eraseImpl(itr.cursor_);
+  }
+
+  // Given a IP, mask return the node with longest match for it
+  // NOTE: masklen is unsigned and must be <= ipaddr.bitCount()
+  ConstIterator longestMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    auto foundExact = false;
+    return ConstIterator(this, longestMatchImpl(ipaddr, masklen, foundExact));
+  }
+
+  // Non const longest match
+  Iterator longestMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) {
+    auto foundExact = false;
+    return Iterator(this, longestMatchImpl(ipaddr, masklen, foundExact));
+  }
+
+  /*
+   * Longest match for each of a batch of host addresses, with interleaved
+   * and prefetched tree walks. See RadixTree::longestMatchBatch.
+   */
+  void longestMatchBatch(
+      folly::Range<const IPADDRTYPE*> addrs,
+      std::vector<ConstIterator>* matches) const {
+    std::vector<Index> indices;
+    longestMatchBatchImpl(addrs, &indices);
+    matches->clear();
+    matches->reserve(indices.size());
+    for (auto index : indices) {
+      matches->push_back(ConstIterator(this, index));
+    }
+  }
+
+  // Non const longestMatchBatch
+  void longestMatchBatch(
+      folly::Range<const IPADDRTYPE*> addrs,
+      std::vector<Iterator>* matches) {
+    std::vector<Index> indices;
+    longestMatchBatchImpl(addrs, &indices);
+    matches->clear();
+    matches->reserve(indices.size());
+    for (auto index : indices) {
+      matches->push_back(Iterator(this, index));
+    }
+  }
+
+  /*
+   * Given a IP, mask return node whose IP, mask which matches this prefix
+   * exactly
+   */
+  ConstIterator exactMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    auto foundExact = false;
+    auto match = longestMatchImpl(ipaddr, masklen, foundExact);
+    return ConstIterator(this, foundExact ? match : kNoNode);
+  }
+
+  // Non const exact match
+  Iterator exactMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) {
+    auto foundExact = false;
+    auto match = longestMatchImpl(ipaddr, masklen, foundExact);
+    return Iterator(this, foundExact ? match : kNoNode);
+  }
+
+  /*
+   * Call fn(oldNode, newNode) for each prefix whose value differs between
+   * oldTree and newTree, with nullptr for the tree that doesn't have the
+   * prefix. Unlike with PersistentRadixTree, no two trees share nodes, so
+   * this walks both trees in full.
+   */
+  template <typename FUNC>
+  static void forEachChanged(
+      const CompactRadixTree& oldTree,
+      const CompactRadixTree& newTree,
+      FUNC&& fn);
+
+  // Equality
+  bool operator==(const CompactRadixTree& r) const {
+    return size_ == r.size_ && subTreesEqual(r, root_, r.root_);
+  }
+
+  // Inequality
+  bool operator!=(const CompactRadixTree& r) const {
+    return !(*this == r);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Number of nodes, including non value nodes
+  size_t numNodes() const {
+    return arena_.size();
+  }
+
+  // Bytes used by the tree and its nodes
+  size_t memoryUsage() const {
+    return sizeof(*this) + arena_.memoryUsage();
+  }
+
+ private:
+  template <typename TREE, typename CURSORNODE>
+  friend class CompactRadixTreeIterator;
+
+  // Worker function to do the actual longest match lookup.
+  Index longestMatchImpl(
+      const IPADDRTYPE& ipaddr,
+      uint8_t masklen,
+      bool& foundExact,
+      bool includeNonValueNodes = false) const;
+
+  // Number of tree walks longestMatchBatch() keeps in flight
+  static constexpr size_t kBatchLookupWidth = 8;
+
+  void longestMatchBatchImpl(
+      folly::Range<const IPADDRTYPE*> addrs,
+      std::vector<Index>* matches) const;
+
+  bool eraseImpl(Index toDelete);
+
+  // Join the subtree at existing with newNode, which is not a more specific
+  // prefix of existing. Returns the root of the joint subtree.
+  Index join(Index existing, Index newNode);
+
+  bool subTreesEqual(const CompactRadixTree& r, Index mine, Index theirs)
+      const;
+
+  // Whether a comes before b when iterating, i.e. in preorder
+  static bool iteratesBefore(const TreeNode& a, const TreeNode& b) {
+    auto masklen = std::min(a.masklen(), b.masklen());
+    auto aPrefix = a.ipAddress().mask(masklen);
+    auto bPrefix = b.ipAddress().mask(masklen);
+    return aPrefix != bPrefix ? aPrefix < bPrefix : a.masklen() < b.masklen();
+  }
+
+  Index makeNode(const IPADDRTYPE& ip, uint8_t masklen) {
+    auto index = arena_.allocate();
+    auto& node = arena_[index];
+    node.ipAddress_ = ip;
+    node.masklen_ = masklen;
+    return index;
+  }
+
+  void setChild(Index parent, bool right, Index child) {
+    arena_[parent].children_[right] = child;
+    if (child != kNoNode) {
+      arena_[child].parent_ = parent;
+    }
+  }
+
+  // Make newChild take oldChild's place under parent (or as root)
+  void replaceChild(Index parent, Index oldChild, Index newChild) {
+    if (parent == kNoNode) {
+      CHECK_EQ(root_, oldChild);
+      root_ = newChild;
+      if (newChild != kNoNode) {
+        arena_[newChild].parent_ = kNoNode;
+      }
+    } else {
+      auto& children = arena_[parent].children_;
+      setChild(parent, children[1] == oldChild, newChild);
+    }
+  }
+
+  CompactRadixTreeArena<TreeNode> arena_;
+  Index root_{kNoNode};
+  size_t size_{0};
+};
+
+} // namespace facebook::network
+
+#include "fboss/lib/CompactRadixTree-inl.h"
@@ -0,0 +1,317 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+#include "fboss/lib/PersistentRadixTree.h"
+
+namespace facebook::network {
+
+template <typename IPADDRTYPE, typename T>
+const typename PersistentRadixTree<IPADDRTYPE, T>::TreeNode*
+PersistentRadixTree<IPADDRTYPE, T>::longestMatchImpl(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen,
+    bool& foundExact) const {
+  // Can't trust the clients to have 0s in all bits after mask length
+  const auto toMatch = ipaddr.mask(masklen);
+
+  const TreeNode* lastValueNodeSeen = nullptr;
+  auto curNode = root_.get();
+  while (curNode) {
+    if (curNode->masklen_ > masklen ||
+        toMatch.mask(curNode->masklen_) != curNode->ipAddress_) {
+      break;
+    }
+    if (curNode->isValueNode()) {
+      lastValueNodeSeen = curNode;
+    }
+    if (curNode->masklen_ == masklen) {
+      foundExact = curNode->isValueNode();
+      break;
+    }
+    curNode = curNode->children_[toMatch.getNthMSBit(curNode->masklen_)].get();
+  }
+  return lastValueNodeSeen;
+}
+
+template <typename IPADDRTYPE, typename T>
+template <typename VALUE>
+std::pair<typename PersistentRadixTree<IPADDRTYPE, T>::ConstIterator, bool>
+PersistentRadixTree<IPADDRTYPE, T>::insert(
+    const IPADDRTYPE& ipaddr,
+    uint8_t mask,
+    VALUE&& value) {
+  auto foundExact = false;
+  // Can't trust the clients to have 0s in all bits after mask length
+  auto toAdd = ipaddr.mask(mask);
+  auto match = longestMatchImpl(toAdd, mask, foundExact);
+  if (foundExact) {
+    // Prefix already exists in the tree
+    return std::make_pair(ConstIterator(this, match), false);
+  }
+
+  // Walk down to where the new node goes, copying the shared nodes on the
+  // way since each of them gets a new child
+  auto link = &root_;
+  while (*link) {
+    const auto& cur = **link;
+    if (cur.masklen_ > mask || toAdd.mask(cur.masklen_) != cur.ipAddress_) {
+      break;
+    }
+    auto& node = writableNode(*link);
+    if (node.masklen_ == mask) {
+      // A non value node joining two subtrees already has this prefix
+      node.value_ = std::forward<VALUE>(value);
+      ++size_;
+      return std::make_pair(ConstIterator(this, &node), true);
+    }
+    link = &node.children_[toAdd.getNthMSBit(node.masklen_)];
+  }
+
+  auto newNode = std::make_shared<TreeNode>(toAdd, mask);
+  newNode->value_ = std::forward<VALUE>(value);
+  auto inserted = newNode.get();
+  // Either an empty slot, or a subtree that is not under the new node's
+  // prefix, which we join with the new node
+  *link = *link ? join(std::move(*link), std::move(newNode))
+                : std::move(newNode);
+  ++size_;
+  return std::make_pair(ConstIterator(this, inserted), true);
+}
+
+template <typename IPADDRTYPE, typename T>
+template <typename VALUE>
+bool PersistentRadixTree<IPADDRTYPE, T>::update(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen,
+    VALUE&& value) {
+  auto foundExact = false;
+  auto toMatch = ipaddr.mask(masklen);
+  longestMatchImpl(toMatch, masklen, foundExact);
+  if (!foundExact) {
+    return false;
+  }
+  auto path = writablePath(toMatch, masklen);
+  (*path.back())->value_ = std::forward<VALUE>(value);
+  return true;
+}
+
+/*
+ * Same as RadixTree::erase, this maintains the invariant that all non value
+ * nodes have 2 children.
+ */
+template <typename IPADDRTYPE, typename T>
+bool PersistentRadixTree<IPADDRTYPE, T>::erase(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen) {
+  auto foundExact = false;
+  auto toMatch = ipaddr.mask(masklen);
+  longestMatchImpl(toMatch, masklen, foundExact);
+  if (!foundExact) {
+    return false;
+  }
+  auto path = writablePath(toMatch, masklen);
+  auto& link = *path.back();
+  auto& node = *link;
+  if (node.children_[0] && node.children_[1]) {
+    // The prefix is still needed to join the two children
+    node.value_.reset();
+  } else if (!node.isLeaf()) {
+    // Let the parent adopt the only child
+    auto child = std::move(node.children_[node.children_[0] ? 0 : 1]);
+    link = std::move(child);
+  } else if (path.size() == 1) {
+    // Only node in the tree
+    root_.reset();
+  } else {
+    auto& parentLink = *path[path.size() - 2];
+    auto& parent = *parentLink;
+    if (parent.isNonValueNode()) {
+      // Without node, the non value parent would be left with one child.
+      // Replace the parent with node's sibling.
+      auto isRight = &link == &parent.children_[1];
+      auto sibling = std::move(parent.children_[!isRight]);
+      CHECK(sibling);
+      parentLink = std::move(sibling);
+    } else {
+      link.reset();
+    }
+  }
+  --size_;
+  return true;
+}
+
+template <typename IPADDRTYPE, typename T>
+std::vector<typename PersistentRadixTree<IPADDRTYPE, T>::NodePtr*>
+PersistentRadixTree<IPADDRTYPE, T>::writablePath(
+    const IPADDRTYPE& toMatch,
+    uint8_t masklen) {
+  std::vector<NodePtr*> path;
+  auto link = &root_;
+  while (true) {
+    CHECK(*link);
+    auto& node = writableNode(*link);
+    path.push_back(link);
+    if (node.masklen_ == masklen) {
+      DCHECK_EQ(node.ipAddress_, toMatch);
+      break;
+    }
+    link = &node.children_[toMatch.getNthMSBit(node.masklen_)];
+  }
+  return path;
+}
+
+template <typename IPADDRTYPE, typename T>
+typename PersistentRadixTree<IPADDRTYPE, T>::NodePtr
+PersistentRadixTree<IPADDRTYPE, T>::join(NodePtr existing, NodePtr newNode) {
+  auto prefix = IPADDRTYPE::longestCommonPrefix(
+      {existing->ipAddress_, existing->masklen_},
+      {newNode->ipAddress_, newNode->masklen_});
+  // existing can't be a less specific prefix of the new node, else the
+  // new node would have gone in existing's subtree.
+  DCHECK(
+      prefix.first != existing->ipAddress_ ||
+      prefix.second != existing->masklen_);
+  auto joint = newNode;
+  if (prefix.first != newNode->ipAddress_ ||
+      prefix.second != newNode->masklen_) {
+    // Need a non value internal node as the parent of existing and
+    // the new node.
+    joint = std::make_shared<TreeNode>(prefix.first, prefix.second);
+    joint->children_[newNode->ipAddress_.getNthMSBit(prefix.second)] =
+        std::move(newNode);
+  }
+  auto right = existing->ipAddress_.getNthMSBit(prefix.second);
+  joint->children_[right] = std::move(existing);
+  return joint;
+}
+
+/*
+ * oldNode and newNode are the roots of the subtrees the two trees have in
+ * the same place, i.e. under the same prefix of their parents. Where one
+ * root is a less specific prefix of the other, only one of its children
+ * can have prefixes in common with the other subtree.
+ */
+template <typename IPADDRTYPE, typename T>
+template <typename FUNC>
+void PersistentRadixTree<IPADDRTYPE, T>::changedImpl(
+    const TreeNode* oldNode,
+    const TreeNode* newNode,
+    FUNC& fn) {
+  if (oldNode == newNode) {
+    // Shared subtree, or both empty
+    return;
+  }
+  const TreeNode* none = nullptr;
+  auto removed = [&fn, none](const TreeNode* node) { fn(node, none); };
+  auto added = [&fn, none](const TreeNode* node) { fn(none, node); };
+  if (!oldNode || !newNode) {
+    forEachValueNode(oldNode, removed);
+    forEachValueNode(newNode, added);
+    return;
+  }
+  auto oldLen = oldNode->masklen_;
+  auto newLen = newNode->masklen_;
+  if (oldLen == newLen && oldNode->ipAddress_ == newNode->ipAddress_) {
+    if (oldNode->isValueNode() != newNode->isValueNode() ||
+        (oldNode->isValueNode() && !(oldNode->value() == newNode->value()))) {
+      fn(oldNode->isValueNode() ? oldNode : nullptr,
+         newNode->isValueNode() ? newNode : nullptr);
+    }
+    changedImpl(oldNode->children_[0].get(), newNode->children_[0].get(), fn);
+    changedImpl(oldNode->children_[1].get(), newNode->children_[1].get(), fn);
+  } else if (
+      oldLen < newLen &&
+      newNode->ipAddress_.mask(oldLen) == oldNode->ipAddress_) {
+    // The new tree has nothing at oldNode's prefix or in its other child
+    if (oldNode->isValueNode()) {
+      removed(oldNode);
+    }
+    auto right = newNode->ipAddress_.getNthMSBit(oldLen);
+    changedImpl(oldNode->children_[right].get(), newNode, fn);
+    forEachValueNode(oldNode->children_[!right].get(), removed);
+  } else if (
+      newLen < oldLen &&
+      oldNode->ipAddress_.mask(newLen) == newNode->ipAddress_) {
+    // The old tree has nothing at newNode's prefix or in its other child
+    if (newNode->isValueNode()) {
+      added(newNode);
+    }
+    auto right = oldNode->ipAddress_.getNthMSBit(newLen);
+    changedImpl(oldNode, newNode->children_[right].get(), fn);
+    forEachValueNode(newNode->children_[!right].get(), added);
+  } else {
+    // Disjoint prefixes
+    forEachValueNode(oldNode, removed);
+    forEachValueNode(newNode, added);
+  }
+}
+
+template <typename IPADDRTYPE, typename T>
+template <typename FUNC>
+void PersistentRadixTree<IPADDRTYPE, T>::forEachValueNode(
+    const TreeNode* node,
+    FUNC&& fn) {
+  if (!node) {
+    return;
+  }
+  if (node->isValueNode()) {
+    fn(node);
+  }
+  forEachValueNode(node->children_[0].get(), fn);
+  forEachValueNode(node->children_[1].get(), fn);
+}
+
+template <typename IPADDRTYPE, typename T>
+bool PersistentRadixTree<IPADDRTYPE, T>::subTreesEqual(
+    const TreeNode* mine,
+    const TreeNode* theirs) {
+  if (mine == theirs) {
+    return true;
+  }
+  if (mine && theirs) {
+    return mine->equalSansLinks(*theirs) &&
+        subTreesEqual(mine->children_[0].get(), theirs->children_[0].get()) &&
+        subTreesEqual(mine->children_[1].get(), theirs->children_[1].get());
+  }
+  return false;
+}
+
+template <typename IPADDRTYPE, typename T>
+void PersistentRadixTreeIterator<IPADDRTYPE, T>::increment() {
+  if (!pendingValid_) {
+    findPending();
+  }
+  do {
+    // Visit the left subtree next, then the right one
+    for (auto right : {1, 0}) {
+      if (cursor_->children_[right]) {
+        pending_.push_back(cursor_->children_[right].get());
+      }
+    }
+    if (pending_.empty()) {
+      cursor_ = nullptr;
+      return;
+    }
+    cursor_ = pending_.back();
+    pending_.pop_back();
+  } while (cursor_->isNonValueNode());
+}
+
+/*
+ * Work out the subtrees to visit after cursor_, i.e. the right children of
+ * the nodes on the path from the root where the path goes left.
+ */
+template <typename IPADDRTYPE, typename T>
+void PersistentRadixTreeIterator<IPADDRTYPE, T>::findPending() {
+  pending_.clear();
+  auto node = tree_->root_.get();
+  while (node != cursor_) {
+    CHECK(node);
+    auto right = cursor_->ipAddress_.getNthMSBit(node->masklen_);
+    if (!right && node->children_[1]) {
+      pending_.push_back(node->children_[1].get());
+    }
+    node = node->children_[right].get();
+  }
+  pendingValid_ = true;
+}
+
+} // namespace facebook::network
@@ -0,0 +1,341 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/Conv.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+
+/*
+ * PersistentRadixTree is a path compressed binary trie with the
+ * insert/erase/longestMatch/exactMatch/iterator API of RadixTree, for
+ * IPAddressV4 or IPAddressV6 keys, whose copies share their nodes.
+ *
+ * Copying a tree only copies its root pointer. Nodes are reference counted
+ * and a tree never modifies a node it shares with another tree: inserting,
+ * erasing or updating a prefix copies the nodes on the path from the root
+ * to it, and leaves the rest of the tree shared. A change thus costs
+ * O(depth) node copies however large the tree, and two trees that were
+ * copied from one another differ only in the subtrees along the paths
+ * changed since, which forEachChanged() finds without walking the rest.
+ *
+ * Nodes that only one tree refers to are modified in place, so building up
+ * a tree that has not been copied costs no more than with RadixTree.
+ *
+ * Differences from RadixTree:
+ * - Values are only read through iterators. Use update() to replace the
+ *   value of an existing prefix.
+ * - Any change to a tree invalidates its iterators.
+ * - Node delete callbacks, custom tree traits and the *WithTrail lookups
+ *   are not supported.
+ */
+
+namespace facebook::network {
+
+template <typename IPADDRTYPE, typename T>
+class PersistentRadixTree;
+
+template <typename IPADDRTYPE, typename T>
+class PersistentRadixTreeIterator;
+
+/*
+ * Node in PersistentRadixTree. As in RadixTree, nodes without a value are
+ * internal nodes joining two subtrees, and always have 2 children.
+ */
+template <typename IPADDRTYPE, typename T>
+class PersistentRadixTreeNode {
+ public:
+  using NodePtr = std::shared_ptr<PersistentRadixTreeNode>;
+
+  PersistentRadixTreeNode(const IPADDRTYPE& ipAddress, uint8_t masklen)
+      : ipAddress_(ipAddress), masklen_(masklen) {}
+
+  const IPADDRTYPE& ipAddress() const {
+    return ipAddress_;
+  }
+  uint32_t masklen() const {
+    return masklen_;
+  }
+  bool isValueNode() const {
+    return value_.has_value();
+  }
+  bool isNonValueNode() const {
+    return !isValueNode();
+  }
+  bool isLeaf() const {
+    return !children_[0] && !children_[1];
+  }
+  const T& value() const {
+    return value_.value();
+  }
+  std::string str(bool printValue = true) const {
+    auto nodeStr = folly::to<std::string>(ipAddress_.str(), "/", masklen_);
+    if (printValue) {
+      nodeStr += isNonValueNode()
+          ? "(*)"
+          : folly::to<std::string>("(", this->value(), ")");
+    }
+    return nodeStr;
+  }
+
+  // Comparison with links (children) ignored
+  bool equalSansLinks(const PersistentRadixTreeNode& r) const {
+    return ipAddress_ == r.ipAddress_ && masklen_ == r.masklen_ &&
+        isValueNode() == r.isValueNode() &&
+        (!isValueNode() || this->value() == r.value());
+  }
+
+ private:
+  friend class PersistentRadixTree<IPADDRTYPE, T>;
+  friend class PersistentRadixTreeIterator<IPADDRTYPE, T>;
+
+  IPADDRTYPE ipAddress_;
+  uint8_t masklen_{0};
+  std::array<NodePtr, 2> children_;
+  std::optional<T> value_;
+};
+
+/*
+ * Forward Iterator to traverse a PersistentRadixTree in DFS/preorder
+ * fashion, skipping non value nodes. Nodes have no parent links, so the
+ * iterator keeps the subtrees it has yet to visit on a stack.
+ */
+template <typename IPADDRTYPE, typename T>
+class PersistentRadixTreeIterator
+    : public std::iterator<
+          std::forward_iterator_tag,
+          const PersistentRadixTreeNode<IPADDRTYPE, T>> {
+ public:
+  typedef PersistentRadixTreeNode<IPADDRTYPE, T> TreeNode;
+  typedef PersistentRadixTree<IPADDRTYPE, T> Tree;
+
+  // default constructor
+  PersistentRadixTreeIterator() {}
+
+  PersistentRadixTreeIterator& operator++() {
+    checkDereference(); // check if we are already at end
+    increment();
+    return *this;
+  }
+
+  PersistentRadixTreeIterator operator++(int) {
+    auto tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  bool operator==(const PersistentRadixTreeIterator& r) const {
+    return cursor_ == r.cursor_;
+  }
+
+  bool operator!=(const PersistentRadixTreeIterator& r) const {
+    return cursor_ != r.cursor_;
+  }
+
+  const TreeNode& operator*() const {
+    checkDereference();
+    return *cursor_;
+  }
+
+  const TreeNode* operator->() const {
+    checkDereference();
+    return cursor_;
+  }
+
+  bool atEnd() const {
+    return cursor_ == nullptr;
+  }
+
+ private:
+  friend class PersistentRadixTree<IPADDRTYPE, T>;
+
+  // Iterator starting at the first value node of the tree
+  explicit PersistentRadixTreeIterator(const Tree* tree)
+      : tree_(tree), cursor_(tree->root_.get()), pendingValid_(true) {
+    if (cursor_ && cursor_->isNonValueNode()) {
+      increment();
+    }
+  }
+  // Iterator at node, as returned by lookups. The subtrees left to visit
+  // after node are only worked out if the iterator is incremented.
+  PersistentRadixTreeIterator(const Tree* tree, const TreeNode* node)
+      : tree_(tree), cursor_(node) {}
+
+  void checkDereference() const {
+    CHECK(!atEnd());
+  }
+  void increment();
+  void findPending();
+
+  const Tree* tree_{nullptr};
+  const TreeNode* cursor_{nullptr};
+  // Roots of the subtrees still to visit, the next one on top
+  std::vector<const TreeNode*> pending_;
+  bool pendingValid_{false};
+};
+
+template <typename IPADDRTYPE, typename T>
+class PersistentRadixTree {
+ public:
+  typedef PersistentRadixTreeNode<IPADDRTYPE, T> TreeNode;
+  typedef PersistentRadixTreeIterator<IPADDRTYPE, T> ConstIterator;
+  using NodePtr = typename TreeNode::NodePtr;
+
+  static_assert(
+      std::is_same<IPADDRTYPE, folly::IPAddressV4>::value ||
+          std::is_same<IPADDRTYPE, folly::IPAddressV6>::value,
+      "PersistentRadixTree supports IPAddressV4 and IPAddressV6 keys");
+
+  PersistentRadixTree() {}
+  // Copies share all their nodes with this tree, see above
+  PersistentRadixTree(const PersistentRadixTree& r) = default;
+  PersistentRadixTree& operator=(const PersistentRadixTree& r) = default;
+  PersistentRadixTree(PersistentRadixTree&& r) noexcept {
+    *this = std::move(r);
+  }
+  PersistentRadixTree& operator=(PersistentRadixTree&& r) noexcept {
+    root_ = std::move(r.root_);
+    size_ = r.size_;
+    r.size_ = 0;
+    return *this;
+  }
+  // Same as copying, for the clone() API of the other radix trees
+  PersistentRadixTree clone() const {
+    return *this;
+  }
+
+  ConstIterator begin() const {
+    return ConstIterator(this);
+  }
+  ConstIterator end() const {
+    return ConstIterator();
+  }
+
+  // Drop all nodes and clear the tree.
+  void clear() {
+    root_.reset();
+    size_ = 0;
+  }
+
+  /*
+   * Insert a IP, mask, value in tree. Returns inserted node, true
+   * if a node was inserted. If a node for IP, mask already existed
+   * in the tree we return that node, false.
+   */
+  template <typename VALUE>
+  std::pair<ConstIterator, bool>
+  insert(const IPADDRTYPE& ipaddr, uint8_t masklen, VALUE&& value);
+
+  /*
+   * Replace the value of an existing IP, mask. Returns false if the tree
+   * has no value for IP, mask.
+   */
+  template <typename VALUE>
+  bool update(const IPADDRTYPE& ipaddr, uint8_t masklen, VALUE&& value);
+
+  // Erase a IP, mask
+  bool erase(const IPADDRTYPE& ipaddr, uint8_t masklen);
+
+  // Given a IP, mask return the node with longest match for it
+  // NOTE: masklen is unsigned and must be <= ipaddr.bitCount()
+  ConstIterator longestMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    auto foundExact = false;
+    return ConstIterator(this, longestMatchImpl(ipaddr, masklen, foundExact));
+  }
+
+  /*
+   * Given a IP, mask return node whose IP, mask which matches this prefix
+   * exactly
+   */
+  ConstIterator exactMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    auto foundExact = false;
+    auto match = longestMatchImpl(ipaddr, masklen, foundExact);
+    return ConstIterator(this, foundExact ? match : nullptr);
+  }
+
+  /*
+   * Call fn(oldNode, newNode) for each prefix whose value differs between
+   * oldTree and newTree, with nullptr for the tree that doesn't have the
+   * prefix. Subtrees the two trees share are skipped, so this is cheap for
+   * trees copied from one another.
+   */
+  template <typename FUNC>
+  static void forEachChanged(
+      const PersistentRadixTree& oldTree,
+      const PersistentRadixTree& newTree,
+      FUNC&& fn) {
+    changedImpl(oldTree.root_.get(), newTree.root_.get(), fn);
+  }
+
+  // Equality
+  bool operator==(const PersistentRadixTree& r) const {
+    return size_ == r.size_ && subTreesEqual(root_.get(), r.root_.get());
+  }
+
+  // Inequality
+  bool operator!=(const PersistentRadixTree& r) const {
+    return !(*this == r);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  friend class PersistentRadixTreeIterator<IPADDRTYPE, T>;
+
+  // Worker function to do the actual longest match lookup.
+  const TreeNode* longestMatchImpl(
+      const IPADDRTYPE& ipaddr,
+      uint8_t masklen,
+      bool& foundExact) const;
+
+  /*
+   * Copy the nodes on the path to the exact match for toMatch, masklen
+   * that we share with other trees. Returns the links to each node on the
+   * path, from the root down. The exact match must exist.
+   */
+  std::vector<NodePtr*> writablePath(
+      const IPADDRTYPE& toMatch,
+      uint8_t masklen);
+
+  // Make node ours alone, copying it if other trees refer to it
+  static TreeNode& writableNode(NodePtr& node) {
+    if (node.use_count() != 1) {
+      node = std::make_shared<TreeNode>(*node);
+    }
+    return *node;
+  }
+
+  // Join the subtree at existing with newNode, which is not a more specific
+  // prefix of existing. Returns the root of the joint subtree.
+  static NodePtr join(NodePtr existing, NodePtr newNode);
+
+  template <typename FUNC>
+  static void changedImpl(
+      const TreeNode* oldNode,
+      const TreeNode* newNode,
+      FUNC& fn);
+  template <typename FUNC>
+  static void forEachValueNode(const TreeNode* node, FUNC&& fn);
+
+  static bool subTreesEqual(const TreeNode* mine, const TreeNode* theirs);
+
+  NodePtr root_;
+  size_t size_{0};
+};
+
+} // namespace facebook::network
+
+#include "fboss/lib/PersistentRadixTree-inl.h"
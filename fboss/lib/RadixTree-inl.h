@@ -97,6 +97,64 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::longestMatchImpl(
   return includeNonValueNodes ? curNode : lastValueNodeSeen;
 }
 
+template <typename IPADDRTYPE, typename T, typename TreeTraits>
+void RadixTree<IPADDRTYPE, T, TreeTraits>::longestMatchBatchImpl(
+    folly::Range<const IPADDRTYPE*> addrs,
+    std::vector<const TreeNode*>* matches) const {
+  struct Walk {
+    size_t index;
+    const TreeNode* curNode;
+    const TreeNode* lastValueNodeSeen;
+  };
+  // Advance walk by one node. Returns false once the walk is done.
+  auto step = [&addrs](Walk& walk) {
+    const auto& addr = addrs[walk.index];
+    auto node = walk.curNode;
+    if (!node || addr.mask(node->masklen()) != node->ipAddress()) {
+      return false;
+    }
+    if (node->isValueNode()) {
+      walk.lastValueNodeSeen = node;
+    }
+    if (node->masklen() == IPADDRTYPE::bitCount()) {
+      return false;
+    }
+    walk.curNode =
+        addr.getNthMSBit(node->masklen()) ? node->right() : node->left();
+    if (!walk.curNode) {
+      return false;
+    }
+    __builtin_prefetch(walk.curNode);
+    return true;
+  };
+
+  matches->assign(addrs.size(), nullptr);
+  std::array<Walk, kBatchLookupWidth> walks;
+  size_t numWalks = 0;
+  size_t nextIndex = 0;
+  while (numWalks < walks.size() && nextIndex < addrs.size()) {
+    walks[numWalks++] = Walk{nextIndex++, root_.get(), nullptr};
+  }
+  while (numWalks > 0) {
+    for (size_t i = 0; i < numWalks;) {
+      auto& walk = walks[i];
+      if (step(walk)) {
+        ++i;
+        continue;
+      }
+      (*matches)[walk.index] = walk.lastValueNodeSeen;
+      if (nextIndex < addrs.size()) {
+        // Start the next lookup in this slot
+        walk = Walk{nextIndex++, root_.get(), nullptr};
+        ++i;
+      } else {
+        // No lookups left to start, retire this slot
+        walk = walks[--numWalks];
+      }
+    }
+  }
+}
+
 template <typename IPADDRTYPE, typename T, typename TreeTraits>
 inline void RadixTree<IPADDRTYPE, T, TreeTraits>::trailAppend(
     VecConstIterators* trail,
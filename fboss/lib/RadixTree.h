@@ -5,6 +5,7 @@
 
 #include <sys/socket.h>
 #include <algorithm>
+#include <array>
 #include <exception>
 #include <functional>
 #include <memory>
@@ -19,6 +20,7 @@
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
 #include <folly/Memory.h>
+#include <folly/Range.h>
 #include <optional>
 
 namespace facebook {
@@ -475,6 +477,38 @@ class RadixTree {
         const_cast<const RadixTree*>(this)->longestMatch(ipaddr, mask));
   }
 
+  /*
+   * Longest match for each of a batch of host addresses. On return
+   * (*matches)[i] holds the longest match for addrs[i]. Up to
+   * kBatchLookupWidth tree walks are interleaved, each prefetching its next
+   * node while the others advance, so that the cache misses of independent
+   * lookups overlap rather than being taken one after the other.
+   */
+  void longestMatchBatch(
+      folly::Range<const IPADDRTYPE*> addrs,
+      std::vector<ConstIterator>* matches) const {
+    std::vector<const TreeNode*> nodes;
+    longestMatchBatchImpl(addrs, &nodes);
+    matches->clear();
+    matches->reserve(nodes.size());
+    for (auto node : nodes) {
+      matches->push_back(traits_.makeCItr(node));
+    }
+  }
+
+  // Non const longestMatchBatch
+  void longestMatchBatch(
+      folly::Range<const IPADDRTYPE*> addrs,
+      std::vector<Iterator>* matches) {
+    std::vector<const TreeNode*> nodes;
+    longestMatchBatchImpl(addrs, &nodes);
+    matches->clear();
+    matches->reserve(nodes.size());
+    for (auto node : nodes) {
+      matches->push_back(traits_.makeItr(const_cast<TreeNode*>(node)));
+    }
+  }
+
   /*
    * Given a IP, mask return node whose IP, mask which matches this prefix
    * exactly
@@ -636,6 +670,13 @@ class RadixTree {
       bool includeNonValueNodes,
       const TreeNode* node) const;
 
+  // Number of tree walks longestMatchBatch() keeps in flight
+  static constexpr size_t kBatchLookupWidth = 8;
+
+  void longestMatchBatchImpl(
+      folly::Range<const IPADDRTYPE*> addrs,
+      std::vector<const TreeNode*>* matches) const;
+
   std::unique_ptr<TreeNode> root_{nullptr};
   size_t size_{0};
   NodeDeleteCallback nodeDeleteCallback_;
@@ -0,0 +1,270 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Random.h>
+
+#include "fboss/lib/CompactRadixTree.h"
+#include "fboss/lib/RadixTree.h"
+
+using namespace facebook::network;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+
+namespace {
+
+template <typename AddrT>
+AddrT randomAddress();
+
+template <>
+IPAddressV4 randomAddress<IPAddressV4>() {
+  // Restrict the first octet to get plenty of nested prefixes
+  return IPAddressV4::fromLongHBO(
+      (folly::Random::rand32(4) << 24) | (folly::Random::rand32() >> 8));
+}
+
+template <>
+IPAddressV6 randomAddress<IPAddressV6>() {
+  folly::ByteArray16 bytes{};
+  bytes[0] = 0x20;
+  bytes[1] = folly::Random::rand32(4);
+  for (auto i = 2; i < 16; ++i) {
+    bytes[i] = folly::Random::rand32(256);
+  }
+  return IPAddressV6(bytes);
+}
+
+template <typename AddrT>
+std::pair<AddrT, uint8_t> randomPrefix() {
+  auto mask = folly::Random::rand32(AddrT::bitCount() + 1);
+  return std::make_pair(randomAddress<AddrT>(), mask);
+}
+
+template <typename AddrT>
+void expectTreesMatch(
+    const RadixTree<AddrT, int>& expected,
+    const CompactRadixTree<AddrT, int>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  // Both trees have the same shape, so preorder walks yield the same
+  // sequence of prefixes.
+  auto actualItr = actual.begin();
+  for (const auto& node : expected) {
+    ASSERT_NE(actualItr, actual.end());
+    EXPECT_EQ(node.ipAddress(), actualItr->ipAddress());
+    EXPECT_EQ(node.masklen(), actualItr->masklen());
+    EXPECT_EQ(node.value(), actualItr->value());
+    ++actualItr;
+  }
+  EXPECT_EQ(actualItr, actual.end());
+
+  for (auto i = 0; i < 100; ++i) {
+    auto addr = randomAddress<AddrT>();
+    auto expectedMatch = expected.longestMatch(addr, AddrT::bitCount());
+    auto actualMatch = actual.longestMatch(addr, AddrT::bitCount());
+    ASSERT_EQ(expectedMatch == expected.end(), actualMatch == actual.end());
+    if (expectedMatch != expected.end()) {
+      EXPECT_EQ(expectedMatch->ipAddress(), actualMatch->ipAddress());
+      EXPECT_EQ(expectedMatch->masklen(), actualMatch->masklen());
+    }
+  }
+}
+
+/*
+ * Apply the same random inserts and erases to a RadixTree and a
+ * CompactRadixTree, and compare the trees after each round.
+ */
+template <typename AddrT>
+void compareWithRadixTree() {
+  RadixTree<AddrT, int> rtree;
+  CompactRadixTree<AddrT, int> ctree;
+  std::vector<std::pair<AddrT, uint8_t>> inserted;
+  for (auto round = 0; round < 10; ++round) {
+    for (auto i = 0; i < 500; ++i) {
+      auto prefix = randomPrefix<AddrT>();
+      auto value = round * 1000 + i;
+      auto expected = rtree.insert(prefix.first, prefix.second, value);
+      auto actual = ctree.insert(prefix.first, prefix.second, value);
+      EXPECT_EQ(expected.second, actual.second);
+      EXPECT_EQ(expected.first->value(), actual.first->value());
+      inserted.push_back(prefix);
+    }
+    expectTreesMatch(rtree, ctree);
+
+    for (auto i = 0; i < 300; ++i) {
+      const auto& prefix = inserted[folly::Random::rand32(inserted.size())];
+      EXPECT_EQ(
+          rtree.erase(prefix.first, prefix.second),
+          ctree.erase(prefix.first, prefix.second));
+    }
+    expectTreesMatch(rtree, ctree);
+  }
+}
+
+} // namespace
+
+TEST(CompactRadixTree, CompareWithRadixTree4) {
+  compareWithRadixTree<IPAddressV4>();
+}
+
+TEST(CompactRadixTree, CompareWithRadixTree6) {
+  compareWithRadixTree<IPAddressV6>();
+}
+
+TEST(CompactRadixTree, ExactMatch) {
+  CompactRadixTree<IPAddressV4, int> ctree;
+  ctree.insert(IPAddressV4("10.0.0.0"), 8, 1);
+  ctree.insert(IPAddressV4("10.1.0.0"), 16, 2);
+  ctree.insert(IPAddressV4("10.2.0.0"), 16, 3);
+
+  EXPECT_EQ(2, ctree.exactMatch(IPAddressV4("10.1.0.0"), 16)->value());
+  // Bits past the mask length are ignored
+  EXPECT_EQ(3, ctree.exactMatch(IPAddressV4("10.2.3.4"), 16)->value());
+  // 10.0.0.0/14 is a non value node joining the two /16s
+  EXPECT_EQ(ctree.end(), ctree.exactMatch(IPAddressV4("10.0.0.0"), 14));
+  EXPECT_EQ(1, ctree.longestMatch(IPAddressV4("10.0.0.0"), 14)->value());
+  EXPECT_EQ(ctree.end(), ctree.longestMatch(IPAddressV4("11.0.0.0"), 32));
+
+  // Inserting an existing prefix returns the existing node
+  auto result = ctree.insert(IPAddressV4("10.1.0.0"), 16, 4);
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(2, result.first->value());
+
+  // Set value via iterator
+  ctree.exactMatch(IPAddressV4("10.1.0.0"), 16)->setValue(42);
+  EXPECT_EQ(42, ctree.longestMatch(IPAddressV4("10.1.1.1"), 32)->value());
+
+  // Or via update(), which only replaces existing values
+  EXPECT_TRUE(ctree.update(IPAddressV4("10.2.0.0"), 16, 43));
+  EXPECT_FALSE(ctree.update(IPAddressV4("10.0.0.0"), 14, 43));
+  EXPECT_EQ(43, ctree.longestMatch(IPAddressV4("10.2.1.1"), 32)->value());
+  EXPECT_EQ(ctree.end(), ctree.exactMatch(IPAddressV4("10.0.0.0"), 14));
+}
+
+TEST(CompactRadixTree, ForEachChanged) {
+  using PrefixValues = std::map<std::pair<IPAddressV6, uint8_t>, int>;
+  auto toMap = [](const CompactRadixTree<IPAddressV6, int>& tree) {
+    PrefixValues values;
+    for (const auto& node : tree) {
+      values[std::make_pair(node.ipAddress(), node.masklen())] = node.value();
+    }
+    return values;
+  };
+  CompactRadixTree<IPAddressV6, int> oldTree;
+  for (auto i = 0; i < 1000; ++i) {
+    auto prefix = randomPrefix<IPAddressV6>();
+    oldTree.insert(prefix.first, prefix.second, i);
+  }
+  auto newTree = oldTree.clone();
+  auto changed = [&oldTree, &newTree]() {
+    PrefixValues removed;
+    PrefixValues added;
+    CompactRadixTree<IPAddressV6, int>::forEachChanged(
+        oldTree, newTree, [&](const auto* oldNode, const auto* newNode) {
+          if (oldNode) {
+            removed[std::make_pair(oldNode->ipAddress(), oldNode->masklen())] =
+                oldNode->value();
+          }
+          if (newNode) {
+            added[std::make_pair(newNode->ipAddress(), newNode->masklen())] =
+                newNode->value();
+          }
+        });
+    return std::make_pair(removed, added);
+  };
+  EXPECT_TRUE(changed().first.empty());
+  EXPECT_TRUE(changed().second.empty());
+
+  for (auto i = 0; i < 100; ++i) {
+    auto prefix = randomPrefix<IPAddressV6>();
+    newTree.insert(prefix.first, prefix.second, 1000 + i);
+    prefix = randomPrefix<IPAddressV6>();
+    newTree.erase(prefix.first, prefix.second);
+  }
+  auto first = newTree.begin();
+  newTree.update(first->ipAddress(), first->masklen(), -1);
+
+  // Compare with the difference of all prefixes and values
+  PrefixValues expectedRemoved;
+  PrefixValues expectedAdded;
+  auto oldValues = toMap(oldTree);
+  auto newValues = toMap(newTree);
+  for (const auto& prefixValue : oldValues) {
+    auto itr = newValues.find(prefixValue.first);
+    if (itr == newValues.end() || itr->second != prefixValue.second) {
+      expectedRemoved.insert(prefixValue);
+    }
+  }
+  for (const auto& prefixValue : newValues) {
+    auto itr = oldValues.find(prefixValue.first);
+    if (itr == oldValues.end() || itr->second != prefixValue.second) {
+      expectedAdded.insert(prefixValue);
+    }
+  }
+  auto actual = changed();
+  EXPECT_EQ(expectedRemoved, actual.first);
+  EXPECT_EQ(expectedAdded, actual.second);
+}
+
+TEST(CompactRadixTree, EraseViaIterators) {
+  CompactRadixTree<IPAddressV4, std::unique_ptr<int>> ctree;
+  for (auto i = 0; i < 1000; ++i) {
+    auto prefix = randomPrefix<IPAddressV4>();
+    ctree.insert(prefix.first, prefix.second, std::make_unique<int>(i));
+  }
+  // Iterators stay valid while other nodes are erased
+  std::vector<CompactRadixTree<IPAddressV4, std::unique_ptr<int>>::Iterator>
+      toDelete;
+  for (auto itr = ctree.begin(); itr != ctree.end(); ++itr) {
+    toDelete.push_back(itr);
+  }
+  for (auto& itr : toDelete) {
+    EXPECT_TRUE(ctree.erase(itr));
+  }
+  EXPECT_EQ(0, ctree.size());
+  EXPECT_EQ(0, ctree.numNodes());
+  EXPECT_EQ(ctree.begin(), ctree.end());
+}
+
+TEST(CompactRadixTree, CloneAndMove) {
+  CompactRadixTree<IPAddressV6, int> ctree;
+  // Ensure clone() works on empty trees.
+  EXPECT_TRUE(ctree == ctree.clone());
+  for (auto i = 0; i < 1000; ++i) {
+    auto prefix = randomPrefix<IPAddressV6>();
+    ctree.insert(prefix.first, prefix.second, i);
+  }
+  auto copy = ctree.clone();
+  EXPECT_TRUE(ctree == copy);
+
+  copy.begin()->setValue(-1);
+  EXPECT_FALSE(ctree == copy);
+
+  auto moved = std::move(copy);
+  EXPECT_EQ(0, copy.size());
+  EXPECT_EQ(ctree.size(), moved.size());
+  EXPECT_EQ(-1, moved.begin()->value());
+}
+
+TEST(CompactRadixTree, LongestMatchBatch) {
+  CompactRadixTree<IPAddressV4, int> ctree;
+  for (auto i = 0; i < 1000; ++i) {
+    auto prefix = randomPrefix<IPAddressV4>();
+    ctree.insert(prefix.first, prefix.second, i);
+  }
+  std::vector<IPAddressV4> addrs;
+  for (auto i = 0; i < 1000; ++i) {
+    addrs.push_back(randomAddress<IPAddressV4>());
+  }
+  std::vector<CompactRadixTree<IPAddressV4, int>::Iterator> matches;
+  ctree.longestMatchBatch(folly::range(addrs), &matches);
+  ASSERT_EQ(addrs.size(), matches.size());
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    EXPECT_EQ(ctree.longestMatch(addrs[i], 32), matches[i]);
+  }
+}
@@ -0,0 +1,246 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <gtest/gtest.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Random.h>
+
+#include "fboss/lib/PersistentRadixTree.h"
+#include "fboss/lib/RadixTree.h"
+
+using namespace facebook::network;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+
+namespace {
+
+template <typename AddrT>
+AddrT randomAddress();
+
+template <>
+IPAddressV4 randomAddress<IPAddressV4>() {
+  // Restrict the first octet to get plenty of nested prefixes
+  return IPAddressV4::fromLongHBO(
+      (folly::Random::rand32(4) << 24) | (folly::Random::rand32() >> 8));
+}
+
+template <>
+IPAddressV6 randomAddress<IPAddressV6>() {
+  folly::ByteArray16 bytes{};
+  bytes[0] = 0x20;
+  bytes[1] = folly::Random::rand32(4);
+  for (auto i = 2; i < 16; ++i) {
+    bytes[i] = folly::Random::rand32(256);
+  }
+  return IPAddressV6(bytes);
+}
+
+template <typename AddrT>
+std::pair<AddrT, uint8_t> randomPrefix() {
+  auto mask = folly::Random::rand32(AddrT::bitCount() + 1);
+  return std::make_pair(randomAddress<AddrT>().mask(mask), mask);
+}
+
+template <typename AddrT>
+void expectTreesMatch(
+    const RadixTree<AddrT, int>& expected,
+    const PersistentRadixTree<AddrT, int>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  // Both trees have the same shape, so preorder walks yield the same
+  // sequence of prefixes.
+  auto actualItr = actual.begin();
+  for (const auto& node : expected) {
+    ASSERT_NE(actualItr, actual.end());
+    EXPECT_EQ(node.ipAddress(), actualItr->ipAddress());
+    EXPECT_EQ(node.masklen(), actualItr->masklen());
+    EXPECT_EQ(node.value(), actualItr->value());
+    ++actualItr;
+  }
+  EXPECT_EQ(actualItr, actual.end());
+
+  for (auto i = 0; i < 100; ++i) {
+    auto addr = randomAddress<AddrT>();
+    auto expectedMatch = expected.longestMatch(addr, AddrT::bitCount());
+    auto actualMatch = actual.longestMatch(addr, AddrT::bitCount());
+    ASSERT_EQ(expectedMatch == expected.end(), actualMatch == actual.end());
+    if (expectedMatch != expected.end()) {
+      EXPECT_EQ(expectedMatch->ipAddress(), actualMatch->ipAddress());
+      EXPECT_EQ(expectedMatch->masklen(), actualMatch->masklen());
+    }
+  }
+}
+
+template <typename AddrT>
+using PrefixValues = std::map<std::pair<AddrT, uint8_t>, int>;
+
+template <typename AddrT>
+PrefixValues<AddrT> toMap(const PersistentRadixTree<AddrT, int>& tree) {
+  PrefixValues<AddrT> values;
+  for (const auto& node : tree) {
+    values[std::make_pair(node.ipAddress(), node.masklen())] = node.value();
+  }
+  return values;
+}
+
+/*
+ * Apply the same random inserts and erases to a RadixTree and a
+ * PersistentRadixTree, and compare the trees after each round. Copies of
+ * the tree taken along the way must not change.
+ */
+template <typename AddrT>
+void compareWithRadixTree() {
+  RadixTree<AddrT, int> rtree;
+  PersistentRadixTree<AddrT, int> ptree;
+  std::vector<std::pair<PersistentRadixTree<AddrT, int>, PrefixValues<AddrT>>>
+      copies;
+  std::vector<std::pair<AddrT, uint8_t>> inserted;
+  for (auto round = 0; round < 10; ++round) {
+    for (auto i = 0; i < 500; ++i) {
+      auto prefix = randomPrefix<AddrT>();
+      auto value = round * 1000 + i;
+      auto expected = rtree.insert(prefix.first, prefix.second, value);
+      auto actual = ptree.insert(prefix.first, prefix.second, value);
+      EXPECT_EQ(expected.second, actual.second);
+      EXPECT_EQ(expected.first->value(), actual.first->value());
+      inserted.push_back(prefix);
+    }
+    expectTreesMatch(rtree, ptree);
+    copies.emplace_back(ptree, toMap(ptree));
+
+    for (auto i = 0; i < 300; ++i) {
+      const auto& prefix = inserted[folly::Random::rand32(inserted.size())];
+      EXPECT_EQ(
+          rtree.erase(prefix.first, prefix.second),
+          ptree.erase(prefix.first, prefix.second));
+    }
+    expectTreesMatch(rtree, ptree);
+    copies.emplace_back(ptree, toMap(ptree));
+  }
+  for (const auto& copy : copies) {
+    EXPECT_EQ(copy.second, toMap(copy.first));
+  }
+}
+
+} // namespace
+
+TEST(PersistentRadixTree, CompareWithRadixTree4) {
+  compareWithRadixTree<IPAddressV4>();
+}
+
+TEST(PersistentRadixTree, CompareWithRadixTree6) {
+  compareWithRadixTree<IPAddressV6>();
+}
+
+TEST(PersistentRadixTree, ExactMatchAndUpdate) {
+  PersistentRadixTree<IPAddressV4, int> ptree;
+  ptree.insert(IPAddressV4("10.0.0.0"), 8, 1);
+  ptree.insert(IPAddressV4("10.1.0.0"), 16, 2);
+  ptree.insert(IPAddressV4("10.2.0.0"), 16, 3);
+
+  EXPECT_EQ(2, ptree.exactMatch(IPAddressV4("10.1.0.0"), 16)->value());
+  // Bits past the mask length are ignored
+  EXPECT_EQ(3, ptree.exactMatch(IPAddressV4("10.2.3.4"), 16)->value());
+  // 10.0.0.0/14 is a non value node joining the two /16s
+  EXPECT_EQ(ptree.end(), ptree.exactMatch(IPAddressV4("10.0.0.0"), 14));
+  EXPECT_EQ(1, ptree.longestMatch(IPAddressV4("10.0.0.0"), 14)->value());
+  EXPECT_EQ(ptree.end(), ptree.longestMatch(IPAddressV4("11.0.0.0"), 32));
+
+  // Inserting an existing prefix returns the existing node
+  auto result = ptree.insert(IPAddressV4("10.1.0.0"), 16, 4);
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(2, result.first->value());
+
+  auto copy = ptree;
+  EXPECT_TRUE(copy.update(IPAddressV4("10.1.0.0"), 16, 42));
+  EXPECT_FALSE(copy.update(IPAddressV4("10.0.0.0"), 14, 42));
+  EXPECT_EQ(42, copy.longestMatch(IPAddressV4("10.1.1.1"), 32)->value());
+  EXPECT_EQ(2, ptree.longestMatch(IPAddressV4("10.1.1.1"), 32)->value());
+  EXPECT_FALSE(ptree == copy);
+
+  // Iterators from lookups carry on with the rest of the tree
+  auto itr = ptree.exactMatch(IPAddressV4("10.1.0.0"), 16);
+  EXPECT_EQ(3, (++itr)->value());
+  EXPECT_EQ(ptree.end(), ++itr);
+}
+
+TEST(PersistentRadixTree, ForEachChanged) {
+  PersistentRadixTree<IPAddressV6, int> oldTree;
+  for (auto i = 0; i < 1000; ++i) {
+    auto prefix = randomPrefix<IPAddressV6>();
+    oldTree.insert(prefix.first, prefix.second, i);
+  }
+  auto newTree = oldTree;
+  auto changed = [&oldTree, &newTree]() {
+    PrefixValues<IPAddressV6> removed;
+    PrefixValues<IPAddressV6> added;
+    PersistentRadixTree<IPAddressV6, int>::forEachChanged(
+        oldTree, newTree, [&](const auto* oldNode, const auto* newNode) {
+          if (oldNode) {
+            removed[std::make_pair(oldNode->ipAddress(), oldNode->masklen())] =
+                oldNode->value();
+          }
+          if (newNode) {
+            added[std::make_pair(newNode->ipAddress(), newNode->masklen())] =
+                newNode->value();
+          }
+        });
+    return std::make_pair(removed, added);
+  };
+  EXPECT_TRUE(changed().first.empty());
+  EXPECT_TRUE(changed().second.empty());
+
+  for (auto i = 0; i < 100; ++i) {
+    auto prefix = randomPrefix<IPAddressV6>();
+    newTree.insert(prefix.first, prefix.second, 1000 + i);
+    prefix = randomPrefix<IPAddressV6>();
+    newTree.erase(prefix.first, prefix.second);
+  }
+  auto first = newTree.begin();
+  newTree.update(first->ipAddress(), first->masklen(), -1);
+
+  // Compare with the difference of all prefixes and values
+  PrefixValues<IPAddressV6> expectedRemoved;
+  PrefixValues<IPAddressV6> expectedAdded;
+  auto oldValues = toMap(oldTree);
+  auto newValues = toMap(newTree);
+  for (const auto& prefixValue : oldValues) {
+    auto itr = newValues.find(prefixValue.first);
+    if (itr == newValues.end() || itr->second != prefixValue.second) {
+      expectedRemoved.insert(prefixValue);
+    }
+  }
+  for (const auto& prefixValue : newValues) {
+    auto itr = oldValues.find(prefixValue.first);
+    if (itr == oldValues.end() || itr->second != prefixValue.second) {
+      expectedAdded.insert(prefixValue);
+    }
+  }
+  auto actual = changed();
+  EXPECT_EQ(expectedRemoved, actual.first);
+  EXPECT_EQ(expectedAdded, actual.second);
+}
+
+TEST(PersistentRadixTree, CopyAndMove) {
+  PersistentRadixTree<IPAddressV6, int> ptree;
+  EXPECT_TRUE(ptree == PersistentRadixTree<IPAddressV6, int>(ptree));
+  for (auto i = 0; i < 1000; ++i) {
+    auto prefix = randomPrefix<IPAddressV6>();
+    ptree.insert(prefix.first, prefix.second, i);
+  }
+  auto copy = ptree;
+  EXPECT_TRUE(ptree == copy);
+
+  copy.clear();
+  EXPECT_EQ(0, copy.size());
+  EXPECT_EQ(copy.begin(), copy.end());
+  EXPECT_NE(ptree.begin(), ptree.end());
+
+  auto size = ptree.size();
+  auto moved = std::move(ptree);
+  EXPECT_EQ(0, ptree.size());
+  EXPECT_EQ(size, moved.size());
+}
@@ -3,11 +3,13 @@
 #include <folly/Benchmark.h>
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
+#include <cstdio>
 #include <set>
 #include <vector>
 #include "PyRadixWrapper.h"
 #include "common/base/Random.h"
 #include "common/init/Init.h"
+#include "fboss/lib/CompactRadixTree.h"
 #include "fboss/lib/RadixTree.h"
 
 using namespace std;
@@ -57,6 +59,11 @@ BENCHMARK_RELATIVE(RadixTreeInsert4) {
   setupTree4(rtree);
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeInsert4) {
+  CompactRadixTree<IPAddressV4, int> ctree;
+  setupTree4(ctree);
+}
+
 BENCHMARK(PyRadixErase4) {
   PyRadixWrapper<IPAddressV4, int> pyrtree;
   BENCHMARK_SUSPEND {
@@ -117,6 +124,16 @@ BENCHMARK_RELATIVE(RadixTreeLongestMatch4) {
   }
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeLongestMatch4) {
+  CompactRadixTree<IPAddressV4, int> ctree;
+  BENCHMARK_SUSPEND {
+    setupTree4(ctree);
+  }
+  for (auto pfx : longestMatchSet4) {
+    ctree.longestMatch(pfx.ip, pfx.mask);
+  }
+}
+
 // V6 benchmarks
 
 template <typename TREE>
@@ -137,6 +154,11 @@ BENCHMARK_RELATIVE(RadixTreeInsert6) {
   setupTree6(rtree);
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeInsert6) {
+  CompactRadixTree<IPAddressV6, int> ctree;
+  setupTree6(ctree);
+}
+
 BENCHMARK(PyRadixErase6) {
   PyRadixWrapper<IPAddressV6, int> pyrtree;
   BENCHMARK_SUSPEND {
@@ -197,6 +219,132 @@ BENCHMARK_RELATIVE(RadixTreeLongestMatch6) {
   }
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeLongestMatch6) {
+  CompactRadixTree<IPAddressV6, int> ctree;
+  BENCHMARK_SUSPEND {
+    setupTree6(ctree);
+  }
+  for (auto pfx : longestMatchSet6) {
+    ctree.longestMatch(pfx.ip, pfx.mask);
+  }
+}
+
+// Batched longest match of random host addresses
+
+IPAddressV4 randomAddress(const IPAddressV4& /*unused*/) {
+  return IPAddressV4::fromLongHBO(folly::Random::rand32());
+}
+
+IPAddressV6 randomAddress(const IPAddressV6& /*unused*/) {
+  ByteArray16 ba;
+  *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+  *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+  return IPAddressV6(ba);
+}
+
+template <typename IPADDRTYPE, typename SETUPFN>
+void longestMatchOneByOne(uint32_t iters, size_t batchSize, SETUPFN setupFn) {
+  RadixTree<IPADDRTYPE, int> rtree;
+  vector<IPADDRTYPE> addrs;
+  BENCHMARK_SUSPEND {
+    setupFn(rtree);
+    for (size_t i = 0; i < batchSize; ++i) {
+      addrs.push_back(randomAddress(IPADDRTYPE()));
+    }
+  }
+  for (uint32_t iter = 0; iter < iters; ++iter) {
+    for (const auto& addr : addrs) {
+      folly::doNotOptimizeAway(rtree.longestMatch(addr, addr.bitCount()));
+    }
+  }
+}
+
+template <typename IPADDRTYPE, typename SETUPFN>
+void longestMatchBatch(uint32_t iters, size_t batchSize, SETUPFN setupFn) {
+  RadixTree<IPADDRTYPE, int> rtree;
+  vector<IPADDRTYPE> addrs;
+  vector<typename RadixTree<IPADDRTYPE, int>::ConstIterator> matches;
+  BENCHMARK_SUSPEND {
+    setupFn(rtree);
+    for (size_t i = 0; i < batchSize; ++i) {
+      addrs.push_back(randomAddress(IPADDRTYPE()));
+    }
+  }
+  const auto& crtree = rtree;
+  for (uint32_t iter = 0; iter < iters; ++iter) {
+    crtree.longestMatchBatch(folly::range(addrs), &matches);
+    folly::doNotOptimizeAway(matches.data());
+  }
+}
+
+void longestMatchOneByOne4(uint32_t iters, size_t batchSize) {
+  longestMatchOneByOne<IPAddressV4>(
+      iters, batchSize, [](auto& tree) { setupTree4(tree); });
+}
+
+void longestMatchBatch4(uint32_t iters, size_t batchSize) {
+  longestMatchBatch<IPAddressV4>(
+      iters, batchSize, [](auto& tree) { setupTree4(tree); });
+}
+
+void longestMatchOneByOne6(uint32_t iters, size_t batchSize) {
+  longestMatchOneByOne<IPAddressV6>(
+      iters, batchSize, [](auto& tree) { setupTree6(tree); });
+}
+
+void longestMatchBatch6(uint32_t iters, size_t batchSize) {
+  longestMatchBatch<IPAddressV6>(
+      iters, batchSize, [](auto& tree) { setupTree6(tree); });
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(longestMatchOneByOne4, 16, 16)
+BENCHMARK_RELATIVE_NAMED_PARAM(longestMatchBatch4, 16, 16)
+BENCHMARK_NAMED_PARAM(longestMatchOneByOne4, 64, 64)
+BENCHMARK_RELATIVE_NAMED_PARAM(longestMatchBatch4, 64, 64)
+BENCHMARK_NAMED_PARAM(longestMatchOneByOne4, 1024, 1024)
+BENCHMARK_RELATIVE_NAMED_PARAM(longestMatchBatch4, 1024, 1024)
+BENCHMARK_NAMED_PARAM(longestMatchOneByOne6, 16, 16)
+BENCHMARK_RELATIVE_NAMED_PARAM(longestMatchBatch6, 16, 16)
+BENCHMARK_NAMED_PARAM(longestMatchOneByOne6, 64, 64)
+BENCHMARK_RELATIVE_NAMED_PARAM(longestMatchBatch6, 64, 64)
+BENCHMARK_NAMED_PARAM(longestMatchOneByOne6, 1024, 1024)
+BENCHMARK_RELATIVE_NAMED_PARAM(longestMatchBatch6, 1024, 1024)
+
+// Memory per prefix
+
+/*
+ * RadixTree doesn't track its memory, so count its nodes (including non
+ * value nodes). This excludes malloc overhead, so it underestimates the
+ * actual usage.
+ */
+template <typename IPADDRTYPE>
+size_t radixTreeMemoryUsage(const RadixTree<IPADDRTYPE, int>& rtree) {
+  size_t numNodes = 0;
+  for (RadixTreeConstIterator<IPADDRTYPE, int> itr(
+           rtree.root(), true /*include non value nodes*/);
+       !itr.atEnd();
+       ++itr) {
+    ++numNodes;
+  }
+  return sizeof(rtree) + numNodes * sizeof(RadixTreeNode<IPADDRTYPE, int>);
+}
+
+template <typename IPADDRTYPE, typename SETUPFN>
+void printMemoryPerPrefix(const char* name, SETUPFN setupFn) {
+  RadixTree<IPADDRTYPE, int> rtree;
+  CompactRadixTree<IPADDRTYPE, int> ctree;
+  setupFn(rtree);
+  setupFn(ctree);
+  printf(
+      "%s: %zu prefixes, bytes/prefix RadixTree %.1f, CompactRadixTree %.1f\n",
+      name,
+      rtree.size(),
+      static_cast<double>(radixTreeMemoryUsage(rtree)) / rtree.size(),
+      static_cast<double>(ctree.memoryUsage()) / ctree.size());
+}
+
 } // namespace
 
 int main(int /*argc*/, char* /*argv*/ []) {
@@ -252,5 +400,9 @@ int main(int /*argc*/, char* /*argv*/ []) {
     auto newIp = pfx.ip.mask(newMask);
     longestMatchSet6.insert(Prefix6(newIp, newMask));
   }
+  printMemoryPerPrefix<IPAddressV4>(
+      "IPv4", [](auto& tree) { setupTree4(tree); });
+  printMemoryPerPrefix<IPAddressV6>(
+      "IPv6", [](auto& tree) { setupTree6(tree); });
   runBenchmarks();
 }
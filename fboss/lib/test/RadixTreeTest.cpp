@@ -1527,3 +1527,49 @@ TEST(RadixTree, SubTreeIterator) {
   }
   EXPECT_EQ(rtree.end().subTreeIterator(), rtree.end());
 }
+
+template <typename IPADDRTYPE>
+void checkLongestMatchBatch(
+    RadixTree<IPADDRTYPE, int>& rtree,
+    const vector<IPADDRTYPE>& addrs) {
+  vector<typename RadixTree<IPADDRTYPE, int>::ConstIterator> matches;
+  const auto& crtree = rtree;
+  crtree.longestMatchBatch(folly::range(addrs), &matches);
+  ASSERT_EQ(addrs.size(), matches.size());
+  for (auto i = 0; i < addrs.size(); ++i) {
+    EXPECT_EQ(
+        crtree.longestMatch(addrs[i], IPADDRTYPE::bitCount()), matches[i]);
+  }
+
+  vector<typename RadixTree<IPADDRTYPE, int>::Iterator> nonConstMatches;
+  rtree.longestMatchBatch(folly::range(addrs), &nonConstMatches);
+  ASSERT_EQ(addrs.size(), nonConstMatches.size());
+  for (auto i = 0; i < addrs.size(); ++i) {
+    EXPECT_EQ(
+        rtree.longestMatch(addrs[i], IPADDRTYPE::bitCount()),
+        nonConstMatches[i]);
+  }
+}
+
+TEST(RadixTree, LongestMatchBatch) {
+  RadixTree<IPAddressV4, int> v4Tree;
+  RadixTree<IPAddressV6, int> v6Tree;
+  // Empty trees and empty batches
+  checkLongestMatchBatch(v4Tree, {IPAddressV4("1.1.1.1")});
+  checkLongestMatchBatch(v6Tree, {});
+
+  setupTestTree4(v4Tree);
+  setupTestTree6(v6Tree);
+  // Many more addresses than there are lookups in flight at a time
+  vector<IPAddressV4> v4Addrs;
+  vector<IPAddressV6> v6Addrs;
+  for (auto i = 0; i < 1000; ++i) {
+    v4Addrs.push_back(IPAddressV4::fromLongHBO(folly::Random::rand32()));
+    folly::ByteArray16 ba;
+    *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+    *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+    v6Addrs.push_back(IPAddressV6(ba));
+  }
+  checkLongestMatchBatch(v4Tree, v4Addrs);
+  checkLongestMatchBatch(v6Tree, v6Addrs);
+}
@@ -16,9 +16,11 @@ DEFINE_int32(
     "Interval (in seconds) for publishing stats");
 DEFINE_int32(
     loop_interval,
-    5,
+    1,
     "Interval (in seconds) to run the main loop that determines "
-    "if we need to change or fetch data for transceivers");
+    "if we need to change or fetch data for transceivers. Presence and "
+    "flags are polled on every iteration, the rest of the data every "
+    "qsfp_data_refresh_interval seconds");
 
 int doServerLoop(std::shared_ptr<apache::thrift::ThriftServer>
         thriftServer, std::shared_ptr<QsfpServiceHandler>);
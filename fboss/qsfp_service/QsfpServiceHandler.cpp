@@ -3,6 +3,9 @@
 #include <fboss/lib/LogThriftCall.h>
 #include <folly/logging/xlog.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
+#include <thrift/lib/cpp2/async/StreamPublisher.h>
+
+#include <atomic>
 
 namespace facebook { namespace fboss {
 
@@ -53,4 +56,32 @@ void QsfpServiceHandler::syncPorts(
   manager_->syncPorts(info, std::move(ports));
 }
 
+apache::thrift::ResponseAndServerStream<TransceiverUpdates, TransceiverUpdates>
+QsfpServiceHandler::subscribeToTransceiverUpdates(
+    int64_t epoch,
+    int64_t generation) {
+  auto log = LOG_THRIFT_CALL(INFO);
+  auto closed = std::make_shared<std::atomic<bool>>(false);
+  auto streamAndPublisher =
+      createStreamPublisher<TransceiverUpdates>([closed]() {
+        XLOG(INFO) << "Transceiver update subscriber disconnected";
+        *closed = true;
+      });
+  auto publisher =
+      std::make_shared<apache::thrift::StreamPublisher<TransceiverUpdates>>(
+          std::move(streamAndPublisher.second));
+
+  // The publisher drops us on the first change after the client is gone
+  auto updates = manager_->getUpdatePublisher()->subscribe(
+      epoch, generation, [publisher, closed](const TransceiverUpdates& next) {
+        if (*closed) {
+          std::move(*publisher).complete();
+          return false;
+        }
+        publisher->next(next);
+        return true;
+      });
+  return {std::move(updates), std::move(streamAndPublisher.first)};
+}
+
 }} // facebook::fboss
@@ -45,6 +45,15 @@ class QsfpServiceHandler : public facebook::fboss::QsfpServiceSvIf,
    */
   void customizeTransceiver(int32_t idx, cfg::PortSpeed speed) override;
 
+  /*
+   * Stream the changes to transceivers, starting after the given
+   * generation.
+   */
+  apache::thrift::
+      ResponseAndServerStream<TransceiverUpdates, TransceiverUpdates>
+      subscribeToTransceiverUpdates(int64_t epoch, int64_t generation)
+          override;
+
   /*
    * Return a pointer to the transceiver manager.
    */
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <folly/io/async/EventBase.h>
+#include <chrono>
 #include "fboss/qsfp_service/TransceiverManager.h"
 
 namespace facebook { namespace fboss {
@@ -25,6 +26,9 @@ class StatsPublisher {
   static void bumpWriteFailure();
   static void bumpModuleErrors();
   static void missingPorts(TransceiverID module);
+  // Time taken to refresh one transceiver, and to refresh all of them
+  static void recordModuleRefreshTime(std::chrono::microseconds duration);
+  static void recordSweepTime(std::chrono::microseconds duration);
 
  private:
   TransceiverManager* transceiverManager_{nullptr};
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "fboss/agent/types.h"
+#include "fboss/qsfp_service/TransceiverUpdatePublisher.h"
 #include "fboss/qsfp_service/module/Transceiver.h"
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
 
@@ -29,11 +30,20 @@ class TransceiverManager {
   virtual int scanTransceiverPresence(
       std::unique_ptr<std::vector<int32_t>> ids) = 0;
   virtual int numPortsPerTransceiver() = 0;
+
+  /*
+   * Tracks the changes to transceivers seen when refreshing them, for
+   * clients that subscribe to them.
+   */
+  TransceiverUpdatePublisher* getUpdatePublisher() {
+    return &updatePublisher_;
+  }
  private:
   // Forbidden copy constructor and assignment operator
   TransceiverManager(TransceiverManager const &) = delete;
   TransceiverManager& operator=(TransceiverManager const &) = delete;
  protected:
   std::vector<std::unique_ptr<Transceiver>> transceivers_;
+  TransceiverUpdatePublisher updatePublisher_;
 };
 }} // facebook::fboss
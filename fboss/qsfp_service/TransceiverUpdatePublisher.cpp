@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/qsfp_service/TransceiverUpdatePublisher.h"
+
+#include <folly/logging/xlog.h>
+
+#include <chrono>
+
+namespace facebook { namespace fboss {
+
+TransceiverUpdatePublisher::TransceiverUpdatePublisher()
+    // Tell restarts apart, even ones within the same second
+    : TransceiverUpdatePublisher(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count()) {}
+
+TransceiverUpdatePublisher::TransceiverUpdatePublisher(int64_t epoch)
+    : epoch_(epoch) {}
+
+void TransceiverUpdatePublisher::transceiversUpdated(
+    const std::map<int32_t, TransceiverInfo>& infos) {
+  std::lock_guard<std::mutex> g(mutex_);
+  TransceiverUpdates updates;
+  for (const auto& item : infos) {
+    auto& entry = transceivers_[item.first];
+    if (entry.generation > 0 && entry.info == item.second) {
+      continue;
+    }
+    entry.info = item.second;
+    entry.generation = generation_ + 1;
+    updates.transceivers[item.first] = item.second;
+  }
+  if (updates.transceivers.empty()) {
+    return;
+  }
+
+  updates.epoch = epoch_;
+  updates.generation = ++generation_;
+  XLOG(DBG2) << updates.transceivers.size()
+             << " transceivers changed, generation " << generation_;
+
+  auto it = subscribers_.begin();
+  while (it != subscribers_.end()) {
+    if ((*it)(updates)) {
+      ++it;
+    } else {
+      XLOG(DBG1) << "Dropping transceiver update subscriber";
+      it = subscribers_.erase(it);
+    }
+  }
+}
+
+TransceiverUpdates TransceiverUpdatePublisher::subscribe(
+    int64_t epoch,
+    int64_t generation,
+    Subscriber subscriber) {
+  std::lock_guard<std::mutex> g(mutex_);
+  if (epoch != epoch_) {
+    // Generations from another run of qsfp_service mean nothing to us
+    generation = 0;
+  }
+
+  TransceiverUpdates updates;
+  updates.epoch = epoch_;
+  updates.generation = generation_;
+  for (const auto& item : transceivers_) {
+    if (item.second.generation > generation) {
+      updates.transceivers[item.first] = item.second.info;
+    }
+  }
+  subscribers_.push_back(std::move(subscriber));
+  XLOG(DBG1) << "New transceiver update subscriber after generation "
+             << generation << ", sending " << updates.transceivers.size()
+             << " transceivers";
+  return updates;
+}
+
+size_t TransceiverUpdatePublisher::numSubscribers() const {
+  std::lock_guard<std::mutex> g(mutex_);
+  return subscribers_.size();
+}
+
+}} // facebook::fboss
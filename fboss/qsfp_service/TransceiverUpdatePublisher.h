@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "fboss/qsfp_service/if/gen-cpp2/transceiver_types.h"
+
+namespace facebook { namespace fboss {
+
+/*
+ * Keeps the latest TransceiverInfo of every transceiver, numbers each
+ * change with a generation and pushes the changes to subscribers.
+ *
+ * Subscribing returns everything that changed after the last generation
+ * the subscriber saw, and the subscriber is then called with every later
+ * change. Both happen under the same lock, so a client that resubscribes
+ * with the last generation it got, e.g. after a reconnect, does not miss
+ * any change.
+ */
+class TransceiverUpdatePublisher {
+ public:
+  // Returns false when the subscriber has gone away, to unsubscribe it
+  using Subscriber = std::function<bool(const TransceiverUpdates&)>;
+
+  TransceiverUpdatePublisher();
+  explicit TransceiverUpdatePublisher(int64_t epoch);
+
+  /*
+   * Record the latest info of the given transceivers, and send the ones
+   * that changed to the subscribers.
+   */
+  void transceiversUpdated(const std::map<int32_t, TransceiverInfo>& infos);
+
+  /*
+   * Returns the transceivers that changed after the given generation, or
+   * all of them if the epoch is not ours, and adds a subscriber for every
+   * change after that.
+   */
+  TransceiverUpdates
+  subscribe(int64_t epoch, int64_t generation, Subscriber subscriber);
+
+  int64_t getEpoch() const {
+    return epoch_;
+  }
+  size_t numSubscribers() const;
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  TransceiverUpdatePublisher(TransceiverUpdatePublisher const&) = delete;
+  TransceiverUpdatePublisher& operator=(TransceiverUpdatePublisher const&) =
+      delete;
+
+  struct TransceiverEntry {
+    TransceiverInfo info;
+    // generation of the last change to info
+    int64_t generation{0};
+  };
+
+  const int64_t epoch_;
+  mutable std::mutex mutex_;
+  int64_t generation_{0};
+  std::map<int32_t, TransceiverEntry> transceivers_;
+  std::vector<Subscriber> subscribers_;
+};
+
+}} // facebook::fboss
@@ -37,4 +37,12 @@ service QsfpService extends fb303.FacebookService {
   map<i32, transceiver.TransceiverInfo> syncPorts(1: map<i32, ctrl.PortStatus> ports)
     throws (1: fboss.FbossBaseError error)
 
+  /*
+   * Subscribe to transceiver changes. The response has the transceivers
+   * that changed after the given generation, or all of them if the epoch
+   * is not the current one, and the stream has every change after that.
+   */
+  transceiver.TransceiverUpdates, stream<transceiver.TransceiverUpdates>
+    subscribeToTransceiverUpdates(1: i64 epoch, 2: i64 generation)
+
 }
@@ -161,6 +161,15 @@ struct TransceiverInfo {
   14: optional TransceiverStats stats,
 }
 
+// Transceivers that changed since a previous update. Every change bumps
+// the generation, which only increases within one run of qsfp_service,
+// identified by the epoch.
+struct TransceiverUpdates {
+  1: i64 epoch,
+  2: i64 generation,
+  3: map<i32, TransceiverInfo> transceivers,
+}
+
 typedef binary (cpp2.type = "folly::IOBuf") IOBuf
 
 struct RawDOMData {
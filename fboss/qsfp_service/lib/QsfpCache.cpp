@@ -36,7 +36,7 @@ void QsfpCache::init(folly::EventBase* evb, const PortMapThrift& ports) {
 
   attachEventBase(evb);
   scheduleTimeout(kLivenessCheckInterval);
-
+  evb_->runInEventBaseThread([this]() { subscribe(); });
 }
 
 void QsfpCache::init(folly::EventBase* evb) {
@@ -176,6 +176,71 @@ folly::Future<folly::Unit> QsfpCache::doSync(PortMapThrift&& toSync) {
       });
 }
 
+void QsfpCache::subscribe() {
+  CHECK(evb_->isInEventBaseThread());
+
+  if (subscribed_) {
+    return;
+  }
+  subscribed_ = true;
+
+  auto doSubscribe = [this](std::unique_ptr<QsfpServiceAsyncClient> client) {
+    XLOG(DBG1) << "Subscribing to transceiver updates after epoch "
+               << updatesEpoch_ << " generation " << updatesGeneration_;
+    updatesClient_ = std::move(client);
+    auto options = QsfpClient::getRpcOptions();
+    return updatesClient_->future_subscribeToTransceiverUpdates(
+        options, updatesEpoch_, updatesGeneration_);
+  };
+  auto consumeUpdates = [this](auto&& responseAndStream) {
+    this->transceiversUpdated(responseAndStream.response);
+    return std::move(responseAndStream.stream)
+        .via(evb_)
+        .subscribe(
+            [this](const TransceiverUpdates& updates) {
+              this->transceiversUpdated(updates);
+            },
+            [](folly::exception_wrapper e) {
+              XLOG(ERR) << "Transceiver update stream failed: "
+                        << folly::exceptionStr(e);
+            },
+            []() { XLOG(INFO) << "Transceiver update stream completed"; })
+        .futureJoin();
+  };
+
+  QsfpClient::createStreamingClient(evb_)
+      .thenValue(doSubscribe)
+      .thenValue(consumeUpdates)
+      .thenError(
+          folly::tag_t<std::exception>{},
+          [](const std::exception& e) {
+            XLOG(ERR) << "Exception subscribing to transceiver updates: "
+                      << e.what();
+          })
+      .ensure([this]() {
+        // We will resubscribe on the next liveness check
+        subscribed_ = false;
+        updatesClient_.reset();
+      });
+}
+
+void QsfpCache::transceiversUpdated(const TransceiverUpdates& updates) {
+  CHECK(evb_->isInEventBaseThread());
+
+  if (updates.epoch == updatesEpoch_ &&
+      updates.generation <= updatesGeneration_) {
+    XLOG(DBG3) << "Already have transceiver updates up to generation "
+               << updates.generation;
+    return;
+  }
+  XLOG(DBG2) << "Got " << updates.transceivers.size()
+             << " changed transceivers from qsfp_service, generation "
+             << updates.generation;
+  updateCache(updates.transceivers);
+  updatesEpoch_ = updates.epoch;
+  updatesGeneration_ = updates.generation;
+}
+
 void QsfpCache::updateCache(const TcvrMapThrift& tcvrs) {
   tcvrs_.withWLock([&tcvrs](auto& lockedTcvrs) {
     for (const auto& item : tcvrs) {
@@ -225,6 +290,7 @@ folly::Future<TransceiverInfo> QsfpCache::futureGet(TransceiverID tcvrId) {
 
 void QsfpCache::timeoutExpired() noexcept {
   confirmAlive().then(&QsfpCache::maybeSync, this);
+  subscribe();
   scheduleTimeout(kLivenessCheckInterval);
 }
 
@@ -26,6 +26,7 @@
 
 #include "fboss/agent/types.h"
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+#include "fboss/qsfp_service/if/gen-cpp2/QsfpService.h"
 #include "fboss/qsfp_service/if/gen-cpp2/transceiver_types.h"
 
 /*
@@ -62,6 +63,15 @@
  * and store the last aliveSince. If this changes, we reset remoteGen_
  * back to zero so we will re-sync all ports.
  *
+ * Transceiver updates
+ * -------------------
+ * Besides the transceivers returned by syncPorts, we subscribe to the
+ * stream of transceiver changes from qsfp_service. Each update is
+ * numbered with a generation, and when the stream breaks we resubscribe
+ * with the epoch and generation of the last update we got, so
+ * qsfp_service sends us everything we missed in between. A restart of
+ * qsfp_service changes the epoch, in which case we get every transceiver.
+ *
  * Threading model
  * ---------------
  * All thrift calls to qsfp_service are done on evb_. No guarantee for
@@ -113,6 +123,21 @@ class QsfpCache : private folly::AsyncTimeout {
   // output state of the cache. Useful for debugging
   void dump();
 
+ protected:
+  /* Subscribes to transceiver updates from qsfp_service, unless there
+   * already is a subscription, picking up after the last update we got.
+   */
+  virtual void subscribe();
+
+  /* Called with the response to a subscription and with every update
+   * streamed after it.
+   */
+  void transceiversUpdated(const TransceiverUpdates& updates);
+
+  // epoch and generation of the last transceiver update we got
+  int64_t updatesEpoch_{0};
+  int64_t updatesGeneration_{0};
+
  private:
   // Forbidden copy constructor and assignment operator
   QsfpCache(QsfpCache const &) = delete;
@@ -151,6 +176,10 @@ class QsfpCache : private folly::AsyncTimeout {
 
   std::optional<folly::SharedPromise<folly::Unit>> activeReq_;
 
+  // client for the transceiver update stream, while we are subscribed
+  std::unique_ptr<QsfpServiceAsyncClient> updatesClient_;
+  bool subscribed_{false};
+
   folly::EventBase* evb_{nullptr};
 
   // generation number that we know is synced to qsfp_service
@@ -11,6 +11,7 @@
 #include "QsfpClient.h"
 
 #include <thrift/lib/cpp/async/TAsyncSocket.h>
+#include <thrift/lib/cpp2/async/RocketClientChannel.h>
 
 DEFINE_string(qsfp_service_host, "::1", "Host running qsfp service");
 DEFINE_int32(qsfp_service_port, 5910, "Port running qsfp service");
@@ -39,6 +40,21 @@ QsfpClient::createClient(folly::EventBase* eb) {
   return folly::via(eb, createClient);
 }
 
+// static
+folly::Future<std::unique_ptr<QsfpServiceAsyncClient>>
+QsfpClient::createStreamingClient(folly::EventBase* eb) {
+  auto createClient = [eb]() {
+    folly::SocketAddress addr(FLAGS_qsfp_service_host, FLAGS_qsfp_service_port);
+    apache::thrift::async::TAsyncSocket::UniquePtr socket(
+        new apache::thrift::async::TAsyncSocket(eb, addr, kQsfpConnTimeoutMs));
+    socket->setSendTimeout(kQsfpSendTimeoutMs);
+    auto channel =
+        apache::thrift::RocketClientChannel::newChannel(std::move(socket));
+    return std::make_unique<QsfpServiceAsyncClient>(std::move(channel));
+  };
+  return folly::via(eb, createClient);
+}
+
 // static
 apache::thrift::RpcOptions QsfpClient::getRpcOptions(){
   apache::thrift::RpcOptions opts;
@@ -36,6 +36,10 @@ class QsfpClient {
   static folly::Future<std::unique_ptr<QsfpServiceAsyncClient>>
   createClient(folly::EventBase* eb);
 
+  // Streaming calls need a rocket channel, rather than a header one
+  static folly::Future<std::unique_ptr<QsfpServiceAsyncClient>>
+  createStreamingClient(folly::EventBase* eb);
+
   static apache::thrift::RpcOptions getRpcOptions();
 };
 
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/qsfp_service/lib/QsfpCache.h"
+#include "fboss/qsfp_service/TransceiverUpdatePublisher.h"
+
+#include <folly/io/async/EventBase.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+using namespace facebook::fboss;
+
+namespace {
+
+/*
+ * Subscribes to an in-process TransceiverUpdatePublisher, standing in for
+ * qsfp_service, instead of over thrift.
+ */
+class TestQsfpCache : public QsfpCache {
+ public:
+  void connect(TransceiverUpdatePublisher* publisher) {
+    publisher_ = publisher;
+    subscribe();
+  }
+
+  void disconnect() {
+    *connected_ = false;
+    connected_ = std::make_shared<bool>(false);
+  }
+
+ protected:
+  void subscribe() override {
+    if (!publisher_ || *connected_) {
+      return;
+    }
+    *connected_ = true;
+    auto updates = publisher_->subscribe(
+        updatesEpoch_,
+        updatesGeneration_,
+        [this, connected = connected_](const TransceiverUpdates& next) {
+          if (!*connected) {
+            return false;
+          }
+          transceiversUpdated(next);
+          return true;
+        });
+    transceiversUpdated(updates);
+  }
+
+ private:
+  TransceiverUpdatePublisher* publisher_{nullptr};
+  std::shared_ptr<bool> connected_{std::make_shared<bool>(false)};
+};
+
+TransceiverInfo makeTransceiver(int32_t id, bool present) {
+  TransceiverInfo info;
+  info.present = present;
+  info.port = id;
+  return info;
+}
+
+class QsfpCacheTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    cache_ = std::make_unique<TestQsfpCache>();
+    cache_->init(&evb_);
+    evb_.loopOnce();
+  }
+
+  void expectPresent(int32_t id, bool present) {
+    auto info = cache_->getIf(TransceiverID(id));
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->present, present);
+  }
+
+  folly::EventBase evb_;
+  std::unique_ptr<TestQsfpCache> cache_;
+};
+
+} // namespace
+
+TEST_F(QsfpCacheTest, streamUpdates) {
+  TransceiverUpdatePublisher publisher(1);
+  publisher.transceiversUpdated({{0, makeTransceiver(0, true)},
+                                 {1, makeTransceiver(1, false)}});
+  cache_->connect(&publisher);
+  expectPresent(0, true);
+  expectPresent(1, false);
+
+  publisher.transceiversUpdated({{0, makeTransceiver(0, true)},
+                                 {1, makeTransceiver(1, true)}});
+  expectPresent(1, true);
+  EXPECT_EQ(publisher.numSubscribers(), 1U);
+}
+
+TEST_F(QsfpCacheTest, noUpdatesMissedAcrossReconnect) {
+  TransceiverUpdatePublisher publisher(1);
+  publisher.transceiversUpdated({{0, makeTransceiver(0, true)}});
+  cache_->connect(&publisher);
+  expectPresent(0, true);
+
+  cache_->disconnect();
+  publisher.transceiversUpdated({{0, makeTransceiver(0, false)},
+                                 {1, makeTransceiver(1, true)}});
+  publisher.transceiversUpdated({{2, makeTransceiver(2, true)}});
+  // The publisher dropped us on the first change after disconnecting
+  EXPECT_EQ(publisher.numSubscribers(), 0U);
+  expectPresent(0, true);
+  EXPECT_FALSE(cache_->getIf(TransceiverID(1)).has_value());
+
+  cache_->connect(&publisher);
+  expectPresent(0, false);
+  expectPresent(1, true);
+  expectPresent(2, true);
+
+  publisher.transceiversUpdated({{2, makeTransceiver(2, false)}});
+  expectPresent(2, false);
+}
+
+TEST_F(QsfpCacheTest, resyncAfterRestart) {
+  auto publisher = std::make_unique<TransceiverUpdatePublisher>(1);
+  for (auto present : {true, false, true}) {
+    publisher->transceiversUpdated({{0, makeTransceiver(0, present)},
+                                    {1, makeTransceiver(1, true)}});
+  }
+  cache_->connect(publisher.get());
+  expectPresent(0, true);
+  expectPresent(1, true);
+
+  // qsfp_service restarts, and its generations start over
+  cache_->disconnect();
+  publisher = std::make_unique<TransceiverUpdatePublisher>(2);
+  publisher->transceiversUpdated({{0, makeTransceiver(0, false)},
+                                  {1, makeTransceiver(1, false)}});
+  cache_->connect(publisher.get());
+  expectPresent(0, false);
+  expectPresent(1, false);
+}
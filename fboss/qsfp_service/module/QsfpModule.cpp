@@ -17,10 +17,13 @@
 #include "fboss/qsfp_service/StatsPublisher.h"
 #include "fboss/lib/usb/TransceiverI2CApi.h"
 
+#include <folly/ScopeGuard.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/logging/xlog.h>
 
+#include <chrono>
+
 DEFINE_int32(
     qsfp_data_refresh_interval,
     10,
@@ -268,6 +271,12 @@ void QsfpModule::transceiverPortsChanged(
 
 void QsfpModule::refresh() {
   lock_guard<std::mutex> g(qsfpModuleMutex_);
+  auto start = std::chrono::steady_clock::now();
+  SCOPE_EXIT {
+    StatsPublisher::recordModuleRefreshTime(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start));
+  };
   refreshLocked();
 }
 
@@ -299,6 +308,11 @@ void QsfpModule::refreshLocked() {
   auto customizeWanted = customizationWanted(FLAGS_customize_interval);
   auto willRefresh = !dirty_ && shouldRefresh(FLAGS_qsfp_data_refresh_interval);
   if (!dirty_ && !customizeWanted && !willRefresh) {
+    // Keep polling the flags in between DOM refreshes, so that LOS and
+    // alarms are picked up quickly. Only reparse if they changed.
+    if (present_ && updateQsfpFlags()) {
+      *info_.wlock() = parseDataLocked();
+    }
     return;
   }
 
@@ -267,8 +267,17 @@ class QsfpModule : public Transceiver {
    * on the first page holds most of the fields that actually change,
    * so unless we have reason to believe the transceiver was unplugged
    * there is not much point in refreshing static data on other pages.
+   * Partial updates only read the monitors and control bytes of the
+   * first page.
    */
   virtual void updateQsfpData(bool allPages = true) = 0;
+  /*
+   * Update just the status and interrupt flag bytes, which is where
+   * LOS, faults and alarms show up. This is a single short read, so
+   * unlike updateQsfpData() it is cheap enough to do on every refresh.
+   * Returns true if any of the flags changed.
+   */
+  virtual bool updateQsfpFlags() = 0;
 
   /*
    * Helpers to parse DOM data for DAC cables. These incorporate some
@@ -20,6 +20,7 @@
 
 using folly::IOBuf;
 using std::lock_guard;
+using std::memcmp;
 using std::memcpy;
 using std::mutex;
 
@@ -29,6 +30,15 @@ namespace {
 
 constexpr int kUsecBetweenPowerModeFlap = 100000;
 
+// The parts of the lower page that change while a transceiver is plugged
+// in: the identifier, status and interrupt flags (bytes 0-14), followed
+// by the monitors (up to byte 57), and the control bytes that we write
+// when customizing (bytes 86-98).
+constexpr int kFlagsLength = 15;
+constexpr int kMonitorsLength = 58;
+constexpr int kControlOffset = 86;
+constexpr int kControlLength = 13;
+
 }
 
 namespace facebook {
@@ -607,21 +617,31 @@ void SffModule::updateQsfpData(bool allPages) {
     XLOG(DBG2) << "Performing " << ((allPages) ? "full" : "partial")
                << " qsfp data cache refresh for transceiver "
                << folly::to<std::string>(qsfpImpl_->getName());
+    if (!allPages) {
+      // Only the first page has fields that change often so provide
+      // an option to only fetch the parts of that page we use. Also
+      // the write path is particularly slow due to using an i2c bus,
+      // so writing the bytes needed to select later pages on non-flat
+      // memories can be quite expensive.
+      qsfpImpl_->readTransceiver(
+          TransceiverI2CApi::ADDR_QSFP, 0, kMonitorsLength, lowerPage_);
+      qsfpImpl_->readTransceiver(
+          TransceiverI2CApi::ADDR_QSFP,
+          kControlOffset,
+          kControlLength,
+          lowerPage_ + kControlOffset);
+      lastRefreshTime_ = std::time(nullptr);
+      dirty_ = false;
+      setQsfpIdprom();
+      return;
+    }
+
     qsfpImpl_->readTransceiver(
         TransceiverI2CApi::ADDR_QSFP, 0, sizeof(lowerPage_), lowerPage_);
     lastRefreshTime_ = std::time(nullptr);
     dirty_ = false;
     setQsfpIdprom();
 
-    if (!allPages) {
-      // Only the first page has fields that change often so provide
-      // an option to only fetch that page. Also the write path is
-      // particularly slow due to using an i2c bus, so writing the
-      // bytes needed to select later pages on non-flat memories can
-      // be quite expensive.
-      return;
-    }
-
     // If we have flat memory, we don't have to set the page
     if (!flatMem_) {
       uint8_t page = 0;
@@ -648,6 +668,31 @@ void SffModule::updateQsfpData(bool allPages) {
   }
 }
 
+bool SffModule::updateQsfpFlags() {
+  // expects the lock to be held
+  if (!present_) {
+    return false;
+  }
+  std::array<uint8_t, kFlagsLength> flags{};
+  try {
+    qsfpImpl_->readTransceiver(
+        TransceiverI2CApi::ADDR_QSFP, 0, flags.size(), flags.data());
+  } catch (const std::exception& ex) {
+    // The module may have been reseated, so read everything next time
+    dirty_ = true;
+    XLOG(ERR) << "Error update flags for transceiver:"
+              << folly::to<std::string>(qsfpImpl_->getName()) << ": "
+              << ex.what();
+    throw;
+  }
+  if (memcmp(flags.data(), lowerPage_, flags.size()) == 0) {
+    return false;
+  }
+  memcpy(lowerPage_, flags.data(), flags.size());
+  setQsfpIdprom();
+  return true;
+}
+
 void SffModule::setCdrIfSupported(
     cfg::PortSpeed speed,
     FeatureState currentStateTx,
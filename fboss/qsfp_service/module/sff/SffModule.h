@@ -184,6 +184,10 @@ class SffModule : public QsfpModule {
    * there is not much point in refreshing static data on other pages.
    */
   void updateQsfpData(bool allPages = true) override;
+  /*
+   * Update the status and interrupt flag bytes of the lower page.
+   */
+  bool updateQsfpFlags() override;
 
  private:
   /*
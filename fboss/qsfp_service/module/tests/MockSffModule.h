@@ -30,7 +30,9 @@ class MockSffModule : public SffModule {
       unsigned int portsPerTransceiver)
       : SffModule(std::move(qsfpImpl), portsPerTransceiver) {
     ON_CALL(*this, updateQsfpData(testing::_))
-        .WillByDefault(testing::Assign(&dirty_, false));
+        .WillByDefault(testing::DoAll(
+            testing::Assign(&dirty_, false),
+            testing::Assign(&lastRefreshTime_, std::time(nullptr))));
   }
   MOCK_METHOD1(setPowerOverrideIfSupported, void(PowerControlState));
   MOCK_CONST_METHOD0(cacheIsValid, bool());
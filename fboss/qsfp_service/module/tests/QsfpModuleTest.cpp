@@ -402,6 +402,18 @@ TEST_F(QsfpModuleTest, updateQsfpDataFull) {
   qsfp_->actualUpdateQsfpData(true);
 }
 
+TEST_F(QsfpModuleTest, refreshPollsFlagsBetweenDomRefreshes) {
+  // The first refresh reads everything, since the module was just inserted
+  EXPECT_CALL(*qsfp_, updateQsfpData(true)).Times(1);
+  qsfp_->refresh();
+
+  // After that, only the flags are read until the DOM data goes stale
+  EXPECT_CALL(*qsfp_, updateQsfpData(_)).Times(0);
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 0, 15, _)).Times(2);
+  qsfp_->refresh();
+  qsfp_->refresh();
+}
+
 TEST_F(QsfpModuleTest, skipCustomizingMissingPorts) {
   // set present_ = false, dirty_ = true
   EXPECT_CALL(*transImpl_, detectTransceiver()).WillRepeatedly(Return(false));
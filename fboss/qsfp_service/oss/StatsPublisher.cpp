@@ -9,8 +9,22 @@
  */
 
 #include "fboss/qsfp_service/StatsPublisher.h"
+
+#include <fb303/ServiceData.h>
+
+namespace {
+constexpr auto kModuleRefreshTime = "qsfp.module_refresh.us";
+constexpr auto kSweepTime = "qsfp.refresh_sweep.us";
+} // namespace
+
 namespace facebook { namespace fboss {
 void StatsPublisher::init() {
+  // 10ms buckets up to a second per module, 100ms buckets up to 10s for
+  // refreshing all of them
+  fb303::fbData->addHistogram(kModuleRefreshTime, 10000, 0, 1000000);
+  fb303::fbData->exportHistogramPercentile(kModuleRefreshTime, 50, 95, 99);
+  fb303::fbData->addHistogram(kSweepTime, 100000, 0, 10000000);
+  fb303::fbData->exportHistogramPercentile(kSweepTime, 50, 95, 99);
 }
 
 void StatsPublisher::publishStats(folly::EventBase*, int32_t) {}
@@ -28,4 +42,13 @@ void StatsPublisher::missingPorts(TransceiverID /* unused */) {
 }
 // static
 void StatsPublisher::bumpModuleErrors() {}
+// static
+void StatsPublisher::recordModuleRefreshTime(
+    std::chrono::microseconds duration) {
+  fb303::fbData->addHistogramValue(kModuleRefreshTime, duration.count());
+}
+// static
+void StatsPublisher::recordSweepTime(std::chrono::microseconds duration) {
+  fb303::fbData->addHistogramValue(kSweepTime, duration.count());
+}
 }}
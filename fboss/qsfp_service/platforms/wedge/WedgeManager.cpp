@@ -3,9 +3,12 @@
 #include <folly/gen/Base.h>
 
 #include <folly/logging/xlog.h>
+#include "fboss/qsfp_service/StatsPublisher.h"
 #include "fboss/qsfp_service/module/sff/SffModule.h"
 #include "fboss/qsfp_service/platforms/wedge/WedgeQsfp.h"
 
+#include <chrono>
+
 namespace facebook { namespace fboss {
 
 WedgeManager::WedgeManager(std::unique_ptr<TransceiverPlatformApi> api) :
@@ -130,15 +133,37 @@ void WedgeManager::refreshTransceivers() {
   }
 
   std::vector<folly::Future<folly::Unit>> futs;
-  XLOG(INFO) << "Start refreshing all transceivers...";
+  XLOG(DBG2) << "Start refreshing all transceivers...";
+  auto start = std::chrono::steady_clock::now();
 
+  // Transceivers on different I2C buses have their own event bases and are
+  // refreshed in parallel. Those sharing a bus are serialized on its event
+  // base, or inline if the platform doesn't provide one.
   for (const auto& transceiver : transceivers_) {
     XLOG(DBG3) << "Fired to refresh transceiver " << transceiver->getID();
     futs.push_back(transceiver->futureRefresh());
   }
 
   folly::collectAll(futs.begin(), futs.end()).wait();
-  XLOG(INFO) << "Finished refreshing all transceivers";
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  StatsPublisher::recordSweepTime(duration);
+  XLOG(DBG2) << "Finished refreshing all transceivers in "
+             << duration.count() << "us";
+
+  std::map<int32_t, TransceiverInfo> infos;
+  for (const auto& transceiver : transceivers_) {
+    TransceiverInfo info;
+    try {
+      info = transceiver->getTransceiverInfo();
+    } catch (const std::exception& ex) {
+      // Not present, or not read yet
+      XLOG(DBG3) << "Transceiver " << transceiver->getID()
+                 << ": Error calling getTransceiverInfo(): " << ex.what();
+    }
+    infos[transceiver->getID()] = info;
+  }
+  updatePublisher_.transceiversUpdated(infos);
 }
 
 int WedgeManager::scanTransceiverPresence(
@@ -0,0 +1,70 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+#include "fboss/agent/BinaryDynamic.h"
+
+#include <folly/MemoryMapping.h>
+#include <folly/String.h>
+#include <folly/init/Init.h>
+#include <folly/json.h>
+#include <gflags/gflags.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace facebook::fboss;
+
+DEFINE_string(
+    path,
+    "",
+    "Only print the subtree at this dot separated list of object keys, "
+    "e.g. swSwitch.vlans");
+DEFINE_bool(
+    to_binary,
+    false,
+    "Convert a JSON switch state to the binary format instead of printing it");
+
+/*
+ * Print a switch state file, binary or JSON, as JSON. Or convert it to the
+ * binary warm boot format with --to_binary.
+ *
+ * usage: switch_state_converter [--path=KEYS] INPUT
+ *        switch_state_converter --to_binary INPUT OUTPUT
+ */
+int main(int argc, char* argv[]) {
+  folly::init(&argc, &argv, true);
+
+  if (argc != (FLAGS_to_binary ? 3 : 2)) {
+    std::cerr << "usage: " << argv[0] << " [--path=KEYS] INPUT" << std::endl
+              << "       " << argv[0] << " --to_binary INPUT OUTPUT"
+              << std::endl;
+    return 1;
+  }
+  std::string input = argv[1];
+
+  if (FLAGS_to_binary) {
+    if (!dumpBinaryStateToFile(argv[2], readStateFromFile(input))) {
+      std::cerr << "Failed to write " << argv[2] << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  std::vector<std::string> path;
+  if (!FLAGS_path.empty()) {
+    folly::split('.', FLAGS_path, path);
+  }
+  folly::MemoryMapping mapping(input.c_str());
+  folly::dynamic state;
+  if (isBinaryDynamic(mapping.range())) {
+    // Only the requested subtree is decoded
+    state = BinaryDynamicReader(mapping.range()).decode(path);
+  } else {
+    state = folly::parseJson(folly::StringPiece(mapping.range()));
+    for (const auto& key : path) {
+      auto next = state.isObject() ? state.get_ptr(key) : nullptr;
+      state = next ? folly::dynamic(*next) : nullptr;
+    }
+  }
+  std::cout << folly::toPrettyJson(state) << std::endl;
+  return 0;
+}